@@ -62,8 +62,8 @@ void NDR_InitASTNode(NDR_ASTNode* node){
     node->orderNumber = 0;
     node->numberOfChildren = 0;
     node->nodeType = 0;
-    node->lineNumber = 0;
-    node->columnNumber = 0;
+    node->offset = 0;
+    node->lineIndex = NULL;
 
     node->childrenAllocated = 50;
     node->children = malloc(sizeof(NDR_ASTNode*) * node->childrenAllocated);
@@ -174,11 +174,9 @@ void NDR_SetASTNodeOrderNumber(NDR_ASTNode* node, long orderNumber){
 void NDR_SetASTNodeNodeType(NDR_ASTNode* node, size_t nodeType){
     node->nodeType = nodeType;
 }
-void NDR_SetASTNodeLineNumber(NDR_ASTNode* node, size_t lineNumber){
-    node->lineNumber = lineNumber;
-}
-void NDR_SetASTNodeColumnNumber(NDR_ASTNode* node, size_t columnNumber){
-    node->columnNumber = columnNumber;
+void NDR_SetASTNodePosition(NDR_ASTNode* node, NDR_LineIndex* lineIndex, size_t offset){
+    node->lineIndex = lineIndex;
+    node->offset = offset;
 }
 
 void NDR_IncASTTotalNode(NDR_ASTNodeHolder* nodeWrapper){
@@ -199,11 +197,15 @@ size_t NDR_GetASTNodeNodeType(NDR_ASTNode* node){
     return node->nodeType;
 }
 size_t NDR_GetASTNodeLineNumber(NDR_ASTNode* node){
-    return node->lineNumber;
+    if(node->lineIndex == NULL)
+        return 0;
+    return NDR_LineIndexGetLine(node->lineIndex, node->offset);
 }
 size_t NDR_GetASTNodeColumnNumber(NDR_ASTNode* node){
-    return node->columnNumber;
-}
+    if(node->lineIndex == NULL)
+        return 0;
+    return NDR_LineIndexGetColumn(node->lineIndex, node->offset);
+}
 size_t NDR_GetASTNodeNumChildren(NDR_ASTNode* node){
     return node->numberOfChildren;
 }
@@ -38,6 +38,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define ASTNODE_H
 
 #include <stdbool.h>
+#include <stddef.h>
+
+#include "ndr_lineindex.h"
 
 //typedef struct NDR_ASTNode NDR_ASTNode;
 
@@ -53,8 +56,9 @@ typedef struct NDR_ASTNode{
     long orderNumber;
     size_t numberOfChildren;
     size_t nodeType;
-    size_t lineNumber;
-    size_t columnNumber;
+    // offset is the position of the first character of the node in the input, its line and column are found in lineIndex when asked for
+    size_t offset;
+    NDR_LineIndex* lineIndex;
     size_t childrenAllocated;
     struct NDR_ASTNode** children;
 } NDR_ASTNode;
@@ -150,18 +154,13 @@ void NDR_SetASTNodeOrderNumber(NDR_ASTNode* node, long orderNumber);
 * @param nodeType is the number to be used
 */
 void NDR_SetASTNodeNodeType(NDR_ASTNode* node, size_t nodeType);
-/** @brief Set the lineNumber in the abstract syntax tree node
-*
-* @param node is the structure to be modified
-* @param lineNumber is the number to be used
+/** @brief Set the position of the abstract syntax tree node in the input
+*
+* @param node is the structure to be modified
+* @param lineIndex holds the line starts of the input, or NULL when the position is unknown
+* @param offset is the position of the first character of the node in the input
 */
-void NDR_SetASTNodeLineNumber(NDR_ASTNode* node, size_t lineNumber);
-/** @brief Set the columnNumber in the abstract syntax tree node
-*
-* @param node is the structure to be modified
-* @param columnNumber is the number to be used
-*/
-void NDR_SetASTNodeColumnNumber(NDR_ASTNode* node, size_t columnNumber);
+void NDR_SetASTNodePosition(NDR_ASTNode* node, NDR_LineIndex* lineIndex, size_t offset);
 /** @brief Increment the total number of nodes int in the abstract syntax tree node by 1
 *
 * @param nodeWrapper is the structure to be modified
@@ -194,14 +193,16 @@ long NDR_GetASTNodeOrderNumber(NDR_ASTNode* node);
 size_t NDR_GetASTNodeNodeType(NDR_ASTNode* node);
 /** @brief Get the lineNumber associated with the abstract syntax tree node
 *
+* The line is looked up from the offset of the node, so it is only computed for nodes that are asked for
+*
 * @param node is an initialized abstract syntax tree node
-* @return the lineNumber in the abstract syntax tree node
+* @return the lineNumber in the abstract syntax tree node, or 0 when its position is unknown
 */
 size_t NDR_GetASTNodeLineNumber(NDR_ASTNode* node);
 /** @brief Get the columnNumber associated with the abstract syntax tree node
 *
 * @param node is an initialized abstract syntax tree node
-* @return the columnNumber in the abstract syntax tree node
+* @return the columnNumber in the abstract syntax tree node, or 0 when its position is unknown
 */
 size_t NDR_GetASTNodeColumnNumber(NDR_ASTNode* node);
 /** @brief Get the number of children associated with the abstract syntax tree node
@@ -45,21 +45,44 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 void NDR_InitTreeTokenInfoWrapper(NDR_TreeTokenInfoWrapper* tokenInfoWrapper){
     tokenInfoWrapper->numTokens = 0;
+    tokenInfoWrapper->numTokensCreated = 0;
     tokenInfoWrapper->memoryAllocated = 50;
     tokenInfoWrapper->tokens = malloc(sizeof(NDR_TreeTokenInfo*) * tokenInfoWrapper->memoryAllocated);
 }
 
+void NDR_FreeTreeTokenInfoWrapper(NDR_TreeTokenInfoWrapper* tokenInfoWrapper){
+    for(size_t x = 0; x < tokenInfoWrapper->numTokensCreated; x++){
+        NDR_FreeTokenInfo(tokenInfoWrapper->tokens[x]->tokenInfo);
+        free(tokenInfoWrapper->tokens[x]->tokenInfo);
+        free(tokenInfoWrapper->tokens[x]);
+    }
+    free(tokenInfoWrapper->tokens);
+}
+
+void NDR_ResetTreeTokenInfoWrapper(NDR_TreeTokenInfoWrapper* tokenInfoWrapper){
+    tokenInfoWrapper->numTokens = 0;
+}
+
 void NDR_AddTreeNewToken(NDR_TreeTokenInfoWrapper* tokenInfoWrapper){
     if(tokenInfoWrapper->numTokens > tokenInfoWrapper->memoryAllocated - 5){
         tokenInfoWrapper->memoryAllocated = tokenInfoWrapper->memoryAllocated * 2;
         tokenInfoWrapper->tokens = realloc(tokenInfoWrapper->tokens, sizeof(NDR_TreeTokenInfo*) * tokenInfoWrapper->memoryAllocated);
     }
+    // Tokens dropped while condensing the table and tokens left over from before the last reset are reused
+    if(tokenInfoWrapper->numTokens < tokenInfoWrapper->numTokensCreated){
+        tokenInfoWrapper->tokens[tokenInfoWrapper->numTokens]->nodeNumber = -1;
+        tokenInfoWrapper->tokens[tokenInfoWrapper->numTokens]->tokenInfo->keyword[0] = '\0';
+        tokenInfoWrapper->tokens[tokenInfoWrapper->numTokens]->tokenInfo->token[0] = '\0';
+        tokenInfoWrapper->numTokens++;
+        return;
+    }
     tokenInfoWrapper->tokens[tokenInfoWrapper->numTokens] = malloc(sizeof(NDR_TreeTokenInfo));
     tokenInfoWrapper->tokens[tokenInfoWrapper->numTokens]->nodeNumber = -1;
     tokenInfoWrapper->tokens[tokenInfoWrapper->numTokens]->tokenInfo = malloc(sizeof(NDR_TokenInformation));
     tokenInfoWrapper->tokens[tokenInfoWrapper->numTokens]->tokenInfo->keyword = malloc(1);
     tokenInfoWrapper->tokens[tokenInfoWrapper->numTokens]->tokenInfo->token = malloc(1);
     tokenInfoWrapper->numTokens++;
+    tokenInfoWrapper->numTokensCreated++;
 }
 
 void NDR_SetTreeTokenInfoKeyword(NDR_TreeTokenInfo* tokenInformation, char* keyword){
@@ -68,11 +91,8 @@ void NDR_SetTreeTokenInfoKeyword(NDR_TreeTokenInfo* tokenInformation, char* keyw
 void NDR_SetTreeTokenInfoToken(NDR_TreeTokenInfo* tokenInformation, char* token){
     NDR_SetTokenInfoToken(tokenInformation->tokenInfo, token);
 }
-void NDR_SetTreeTokenInfoLine(NDR_TreeTokenInfo* tokenInformation, size_t lineNumber){
-    NDR_SetTokenInfoLine(tokenInformation->tokenInfo, lineNumber);
-}
-void NDR_SetTreeTokenInfoColumn(NDR_TreeTokenInfo* tokenInformation, size_t columnNumber){
-    NDR_SetTokenInfoColumn(tokenInformation->tokenInfo, columnNumber);
+void NDR_SetTreeTokenInfoPosition(NDR_TreeTokenInfo* tokenInformation, NDR_TokenInformation* source){
+    NDR_CopyTokenInfoPosition(tokenInformation->tokenInfo, source);
 }
 void NDR_SetTreeTokenInfoNodeNumber(NDR_TreeTokenInfo* tokenInformation, long nodeNumber){
     tokenInformation->nodeNumber = nodeNumber;
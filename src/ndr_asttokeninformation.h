@@ -50,16 +50,19 @@ typedef struct NDR_TreeTokenInfo{
 
 typedef struct NDR_TreeTokenInfoWrapper {
     size_t numTokens;
+    // numTokensCreated counts every token allocated so far. Tokens past numTokens are reused after NDR_ResetTreeTokenInfoWrapper
+    size_t numTokensCreated;
     size_t memoryAllocated;
     NDR_TreeTokenInfo** tokens;
 } NDR_TreeTokenInfoWrapper;
 
 void NDR_InitTreeTokenInfoWrapper(NDR_TreeTokenInfoWrapper* tokenInfoWrapper);
+void NDR_FreeTreeTokenInfoWrapper(NDR_TreeTokenInfoWrapper* tokenInfoWrapper);
+void NDR_ResetTreeTokenInfoWrapper(NDR_TreeTokenInfoWrapper* tokenInfoWrapper);
 void NDR_AddTreeNewToken(NDR_TreeTokenInfoWrapper* tokenInfoWrapper);
 void NDR_SetTreeTokenInfoKeyword(NDR_TreeTokenInfo* tokenInformation, char* keyword);
 void NDR_SetTreeTokenInfoToken(NDR_TreeTokenInfo* tokenInformation, char* token);
-void NDR_SetTreeTokenInfoLine(NDR_TreeTokenInfo* tokenInformation, size_t lineNumber);
-void NDR_SetTreeTokenInfoColumn(NDR_TreeTokenInfo* tokenInformation, size_t columnNumber);
+void NDR_SetTreeTokenInfoPosition(NDR_TreeTokenInfo* tokenInformation, NDR_TokenInformation* source);
 void NDR_SetTreeTokenInfoNodeNumber(NDR_TreeTokenInfo* tokenInformation, long nodeNumber);
 
 char* NDR_GetTreeTokenInfoKeyword(NDR_TreeTokenInfo* tokenInformation);
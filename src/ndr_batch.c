@@ -0,0 +1,270 @@
+
+/*********************************************************************************
+*                                   NDR Batch                                    *
+**********************************************************************************/
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Neil Runcie
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "ndr_batch.h"
+#include "ndr_lexer.h"
+#include "ndr_parser.h"
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+// A range of file indices waiting to be processed by one worker
+// The owning worker takes files from the front and other workers steal from the back
+typedef struct NDR_BatchQueue {
+#ifndef _WIN32
+    pthread_mutex_t lock;
+#endif
+    size_t next;
+    size_t end;
+} NDR_BatchQueue;
+
+// The state shared by every worker of one call to NDR_Context_ParseBatch
+typedef struct NDR_Batch {
+    NDR_Context* configuredContext;
+    const char** files;
+    NDR_BatchCallback callback;
+    void* userData;
+    NDR_BatchQueue* queues;
+    size_t numWorkers;
+#ifndef _WIN32
+    pthread_mutex_t failureLock;
+#endif
+    size_t numFailures;
+} NDR_Batch;
+
+typedef struct NDR_BatchWorker {
+    NDR_Batch* batch;
+    size_t workerIndex;
+} NDR_BatchWorker;
+
+static void* RunBatchWorker(void* argument);
+static bool TakeNextFile(NDR_Batch* batch, size_t workerIndex, size_t* fileIndex);
+static bool TakeOwnFile(NDR_BatchQueue* queue, size_t* fileIndex);
+static bool StealFiles(NDR_Batch* batch, size_t workerIndex);
+static size_t GetWorkerCount(int threads, size_t numFiles);
+
+
+int NDR_ParseBatch(const char** files, size_t numFiles, int threads, NDR_BatchCallback callback, void* userData){
+    return NDR_Context_ParseBatch(NDR_GetDefaultContext(), files, numFiles, threads, callback, userData);
+}
+
+int NDR_Context_ParseBatch(NDR_Context* configuredContext, const char** files, size_t numFiles, int threads, NDR_BatchCallback callback, void* userData){
+
+    if(configuredContext->lexerConfiguringCompleted == false){
+        printf("The lexer must be configured before a batch of code files can be processed\n");
+        return 1;
+    }
+    if(numFiles == 0)
+        return 0;
+    if(files == NULL){
+        printf("A list of code files must be provided for batch processing\n");
+        return 1;
+    }
+
+    NDR_Batch batch;
+    batch.configuredContext = configuredContext;
+    batch.files = files;
+    batch.callback = callback;
+    batch.userData = userData;
+    batch.numWorkers = GetWorkerCount(threads, numFiles);
+    batch.numFailures = 0;
+    batch.queues = malloc(sizeof(NDR_BatchQueue) * batch.numWorkers);
+    NDR_BatchWorker* workers = malloc(sizeof(NDR_BatchWorker) * batch.numWorkers);
+
+    // Every worker starts with an even contiguous share of the files
+    for(size_t x = 0; x < batch.numWorkers; x++){
+        batch.queues[x].next = numFiles * x / batch.numWorkers;
+        batch.queues[x].end = numFiles * (x + 1) / batch.numWorkers;
+        workers[x].batch = &batch;
+        workers[x].workerIndex = x;
+    }
+
+#ifndef _WIN32
+    pthread_mutex_init(&batch.failureLock, NULL);
+    for(size_t x = 0; x < batch.numWorkers; x++)
+        pthread_mutex_init(&batch.queues[x].lock, NULL);
+
+    // The calling thread acts as the first worker
+    pthread_t* threadIDs = malloc(sizeof(pthread_t) * batch.numWorkers);
+    size_t numStarted = 1;
+    for(; numStarted < batch.numWorkers; numStarted++){
+        if(pthread_create(&threadIDs[numStarted], NULL, RunBatchWorker, &workers[numStarted]) != 0)
+            break;
+    }
+    // Files of workers that could not be started are stolen by the running workers
+    RunBatchWorker(&workers[0]);
+    for(size_t x = 1; x < numStarted; x++)
+        pthread_join(threadIDs[x], NULL);
+    free(threadIDs);
+
+    for(size_t x = 0; x < batch.numWorkers; x++)
+        pthread_mutex_destroy(&batch.queues[x].lock);
+    pthread_mutex_destroy(&batch.failureLock);
+#else
+    for(size_t x = 0; x < batch.numWorkers; x++)
+        RunBatchWorker(&workers[x]);
+#endif
+
+    free(workers);
+    free(batch.queues);
+
+    if(batch.numFailures > 0)
+        return 1;
+    return 0;
+}
+
+
+// Lex and parse files with a context that shares the batch configuration until no worker has files remaining
+void* RunBatchWorker(void* argument){
+    NDR_BatchWorker* worker = (NDR_BatchWorker*) argument;
+    NDR_Batch* batch = worker->batch;
+
+    NDR_Context context;
+    NDR_InitContext(&context);
+    NDR_Context_ShareConfiguration(&context, batch->configuredContext);
+    // The files are already spread over the workers so each file is lexed on its worker thread
+    NDR_Context_SetLexThreads(&context, 1);
+
+    size_t fileIndex;
+    while(TakeNextFile(batch, worker->workerIndex, &fileIndex) == true){
+        char* fileName = (char*) batch->files[fileIndex];
+
+        int result = NDR_Context_Lex(&context, fileName);
+        if(result == 0 && context.parserConfiguringCompleted == true)
+            result = NDR_Context_Parse(&context);
+
+        if(batch->callback != NULL)
+            batch->callback(&context, fileName, fileIndex, result, batch->userData);
+
+        if(result != 0){
+#ifndef _WIN32
+            pthread_mutex_lock(&batch->failureLock);
+            batch->numFailures++;
+            pthread_mutex_unlock(&batch->failureLock);
+#else
+            batch->numFailures++;
+#endif
+        }
+
+        NDR_Context_ResetInput(&context);
+    }
+
+    NDR_DestroyContext(&context);
+    return NULL;
+}
+
+bool TakeNextFile(NDR_Batch* batch, size_t workerIndex, size_t* fileIndex){
+    while(TakeOwnFile(&batch->queues[workerIndex], fileIndex) == false){
+        if(StealFiles(batch, workerIndex) == false)
+            return false;
+    }
+    return true;
+}
+
+bool TakeOwnFile(NDR_BatchQueue* queue, size_t* fileIndex){
+    bool taken = false;
+#ifndef _WIN32
+    pthread_mutex_lock(&queue->lock);
+#endif
+    if(queue->next < queue->end){
+        *fileIndex = queue->next;
+        queue->next++;
+        taken = true;
+    }
+#ifndef _WIN32
+    pthread_mutex_unlock(&queue->lock);
+#endif
+    return taken;
+}
+
+// Move the back half of the remaining files of another worker into the empty queue of workerIndex
+// Returns false once every other worker has run out of files
+bool StealFiles(NDR_Batch* batch, size_t workerIndex){
+    for(size_t x = 1; x < batch->numWorkers; x++){
+        NDR_BatchQueue* victim = &batch->queues[(workerIndex + x) % batch->numWorkers];
+        size_t stolenBegin = 0;
+        size_t stolenEnd = 0;
+
+#ifndef _WIN32
+        pthread_mutex_lock(&victim->lock);
+#endif
+        if(victim->next < victim->end){
+            stolenEnd = victim->end;
+            stolenBegin = victim->end - (victim->end - victim->next + 1) / 2;
+            victim->end = stolenBegin;
+        }
+#ifndef _WIN32
+        pthread_mutex_unlock(&victim->lock);
+#endif
+
+        if(stolenBegin < stolenEnd){
+            NDR_BatchQueue* queue = &batch->queues[workerIndex];
+#ifndef _WIN32
+            pthread_mutex_lock(&queue->lock);
+#endif
+            queue->next = stolenBegin;
+            queue->end = stolenEnd;
+#ifndef _WIN32
+            pthread_mutex_unlock(&queue->lock);
+#endif
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t GetWorkerCount(int threads, size_t numFiles){
+    size_t numWorkers = 1;
+    if(threads > 0){
+        numWorkers = (size_t) threads;
+    }
+    else{
+#ifndef _WIN32
+        long numProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+        if(numProcessors > 0)
+            numWorkers = (size_t) numProcessors;
+#endif
+    }
+    if(numWorkers > numFiles)
+        numWorkers = numFiles;
+    return numWorkers;
+}
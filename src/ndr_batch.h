@@ -0,0 +1,85 @@
+
+/*********************************************************************************
+*                                   NDR Batch                                    *
+**********************************************************************************/
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Neil Runcie
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef NDRBATCH_H
+#define NDRBATCH_H
+
+#include <stddef.h>
+
+#include "ndr_context.h"
+
+/** @brief A function called once for every file processed by NDR_ParseBatch
+*
+* The function is called from the worker thread that processed the file, so it can be called by several threads at the same time.
+* The token table and syntax tree held by context are only valid until the function returns.
+* The AST traversal functions such as NDR_ASTPreOrderTraversal keep internal state and must not be used by more than one thread at a time
+*
+* @param context is the context of the worker that processed the file, its TIWrapper holds the token table and NDR_Context_GetASTHead returns the syntax tree
+* @param fileName is the name of the file that was processed
+* @param fileIndex is the position of fileName in the list of files provided to NDR_ParseBatch
+* @param result is 0 if lexing and parsing succeeded and non-zero otherwise
+* @param userData is the pointer provided to NDR_ParseBatch
+*/
+typedef void (*NDR_BatchCallback)(NDR_Context* context, const char* fileName, size_t fileIndex, int result, void* userData);
+
+/** @brief Lex and parse a list of code files on a pool of threads that share the configuration of the default context
+*
+* NDR_Configure_Lexer must be called first. The files are parsed as well when NDR_Configure_Parser has been called
+*
+* @param files is the list of names of the code files to be processed
+* @param numFiles is the number of names found in files
+* @param threads is the number of worker threads to use, or 0 to use one for every online processor
+* @param callback is called with the results of each file, it can be NULL
+* @param userData is passed to every call of callback
+* @return The success status of the function. 0 if every file was processed successfully and non-zero otherwise
+*/
+int NDR_ParseBatch(const char** files, size_t numFiles, int threads, NDR_BatchCallback callback, void* userData);
+/** @brief Lex and parse a list of code files on a pool of threads that share the configuration of the provided context
+*
+* Every worker thread uses its own context that shares the configuration through NDR_Context_ShareConfiguration.
+* Each worker starts with an even share of the files and takes half of the remaining files of another worker once its own are finished
+*
+* @param configuredContext is an NDR_Context structure that has been configured for lexing and optionally for parsing
+* @param files is the list of names of the code files to be processed
+* @param numFiles is the number of names found in files
+* @param threads is the number of worker threads to use, or 0 to use one for every online processor
+* @param callback is called with the results of each file, it can be NULL
+* @param userData is passed to every call of callback
+* @return The success status of the function. 0 if every file was processed successfully and non-zero otherwise
+*/
+int NDR_Context_ParseBatch(NDR_Context* configuredContext, const char** files, size_t numFiles, int threads, NDR_BatchCallback callback, void* userData);
+
+#endif
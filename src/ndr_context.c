@@ -0,0 +1,256 @@
+
+
+/*********************************************************************************
+*                                  NDR Context                                   *
+**********************************************************************************/
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Neil Runcie
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "ndr_context.h"
+#include "ndr_parser.h"
+
+static void ReleaseSyntaxTree(NDR_Context* context, NDR_ASTNodeHolder* nodePool);
+static void ReleaseParsedNode(NDR_ASTNode* node, NDR_ASTNodeHolder* nodePool);
+static void ReleaseASTNode(NDR_ASTNode* node, NDR_ASTNodeHolder* nodePool);
+
+static NDR_Context defaultContext;
+static bool defaultContextInitialized = false;
+
+void NDR_InitContext(NDR_Context* context){
+    context->autoCap = true;
+    context->autoTrim = true;
+    context->matchAll = true;
+    context->matchAllSeen = false;
+    context->lexThreads = 0;
+    context->regexEngine = NDR_REGEX_ENGINE_AUTO;
+    context->inputLength = 0;
+
+    context->lexerConfiguringAttempted = false;
+    context->lexingAttempted = false;
+    context->lexerConfiguringCompleted = false;
+    context->lexingCompleted = false;
+    context->parserConfiguringAttempted = false;
+    context->parsingAttempted = false;
+    context->parserConfiguringCompleted = false;
+    context->parsingCompleted = false;
+    context->ownsConfiguration = true;
+
+    context->RSWrapper = NULL;
+    context->lexerDFA = NULL;
+    context->lexerTrie = NULL;
+    context->lexerImage = NULL;
+    context->lexerConfigHash = 0;
+    context->tokenCacheDirectory = NULL;
+    context->TIWrapper = NULL;
+    context->lineIndex = NULL;
+    context->PIWrapper = NULL;
+    context->TTIWrapper = NULL;
+    context->NWrapper = NULL;
+    context->ASThead = NULL;
+    context->ASTNodePool = NULL;
+}
+
+void NDR_DestroyContext(NDR_Context* context){
+    if(context->ownsConfiguration == false){
+        context->RSWrapper = NULL;
+        context->lexerDFA = NULL;
+        context->lexerTrie = NULL;
+        context->lexerImage = NULL;
+        context->PIWrapper = NULL;
+    }
+    if(context->RSWrapper != NULL){
+        NDR_FreeRegexStateWrapper(context->RSWrapper);
+        free(context->RSWrapper);
+    }
+    if(context->lexerDFA != NULL){
+        NDR_FreeLexerDFA(context->lexerDFA);
+        free(context->lexerDFA);
+    }
+    if(context->lexerTrie != NULL){
+        NDR_FreeLexerTrie(context->lexerTrie);
+        free(context->lexerTrie);
+    }
+    // The image is released after the automaton and trie whose tables may refer to it
+    if(context->lexerImage != NULL){
+        NDR_UnmapFile(context->lexerImage);
+        free(context->lexerImage);
+    }
+    free(context->tokenCacheDirectory);
+    if(context->TIWrapper != NULL){
+        NDR_FreeTokenInfoWrapper(context->TIWrapper);
+        free(context->TIWrapper);
+    }
+    if(context->lineIndex != NULL){
+        NDR_FreeLineIndex(context->lineIndex);
+        free(context->lineIndex);
+    }
+    if(context->PIWrapper != NULL){
+        NDR_FreeSequenceInfoWrapper(context->PIWrapper);
+        free(context->PIWrapper);
+    }
+    if(context->TTIWrapper != NULL){
+        NDR_FreeTreeTokenInfoWrapper(context->TTIWrapper);
+        free(context->TTIWrapper);
+    }
+    ReleaseSyntaxTree(context, NULL);
+    if(context->NWrapper != NULL){
+        free(context->NWrapper->nodes);
+        free(context->NWrapper);
+    }
+    if(context->ASTNodePool != NULL){
+        for(size_t x = 0; x < context->ASTNodePool->numNodes; x++)
+            ReleaseASTNode(context->ASTNodePool->nodes[x], NULL);
+        free(context->ASTNodePool->nodes);
+        free(context->ASTNodePool);
+    }
+
+    NDR_InitContext(context);
+}
+
+void NDR_Context_ResetInput(NDR_Context* context){
+    if(context->TIWrapper != NULL)
+        NDR_ResetTokenInfoWrapper(context->TIWrapper);
+    NDR_Context_ResetParse(context);
+
+    context->lexingAttempted = false;
+    context->lexingCompleted = false;
+}
+
+void NDR_Context_ResetParse(NDR_Context* context){
+    if(context->TTIWrapper != NULL)
+        NDR_ResetTreeTokenInfoWrapper(context->TTIWrapper);
+
+    if(context->ASTNodePool == NULL){
+        context->ASTNodePool = malloc(sizeof(NDR_ASTNodeHolder));
+        NDR_InitASTNodeHolder(context->ASTNodePool);
+    }
+    ReleaseSyntaxTree(context, context->ASTNodePool);
+
+    context->parsingAttempted = false;
+    context->parsingCompleted = false;
+}
+
+void NDR_ResetInput(){
+    NDR_Context_ResetInput(NDR_GetDefaultContext());
+    NDR_ASThead = NULL;
+}
+
+int NDR_Context_ShareConfiguration(NDR_Context* context, NDR_Context* configuredContext){
+    if(configuredContext->lexerConfiguringCompleted == false){
+        printf("The lexer must be configured before its configuration can be shared\n");
+        return 1;
+    }
+    if(context->lexerConfiguringAttempted == true || context->parserConfiguringAttempted == true){
+        printf("Configuration has already been performed on the context that would share a configuration\n");
+        return 1;
+    }
+
+    context->autoCap = configuredContext->autoCap;
+    context->autoTrim = configuredContext->autoTrim;
+    context->matchAll = configuredContext->matchAll;
+    context->matchAllSeen = configuredContext->matchAllSeen;
+    context->lexThreads = configuredContext->lexThreads;
+    context->regexEngine = configuredContext->regexEngine;
+    if(configuredContext->tokenCacheDirectory != NULL && context->tokenCacheDirectory == NULL){
+        context->tokenCacheDirectory = malloc(strlen(configuredContext->tokenCacheDirectory) + 1);
+        strcpy(context->tokenCacheDirectory, configuredContext->tokenCacheDirectory);
+    }
+
+    context->RSWrapper = configuredContext->RSWrapper;
+    context->lexerDFA = configuredContext->lexerDFA;
+    context->lexerTrie = configuredContext->lexerTrie;
+    context->lexerImage = configuredContext->lexerImage;
+    context->lexerConfigHash = configuredContext->lexerConfigHash;
+    context->lexerConfiguringAttempted = true;
+    context->lexerConfiguringCompleted = true;
+    if(configuredContext->parserConfiguringCompleted == true){
+        context->PIWrapper = configuredContext->PIWrapper;
+        context->parserConfiguringAttempted = true;
+        context->parserConfiguringCompleted = true;
+    }
+    context->ownsConfiguration = false;
+
+    return 0;
+}
+
+NDR_ASTNode* NDR_Context_GetASTHead(NDR_Context* context){
+    return context->ASThead;
+}
+
+NDR_Context* NDR_GetDefaultContext(){
+    if(defaultContextInitialized == false){
+        NDR_InitContext(&defaultContext);
+        defaultContextInitialized = true;
+    }
+    return &defaultContext;
+}
+
+// Release every node created by the last parse. Nodes are added to nodePool when it is provided and freed otherwise
+// Every parent node other than the head is held in NWrapper and every leaf belongs to exactly one parent
+// Parents are always created after their children so they are released newest first while their children are still readable
+void ReleaseSyntaxTree(NDR_Context* context, NDR_ASTNodeHolder* nodePool){
+    if(context->ASThead != NULL)
+        ReleaseParsedNode(context->ASThead, nodePool);
+    context->ASThead = NULL;
+
+    if(context->NWrapper != NULL){
+        for(size_t x = context->NWrapper->numNodes; x > 0; x--)
+            ReleaseParsedNode(context->NWrapper->nodes[x - 1], nodePool);
+        context->NWrapper->numNodes = 0;
+        context->NWrapper->totalNodesInTree = 0;
+    }
+}
+
+// Release a parent node created during parsing together with its leaf children
+void ReleaseParsedNode(NDR_ASTNode* node, NDR_ASTNodeHolder* nodePool){
+    for(size_t x = 0; x < node->numberOfChildren; x++){
+        if(node->children[x]->nodeType == 0)
+            ReleaseASTNode(node->children[x], nodePool);
+    }
+    ReleaseASTNode(node, nodePool);
+}
+
+void ReleaseASTNode(NDR_ASTNode* node, NDR_ASTNodeHolder* nodePool){
+    if(nodePool != NULL){
+        NDR_AddNewASTNode(nodePool, node);
+        return;
+    }
+    free(node->token);
+    free(node->keyword);
+    free(node->children);
+    free(node);
+}
@@ -0,0 +1,158 @@
+
+
+/*********************************************************************************
+*                                  NDR Context                                   *
+**********************************************************************************/
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Neil Runcie
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef NDRCONTEXT_H
+#define NDRCONTEXT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ndr_regexstate.h"
+#include "ndr_lexerdfa.h"
+#include "ndr_lexertrie.h"
+#include "ndr_fileprocessor.h"
+#include "ndr_tokeninformation.h"
+#include "ndr_sequenceinformation.h"
+#include "ndr_asttokeninformation.h"
+#include "ndr_astnode.h"
+
+/**
+* @struct NDR_Context
+* @brief A container for all of the state used by one lexer and parser so that several can be used at the same time
+*/
+typedef struct NDR_Context {
+    // autoCap adds ^ to the beginning and \z to the end of every regex descriptor in lexer config file
+    bool autoCap;
+    // autoTrim removes the space from the beginning and end of every regex descriptor in lexer config file
+    bool autoTrim;
+    // matchAll toggles error catching for failure to match all characters in lexer config file
+    bool matchAll;
+    bool matchAllSeen;
+    // lexThreads is the largest number of threads used to lex one input, 0 uses one for every online processor
+    int lexThreads;
+    // regexEngine is how regexes are matched when their rules do not give an engine, NDR_REGEX_ENGINE_PIKEVM forbids backtracking in every rule
+    NDR_RegexEngine regexEngine;
+    // inputLength is the number of bytes of the input of the last lexical analysis
+    size_t inputLength;
+
+    bool lexerConfiguringAttempted;
+    bool lexingAttempted;
+    bool lexerConfiguringCompleted;
+    bool lexingCompleted;
+    bool parserConfiguringAttempted;
+    bool parsingAttempted;
+    bool parserConfiguringCompleted;
+    bool parsingCompleted;
+    // ownsConfiguration is false when RSWrapper, lexerDFA, lexerTrie, lexerImage and PIWrapper are shared from another context and must not be freed
+    bool ownsConfiguration;
+
+    // RSWrapper holds the symbol table built from the lexer configuration file
+    NDR_RegexStateWrapper* RSWrapper;
+    // lexerDFA combines every start regex that is not a literal into one automaton so each character is matched once for all of them
+    NDR_LexerDFA* lexerDFA;
+    // lexerTrie holds every start regex that only matches one fixed string, NULL when there are none
+    NDR_LexerTrie* lexerTrie;
+    // lexerImage holds the mapped lexer image that lexerDFA and lexerTrie refer to when the lexer was configured from one, NULL otherwise
+    NDR_MappedFile* lexerImage;
+    // lexerConfigHash is the hash of the lexer configuration file, recorded in lexer images to detect when they are out of date
+    uint64_t lexerConfigHash;
+    // tokenCacheDirectory is the directory that token tables are cached in, NULL when no token cache is used
+    char* tokenCacheDirectory;
+    // TIWrapper holds the tokens found during lexing
+    NDR_TokenInformationWrapper* TIWrapper;
+    // lineIndex holds the line starts of the lexed input that the line and column numbers of the tokens are found from
+    NDR_LineIndex* lineIndex;
+    // PIWrapper holds the parsing sequences built from the parser configuration file
+    NDR_SequenceInformationWrapper* PIWrapper;
+    // TTIWrapper holds the tokens that are condensed during parsing
+    NDR_TreeTokenInfoWrapper* TTIWrapper;
+    // NWrapper holds the nodes created during parsing that are not yet attached to a parent
+    NDR_ASTNodeHolder* NWrapper;
+    // ASThead refers to the top level node in the syntax tree
+    NDR_ASTNode* ASThead;
+    // ASTNodePool holds the nodes of syntax trees released by NDR_Context_ResetInput so that the next parse can reuse them
+    NDR_ASTNodeHolder* ASTNodePool;
+} NDR_Context;
+
+/** @brief Initialize an NDR_Context structure so that it can be configured
+*
+* @param context is a structure that has memory allocated to it
+*/
+void NDR_InitContext(NDR_Context* context);
+/** @brief Free the memory of everything held by an NDR_Context structure including its abstract syntax tree
+*
+* @param context is an initialized NDR_Context structure
+*/
+void NDR_DestroyContext(NDR_Context* context);
+/** @brief Prepare a configured context to lex and parse another input
+*
+* The lexer and parser configuration is kept while the token tables and syntax tree nodes are kept for reuse by the next input.
+* The syntax tree of the previous input can no longer be used after this call
+*
+* @param context is an initialized NDR_Context structure
+*/
+void NDR_Context_ResetInput(NDR_Context* context);
+/** @brief Discard the syntax tree of a context so that its token table can be parsed again
+*
+* @param context is an initialized NDR_Context structure
+*/
+void NDR_Context_ResetParse(NDR_Context* context);
+/** @brief Prepare the default context to lex and parse another input, see NDR_Context_ResetInput */
+void NDR_ResetInput();
+/** @brief Let a context lex and parse with the configuration of another context without copying it
+*
+* The configuration is only read while lexing and parsing so any number of contexts, including contexts used on different threads, can share it.
+* The configured context must not be destroyed or reconfigured while another context shares its configuration
+*
+* @param context is an initialized NDR_Context structure that has not been configured
+* @param configuredContext is a context that has completed lexer configuration and optionally parser configuration
+* @return 0 on success, or 1 if the configured context has no lexer configuration or context has already been configured
+*/
+int NDR_Context_ShareConfiguration(NDR_Context* context, NDR_Context* configuredContext);
+/** @brief Get the head of the abstract syntax tree generated by parsing with the provided context
+*
+* @param context is an initialized NDR_Context structure
+* @return The head of the abstract syntax tree or NULL if parsing has not completed
+*/
+NDR_ASTNode* NDR_Context_GetASTHead(NDR_Context* context);
+/** @brief Get the context used by the functions that do not take a context such as NDR_Configure_Lexer and NDR_Parse
+*
+* @return The default context which is initialized on first use
+*/
+NDR_Context* NDR_GetDefaultContext();
+
+#endif
@@ -47,6 +47,10 @@ void NDR_InitializeRegexState(NDR_RegexState* state){
     state->isState = false;
     state->isLiteral = false;
     state->category = NDR_STATE_ACCEPT;
+    state->modes = 1;
+    state->modeAction = NDR_MODE_NONE;
+    state->modeTarget = 0;
+    state->engine = NDR_REGEX_ENGINE_AUTO;
     state->numStartStates = 0;
     state->numAllowStates = 0;
     state->numEscapeStates = 0;
@@ -59,6 +63,10 @@ void NDR_InitializeRegexState(NDR_RegexState* state){
     state->compiledAllowRegex = malloc(sizeof(NDR_Regex*));
     state->compiledEscapeRegex = malloc(sizeof(NDR_Regex*));
     state->compiledEndRegex = malloc(sizeof(NDR_Regex*));
+    memset(state->allowedBytes, 0, sizeof(state->allowedBytes));
+    memset(state->escapedBytes, 0, sizeof(state->escapedBytes));
+    memset(state->plainBytes, 0, sizeof(state->plainBytes));
+    state->numStopBytes = 0;
 }
 
 
@@ -70,18 +78,22 @@ void NDR_FreeRegexState(NDR_RegexState* state){
     for(size_t x = 0; x < state->numStartStates; x++){
         free(state->startRegex[x]);
         NDR_DestroyRegex(state->compiledStartRegex[x]);
+        free(state->compiledStartRegex[x]);
     }
     for(size_t x = 0; x < state->numAllowStates; x++){
         free(state->allowRegex[x]);
         NDR_DestroyRegex(state->compiledAllowRegex[x]);
+        free(state->compiledAllowRegex[x]);
     }
     for(size_t x = 0; x < state->numEscapeStates; x++){
         free(state->escapeRegex[x]);
         NDR_DestroyRegex(state->compiledEscapeRegex[x]);
+        free(state->compiledEscapeRegex[x]);
     }
     for(size_t x = 0; x < state->numEndStates; x++){
         free(state->endRegex[x]);
         NDR_DestroyRegex(state->compiledEndRegex[x]);
+        free(state->compiledEndRegex[x]);
     }
     free(state->startRegex);
     free(state->allowRegex);
@@ -164,6 +176,24 @@ int NDR_CompileStateRegex(NDR_Regex** regexTable, int stateIndex, char* regex){
     return 0;
 }
 
+// Regexes that failed to compile are never matched so they keep their engine
+char* NDR_SetStateRegexEngine(NDR_RegexState* state, NDR_RegexEngine engine){
+    NDR_Regex** regexTables[4] = {state->compiledStartRegex, state->compiledAllowRegex, state->compiledEscapeRegex, state->compiledEndRegex};
+    char** regexStrings[4] = {state->startRegex, state->allowRegex, state->escapeRegex, state->endRegex};
+    size_t numRegexes[4] = {state->numStartStates, state->numAllowStates, state->numEscapeStates, state->numEndStates};
+
+    for(int table = 0; table < 4; table++){
+        for(size_t x = 0; x < numRegexes[table]; x++){
+            if(NDR_Regex_IsCompiled(regexTables[table][x]) == false)
+                continue;
+            if(NDR_Regex_SetEngine(regexTables[table][x], engine) != 0)
+                return regexStrings[table][x];
+        }
+    }
+
+    return NULL;
+}
+
 
 int NDR_RSGetMatchResult(NDR_RegexState* regexState, char* token, NDR_StateCategories category, int regIndex){
     if(category == NDR_STATE_STARTSTATE)
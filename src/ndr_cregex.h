@@ -42,16 +42,32 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <string.h>
 #include <ctype.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "ndr_statecategories.h"
 
 #include "regex_engines/ndr_regex.h"
 
+// Upper bound on the number of stop bytes listed for a state token. States with more are scanned using plainBytes alone
+#define NDR_RS_MAXSTOPBYTES 4
+
+// The change of lexer mode made once a token of a regex state has been matched
+typedef enum NDR_ModeAction{
+    NDR_MODE_NONE, NDR_MODE_PUSH, NDR_MODE_POP, NDR_MODE_SWITCH
+} NDR_ModeAction;
+
 typedef struct NDR_RegexState {
     char* keyword;
     bool isState;
     bool isLiteral;
     NDR_StateCategories category;
+    // modes holds a bit for every lexer mode the start regexes of the state are matched in, bit 0 being the initial mode
+    uint64_t modes;
+    // modeAction is applied to the mode stack when a token of the state is matched, modeTarget is the mode pushed or switched to
+    NDR_ModeAction modeAction;
+    int modeTarget;
+    // engine is how the regexes of the state are matched on their own, NDR_REGEX_ENGINE_AUTO unless the rule gives one
+    NDR_RegexEngine engine;
 
     size_t numStartStates;
     size_t numAllowStates;
@@ -65,6 +81,14 @@ typedef struct NDR_RegexState {
     NDR_Regex** compiledAllowRegex;
     NDR_Regex** compiledEscapeRegex;
     NDR_Regex** compiledEndRegex;
+    // allowedBytes and escapedBytes hold whether each byte value, read as a one character string, matches an allow or escape regex of the state
+    bool allowedBytes[256];
+    bool escapedBytes[256];
+    // plainBytes holds the bytes that are allowed, are not escapes and cannot begin an end regex, so they are added to a state token without further checks
+    bool plainBytes[256];
+    // stopBytes lists every byte that is not plain when there are at most NDR_RS_MAXSTOPBYTES of them, numStopBytes is 0 otherwise
+    size_t numStopBytes;
+    unsigned char stopBytes[NDR_RS_MAXSTOPBYTES];
 } NDR_RegexState;
 
 void NDR_InitializeRegexState(NDR_RegexState* state);
@@ -74,6 +98,8 @@ int NDR_AddAllowRegex(NDR_RegexState* state, char* regex);
 int NDR_AddEscapeRegex(NDR_RegexState* state, char* regex);
 int NDR_AddEndRegex(NDR_RegexState* state, char* regex);
 int NDR_CompileStateRegex(NDR_Regex** regexTable, int stateIndex, char* regex);
+// Set how every compiled regex of the state is matched. Returns the regex string that cannot use the engine, or NULL on success
+char* NDR_SetStateRegexEngine(NDR_RegexState* state, NDR_RegexEngine engine);
 int NDR_RSGetMatchResult(NDR_RegexState* regexState, char* token, NDR_StateCategories category, int regIndex);
 
 #endif
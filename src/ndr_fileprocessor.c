@@ -41,6 +41,13 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <stdbool.h>
 #include "ndr_fileprocessor.h"
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 
 
 /*
@@ -70,6 +77,13 @@ static void NDR_AddLine(NDR_FileInformation* fileInfo, char* line, char* separat
 * \param token is the new token to be added to the line
 */
 static void NDR_AddToken(NDR_LineInformation* lineInfo, char* token);
+/*
+* \fn NDR_ReadFileContents
+* \brief Reads an open file into a single allocated block of memory when the file cannot be memory mapped
+* \param file is the open file to be read
+* \param mappedFile is the NDR_MappedFile structure that will hold the contents of the file
+*/
+static int NDR_ReadFileContents(FILE* file, NDR_MappedFile* mappedFile);
 
 
 int NDR_ProcessFile(char* fileName, NDR_FileInformation* fileInfo, char* separator){
@@ -227,3 +241,79 @@ char* NDR_GetOriginalLine(NDR_LineInformation* lineInfo){
 size_t NDR_GetNumberOfTokens(NDR_LineInformation* lineInfo){
     return lineInfo->numberOfTokens;
 }
+
+int NDR_MapFile(char* fileName, NDR_MappedFile* mappedFile){
+
+    mappedFile->data = NULL;
+    mappedFile->length = 0;
+    mappedFile->mapped = false;
+
+    if(fileName == NULL || strcmp(fileName, "") == 0)
+        return 1;
+
+#ifndef _WIN32
+    int descriptor = open(fileName, O_RDONLY);
+    if(descriptor < 0)
+        return 1;
+
+    struct stat fileStatus;
+    if(fstat(descriptor, &fileStatus) == 0 && S_ISREG(fileStatus.st_mode) && fileStatus.st_size > 0){
+        void* data = mmap(NULL, (size_t) fileStatus.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if(data != MAP_FAILED){
+            mappedFile->data = data;
+            mappedFile->length = (size_t) fileStatus.st_size;
+            mappedFile->mapped = true;
+            close(descriptor);
+            return 0;
+        }
+    }
+    close(descriptor);
+#endif
+
+    // Files that cannot be mapped (pipes, devices, or text mode newline translation on windows) are read instead
+    FILE* file = fopen(fileName, "r");
+    if(file == NULL)
+        return 1;
+    int result = NDR_ReadFileContents(file, mappedFile);
+    fclose(file);
+
+    return result;
+}
+
+void NDR_UnmapFile(NDR_MappedFile* mappedFile){
+#ifndef _WIN32
+    if(mappedFile->mapped == true)
+        munmap(mappedFile->data, mappedFile->length);
+    else
+        free(mappedFile->data);
+#else
+    free(mappedFile->data);
+#endif
+    mappedFile->data = NULL;
+    mappedFile->length = 0;
+    mappedFile->mapped = false;
+}
+
+int NDR_ReadFileContents(FILE* file, NDR_MappedFile* mappedFile){
+
+    size_t memoryAllocated = 4096;
+    size_t amountRead;
+    mappedFile->data = malloc(memoryAllocated);
+
+    while((amountRead = fread(mappedFile->data + mappedFile->length, 1, memoryAllocated - mappedFile->length, file)) > 0){
+        mappedFile->length += amountRead;
+        if(mappedFile->length == memoryAllocated){
+            memoryAllocated = memoryAllocated * 2;
+            mappedFile->data = realloc(mappedFile->data, memoryAllocated);
+        }
+    }
+
+    if(ferror(file)){
+        free(mappedFile->data);
+        mappedFile->data = NULL;
+        mappedFile->length = 0;
+        return 1;
+    }
+
+    return 0;
+}
@@ -37,6 +37,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef NDRFILEPROCESSOR_H
 #define NDRFILEPROCESSOR_H
 
+#include <stddef.h>
 #include <stdbool.h>
 
 
@@ -64,6 +65,15 @@ typedef struct NDR_FileInformation {
     size_t longestTokenAmount;
     bool fileError;
 } NDR_FileInformation;
+/**
+* \struct NDR_MappedFile
+* \brief provides the entire contents of a file as one contiguous block of memory
+*/
+typedef struct NDR_MappedFile {
+    char* data;
+    size_t length;
+    bool mapped;
+} NDR_MappedFile;
 /** @brief A destructor style function for freeing the memory used within the NDR_FileInformation structure
 * 
 * @param fileInfo is a NDR_FileInformation* that has been previously used with NDR_InitializeFileInformation
@@ -141,5 +151,18 @@ char* NDR_GetOriginalLine(NDR_LineInformation* lineInfo);
 */
 size_t NDR_GetNumberOfTokens(NDR_LineInformation* lineInfo);
 
+/** @brief Make the entire contents of a file available as one contiguous block of memory. The file is memory mapped when possible and read otherwise
+*
+* @param fileName is the name of the file to be loaded
+* @param mappedFile is a structure that will hold the contents of the file
+* @return An int signaling the result of the function. 0 is success and 1 is failure
+*/
+int NDR_MapFile(char* fileName, NDR_MappedFile* mappedFile);
+/** @brief Release the memory used by a file loaded with NDR_MapFile
+*
+* @param mappedFile is a structure that has been previously used with NDR_MapFile
+*/
+void NDR_UnmapFile(NDR_MappedFile* mappedFile);
+
 
 #endif
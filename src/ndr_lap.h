@@ -38,9 +38,13 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define NDRLAP_H
 
 #include "../src/ndr_astnode.h"
+#include "../src/ndr_batch.h"
+#include "../src/ndr_context.h"
 #include "../src/ndr_debug.h"
 #include "../src/ndr_fileprocessor.h"
 #include "../src/ndr_lexer.h"
+#include "../src/ndr_lexerimage.h"
 #include "../src/ndr_parser.h"
+#include "../src/ndr_tokencache.h"
 
 #endif
@@ -41,22 +41,35 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <stdbool.h>
 
 #include "ndr_lexer.h"
+#include "ndr_context.h"
 #include "ndr_fileprocessor.h"
 #include "ndr_matchstate.h"
 #include "ndr_statecategories.h"
 
 #include "ndr_tokeninformation.h"
+#include "ndr_tokenstore.h"
 #include "ndr_regexstate.h"
+#include "ndr_lexerdfa.h"
+#include "ndr_lexertrie.h"
+#include "ndr_lexerimage.h"
+#include "ndr_tokencache.h"
+#include "regex_engines/ndr_regexnfa.h"
 #include "ndr_debug.h"
+#include "ndr_parser.h"
 
-// the NEWLINEMULTIPLIER is used because the newline takes two bytes in windows '\r''\n' whereas linux uses one byte '\n'
-#ifdef _WIN32
-#define NEWLINEMULTIPLIER 1
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
 #endif
 
-#ifdef linux
-#define NEWLINEMULTIPLIER 0
+// Inputs are split for lexing on several threads only when every chunk gets at least this many bytes
+#ifndef NDR_LEXER_MINIMUM_CHUNK
+#define NDR_LEXER_MINIMUM_CHUNK 1048576
 #endif
+// The number of bytes at the start of a chunk in which token boundaries are kept for joining it to the previous chunk
+#define NDR_LEXER_RESYNC_WINDOW 65536
+// The number of bytes requested from the read callback of a stream each time its window runs out
+#define NDR_LEXSTREAM_READ_SIZE 65536
 
 
 typedef struct LexerLineCategorizer {
@@ -73,16 +86,106 @@ typedef struct StateRepresentation {
     bool endState;
 } StateRepresentation;
 
+typedef struct LexerInput {
+    // data holds the input from position base up to position length
+    const char* data;
+    size_t base;
+    size_t length;
+    size_t position;
+    // limit ends lexing at the first token that would start at or after it, a token that starts before it is always completed
+    size_t limit;
+    // speculative input starts at a guessed token boundary so its errors are not reported
+    bool speculative;
+    // furthestPosition is one past the furthest position read so far, reading the end of the input counts as reading position length
+    size_t furthestPosition;
+    // read refills the window held by buffer once every byte of data has been read, it is NULL when data holds the whole input
+    // Bytes before keepPosition are no longer needed and are dropped from the window when it is refilled
+    NDR_ReadCallback read;
+    void* userData;
+    char* buffer;
+    size_t bufferSize;
+    size_t keepPosition;
+    bool endOfInput;
+    // lineIndex finds the line and column of a position of the input, the bytes of a streamed input are added to it as they are read
+    NDR_LineIndex* lineIndex;
+} LexerInput;
+
+// A position between two tokens passed while lexing a chunk
+typedef struct LexerBoundary {
+    size_t position;
+    size_t tokenIndex;
+    // furthestPosition is the furthest position of the input read when the boundary was reached
+    // nextTokenFurthestPosition is the furthest position read when the next kept token started, or when lexing stopped without one
+    size_t furthestPosition;
+    size_t nextTokenFurthestPosition;
+} LexerBoundary;
+
+// A part of the input that is lexed on its own thread
+typedef struct LexerChunk {
+    NDR_Context* context;
+    LexerInput input;
+    // TIWrapper receives the tokens of the chunk
+    NDR_TokenInformationWrapper* TIWrapper;
+    // tokenStore receives the tokens instead of TIWrapper when it is set
+    NDR_TokenStore* tokenStore;
+    // firstToken is the number of tokens held by TIWrapper before lexing the chunk started
+    size_t firstToken;
+    // tokenStart is the boundary where the current token started
+    size_t tokenStart;
+    // stopPosition is the boundary where lexing stopped or the input length once the input is exhausted
+    size_t stopPosition;
+    // boundaries holds the token boundaries passed before boundaryWindowEnd
+    LexerBoundary* boundaries;
+    size_t numBoundaries;
+    size_t memoryAllocated;
+    size_t boundaryWindowEnd;
+    // realignTokens holds the tokens of an input before an edit, lexing stops at the first of them from realignIndex on that starts at a boundary
+    // Only tokens at or after realignOffset are compared, their offsets are moved by the lengths of the text removed and inserted by the edit
+    NDR_TokenInformationWrapper* realignTokens;
+    size_t realignIndex;
+    size_t realignOffset;
+    size_t removedLength;
+    size_t insertedLength;
+    bool realigned;
+    // tokenLimit stops lexing at the first boundary after TIWrapper holds that many tokens, 0 for no limit
+    size_t tokenLimit;
+    int result;
+} LexerChunk;
+
+typedef struct RegexCursorSet {
+    NDR_RegexCursor* cursors;
+    int* RSIndices;
+    char** regexStrings;
+    size_t numCursors;
+    size_t memoryAllocated;
+    // liveCursors holds the cursors that can still match the current token, failed cursors are no longer stepped
+    size_t* liveCursors;
+    size_t numLiveCursors;
+    // firstByteCursors lists, in cursor order, the cursors able to accept each byte value as the first character of a token
+    // The cursors for byte b are found from firstByteOffset[b] up to firstByteOffset[b + 1]
+    size_t* firstByteCursors;
+    size_t firstByteOffset[257];
+    // tokenStarted is false after a reset until the first character of the next token has been matched
+    bool tokenStarted;
+} RegexCursorSet;
+
 typedef struct TokenMatchingState{
     char ch;
     char* currentToken;
     char* potentialFinalToken;
     int allocatedLength;
+    // tokenLength is strlen(currentToken), kept by the token helpers so appending does not rescan the token
+    size_t tokenLength;
 
     int backtrackAmount;
-    int numNewLinesSeen;
 
     int matchValue;
+    size_t dfaState;
+    size_t trieNode;
+    // startDFAState and rootTrieNode are where the combined automaton and the literal trie begin every token of the current lexer mode
+    size_t startDFAState;
+    size_t rootTrieNode;
+    RegexCursorSet* cursorSet;
     int indexOfBestMatch;
     bool completeMatchFound;
     bool potentialMatchFound;
@@ -90,23 +193,59 @@ typedef struct TokenMatchingState{
     NDR_MatchState highestMatchSeen;
 } TokenMatchingState;
 
+// The last search made for a byte value while skipping plain bytes within state tokens
+typedef struct StopByteSearch {
+    // from is the position the search started at and found is the first occurrence at or after it, equal to searchedTo when there is none
+    size_t from;
+    size_t found;
+    size_t searchedTo;
+} StopByteSearch;
+
+// The matching state used while lexing a chunk
+typedef struct LexerMatcher {
+    TokenMatchingState* matchingState;
+    // endCursorSets holds the end regex cursors of each state, created the first time a token of the state is found
+    RegexCursorSet** endCursorSets;
+    // stopByteSearches holds the last search made for every byte value so the text of state tokens is never searched twice
+    StopByteSearch* stopByteSearches;
+    // modeStack holds the lexer modes entered by push actions with the current mode on top, the mode at the bottom is only left by a switch action
+    int* modeStack;
+    size_t modeStackSize;
+    size_t modeStackAllocated;
+    // startCursorSets holds the start regex cursors of each lexer mode when there is no combined automaton, created the first time the mode is entered
+    RegexCursorSet** startCursorSets;
+} LexerMatcher;
+
+struct NDR_LexStream {
+    NDR_Context* context;
+    LexerChunk chunk;
+    LexerMatcher matcher;
+    // tokens holds only the token returned by the last call to NDR_NextToken
+    NDR_TokenInformationWrapper tokens;
+    // lineIndex only keeps the lines from the start of the last token returned on
+    NDR_LineIndex lineIndex;
+    int result;
+};
+
 
 static void InitializeTokenMatchingState(TokenMatchingState* matchingState);
 static void DestroyTokenMatchingState(TokenMatchingState* matchingState);
 static void ResetTokenMatchingState(TokenMatchingState* matchingState);
 static void addCharToToken(TokenMatchingState* matchingState, char ch);
 static void addStringToToken(TokenMatchingState* matchingState, char* src);
+static void addRangeToToken(TokenMatchingState* matchingState, const char* src, size_t length);
+static void truncateToken(TokenMatchingState* matchingState, size_t amount);
 static char* getMatchToken(TokenMatchingState* matchingState);
 static void AcknowledgePotentialMatch(TokenMatchingState* matchingState);
 static void AcknowledgeCompleteMatch(TokenMatchingState* matchingState);
 static bool completeMatchFound(TokenMatchingState* matchingState);
 static bool hasMatchingStarted(TokenMatchingState* matchingState);
 static size_t getNumberOfCompleteMatches(TokenMatchingState* matchingState);
-static void calcBackTrack(TokenMatchingState* matchingState, char ch);
+static void calcBackTrack(TokenMatchingState* matchingState);
 static int getBackTrackAmount(TokenMatchingState* matchingState);
-static int getFileBackTrackAmount(TokenMatchingState* matchingState);
 static void resetBackTrackAmount(TokenMatchingState* matchingState);
 static void setMatchingChar(TokenMatchingState* matchingState, char ch);
+static void startNewToken(TokenMatchingState* matchingState);
 void CapturePotentialMatch(TokenMatchingState* matchingState);
 char* GetCapturedMatch(TokenMatchingState* matchingState);
 static bool IsBestMatch(TokenMatchingState* matchingState, int index);
@@ -115,59 +254,93 @@ static void SetBestMatchIndex(TokenMatchingState* matchingState, int index);
 
 static void InitializeStateRepresentation(StateRepresentation* stateRepresentation);
 static void DestroyLexerLineCategorizer(LexerLineCategorizer* lineCategorizer);
-static bool verifyLineTokens(LexerLineCategorizer* lineCategorizer, StateRepresentation* stateRepresentation);
+static bool verifyLineTokens(NDR_Context* context, LexerLineCategorizer* lineCategorizer, StateRepresentation* stateRepresentation);
 static void ResetStates(StateRepresentation* stateRep);
 static void ResetLineCategories(LexerLineCategorizer* lineCategorizer, int memAllocated);
 static int containsCategory(LexerLineCategorizer* lineCategorizer, NDR_StateCategories category);
-static bool HandleSettings(LexerLineCategorizer* lineCategorizer);
-static bool IsOneTimeSettingSeen(LexerLineCategorizer* lineCategorizer);
+static bool HandleSettings(NDR_Context* context, LexerLineCategorizer* lineCategorizer);
+static bool IsOneTimeSettingSeen(NDR_Context* context, LexerLineCategorizer* lineCategorizer);
 static bool ProcessTokensAfterItems(LexerLineCategorizer* lineCategorizer, int index);
+static NDR_ModeAction GetModeAction(char* token);
+static bool SetRegexStateModes(NDR_Context* context, LexerLineCategorizer* lineCategorizer, uint64_t* namedModes);
+static int FindOrAddLexerMode(NDR_Context* context, char* modeName);
+static int GetRegexEngine(char* token);
+static bool ApplyRegexEngines(NDR_Context* context);
 static int ExtractRegexStrings(char* regex, char** extractedStrings);
 
-int CompareUsingRegex(TokenMatchingState* matchingState, int RSIndex, int RegIndex);
-static bool doesCharMatchAllowRegex(int stateIndex, char* comparisonString);
-static bool doesCharMatchEscapeRegex(int stateIndex, char* comparisonString);
+int CompareUsingCursors(TokenMatchingState* matchingState);
+int CompareUsingDFA(NDR_Context* context, TokenMatchingState* matchingState);
+int CompareUsingTrie(NDR_Context* context, TokenMatchingState* matchingState);
+static int HandleMatchResult(TokenMatchingState* matchingState, int RSIndex, char* regexString);
+static void InitializeRegexCursorSet(RegexCursorSet* cursorSet);
+static void AddRegexCursor(RegexCursorSet* cursorSet, NDR_Regex* regex, int RSIndex, char* regexString);
+static void ResetRegexCursorSet(RegexCursorSet* cursorSet);
+static void BuildFirstByteTable(RegexCursorSet* cursorSet);
+static void DestroyRegexCursorSet(RegexCursorSet* cursorSet);
+static RegexCursorSet* CreateStartCursorSet(NDR_Context* context, int mode);
+static RegexCursorSet* CreateEndCursorSet(NDR_Context* context, int stateIndex);
+static bool doesCharMatchAllowRegex(NDR_Context* context, int stateIndex, char* comparisonString);
+static bool doesCharMatchEscapeRegex(NDR_Context* context, int stateIndex, char* comparisonString);
+static void BuildStateByteTables(NDR_Context* context);
+static size_t FindPlainBytesEnd(LexerInput* input, NDR_RegexState* regexState, StopByteSearch* searches);
+
+
+static int LexInput(NDR_Context* context, LexerInput* input);
+static int LexChunk(NDR_Context* context, LexerChunk* chunk);
+static int MatchChunkTokens(NDR_Context* context, LexerChunk* chunk, LexerMatcher* matcher);
+static void InitializeLexerMatcher(NDR_Context* context, LexerMatcher* matcher);
+static void DestroyLexerMatcher(NDR_Context* context, LexerMatcher* matcher);
+static void EnterLexerMode(NDR_Context* context, LexerMatcher* matcher, int mode);
+static int ApplyModeAction(NDR_Context* context, LexerMatcher* matcher, NDR_RegexState* regexState);
+static int LexInputInChunks(NDR_Context* context, LexerInput* input, size_t numChunks);
+static void* RunLexerChunk(void* argument);
+static size_t GetLexerChunkCount(NDR_Context* context, size_t length);
+static size_t ExtendTokenLookahead(NDR_TokenInformation* token, size_t lookaheadEnd);
+static void RecordTokenStart(LexerChunk* chunk, NDR_TokenInformation* token);
+static void UpdateTokenLookahead(LexerChunk* chunk);
+static size_t GetChunkTokenCount(LexerChunk* chunk);
+static bool IsRealigned(LexerChunk* chunk);
+static void InitializeLexerChunk(LexerChunk* chunk, NDR_Context* context, LexerInput* input, NDR_TokenInformationWrapper* tokenWrapper);
+static void DestroyLexerChunk(LexerChunk* chunk);
+static void AddLexerBoundary(LexerChunk* chunk, size_t position);
+static LexerBoundary* FindLexerBoundary(LexerChunk* chunk, size_t position);
+static void InitializeLexerInput(LexerInput* input, const char* data, size_t len);
+static bool FillLexerInput(LexerInput* input);
+static int readInputChar(LexerInput* input);
+static int peekInputChar(LexerInput* input);
+static size_t markInput(LexerInput* input);
+static void rewindInputToMark(LexerInput* input, size_t mark);
+static size_t ReadFileInput(char* buffer, size_t size, void* userData);
+static void PrepareLineIndex(NDR_Context* context, LexerInput* input);
+static int GetInputLine(LexerInput* input, size_t position);
+static int GetInputColumn(LexerInput* input, size_t position);
+static int BeginLexing(NDR_Context* context);
+static bool CanLexBuffer(NDR_Context* context, const char* data, size_t len);
 
-static void updatefilePosition(int* lineNumber, int* columnNumber, char* token);
-
-static void appendCharToString(char* dest, char src);
 static void trimString(char* string);
 static bool containsInt(int* arr, int index);
 static void findEscaped(char* string, int* indices, int length);
 static void removeEscaped(char* string);
 static void lowerCaseString(char* lowerCaseArr, char* arr);
-static char* lowerCaseStringReturn(char* arr, size_t neededLength);
+static char* lowerCaseStringReturn(char* lowered, char* arr, size_t neededLength);
 static void findItems(char* string, int* indices);
 static void stringsBetween(char* string, int* indices, char** answer);
 static int lastOccurrence(char* string, char c, int length);
 static void encapsulateString(const char* prepend, char* string, const char* append);
 
 
-// AUTO_CAP adds ^ to the beginning and \z to the end of every regex descriptor in lexer config file
-static bool AUTO_CAP = true;
-// AUTO_TRIM removes the space from the beginning and end of every regex descriptor in lexer config file
-static bool AUTO_TRIM = true;
-// One Time Settings are below
-// MATCH_ALL toggles error catching for failure to match all characters in lexer config file
-static bool MATCH_ALL = true;
-static bool MATCH_ALL_isSeen = false;
-
-static bool configuringAttempted = false;
-static bool lexingAttempted = false;
-static bool configuringCompleted = false;
-static bool lexingCompleted = false;
-
-static NDR_RegexStateWrapper* RSWrapper = NULL;
-
-NDR_TokenInformationWrapper* TIWrapper = NULL;
 
 int NDR_Configure_Lexer(char* fileName){
+    return NDR_Context_Configure_Lexer(NDR_GetDefaultContext(), fileName);
+}
+
+int NDR_Context_Configure_Lexer(NDR_Context* context, char* fileName){
 
-    if(configuringAttempted == true){
+    if(context->lexerConfiguringAttempted == true){
         printf("\nLexer configuration has already been performed\n");
         return 1;
     }
-    configuringAttempted = true;
+    context->lexerConfiguringAttempted = true;
 
     if(fileName == NULL || strcmp(fileName, "") == 0){
         printf("A non-empty filename must be provided for lexer configuration\n");
@@ -186,8 +359,8 @@ int NDR_Configure_Lexer(char* fileName){
         return 1;
     }
 
-    RSWrapper = malloc(sizeof(NDR_RegexStateWrapper));
-    NDR_InitializeRegexStateWrapper(RSWrapper);
+    context->RSWrapper = malloc(sizeof(NDR_RegexStateWrapper));
+    NDR_InitializeRegexStateWrapper(context->RSWrapper);
 
     LexerLineCategorizer* lineCategorizer = malloc(sizeof(LexerLineCategorizer));
     lineCategorizer->categories = malloc(sizeof(NDR_StateCategories) * NDR_GetLongestTokenAmount(fileInfo));
@@ -201,6 +374,9 @@ int NDR_Configure_Lexer(char* fileName){
     const char beginningString[] = "$";
     const char endingString[] = "%";
 
+    // namedModes holds the lexer modes that rules have been given to, the initial mode holds every rule given no modes
+    uint64_t namedModes = 1;
+
 
     int lexerLineNumber = 1;
 
@@ -217,7 +393,7 @@ int NDR_Configure_Lexer(char* fileName){
             continue;
         }
 
-        if(!verifyLineTokens(lineCategorizer, stateRepresentation)){
+        if(!verifyLineTokens(context, lineCategorizer, stateRepresentation)){
             printf("Error parsing lexer config file at line %i\n", lexerLineNumber);
             return 1;
         }
@@ -227,11 +403,15 @@ int NDR_Configure_Lexer(char* fileName){
         if (containsCategory(lineCategorizer, NDR_STATE_STATES) != -1){
             int index = containsCategory(lineCategorizer, NDR_STATE_KEYWORD);
             if (index != -1){
-                NDR_AddRegexState(RSWrapper);
-                NDR_RSTrimAndSetKeyword(NDR_RSGetLastRegexState(RSWrapper), lineCategorizer->tokens[index]);
-                NDR_RSSetLiteralFlag(NDR_RSGetLastRegexState(RSWrapper), false);
-                NDR_RSSetStateFlag(NDR_RSGetLastRegexState(RSWrapper), true);
-                NDR_RSSetCategory(NDR_RSGetLastRegexState(RSWrapper), lineCategorizer->categories[0]);
+                NDR_AddRegexState(context->RSWrapper);
+                NDR_RSTrimAndSetKeyword(NDR_RSGetLastRegexState(context->RSWrapper), lineCategorizer->tokens[index]);
+                NDR_RSSetLiteralFlag(NDR_RSGetLastRegexState(context->RSWrapper), false);
+                NDR_RSSetStateFlag(NDR_RSGetLastRegexState(context->RSWrapper), true);
+                NDR_RSSetCategory(NDR_RSGetLastRegexState(context->RSWrapper), lineCategorizer->categories[0]);
+                if(SetRegexStateModes(context, lineCategorizer, &namedModes) == false){
+                    printf("Error parsing lexer modes at line %i\n", lexerLineNumber);
+                    return 1;
+                }
             }
             else{
 
@@ -251,47 +431,47 @@ int NDR_Configure_Lexer(char* fileName){
             }
 
             for (int counts = 0; counts < numberOfRegexStrings; counts++){
-                if (AUTO_TRIM == true){
+                if (context->autoTrim == true){
                     trimString(extractedStrings[counts]);
                 }
-                if (AUTO_CAP == true){
+                if (context->autoCap == true){
                     extractedStrings[counts] = realloc(extractedStrings[counts], strlen(extractedStrings[counts]) + strlen(beginningString) + strlen(endingString) + 1);
                     encapsulateString(beginningString, extractedStrings[counts], endingString);
                 }
                 removeEscaped(extractedStrings[counts]);
-                int result = NDR_CheckAndAddStateRegex(RSWrapper, lineCategorizer->categories[0], extractedStrings[counts]);
+                int result = NDR_CheckAndAddStateRegex(context->RSWrapper, lineCategorizer->categories[0], extractedStrings[counts]);
                 if(result == -1){
-                    printf("\nDuplicate end symbol regex \"%s\" for keyword \"%s\" found on line %i\n", extractedStrings[counts], NDR_RSGetKeyword(NDR_RSGetLastRegexState(RSWrapper)), lexerLineNumber);
+                    printf("\nDuplicate end symbol regex \"%s\" for keyword \"%s\" found on line %i\n", extractedStrings[counts], NDR_RSGetKeyword(NDR_RSGetLastRegexState(context->RSWrapper)), lexerLineNumber);
                     return 1;
                 }
                 else if(result == -2){
-                    printf("\nError compiling symbol regex \"%s\" for keyword \"%s\" found on line %i\n", extractedStrings[counts], NDR_RSGetKeyword(NDR_RSGetLastRegexState(RSWrapper)), lexerLineNumber);
+                    printf("\nError compiling symbol regex \"%s\" for keyword \"%s\" found on line %i\n", extractedStrings[counts], NDR_RSGetKeyword(NDR_RSGetLastRegexState(context->RSWrapper)), lexerLineNumber);
                     return 1;
                 }
                 else if(NDR_R == true){
-                    printf("Success for token \"%s\" for keyword \"%s\"\n", extractedStrings[counts], NDR_RSGetKeyword(NDR_RSGetLastRegexState(RSWrapper)));
+                    printf("Success for token \"%s\" for keyword \"%s\"\n", extractedStrings[counts], NDR_RSGetKeyword(NDR_RSGetLastRegexState(context->RSWrapper)));
                 }
                 free(extractedStrings[counts]);
             }
 
 
             if(containsCategory(lineCategorizer, NDR_STATE_ENDSTATE) != -1){
-                if(NDR_RSGetNumStartStates(NDR_RSGetLastRegexState(RSWrapper)) == 0){
-                    printf("Missing start state token around line %i for keyword %s\n", lexerLineNumber, NDR_RSGetKeyword(NDR_RSGetLastRegexState(RSWrapper)));
+                if(NDR_RSGetNumStartStates(NDR_RSGetLastRegexState(context->RSWrapper)) == 0){
+                    printf("Missing start state token around line %i for keyword %s\n", lexerLineNumber, NDR_RSGetKeyword(NDR_RSGetLastRegexState(context->RSWrapper)));
                     return 1;
                 }
 
-                if(NDR_RSGetNumAllowStates(NDR_RSGetLastRegexState(RSWrapper)) == 0){
-                    NDR_AddAllowRegex(NDR_RSGetLastRegexState(RSWrapper), "^[\\s\\S]\\z");
+                if(NDR_RSGetNumAllowStates(NDR_RSGetLastRegexState(context->RSWrapper)) == 0){
+                    NDR_AddAllowRegex(NDR_RSGetLastRegexState(context->RSWrapper), "^[\\s\\S]\\z");
                 }
-                if(NDR_RSGetNumEscapeStates(NDR_RSGetLastRegexState(RSWrapper)) == 0){
-                    NDR_AddEscapeRegex(NDR_RSGetLastRegexState(RSWrapper), "^(?!)\\z");
+                if(NDR_RSGetNumEscapeStates(NDR_RSGetLastRegexState(context->RSWrapper)) == 0){
+                    NDR_AddEscapeRegex(NDR_RSGetLastRegexState(context->RSWrapper), "^(?!)\\z");
                 }
                 stateRepresentation->started = false;
             }
         }
         else if(containsCategory(lineCategorizer, NDR_STATE_STATES) == -1 && containsCategory(lineCategorizer, NDR_STATE_SETTING) == -1){
-            NDR_AddRegexState(RSWrapper);
+            NDR_AddRegexState(context->RSWrapper);
 
             char* items;
             int index = containsCategory(lineCategorizer, NDR_STATE_KEYWORD);
@@ -299,13 +479,23 @@ int NDR_Configure_Lexer(char* fileName){
             if (index != -1){
                 items = strstr(NDR_GetOriginalLine(NDR_GetLine(fileInfo, i)), lineCategorizer->tokens[index]);
                 items = items + strlen(lineCategorizer->tokens[index]);
-                NDR_RSTrimAndSetKeyword(NDR_RSGetLastRegexState(RSWrapper), lineCategorizer->tokens[index]);
-                NDR_RSSetLiteralFlag(NDR_RSGetLastRegexState(RSWrapper), false);
+                NDR_RSTrimAndSetKeyword(NDR_RSGetLastRegexState(context->RSWrapper), lineCategorizer->tokens[index]);
+                NDR_RSSetLiteralFlag(NDR_RSGetLastRegexState(context->RSWrapper), false);
             }
             else{
                 items = NDR_GetOriginalLine(NDR_GetLine(fileInfo, i));
-                NDR_RSSetKeyword(NDR_RSGetLastRegexState(RSWrapper), "literal");
-                NDR_RSSetLiteralFlag(NDR_RSGetLastRegexState(RSWrapper), true);
+                NDR_RSSetKeyword(NDR_RSGetLastRegexState(context->RSWrapper), "literal");
+                NDR_RSSetLiteralFlag(NDR_RSGetLastRegexState(context->RSWrapper), true);
+            }
+
+            // The modes, mode action and regex engine of a rule are given before its regexes and may hold braces of their own
+            for(int x = 1; x < lineCategorizer->numberOfTokens; x++){
+                if(lineCategorizer->categories[x] == NDR_STATE_MODES || lineCategorizer->categories[x] == NDR_STATE_MODEACTION || lineCategorizer->categories[x] == NDR_STATE_ENGINE)
+                    items = strstr(items, lineCategorizer->tokens[x]) + strlen(lineCategorizer->tokens[x]);
+            }
+            if(SetRegexStateModes(context, lineCategorizer, &namedModes) == false){
+                printf("Error parsing lexer modes at line %i\n", lexerLineNumber);
+                return 1;
             }
 
             int numberOfRegexStrings = ExtractRegexStrings(items, extractedStrings);
@@ -314,31 +504,31 @@ int NDR_Configure_Lexer(char* fileName){
                 return 1;
             }
 
-            NDR_RSSetCategory(NDR_RSGetLastRegexState(RSWrapper), lineCategorizer->categories[0]);
-            NDR_RSSetStateFlag(NDR_RSGetLastRegexState(RSWrapper), false);
+            NDR_RSSetCategory(NDR_RSGetLastRegexState(context->RSWrapper), lineCategorizer->categories[0]);
+            NDR_RSSetStateFlag(NDR_RSGetLastRegexState(context->RSWrapper), false);
 
             for(int counts = 0; counts < numberOfRegexStrings; counts++){
 
-                if (AUTO_TRIM == true){
+                if (context->autoTrim == true){
                     trimString(extractedStrings[counts]);
                 }
-                if (AUTO_CAP == true){
+                if (context->autoCap == true){
                     extractedStrings[counts] = realloc(extractedStrings[counts], strlen(extractedStrings[counts]) + strlen(beginningString) + strlen(endingString) + 1);
                     encapsulateString(beginningString, extractedStrings[counts], endingString);
                 }
                 removeEscaped(extractedStrings[counts]);
 
-                int result = NDR_CheckAndAddStateRegex(RSWrapper, lineCategorizer->categories[0], extractedStrings[counts]);
+                int result = NDR_CheckAndAddStateRegex(context->RSWrapper, lineCategorizer->categories[0], extractedStrings[counts]);
                 if(result == -1){
                     printf("Duplicate end symbol regex \"%s\" found on line %i\n", extractedStrings[counts], lexerLineNumber);
                     return 1;
                 }
                 else if(result == -2){
-                    printf("\nError compiling symbol regex \"%s\" for keyword \"%s\" found on line %i\n", extractedStrings[counts], NDR_RSGetKeyword(NDR_RSGetLastRegexState(RSWrapper)), lexerLineNumber);
+                    printf("\nError compiling symbol regex \"%s\" for keyword \"%s\" found on line %i\n", extractedStrings[counts], NDR_RSGetKeyword(NDR_RSGetLastRegexState(context->RSWrapper)), lexerLineNumber);
                     return 1;
                 }
                 else if(NDR_R == true){
-                    printf("Success for token \"%s\" for keyword \"%s\"\n", extractedStrings[counts], NDR_RSGetKeyword(NDR_RSGetLastRegexState(RSWrapper)));
+                    printf("Success for token \"%s\" for keyword \"%s\"\n", extractedStrings[counts], NDR_RSGetKeyword(NDR_RSGetLastRegexState(context->RSWrapper)));
                 }
                 free(extractedStrings[counts]);
             }
@@ -348,7 +538,7 @@ int NDR_Configure_Lexer(char* fileName){
 
     }
 
-    if(NDR_RSGetNumberOfStates(RSWrapper) == 0){
+    if(NDR_RSGetNumberOfStates(context->RSWrapper) == 0){
         printf("\nNo lexer tokens were found in the lexer configuration file\n");
         return 1;
     }
@@ -356,12 +546,25 @@ int NDR_Configure_Lexer(char* fileName){
         printf("\nMissing end state Token around line %i\n", lexerLineNumber);
         return 1;
     }
+    // A mode that is only ever pushed or switched to would match nothing but the rules given to every mode
+    for(size_t x = 0; x < NDR_RSGetNumberOfModes(context->RSWrapper); x++){
+        if((namedModes & ((uint64_t) 1 << x)) == 0){
+            printf("\nNo rules were given to lexer mode \"%s\"\n", NDR_RSGetModeName(context->RSWrapper, x));
+            return 1;
+        }
+    }
+    if(ApplyRegexEngines(context) == false)
+        return 1;
     if (NDR_ST == true){
-        NDR_PrintSymbolTable();
+        NDR_Context_PrintSymbolTable(context);
     }
 
     fclose(lexerConfigFile);
 
+    // The hash lets a lexer image written from this configuration be checked against the file later
+    if(NDR_HashFile(fileName, &context->lexerConfigHash) != 0)
+        context->lexerConfigHash = 0;
+
     NDR_FreeFileInformation(fileInfo);
     free(fileInfo);
     free(stateRepresentation);
@@ -369,7 +572,34 @@ int NDR_Configure_Lexer(char* fileName){
     free(lineCategorizer);
     free(extractedStrings);
 
-    configuringCompleted = true;
+    // Characters within a state token are checked against its allow and escape regexes one at a time, so every answer is found up front
+    BuildStateByteTables(context);
+
+    // Start regexes that only match one fixed string are looked up in a trie rather than matched as regexes
+    context->lexerTrie = malloc(sizeof(NDR_LexerTrie));
+    NDR_InitLexerTrie(context->lexerTrie);
+    if(NDR_BuildLexerTrie(context->lexerTrie, context->RSWrapper) != 0){
+        free(context->lexerTrie);
+        context->lexerTrie = NULL;
+    }
+    else if (NDR_R == true){
+        printf("\n%zu literal start regexes served from a trie of %zu nodes\n", context->lexerTrie->numLiterals, context->lexerTrie->numNodes);
+    }
+
+    // Configurations using start regexes that cannot be combined are matched one regex at a time
+    context->lexerDFA = malloc(sizeof(NDR_LexerDFA));
+    NDR_InitLexerDFA(context->lexerDFA);
+    if(NDR_BuildLexerDFA(context->lexerDFA, context->RSWrapper) != 0){
+        free(context->lexerDFA);
+        context->lexerDFA = NULL;
+        if (NDR_R == true)
+            printf("\nStart regexes could not be combined, each regex will be matched separately\n");
+    }
+    else if (NDR_R == true){
+        printf("\nStart regexes combined into %zu states\n", context->lexerDFA->numStates);
+    }
+
+    context->lexerConfiguringCompleted = true;
 
     if (NDR_STAT == true)
         printf("\nLexer configured successfully\n");
@@ -380,119 +610,631 @@ int NDR_Configure_Lexer(char* fileName){
 
 
 int NDR_Lex(char* fileName){
+    return NDR_Context_Lex(NDR_GetDefaultContext(), fileName);
+}
+
+int NDR_Context_Lex(NDR_Context* context, char* fileName){
+
+    if(fileName == NULL || strcmp(fileName, "") == 0){
+        printf("A non-empty filename must be provided for processing\n");
+        return 1;
+    }
+
+    NDR_MappedFile code;
+    if(NDR_MapFile(fileName, &code) != 0){
+        printf("Cannot open code file \"%s\"\n", fileName);
+        return 1;
+    }
+
+    int result = NDR_Context_LexBuffer(context, code.data, code.length);
+
+    NDR_UnmapFile(&code);
+
+    return result;
+}
+
+
+int NDR_LexBuffer(const char* data, size_t len){
+    return NDR_Context_LexBuffer(NDR_GetDefaultContext(), data, len);
+}
+
+// Check that the context is configured and has not lexed an input yet before lexing starts
+int BeginLexing(NDR_Context* context){
 
-    if(lexingAttempted == true){
-        printf("\nCode file lexical analysis has already been performed\n");
+    if(context->lexingAttempted == true){
+        printf("\nCode file lexical analysis has already been performed, reset the input before processing another code file\n");
         return 1;
     }
-    lexingAttempted = true;
-    if(configuringCompleted == false){
+    context->lexingAttempted = true;
+    if(context->lexerConfiguringCompleted == false){
         printf("\nLexer configuration failed so lexical analysis cannot proceed\n");
         return 1;
     }
 
-    if(RSWrapper == NULL){
+    if(context->RSWrapper == NULL){
         printf("\nCall function \"int Configure_Lexer(char* fileName)\" to setup the lexer configuration before calling function \"int Lex(char* fileName)\"\n");
         return 1;
     }
 
-    if(fileName == NULL || strcmp(fileName, "") == 0){
-        printf("A non-empty filename must be provided for processing\n");
+    return 0;
+}
+
+int NDR_Context_LexBuffer(NDR_Context* context, const char* data, size_t len){
+
+    if(BeginLexing(context) != 0 || CanLexBuffer(context, data, len) == false)
+        return 1;
+
+    LexerInput input;
+    InitializeLexerInput(&input, data, len);
+    context->inputLength = len;
+
+    return LexInput(context, &input);
+}
+
+// Check that a buffer can be lexed with the configuration of the context
+bool CanLexBuffer(NDR_Context* context, const char* data, size_t len){
+    if(context->lexerConfiguringCompleted == false || context->RSWrapper == NULL){
+        printf("\nLexer configuration failed so lexical analysis cannot proceed\n");
+        return false;
+    }
+    if(data == NULL && len > 0){
+        printf("A valid buffer must be provided for processing\n");
+        return false;
+    }
+    return true;
+}
+
+int NDR_LexBufferToStore(const char* data, size_t len, NDR_TokenStore* store){
+    return NDR_Context_LexBufferToStore(NDR_GetDefaultContext(), data, len, store);
+}
+
+int NDR_Context_LexBufferToStore(NDR_Context* context, const char* data, size_t len, NDR_TokenStore* store){
+
+    if(CanLexBuffer(context, data, len) == false)
+        return 1;
+
+    // The store refers to data for the token text so only the matching is done here and the token table of the context is left alone
+    NDR_ResetTokenStore(store, data, len, context->RSWrapper);
+    LexerInput input;
+    InitializeLexerInput(&input, data, len);
+    input.lineIndex = &store->lineIndex;
+    LexerChunk chunk;
+    InitializeLexerChunk(&chunk, context, &input, NULL);
+    chunk.tokenStore = store;
+
+    int result = LexChunk(context, &chunk);
+    DestroyLexerChunk(&chunk);
+    if(result != 0)
+        return 1;
+
+    if(NDR_TSGetNumberOfTokens(store) == 0){
+        printf("\nNo text was matched during parsing of the source file.\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+int NDR_LexFile(FILE* file){
+    return NDR_Context_LexFile(NDR_GetDefaultContext(), file);
+}
+
+int NDR_Context_LexFile(NDR_Context* context, FILE* file){
+
+    if(BeginLexing(context) != 0)
+        return 1;
+
+    if(file == NULL){
+        printf("A valid file must be provided for processing\n");
+        return 1;
+    }
+
+    // The file is read into the window of the input as lexing reaches its end so it never has to be seekable
+    LexerInput input;
+    InitializeLexerInput(&input, NULL, 0);
+    input.limit = (size_t) -1;
+    input.read = ReadFileInput;
+    input.userData = file;
+    input.endOfInput = false;
+
+    int result = LexInput(context, &input);
+    context->inputLength = input.length;
+    free(input.buffer);
+
+    if(ferror(file)){
+        printf("Cannot read code file\n");
+        context->lexingCompleted = false;
+        return 1;
+    }
+
+    return result;
+}
+
+size_t ReadFileInput(char* buffer, size_t size, void* userData){
+    return fread(buffer, 1, size, (FILE*) userData);
+}
+
+// The line index of the context is rebuilt for every input, a buffer is scanned for newlines at once and a streamed input as it is read
+void PrepareLineIndex(NDR_Context* context, LexerInput* input){
+    if(context->lineIndex == NULL){
+        context->lineIndex = malloc(sizeof(NDR_LineIndex));
+        NDR_InitLineIndex(context->lineIndex);
+    }
+    NDR_ResetLineIndex(context->lineIndex);
+    if(input->read == NULL)
+        NDR_LineIndexAddText(context->lineIndex, input->data, input->length);
+    input->lineIndex = context->lineIndex;
+}
+
+int GetInputLine(LexerInput* input, size_t position){
+    if(input->lineIndex == NULL)
+        return 0;
+    return (int) NDR_LineIndexGetLine(input->lineIndex, position);
+}
+
+int GetInputColumn(LexerInput* input, size_t position){
+    if(input->lineIndex == NULL)
+        return 0;
+    return (int) NDR_LineIndexGetColumn(input->lineIndex, position);
+}
+
+int NDR_LexEdit(const char* data, size_t len, size_t offset, size_t removedLength, size_t insertedLength){
+    int result = NDR_Context_LexEdit(NDR_GetDefaultContext(), data, len, offset, removedLength, insertedLength);
+    NDR_ASThead = NDR_GetDefaultContext()->ASThead;
+    return result;
+}
+
+int NDR_Context_LexEdit(NDR_Context* context, const char* data, size_t len, size_t offset, size_t removedLength, size_t insertedLength){
+
+    if(context->lexingCompleted == false){
+        printf("\nLexical analysis of the input must be completed before an edit of it can be lexed\n");
+        return 1;
+    }
+    if((data == NULL && len > 0) || offset + removedLength > context->inputLength || len != context->inputLength - removedLength + insertedLength){
+        printf("\nThe edit does not match the input of the last lexical analysis\n");
         return 1;
     }
 
-    FILE *code = fopen(fileName, "r");
-    if (code == NULL)
-        printf("Cannot open code file");
+    // The syntax tree was built from the tokens before the edit
+    NDR_Context_ResetParse(context);
 
-    TokenMatchingState* matchingState = malloc(sizeof(TokenMatchingState));
-    InitializeTokenMatchingState(matchingState);
-    TIWrapper = malloc(sizeof(NDR_TokenInformationWrapper));
-    NDR_InitTokenInfoWrapper(TIWrapper);
+    NDR_TokenInformationWrapper* tokens = context->TIWrapper;
 
+    // Tokens that were lexed without reading the edited text are kept and lexing restarts at the first token that read it
+    // The lookahead of the token table only increases, also when it was joined from chunks lexed on several threads, so the first of those tokens can be found with a binary search
+    size_t first = 0;
+    size_t last = tokens->numTokens;
+    while(first < last){
+        size_t middle = first + (last - first) / 2;
+        NDR_TokenInformation* token = NDR_TIGetTokenInfo(tokens, middle);
+        if(token->offset + token->lookahead <= offset)
+            first = middle + 1;
+        else
+            last = middle;
+    }
+    if(first == tokens->numTokens)
+        first--;
+    // Offsets after the edited text are positions of the input before the edit, so lexing never restarts at a token that starts after the edit
+    while(first > 0 && NDR_TIGetTokenInfo(tokens, first)->offset > offset)
+        first--;
+    // The lexer mode each token was matched in is not kept, so with several modes the whole edited input is lexed again
+    bool relexAll = (NDR_RSGetNumberOfModes(context->RSWrapper) > 1);
+    if(relexAll == true)
+        first = 0;
+
+    // The tokens that are kept find their lines in the index of the edited input as only their offsets are stored
+    LexerInput input;
+    InitializeLexerInput(&input, data, len);
+    PrepareLineIndex(context, &input);
+    if(first > 0){
+        NDR_TokenInformation* previousToken = NDR_TIGetTokenInfo(tokens, first - 1);
+        input.position = NDR_TIGetTokenInfo(tokens, first)->offset;
+        input.furthestPosition = previousToken->offset + previousToken->lookahead;
+    }
+
+    NDR_TokenInformationWrapper editedTokens;
+    NDR_InitTokenInfoWrapper(&editedTokens);
+    LexerChunk chunk;
+    InitializeLexerChunk(&chunk, context, &input, &editedTokens);
+    chunk.realignTokens = (relexAll == true) ? NULL : tokens;
+    chunk.realignIndex = first;
+    chunk.realignOffset = offset + removedLength;
+    chunk.removedLength = removedLength;
+    chunk.insertedLength = insertedLength;
+
+    int result = LexChunk(context, &chunk);
+    if(result != 0){
+        // The token table still holds the tokens before the edit so the whole input has to be lexed again
+        context->lexingCompleted = false;
+        DestroyLexerChunk(&chunk);
+        NDR_FreeTokenInfoWrapper(&editedTokens);
+        return 1;
+    }
 
-    int lineNumber = 1;
-    int columnNumber = 1;
+    // The tokens after the point where lexing realigned only move by the size of the edit
+    last = tokens->numTokens;
+    if(chunk.realigned == true){
+        last = chunk.realignIndex;
+        size_t lookaheadEnd = chunk.input.furthestPosition;
+        for(size_t x = last; x < tokens->numTokens; x++){
+            NDR_TokenInformation* token = NDR_TIGetTokenInfo(tokens, x);
+            NDR_SetTokenInfoOffset(token, token->offset - removedLength + insertedLength);
+            lookaheadEnd = ExtendTokenLookahead(token, lookaheadEnd);
+        }
+    }
+    NDR_ReplaceTokenInfo(tokens, first, last - first, &editedTokens);
+
+    DestroyLexerChunk(&chunk);
+    NDR_FreeTokenInfoWrapper(&editedTokens);
+    context->inputLength = len;
+
+    if(NDR_TIGetNumberOfTokens(tokens) == 0){
+        printf("\nNo text was matched during parsing of the source file.\n");
+        context->lexingCompleted = false;
+        return 1;
+    }
+    if (NDR_TT == true)
+        NDR_Context_PrintTokenTable(context);
+    if (NDR_TL == true)
+        NDR_Context_PrintTokenTableLocations(context);
+
+    return 0;
+}
+
+NDR_LexStream* NDR_CreateLexStream(NDR_ReadCallback read, void* userData){
+    return NDR_Context_CreateLexStream(NDR_GetDefaultContext(), read, userData);
+}
+
+NDR_LexStream* NDR_Context_CreateLexStream(NDR_Context* context, NDR_ReadCallback read, void* userData){
+
+    if(context->lexerConfiguringCompleted == false){
+        printf("\nThe lexer must be configured before a stream can be lexed\n");
+        return NULL;
+    }
+    if(read == NULL){
+        printf("A read function must be provided for a stream\n");
+        return NULL;
+    }
+
+    NDR_LexStream* stream = malloc(sizeof(NDR_LexStream));
+    stream->context = context;
+    stream->result = 0;
+    NDR_InitTokenInfoWrapper(&stream->tokens);
+
+    // The window starts empty and is filled by the read callback as the lexer reaches its end
+    LexerInput input;
+    InitializeLexerInput(&input, NULL, 0);
+    input.limit = (size_t) -1;
+    input.read = read;
+    input.userData = userData;
+    input.endOfInput = false;
+    NDR_InitLineIndex(&stream->lineIndex);
+    input.lineIndex = &stream->lineIndex;
+    InitializeLexerChunk(&stream->chunk, context, &input, &stream->tokens);
+    stream->chunk.tokenLimit = 1;
+    InitializeLexerMatcher(context, &stream->matcher);
+
+    return stream;
+}
+
+NDR_TokenInformation* NDR_NextToken(NDR_LexStream* stream){
+    if(stream->result != 0)
+        return NULL;
+
+    NDR_ResetTokenInfoWrapper(&stream->tokens);
+    NDR_LineIndexDiscardBefore(&stream->lineIndex, stream->chunk.input.keepPosition);
+    stream->result = MatchChunkTokens(stream->context, &stream->chunk, &stream->matcher);
+    if(stream->result != 0 || NDR_TIGetNumberOfTokens(&stream->tokens) == 0)
+        return NULL;
+
+    return NDR_TIGetTokenInfo(&stream->tokens, 0);
+}
+
+int NDR_GetLexStreamResult(NDR_LexStream* stream){
+    return stream->result;
+}
+
+void NDR_DestroyLexStream(NDR_LexStream* stream){
+    DestroyLexerMatcher(stream->context, &stream->matcher);
+    DestroyLexerChunk(&stream->chunk);
+    free(stream->chunk.input.buffer);
+    NDR_FreeTokenInfoWrapper(&stream->tokens);
+    NDR_FreeLineIndex(&stream->lineIndex);
+    free(stream);
+}
+
+void NDR_SetLexThreads(int threads){
+    NDR_Context_SetLexThreads(NDR_GetDefaultContext(), threads);
+}
+
+void NDR_Context_SetLexThreads(NDR_Context* context, int threads){
+    if(threads < 0)
+        threads = 0;
+    context->lexThreads = threads;
+}
+
+void NDR_SetRegexEngine(NDR_RegexEngine engine){
+    NDR_Context_SetRegexEngine(NDR_GetDefaultContext(), engine);
+}
+
+void NDR_Context_SetRegexEngine(NDR_Context* context, NDR_RegexEngine engine){
+    context->regexEngine = engine;
+}
+
+// Lexing core shared by every input source. Large inputs are split into chunks that are lexed on their own threads
+int LexInput(NDR_Context* context, LexerInput* input){
+
+    // The token table is kept by the context and recycled by NDR_Context_ResetInput
+    if(context->TIWrapper == NULL){
+        context->TIWrapper = malloc(sizeof(NDR_TokenInformationWrapper));
+        NDR_InitTokenInfoWrapper(context->TIWrapper);
+    }
+    PrepareLineIndex(context, input);
 
     if (NDR_M == true){
         printf("\n\n************** Text File Matching ****************\n\n");
         printf("line 1 ------------- column 1\n");
     }
 
+    // A whole input can be looked up in the token cache, a streamed one is only known once it has been lexed
+    bool cacheable = (input->read == NULL && context->tokenCacheDirectory != NULL);
+    if(cacheable == true && NDR_LoadCachedTokens(context, input->data, input->length) == 0){
+        if (NDR_STAT == true)
+            printf("\nTokens loaded from the token cache\n");
+    }
+    else{
+        int result = 0;
+        size_t numChunks = GetLexerChunkCount(context, input->length);
+        if(numChunks > 1){
+            result = LexInputInChunks(context, input, numChunks);
+        }
+        else{
+            LexerChunk chunk;
+            InitializeLexerChunk(&chunk, context, input, context->TIWrapper);
+            result = LexChunk(context, &chunk);
+            // The chunk lexes a copy of the input, so the window it read a streamed input into and the length it reached are handed back
+            *input = chunk.input;
+            DestroyLexerChunk(&chunk);
+        }
+        if(result != 0)
+            return 1;
+
+        if(NDR_TIGetNumberOfTokens(context->TIWrapper) == 0){
+            printf("\nNo text was matched during parsing of the source file.\n");
+            return 1;
+        }
+        // Failing to write the cache only costs the next lexing of the input, so lexing still succeeds
+        if(cacheable == true)
+            NDR_SaveCachedTokens(context, input->data, input->length);
+    }
+    if (NDR_TT == true)
+        NDR_Context_PrintTokenTable(context);
+    if (NDR_TL == true)
+        NDR_Context_PrintTokenTableLocations(context);
+
+    context->lexingCompleted = true;
+
+    if (NDR_STAT == true)
+        printf("\nLexical analysis successful\n");
+
+    return 0;
+}
+
+// Lex the tokens of a chunk with matching state of its own so that chunks can be lexed at the same time
+int LexChunk(NDR_Context* context, LexerChunk* chunk){
+
+    LexerMatcher matcher;
+    InitializeLexerMatcher(context, &matcher);
+
+    chunk->stopPosition = chunk->input.length;
+    int result = MatchChunkTokens(context, chunk, &matcher);
+
+    DestroyLexerMatcher(context, &matcher);
+
+    return result;
+}
+
+void InitializeLexerMatcher(NDR_Context* context, LexerMatcher* matcher){
+    matcher->matchingState = malloc(sizeof(TokenMatchingState));
+    InitializeTokenMatchingState(matcher->matchingState);
+
+    // The end regexes of a state are only needed once a token of that state is found
+    matcher->endCursorSets = calloc(NDR_RSGetNumberOfStates(context->RSWrapper), sizeof(RegexCursorSet*));
+    matcher->stopByteSearches = calloc(256, sizeof(StopByteSearch));
+
+    // Lexing always begins in the initial mode
+    matcher->modeStackAllocated = 50;
+    matcher->modeStack = malloc(sizeof(int) * matcher->modeStackAllocated);
+    matcher->modeStack[0] = 0;
+    matcher->modeStackSize = 1;
+    matcher->startCursorSets = calloc(NDR_RSGetNumberOfModes(context->RSWrapper), sizeof(RegexCursorSet*));
+    EnterLexerMode(context, matcher, 0);
+}
+
+void DestroyLexerMatcher(NDR_Context* context, LexerMatcher* matcher){
+    for(size_t x = 0; x < NDR_RSGetNumberOfModes(context->RSWrapper); x++){
+        if(matcher->startCursorSets[x] != NULL){
+            DestroyRegexCursorSet(matcher->startCursorSets[x]);
+            free(matcher->startCursorSets[x]);
+        }
+    }
+    free(matcher->startCursorSets);
+    free(matcher->modeStack);
+    for(size_t x = 0; x < NDR_RSGetNumberOfStates(context->RSWrapper); x++){
+        if(matcher->endCursorSets[x] != NULL){
+            DestroyRegexCursorSet(matcher->endCursorSets[x]);
+            free(matcher->endCursorSets[x]);
+        }
+    }
+    free(matcher->endCursorSets);
+    free(matcher->stopByteSearches);
+    DestroyTokenMatchingState(matcher->matchingState);
+    free(matcher->matchingState);
+}
+
+// Only the start regexes of the rules in a mode are matched while it is the current mode
+void EnterLexerMode(NDR_Context* context, LexerMatcher* matcher, int mode){
+    TokenMatchingState* matchingState = matcher->matchingState;
+
+    if(context->lexerDFA != NULL){
+        matchingState->startDFAState = NDR_LexerDFAGetStartState(context->lexerDFA, mode);
+    }
+    else{
+        // Without the combined automaton each start regex of the mode keeps a cursor that is stepped once per character
+        if(matcher->startCursorSets[mode] == NULL)
+            matcher->startCursorSets[mode] = CreateStartCursorSet(context, mode);
+        matchingState->cursorSet = matcher->startCursorSets[mode];
+        ResetRegexCursorSet(matchingState->cursorSet);
+    }
+    if(context->lexerTrie != NULL)
+        matchingState->rootTrieNode = NDR_LexerTrieGetRootNode(context->lexerTrie, mode);
+
+    matchingState->dfaState = matchingState->startDFAState;
+    matchingState->trieNode = matchingState->rootTrieNode;
+}
+
+// Change the current mode as the rule of a matched token asks. Returns non-zero when a pop would leave no mode to return to
+int ApplyModeAction(NDR_Context* context, LexerMatcher* matcher, NDR_RegexState* regexState){
+    if(NDR_RSGetModeAction(regexState) == NDR_MODE_NONE)
+        return 0;
+
+    if(NDR_RSGetModeAction(regexState) == NDR_MODE_PUSH){
+        if(matcher->modeStackSize > matcher->modeStackAllocated - 5){
+            matcher->modeStackAllocated = matcher->modeStackAllocated * 2;
+            matcher->modeStack = realloc(matcher->modeStack, sizeof(int) * matcher->modeStackAllocated);
+        }
+        matcher->modeStack[matcher->modeStackSize++] = NDR_RSGetModeTarget(regexState);
+    }
+    else if(NDR_RSGetModeAction(regexState) == NDR_MODE_SWITCH){
+        matcher->modeStack[matcher->modeStackSize - 1] = NDR_RSGetModeTarget(regexState);
+    }
+    else if(NDR_RSGetModeAction(regexState) == NDR_MODE_POP){
+        if(matcher->modeStackSize == 1)
+            return 1;
+        matcher->modeStackSize--;
+    }
+
+    EnterLexerMode(context, matcher, matcher->modeStack[matcher->modeStackSize - 1]);
+    return 0;
+}
+
+// Go through the input character by character from the start of the chunk until a token would start at or after the input limit
+// Lexing can be continued by calling the function again with the same chunk and matcher after it stopped at a boundary
+int MatchChunkTokens(NDR_Context* context, LexerChunk* chunk, LexerMatcher* matcher){
+
+    LexerInput* input = &chunk->input;
+    TokenMatchingState* matchingState = matcher->matchingState;
+    RegexCursorSet** endCursorSets = matcher->endCursorSets;
+    // matchEnd marks the input just after the longest complete match of the current token
+    size_t matchEnd = markInput(input);
+
     // Loop to go through the code file character by character and find matches using PCRE2
     while(matchingState->ch != EOF){
 
-        setMatchingChar(matchingState, fgetc(code));
+        // The token is empty only at a boundary between two tokens
+        if(getMatchToken(matchingState)[0] == '\0'){
+            UpdateTokenLookahead(chunk);
+            if(input->position >= input->limit || IsRealigned(chunk) == true || (chunk->tokenLimit > 0 && GetChunkTokenCount(chunk) >= chunk->tokenLimit)){
+                chunk->stopPosition = input->position;
+                return 0;
+            }
+            if(input->position < chunk->boundaryWindowEnd)
+                AddLexerBoundary(chunk, input->position);
+            input->keepPosition = input->position;
+            chunk->tokenStart = input->position;
+        }
+
+        setMatchingChar(matchingState, readInputChar(input));
         addCharToToken(matchingState, matchingState->ch);
         matchingState->highestMatchSeen = NDR_COMP_NOMATCH;
         // For each entry in the symbol table we will make a comparison
-        // This can be optimized by not checking already failed matches potentially
-        for(size_t x = 0; x < NDR_RSGetNumberOfStates(RSWrapper); x++){
-            for(size_t i = 0; i < NDR_RSGetNumStartStates(NDR_RSGetRegexState(RSWrapper, x)); i++){
-                CompareUsingRegex(matchingState, x, i);
-            }
+        // The literal trie and the combined automaton make the comparison for every entry at once when they are available
+        if(context->lexerTrie != NULL)
+            CompareUsingTrie(context, matchingState);
+        if(context->lexerDFA != NULL){
+            CompareUsingDFA(context, matchingState);
         }
+        else{
+            CompareUsingCursors(matchingState);
+        }
+        if(matchingState->highestMatchSeen == NDR_COMP_COMPLETEMATCH)
+            matchEnd = markInput(input);
+        // A guessed start that reaches text no rule can match was wrong, so the chunk stops instead of reading on to the end of the input
+        // It is lexed again from where the previous chunk stopped
+        if(input->speculative == true && matchingState->completeMatchFound == false && matchingState->potentialMatchFound == false)
+            return 1;
 
-        if(completeMatchFound(matchingState) == true && NDR_RSGetStateFlag(NDR_RSGetRegexState(RSWrapper, matchingState->indexOfBestMatch)) == true){
+        if(completeMatchFound(matchingState) == true && NDR_RSGetStateFlag(NDR_RSGetRegexState(context->RSWrapper, matchingState->indexOfBestMatch)) == true){
 
-            if(getBackTrackAmount(matchingState) > 0){
-                getMatchToken(matchingState)[strlen(getMatchToken(matchingState))-getBackTrackAmount(matchingState)] = '\0';
-                fseek(code, -1 * (getFileBackTrackAmount(matchingState) + 1), SEEK_CUR);
-            }
-            else{
-                getMatchToken(matchingState)[strlen(getMatchToken(matchingState)) - 1] = '\0';
-                fseek(code, -1, SEEK_CUR);
-            }
+            if(getBackTrackAmount(matchingState) > 0)
+                truncateToken(matchingState, getBackTrackAmount(matchingState));
+            else
+                truncateToken(matchingState, 1);
+            rewindInputToMark(input, matchEnd);
 
             // The below loop goes through a token after the start state token match has been found and checks to see if the token can be validated using the states
             int ch = 0;
-            char sString[2];
-            sString[1] = '\0';
 
             bool currentlyEscaped = false;
             bool allowMatch = false;
             bool escapeMatch = false;
             bool endMatch = false;
             bool endCheckComplete = false;
+            // probeStart marks the character being checked for an end regex and endMatchEnd the input just after a complete end match
+            size_t probeStart = 0;
+            size_t endMatchEnd = 0;
 
             TokenMatchingState* endMatchingState = malloc(sizeof(TokenMatchingState));
             InitializeTokenMatchingState(endMatchingState);
+            if(endCursorSets[matchingState->indexOfBestMatch] == NULL)
+                endCursorSets[matchingState->indexOfBestMatch] = CreateEndCursorSet(context, matchingState->indexOfBestMatch);
+            endMatchingState->cursorSet = endCursorSets[matchingState->indexOfBestMatch];
 
             while(ch != EOF){
+                // A run of plain bytes can neither end nor escape anything so it is added to the token in one step
+                if (NDR_M == false){
+                    size_t plainEnd = FindPlainBytesEnd(input, NDR_RSGetRegexState(context->RSWrapper, matchingState->indexOfBestMatch), matcher->stopByteSearches);
+                    if(plainEnd > input->position){
+                        addRangeToToken(matchingState, input->data + (input->position - input->base), plainEnd - input->position);
+                        input->position = plainEnd;
+                        if(input->position > input->furthestPosition)
+                            input->furthestPosition = input->position;
+                        currentlyEscaped = false;
+                    }
+                }
+
                 if (NDR_M == true)
                     printf("Currently matching: %s\n", getMatchToken(matchingState));
 
-                ch = fgetc(code);
+                ch = peekInputChar(input);
                 if (ch == EOF){
-                    printf("Reached end of file during parsing\n");
+                    if(input->speculative == false)
+                        printf("Reached end of file during parsing\n");
+                    DestroyTokenMatchingState(endMatchingState);
+                    free(endMatchingState);
                     return 1;
                 }
-                fseek(code, -1, SEEK_CUR);
-                sString[0] = (char) ch;
 
-                allowMatch = doesCharMatchAllowRegex(matchingState->indexOfBestMatch, sString);
-                escapeMatch = doesCharMatchEscapeRegex(matchingState->indexOfBestMatch, sString);
+                allowMatch = NDR_RSIsAllowedByte(NDR_RSGetRegexState(context->RSWrapper, matchingState->indexOfBestMatch), (char) ch);
+                escapeMatch = NDR_RSIsEscapedByte(NDR_RSGetRegexState(context->RSWrapper, matchingState->indexOfBestMatch), (char) ch);
 
                 ResetTokenMatchingState(endMatchingState);
                 endCheckComplete = false;
+                probeStart = markInput(input);
 
                 while(endMatchingState->ch != EOF && endCheckComplete == false){
 
-                    setMatchingChar(endMatchingState, fgetc(code));
+                    setMatchingChar(endMatchingState, readInputChar(input));
                     addCharToToken(endMatchingState, endMatchingState->ch);
                     endMatchingState->highestMatchSeen = NDR_COMP_NOMATCH;
 
-                    for(size_t x = 0; x < NDR_RSGetNumberOfStates(RSWrapper); x++){
-                        if(NDR_RSGetStateFlag(NDR_RSGetRegexState(RSWrapper, x)) == true && strcmp(NDR_RSGetKeyword(NDR_RSGetRegexState(RSWrapper, matchingState->indexOfBestMatch)), NDR_RSGetKeyword(NDR_RSGetRegexState(RSWrapper, x))) == 0)
-                        for(size_t i = 0; i < NDR_RSGetNumEndStates(NDR_RSGetRegexState(RSWrapper, x)); i++){
-                            CompareUsingRegex(endMatchingState, x, i);
-                        }
-                    }
+                    CompareUsingCursors(endMatchingState);
+                    if(endMatchingState->highestMatchSeen == NDR_COMP_COMPLETEMATCH)
+                        endMatchEnd = markInput(input);
 
                     if(endMatchingState->completeMatchFound == false && endMatchingState->potentialMatchFound == false){
-                        if(getBackTrackAmount(endMatchingState) > 0){
-                            fseek(code, -1 * getFileBackTrackAmount(endMatchingState), SEEK_CUR);
-                        }
+                        // The checked character belongs to the token so lexing carries on just after it
+                        rewindInputToMark(input, probeStart + 1);
 
                         endMatch = false;
                         endCheckComplete = true;
@@ -500,20 +1242,15 @@ int NDR_Lex(char* fileName){
                     }
 
                     if(completeMatchFound(endMatchingState) == true){
-                        if(getBackTrackAmount(endMatchingState) > 0){
-                            fseek(code, -1 * getFileBackTrackAmount(endMatchingState), SEEK_CUR);
-                        }
+                        rewindInputToMark(input, endMatchEnd);
 
-                        getMatchToken(endMatchingState)[strlen(getMatchToken(endMatchingState))-(1+getBackTrackAmount(endMatchingState))] = '\0';
+                        truncateToken(endMatchingState, 1+getBackTrackAmount(endMatchingState));
                         CapturePotentialMatch(endMatchingState);
                         endMatch = true;
                         endCheckComplete = true;
 
-                        fseek(code, -1, SEEK_CUR);
-                        updatefilePosition(&lineNumber, &columnNumber, getMatchToken(endMatchingState));
-
                         if (NDR_M == true)
-                            printf("\nline %i ------------- column %i\n", lineNumber, columnNumber);
+                            printf("\nline %i ------------- column %i\n", GetInputLine(input, input->position), GetInputColumn(input, input->position));
 
                         break;
                     }
@@ -529,22 +1266,24 @@ int NDR_Lex(char* fileName){
                 }
                 else if(escapeMatch == true && currentlyEscaped == true){
                     currentlyEscaped = false;
-                    getMatchToken(matchingState)[strlen(getMatchToken(matchingState)) - 1] = '\0';
+                    truncateToken(matchingState, 1);
                 }
                 else if(endMatch == true && currentlyEscaped == true){
                     currentlyEscaped = false;
-                    getMatchToken(matchingState)[strlen(getMatchToken(matchingState)) - 1] = '\0';
+                    truncateToken(matchingState, 1);
                 }
                 else if(endMatch == true && currentlyEscaped == false){
                     addStringToToken(matchingState, GetCapturedMatch(endMatchingState));
-                    ch = fgetc(code);
                     break;
                 }
                 else if(allowMatch == true){
                     currentlyEscaped = false;
                 }
                 else{
-                    printf("Found invalid character \"%c\" during parsing of state for keyword \"%s\"\n", ch, NDR_RSGetKeyword(NDR_RSGetRegexState(RSWrapper, matchingState->indexOfBestMatch)));
+                    if(input->speculative == false)
+                        printf("Found invalid character \"%c\" during parsing of state for keyword \"%s\"\n", ch, NDR_RSGetKeyword(NDR_RSGetRegexState(context->RSWrapper, matchingState->indexOfBestMatch)));
+                    DestroyTokenMatchingState(endMatchingState);
+                    free(endMatchingState);
                     return 1;
                 }
                 addCharToToken(matchingState, ch);
@@ -552,117 +1291,359 @@ int NDR_Lex(char* fileName){
             DestroyTokenMatchingState(endMatchingState);
             free(endMatchingState);
             // Entering the matched tokens into the tokenTable
-            if(NDR_RSGetCategory(NDR_RSGetRegexState(RSWrapper, matchingState->indexOfBestMatch)) == NDR_STATE_ERROR){
-                printf("\nError token found: %s\n", getMatchToken(matchingState));
+            if(NDR_RSGetCategory(NDR_RSGetRegexState(context->RSWrapper, matchingState->indexOfBestMatch)) == NDR_STATE_ERROR){
+                if(input->speculative == false)
+                    printf("\nError token found: %s\n", getMatchToken(matchingState));
                 return 1;
             }
-            if(NDR_RSGetCategory(NDR_RSGetRegexState(RSWrapper, matchingState->indexOfBestMatch)) == NDR_STATE_ACCEPT){
-                NDR_AddNewToken(TIWrapper);
-                NDR_SetTokenInfoKeyword(NDR_TIGetLastTokenInfo(TIWrapper), NDR_RSGetKeyword(NDR_RSGetRegexState(RSWrapper, matchingState->indexOfBestMatch)));
-                NDR_SetTokenInfoToken(NDR_TIGetLastTokenInfo(TIWrapper), getMatchToken(matchingState));
-                NDR_SetTokenInfoLine(NDR_TIGetLastTokenInfo(TIWrapper), lineNumber);
-                NDR_SetTokenInfoColumn(NDR_TIGetLastTokenInfo(TIWrapper), columnNumber);
+            if(NDR_RSGetCategory(NDR_RSGetRegexState(context->RSWrapper, matchingState->indexOfBestMatch)) == NDR_STATE_ACCEPT && chunk->tokenStore != NULL){
+                NDR_TSAddToken(chunk->tokenStore, matchingState->indexOfBestMatch, chunk->tokenStart, getMatchToken(matchingState), matchingState->tokenLength);
             }
-            // Resetting variables for finding tokens and updating line and column numbers
+            else if(NDR_RSGetCategory(NDR_RSGetRegexState(context->RSWrapper, matchingState->indexOfBestMatch)) == NDR_STATE_ACCEPT){
+                NDR_AddNewToken(chunk->TIWrapper);
+                RecordTokenStart(chunk, NDR_TIGetLastTokenInfo(chunk->TIWrapper));
+                NDR_SetTokenInfoKeyword(NDR_TIGetLastTokenInfo(chunk->TIWrapper), NDR_RSGetKeyword(NDR_RSGetRegexState(context->RSWrapper, matchingState->indexOfBestMatch)));
+                NDR_SetTokenInfoToken(NDR_TIGetLastTokenInfo(chunk->TIWrapper), getMatchToken(matchingState));
+            }
+            if(ApplyModeAction(context, matcher, NDR_RSGetRegexState(context->RSWrapper, matchingState->indexOfBestMatch)) != 0){
+                if(input->speculative == false)
+                    printf("\nNo lexer mode to return to for the token from line: %i column: %i\n", GetInputLine(input, chunk->tokenStart), GetInputColumn(input, chunk->tokenStart));
+                return 1;
+            }
+            // Resetting variables for finding tokens
 
             matchingState->completeMatchFound = false;
-            fseek(code, -1, SEEK_CUR);
-            updatefilePosition(&lineNumber, &columnNumber, getMatchToken(matchingState));
-            strcpy(getMatchToken(matchingState), "");
+            startNewToken(matchingState);
             matchingState->indexOfBestMatch = 0;
 
             if (NDR_M == true)
-                printf("\nline %i ------------- column %i\n", lineNumber, columnNumber);
+                printf("\nline %i ------------- column %i\n", GetInputLine(input, input->position), GetInputColumn(input, input->position));
         }
         else if(completeMatchFound(matchingState) == true){
-            getMatchToken(matchingState)[strlen(getMatchToken(matchingState))-(1+getBackTrackAmount(matchingState))] = '\0';
-            if(getBackTrackAmount(matchingState) > 0){
-                fseek(code, -1 * getFileBackTrackAmount(matchingState), SEEK_CUR);
-            }
+            truncateToken(matchingState, 1+getBackTrackAmount(matchingState));
+            rewindInputToMark(input, matchEnd);
 
-            if(NDR_RSGetCategory(NDR_RSGetRegexState(RSWrapper, matchingState->indexOfBestMatch)) == NDR_STATE_ERROR){
-                printf("\nError token found: %s\n", getMatchToken(matchingState));
+            if(NDR_RSGetCategory(NDR_RSGetRegexState(context->RSWrapper, matchingState->indexOfBestMatch)) == NDR_STATE_ERROR){
+                if(input->speculative == false)
+                    printf("\nError token found: %s\n", getMatchToken(matchingState));
                 return 1;
             }
-            if(NDR_RSGetCategory(NDR_RSGetRegexState(RSWrapper, matchingState->indexOfBestMatch)) == NDR_STATE_ACCEPT){
-                NDR_AddNewToken(TIWrapper);
-                NDR_SetTokenInfoLine(NDR_TIGetLastTokenInfo(TIWrapper), lineNumber);
-                NDR_SetTokenInfoColumn(NDR_TIGetLastTokenInfo(TIWrapper), columnNumber);
-                NDR_SetTokenInfoToken(NDR_TIGetLastTokenInfo(TIWrapper), getMatchToken(matchingState));
-                if(NDR_RSGetLiteralFlag(NDR_RSGetRegexState(RSWrapper, matchingState->indexOfBestMatch)) == true)
-                    NDR_SetTokenInfoKeyword(NDR_TIGetLastTokenInfo(TIWrapper), getMatchToken(matchingState));
+            if(NDR_RSGetCategory(NDR_RSGetRegexState(context->RSWrapper, matchingState->indexOfBestMatch)) == NDR_STATE_ACCEPT && chunk->tokenStore != NULL){
+                NDR_TSAddToken(chunk->tokenStore, matchingState->indexOfBestMatch, chunk->tokenStart, getMatchToken(matchingState), matchingState->tokenLength);
+            }
+            else if(NDR_RSGetCategory(NDR_RSGetRegexState(context->RSWrapper, matchingState->indexOfBestMatch)) == NDR_STATE_ACCEPT){
+                NDR_AddNewToken(chunk->TIWrapper);
+                RecordTokenStart(chunk, NDR_TIGetLastTokenInfo(chunk->TIWrapper));
+                NDR_SetTokenInfoToken(NDR_TIGetLastTokenInfo(chunk->TIWrapper), getMatchToken(matchingState));
+                if(NDR_RSGetLiteralFlag(NDR_RSGetRegexState(context->RSWrapper, matchingState->indexOfBestMatch)) == true)
+                    NDR_SetTokenInfoKeyword(NDR_TIGetLastTokenInfo(chunk->TIWrapper), getMatchToken(matchingState));
                 else
-                    NDR_SetTokenInfoKeyword(NDR_TIGetLastTokenInfo(TIWrapper), NDR_RSGetKeyword(NDR_RSGetRegexState(RSWrapper, matchingState->indexOfBestMatch)));
+                    NDR_SetTokenInfoKeyword(NDR_TIGetLastTokenInfo(chunk->TIWrapper), NDR_RSGetKeyword(NDR_RSGetRegexState(context->RSWrapper, matchingState->indexOfBestMatch)));
+            }
+            if(ApplyModeAction(context, matcher, NDR_RSGetRegexState(context->RSWrapper, matchingState->indexOfBestMatch)) != 0){
+                if(input->speculative == false)
+                    printf("\nNo lexer mode to return to for the token from line: %i column: %i\n", GetInputLine(input, chunk->tokenStart), GetInputColumn(input, chunk->tokenStart));
+                return 1;
             }
-            // Resetting variables for finding tokens and updating line and column numbers
-            fseek(code, -1, SEEK_CUR);
-            updatefilePosition(&lineNumber, &columnNumber, getMatchToken(matchingState));
+            // Resetting variables for finding tokens
             matchingState->completeMatchFound = false;
-            strcpy(getMatchToken(matchingState), "");
+            startNewToken(matchingState);
             matchingState->indexOfBestMatch = 0;
 
 
 
             if (NDR_M == true)
-                printf("\nline %i ------------- column %i\n", lineNumber, columnNumber);
+                printf("\nline %i ------------- column %i\n", GetInputLine(input, input->position), GetInputColumn(input, input->position));
         }
         if(hasMatchingStarted(matchingState) && matchingState->ch == EOF){
-            printf("\nIncomplete matching from line: %i column: %i\nPotentially an opening of item with no closing\n", lineNumber, columnNumber);
+            if(input->speculative == false)
+                printf("\nIncomplete matching from line: %i column: %i\nPotentially an opening of item with no closing\n", GetInputLine(input, chunk->tokenStart), GetInputColumn(input, chunk->tokenStart));
             return 1;
         }
-        else if(getNumberOfCompleteMatches(matchingState) == 0 && strlen(getMatchToken(matchingState)) > 1 && matchingState->ch == EOF && MATCH_ALL == true){
-            printf("\nMatching error from line: %i column: %i\n", lineNumber, columnNumber);
+        else if(getNumberOfCompleteMatches(matchingState) == 0 && strlen(getMatchToken(matchingState)) > 1 && matchingState->ch == EOF && context->matchAll == true){
+            if(input->speculative == false)
+                printf("\nMatching error from line: %i column: %i\n", GetInputLine(input, chunk->tokenStart), GetInputColumn(input, chunk->tokenStart));
             return 1;
         }
 
         matchingState->numberOfCompleteMatches = 0;
         matchingState->potentialMatchFound = false;
     }
+    UpdateTokenLookahead(chunk);
 
+    return 0;
+}
 
-    if(NDR_TIGetNumberOfTokens(TIWrapper) == 0){
-        printf("\nNo text was matched during parsing of the source file.\n");
+// Split the input into one chunk per thread. Every chunk but the first guesses that a token starts after the first newline of its share of the input
+// Chunks are joined in order at a boundary the previous chunk stopped at, and a chunk that never passed that boundary is lexed again from it
+int LexInputInChunks(NDR_Context* context, LexerInput* input, size_t numChunks){
+
+    LexerChunk* chunks = malloc(sizeof(LexerChunk) * numChunks);
+    NDR_TokenInformationWrapper* chunkTokens = malloc(sizeof(NDR_TokenInformationWrapper) * numChunks);
+
+    size_t start = 0;
+    for(size_t x = 0; x < numChunks; x++){
+        size_t limit = input->length;
+        if(x + 1 < numChunks){
+            size_t share = input->length / numChunks * (x + 1);
+            if(share < start)
+                share = start;
+            const char* newline = memchr(input->data + share, '\n', input->length - share);
+            if(newline != NULL)
+                limit = (size_t) (newline - input->data) + 1;
+        }
+
+        LexerInput chunkInput = *input;
+        chunkInput.position = start;
+        chunkInput.furthestPosition = start;
+        chunkInput.limit = limit;
+        chunkInput.speculative = (x > 0);
+        NDR_InitTokenInfoWrapper(&chunkTokens[x]);
+        InitializeLexerChunk(&chunks[x], context, &chunkInput, &chunkTokens[x]);
+        if(x > 0)
+            chunks[x].boundaryWindowEnd = start + NDR_LEXER_RESYNC_WINDOW;
+        start = limit;
+    }
+
+#ifndef _WIN32
+    pthread_t* threadIDs = malloc(sizeof(pthread_t) * numChunks);
+    bool* threadStarted = calloc(numChunks, sizeof(bool));
+    for(size_t x = 1; x < numChunks; x++){
+        if(pthread_create(&threadIDs[x], NULL, RunLexerChunk, &chunks[x]) == 0)
+            threadStarted[x] = true;
+    }
+    RunLexerChunk(&chunks[0]);
+    for(size_t x = 1; x < numChunks; x++){
+        if(threadStarted[x] == true)
+            pthread_join(threadIDs[x], NULL);
+        else
+            RunLexerChunk(&chunks[x]);
+    }
+    free(threadIDs);
+    free(threadStarted);
+#else
+    for(size_t x = 0; x < numChunks; x++)
+        RunLexerChunk(&chunks[x]);
+#endif
+
+    // The first chunk starts at the beginning of the input so its tokens and positions are already exact
+    // furthestPosition is the furthest position a single thread would have read on reaching position
+    int result = chunks[0].result;
+    size_t position = chunks[0].stopPosition;
+    size_t furthestPosition = chunks[0].input.furthestPosition;
+    size_t firstToken = context->TIWrapper->numTokens;
+    if(result == 0)
+        NDR_MoveTokenInfo(context->TIWrapper, chunks[0].TIWrapper, 0, chunks[0].TIWrapper->numTokens);
+
+    for(size_t x = 1; x < numChunks && result == 0 && position < input->length; x++){
+        LexerChunk* chunk = &chunks[x];
+        // A token of an earlier chunk can extend past the whole chunk
+        if(position >= chunk->input.limit)
+            continue;
+
+        // The chunk can only be joined where it had read no further than a single thread would have
+        LexerBoundary* boundary = NULL;
+        if(chunk->result == 0)
+            boundary = FindLexerBoundary(chunk, position);
+        if(boundary != NULL && boundary->furthestPosition > furthestPosition)
+            boundary = NULL;
+        if(boundary == NULL){
+            LexerInput chunkInput = chunk->input;
+            chunkInput.position = position;
+            chunkInput.speculative = false;
+            chunkInput.furthestPosition = furthestPosition;
+            NDR_ResetTokenInfoWrapper(chunk->TIWrapper);
+            DestroyLexerChunk(chunk);
+            InitializeLexerChunk(chunk, context, &chunkInput, &chunkTokens[x]);
+            chunk->boundaryWindowEnd = position + 1;
+            result = LexChunk(context, chunk);
+            if(result != 0)
+                break;
+            boundary = &chunk->boundaries[0];
+        }
+
+        // The last token joined so far covers the ignored text this chunk read before its first token after the boundary
+        LexerBoundary* lastBoundary = boundary;
+        while(lastBoundary + 1 < chunk->boundaries + chunk->numBoundaries && (lastBoundary + 1)->tokenIndex == boundary->tokenIndex)
+            lastBoundary++;
+        size_t lookaheadEnd = lastBoundary->nextTokenFurthestPosition > furthestPosition ? lastBoundary->nextTokenFurthestPosition : furthestPosition;
+        if(context->TIWrapper->numTokens > firstToken)
+            lookaheadEnd = ExtendTokenLookahead(NDR_TIGetLastTokenInfo(context->TIWrapper), lookaheadEnd);
+
+        for(size_t y = boundary->tokenIndex; y < chunk->TIWrapper->numTokens; y++)
+            lookaheadEnd = ExtendTokenLookahead(NDR_TIGetTokenInfo(chunk->TIWrapper, y), lookaheadEnd);
+        NDR_MoveTokenInfo(context->TIWrapper, chunk->TIWrapper, boundary->tokenIndex, chunk->TIWrapper->numTokens - boundary->tokenIndex);
+
+        position = chunk->stopPosition;
+        if(chunk->input.furthestPosition > furthestPosition)
+            furthestPosition = chunk->input.furthestPosition;
+    }
+
+    for(size_t x = 0; x < numChunks; x++){
+        DestroyLexerChunk(&chunks[x]);
+        NDR_FreeTokenInfoWrapper(&chunkTokens[x]);
+    }
+    free(chunks);
+    free(chunkTokens);
+
+    return result;
+}
+
+void* RunLexerChunk(void* argument){
+    LexerChunk* chunk = (LexerChunk*) argument;
+    chunk->result = LexChunk(chunk->context, chunk);
+    return NULL;
+}
+
+// Inputs are only split when there is more than one thread available and every chunk gets at least NDR_LEXER_MINIMUM_CHUNK bytes
+size_t GetLexerChunkCount(NDR_Context* context, size_t length){
+    // Matching output has to be printed in order so it is only available when lexing on one thread
+    if(NDR_M == true)
+        return 1;
+    // A chunk that starts part way through the input cannot know the lexer mode in effect there
+    if(NDR_RSGetNumberOfModes(context->RSWrapper) > 1)
         return 1;
+
+    size_t numChunks = 1;
+    if(context->lexThreads > 0){
+        numChunks = (size_t) context->lexThreads;
     }
-    if (NDR_TT == true)
-        NDR_PrintTokenTable();
-    if (NDR_TL == true)
-        NDR_PrintTokenTableLocations();
+    else{
+#ifndef _WIN32
+        long numProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+        if(numProcessors > 0)
+            numChunks = (size_t) numProcessors;
+#endif
+    }
+    if(numChunks > length / NDR_LEXER_MINIMUM_CHUNK)
+        numChunks = length / NDR_LEXER_MINIMUM_CHUNK;
+    if(numChunks < 1)
+        numChunks = 1;
+    return numChunks;
+}
 
+// Keep the lookahead of the token table increasing for a token found after a boundary of a chunk or an edit
+// Returns the position after the furthest character read while lexing the token or any token before it
+size_t ExtendTokenLookahead(NDR_TokenInformation* token, size_t lookaheadEnd){
+    if(token->offset + token->lookahead < lookaheadEnd)
+        token->lookahead = lookaheadEnd - token->offset;
+    return token->offset + token->lookahead;
+}
 
-    DestroyTokenMatchingState(matchingState);
-    free(matchingState);
-    NDR_FreeRegexStateWrapper(RSWrapper);
-    free(RSWrapper);
+void RecordTokenStart(LexerChunk* chunk, NDR_TokenInformation* token){
+    NDR_SetTokenInfoOffset(token, chunk->tokenStart);
+    token->lookahead = 0;
+    NDR_SetTokenInfoLineIndex(token, chunk->input.lineIndex);
+}
 
+// The lookahead of a token covers everything read until the next boundary so it includes the ignored text after the token
+// The last boundary passed is given the same reach until a token follows it, so a token of an earlier chunk joined there can be extended the same way
+void UpdateTokenLookahead(LexerChunk* chunk){
+    if(chunk->tokenStore == NULL && chunk->TIWrapper->numTokens > chunk->firstToken){
+        NDR_TokenInformation* token = NDR_TIGetLastTokenInfo(chunk->TIWrapper);
+        token->lookahead = chunk->input.furthestPosition - token->offset;
+    }
+    if(chunk->numBoundaries > 0 && chunk->boundaries[chunk->numBoundaries - 1].tokenIndex == GetChunkTokenCount(chunk))
+        chunk->boundaries[chunk->numBoundaries - 1].nextTokenFurthestPosition = chunk->input.furthestPosition;
+}
 
-    fclose(code);
-    code = NULL;
-    free(code);
+size_t GetChunkTokenCount(LexerChunk* chunk){
+    if(chunk->tokenStore != NULL)
+        return chunk->tokenStore->numTokens;
+    return chunk->TIWrapper->numTokens;
+}
 
-    lexingCompleted = true;
+// Lexing an edited input is done once it reaches the start of a token of the input before the edit that follows the edited text
+bool IsRealigned(LexerChunk* chunk){
+    if(chunk->realignTokens == NULL)
+        return false;
 
-    if (NDR_STAT == true)
-        printf("\nLexical analysis successful\n");
+    while(chunk->realignIndex < chunk->realignTokens->numTokens){
+        NDR_TokenInformation* token = NDR_TIGetTokenInfo(chunk->realignTokens, chunk->realignIndex);
+        if(token->offset >= chunk->realignOffset){
+            size_t position = token->offset - chunk->removedLength + chunk->insertedLength;
+            if(position > chunk->input.position)
+                return false;
+            if(position == chunk->input.position){
+                chunk->realigned = true;
+                return true;
+            }
+        }
+        chunk->realignIndex++;
+    }
+    return false;
+}
 
-    return 0;
+/*
+Functions to manipulate LexerChunk structures
+*/
+
+void InitializeLexerChunk(LexerChunk* chunk, NDR_Context* context, LexerInput* input, NDR_TokenInformationWrapper* tokenWrapper){
+    chunk->context = context;
+    chunk->input = *input;
+    chunk->TIWrapper = tokenWrapper;
+    chunk->tokenStore = NULL;
+    chunk->firstToken = (tokenWrapper != NULL) ? tokenWrapper->numTokens : 0;
+    chunk->tokenStart = input->position;
+    chunk->stopPosition = input->length;
+    chunk->numBoundaries = 0;
+    chunk->memoryAllocated = 0;
+    chunk->boundaries = NULL;
+    chunk->boundaryWindowEnd = 0;
+    chunk->realignTokens = NULL;
+    chunk->realignIndex = 0;
+    chunk->realignOffset = 0;
+    chunk->removedLength = 0;
+    chunk->insertedLength = 0;
+    chunk->realigned = false;
+    chunk->tokenLimit = 0;
+    chunk->result = 0;
+}
+
+void DestroyLexerChunk(LexerChunk* chunk){
+    free(chunk->boundaries);
+    chunk->boundaries = NULL;
+}
+
+void AddLexerBoundary(LexerChunk* chunk, size_t position){
+    if(chunk->numBoundaries >= chunk->memoryAllocated){
+        chunk->memoryAllocated = chunk->memoryAllocated == 0 ? 64 : chunk->memoryAllocated * 2;
+        chunk->boundaries = realloc(chunk->boundaries, sizeof(LexerBoundary) * chunk->memoryAllocated);
+    }
+    chunk->boundaries[chunk->numBoundaries].position = position;
+    chunk->boundaries[chunk->numBoundaries].tokenIndex = GetChunkTokenCount(chunk);
+    chunk->boundaries[chunk->numBoundaries].furthestPosition = chunk->input.furthestPosition;
+    chunk->boundaries[chunk->numBoundaries].nextTokenFurthestPosition = chunk->input.furthestPosition;
+    chunk->numBoundaries++;
+}
+
+// Boundaries are added in the order they are passed so the search can stop at the first one past position
+LexerBoundary* FindLexerBoundary(LexerChunk* chunk, size_t position){
+    for(size_t x = 0; x < chunk->numBoundaries; x++){
+        if(chunk->boundaries[x].position == position)
+            return &chunk->boundaries[x];
+        if(chunk->boundaries[x].position > position)
+            break;
+    }
+    return NULL;
 }
 
 
 // verifyTokens is used to validate each line of the lexer config file and assign the config values to the tokens array
-bool verifyLineTokens(LexerLineCategorizer* lineCategorizer, StateRepresentation* stateRep){
+bool verifyLineTokens(NDR_Context* context, LexerLineCategorizer* lineCategorizer, StateRepresentation* stateRep){
 
     char* firstTokenLowerCase = malloc(strlen(lineCategorizer->tokens[0])+1);
+    char loweredToken[50];
     lowerCaseString(firstTokenLowerCase, lineCategorizer->tokens[0]);
 
-    if(HandleSettings(lineCategorizer) == true){
+    if(HandleSettings(context, lineCategorizer) == true){
         if(lineCategorizer->numberOfTokens > 1){
             printf("Tokens are not allowed after setting \"%s\"\n", lineCategorizer->tokens[0]);
             return false;
         }
         lineCategorizer->categories[0] = NDR_STATE_SETTING;
 
-        if(IsOneTimeSettingSeen(lineCategorizer) == true){
+        if(IsOneTimeSettingSeen(context, lineCategorizer) == true){
             printf("\"%s\" should only be set once\n", lineCategorizer->tokens[0]);
             return false;
         }
@@ -681,6 +1662,9 @@ bool verifyLineTokens(LexerLineCategorizer* lineCategorizer, StateRepresentation
         bool keyword = false;
         bool states = false;
         bool items = false;
+        bool modes = false;
+        bool modeAction = false;
+        bool engine = false;
         for(int x = 1; x < lineCategorizer->numberOfTokens; x++){
             if(lineCategorizer->tokens[x][strlen(lineCategorizer->tokens[x]) - 1] == '\n')
                 lineCategorizer->tokens[x][strlen(lineCategorizer->tokens[x]) - 1] = '\0';
@@ -693,8 +1677,8 @@ bool verifyLineTokens(LexerLineCategorizer* lineCategorizer, StateRepresentation
                 }
                 continue;
             }
-            else if ((strlen(lineCategorizer->tokens[x]) == 1 && strcmp(lowerCaseStringReturn(lineCategorizer->tokens[x], 1), "l") == 0)
-                      || (strlen(lineCategorizer->tokens[x]) == 7 && strcmp(lowerCaseStringReturn(lineCategorizer->tokens[x], 7), "literal") == 0)){
+            else if ((strlen(lineCategorizer->tokens[x]) == 1 && strcmp(lowerCaseStringReturn(loweredToken, lineCategorizer->tokens[x], 1), "l") == 0)
+                      || (strlen(lineCategorizer->tokens[x]) == 7 && strcmp(lowerCaseStringReturn(loweredToken, lineCategorizer->tokens[x], 7), "literal") == 0)){
                 if (x != 1 || keyword == true){
                     printf("\"literal\" should be the second token and should not be used with \"keyword\"n");
                     return false;
@@ -726,7 +1710,57 @@ bool verifyLineTokens(LexerLineCategorizer* lineCategorizer, StateRepresentation
                     lineCategorizer->categories[x] = NDR_STATE_KEYWORD;
                 }
             }
-            else if(strcmp(lowerCaseStringReturn(lineCategorizer->tokens[x], 7), "states:") == 0){
+            else if ((memcmp(lineCategorizer->tokens[x], "m{", 2) == 0 || memcmp(lineCategorizer->tokens[x], "M{", 2) == 0) && lineCategorizer->tokens[x][strlen(lineCategorizer->tokens[x]) - 1] == '}'){
+                if(lineCategorizer->tokens[x][2] == '}'){
+                   printf("No name found within mode brackets\n");
+                   return false;
+                }
+                else if(modes == true){
+                    printf("Cannot have more than one list of modes\n");
+                    return false;
+                }
+                else if(states == true){
+                    printf("modes should be given before the \"states\" keyword\n");
+                    return false;
+                }
+                else{
+                    modes = true;
+                    lineCategorizer->categories[x] = NDR_STATE_MODES;
+                }
+            }
+            else if ((memcmp(lineCategorizer->tokens[x], "e{", 2) == 0 || memcmp(lineCategorizer->tokens[x], "E{", 2) == 0) && lineCategorizer->tokens[x][strlen(lineCategorizer->tokens[x]) - 1] == '}'){
+                if(GetRegexEngine(lineCategorizer->tokens[x]) == -1){
+                    printf("\"%s\" is not a regex engine, use auto, backtrack or pikevm\n", lineCategorizer->tokens[x]);
+                    return false;
+                }
+                else if(engine == true){
+                    printf("Cannot have more than one regex engine\n");
+                    return false;
+                }
+                else if(states == true){
+                    printf("regex engines should be given before the \"states\" keyword\n");
+                    return false;
+                }
+                else{
+                    engine = true;
+                    lineCategorizer->categories[x] = NDR_STATE_ENGINE;
+                }
+            }
+            else if(GetModeAction(lineCategorizer->tokens[x]) != NDR_MODE_NONE){
+                if(modeAction == true){
+                    printf("Cannot have more than one mode action\n");
+                    return false;
+                }
+                else if(states == true){
+                    printf("mode actions should be given before the \"states\" keyword\n");
+                    return false;
+                }
+                else{
+                    modeAction = true;
+                    lineCategorizer->categories[x] = NDR_STATE_MODEACTION;
+                }
+            }
+            else if(strcmp(lowerCaseStringReturn(loweredToken, lineCategorizer->tokens[x], 7), "states:") == 0){
 
                 if(strcmp(firstTokenLowerCase, "accept") == 0){
                     if(literal == true){
@@ -853,24 +1887,54 @@ bool verifyLineTokens(LexerLineCategorizer* lineCategorizer, StateRepresentation
     return true;
 }
 
-int CompareUsingRegex(TokenMatchingState* matchingState, int RSIndex, int RegIndex){
+int CompareUsingCursors(TokenMatchingState* matchingState){
+
+    RegexCursorSet* cursorSet = matchingState->cursorSet;
+    size_t numLiveCursors = 0;
+    int result = 0;
+
+    // Only the cursors that can accept the first character of a token are reset and stepped for it
+    if(cursorSet->tokenStarted == false){
+        unsigned char firstByte = (unsigned char) matchingState->ch;
+        for(size_t x = cursorSet->firstByteOffset[firstByte]; x < cursorSet->firstByteOffset[firstByte + 1]; x++){
+            NDR_ResetRegexCursor(&cursorSet->cursors[cursorSet->firstByteCursors[x]]);
+            cursorSet->liveCursors[numLiveCursors++] = cursorSet->firstByteCursors[x];
+        }
+        cursorSet->numLiveCursors = numLiveCursors;
+        cursorSet->tokenStarted = true;
+        numLiveCursors = 0;
+    }
+
+    // Cursors are stepped in regex state order so the first complete match seen is the best match
+    for(size_t x = 0; x < cursorSet->numLiveCursors; x++){
+        size_t cursor = cursorSet->liveCursors[x];
+        matchingState->matchValue = NDR_RegexStep(&cursorSet->cursors[cursor], matchingState->ch);
+        if(HandleMatchResult(matchingState, cursorSet->RSIndices[cursor], cursorSet->regexStrings[cursor]) != 0)
+            result = 1;
+        if(matchingState->matchValue == NDR_REGEX_PARTIALMATCH || matchingState->matchValue == NDR_REGEX_COMPLETEMATCH)
+            cursorSet->liveCursors[numLiveCursors++] = cursor;
+    }
+    cursorSet->numLiveCursors = numLiveCursors;
+
+    return result;
+}
 
-    matchingState->matchValue = NDR_RSGetMatchResult(NDR_RSGetRegexState(RSWrapper, RSIndex), getMatchToken(matchingState), NDR_STATE_STARTSTATE, RegIndex);
+int HandleMatchResult(TokenMatchingState* matchingState, int RSIndex, char* regexString){
 
     if(matchingState->matchValue == NDR_REGEX_NOMATCH){
         if (NDR_M == true)
-            printf("No match for \"%s\", using regex %s\n", getMatchToken(matchingState), NDR_RSGetStartRegex(NDR_RSGetRegexState(RSWrapper, RSIndex), RegIndex));
+            printf("No match for \"%s\", using regex %s\n", getMatchToken(matchingState), regexString);
     }
     else if(matchingState->matchValue == NDR_REGEX_PARTIALMATCH && matchingState->highestMatchSeen == NDR_COMP_NOMATCH){
         if (NDR_M == true)
-            printf("Partial Match for %s, using regex %s\n", getMatchToken(matchingState), NDR_RSGetStartRegex(NDR_RSGetRegexState(RSWrapper, RSIndex), RegIndex));
+            printf("Partial Match for %s, using regex %s\n", getMatchToken(matchingState), regexString);
 
-        calcBackTrack(matchingState, matchingState->ch);
+        calcBackTrack(matchingState);
         AcknowledgePotentialMatch(matchingState);
     }
     else if (matchingState->matchValue == NDR_REGEX_COMPLETEMATCH){
         if (NDR_M == true)
-            printf("Match success for %s, using regex %s\n", getMatchToken(matchingState), NDR_RSGetStartRegex(NDR_RSGetRegexState(RSWrapper, RSIndex), RegIndex));
+            printf("Match success for %s, using regex %s\n", getMatchToken(matchingState), regexString);
 
         if (IsBestMatch(matchingState, RSIndex) == true)
             SetBestMatchIndex(matchingState, RSIndex);
@@ -879,13 +1943,187 @@ int CompareUsingRegex(TokenMatchingState* matchingState, int RSIndex, int RegInd
         AcknowledgeCompleteMatch(matchingState);
     }
     else if(matchingState->matchValue != NDR_REGEX_PARTIALMATCH){
-        printf("Matching error for \"%s\", using regex %s\n", getMatchToken(matchingState), NDR_RSGetStartRegex(NDR_RSGetRegexState(RSWrapper, RSIndex), RegIndex));
+        printf("Matching error for \"%s\", using regex %s\n", getMatchToken(matchingState), regexString);
         return 1;
     }
 
     return 0;
 }
 
+int CompareUsingDFA(NDR_Context* context, TokenMatchingState* matchingState){
+
+    matchingState->dfaState = NDR_LexerDFAStep(context->lexerDFA, matchingState->dfaState, matchingState->ch);
+
+    if(NDR_LexerDFAGetNumCompleteMatches(context->lexerDFA, matchingState->dfaState) > 0){
+        int RSIndex = NDR_LexerDFAGetAcceptingRule(context->lexerDFA, matchingState->dfaState);
+        if (NDR_M == true)
+            printf("Match success for %s, using keyword %s\n", getMatchToken(matchingState), NDR_RSGetKeyword(NDR_RSGetRegexState(context->RSWrapper, RSIndex)));
+
+        if (IsBestMatch(matchingState, RSIndex) == true)
+            SetBestMatchIndex(matchingState, RSIndex);
+
+        resetBackTrackAmount(matchingState);
+        // Every start regex matched counts as its own complete match as it would when compared one at a time
+        for(size_t x = 0; x < NDR_LexerDFAGetNumCompleteMatches(context->lexerDFA, matchingState->dfaState); x++)
+            AcknowledgeCompleteMatch(matchingState);
+    }
+    else if(matchingState->dfaState != NDR_LEXERDFA_DEADSTATE && matchingState->highestMatchSeen == NDR_COMP_NOMATCH){
+        if (NDR_M == true)
+            printf("Partial Match for %s\n", getMatchToken(matchingState));
+
+        calcBackTrack(matchingState);
+        AcknowledgePotentialMatch(matchingState);
+    }
+    else if(matchingState->dfaState == NDR_LEXERDFA_DEADSTATE && NDR_M == true){
+        printf("No match for \"%s\"\n", getMatchToken(matchingState));
+    }
+
+    return 0;
+}
+
+// The literal trie follows the same match rules as the combined automaton. Once the token has left the trie it is not stepped again
+int CompareUsingTrie(NDR_Context* context, TokenMatchingState* matchingState){
+
+    if(matchingState->trieNode == NDR_LEXERTRIE_DEADNODE)
+        return 0;
+
+    matchingState->trieNode = NDR_LexerTrieStep(context->lexerTrie, matchingState->trieNode, matchingState->ch);
+
+    if(NDR_LexerTrieGetNumCompleteMatches(context->lexerTrie, matchingState->trieNode) > 0){
+        int RSIndex = NDR_LexerTrieGetAcceptingRule(context->lexerTrie, matchingState->trieNode);
+        if (NDR_M == true)
+            printf("Match success for %s, using keyword %s\n", getMatchToken(matchingState), NDR_RSGetKeyword(NDR_RSGetRegexState(context->RSWrapper, RSIndex)));
+
+        if (IsBestMatch(matchingState, RSIndex) == true)
+            SetBestMatchIndex(matchingState, RSIndex);
+
+        resetBackTrackAmount(matchingState);
+        for(size_t x = 0; x < NDR_LexerTrieGetNumCompleteMatches(context->lexerTrie, matchingState->trieNode); x++)
+            AcknowledgeCompleteMatch(matchingState);
+    }
+    else if(matchingState->trieNode != NDR_LEXERTRIE_DEADNODE && matchingState->highestMatchSeen == NDR_COMP_NOMATCH){
+        if (NDR_M == true)
+            printf("Partial Match for %s\n", getMatchToken(matchingState));
+
+        calcBackTrack(matchingState);
+        AcknowledgePotentialMatch(matchingState);
+    }
+
+    return 0;
+}
+
+/*
+Functions to manipulate RegexCursorSet structures
+*/
+
+void InitializeRegexCursorSet(RegexCursorSet* cursorSet){
+    cursorSet->numCursors = 0;
+    cursorSet->memoryAllocated = 10;
+    cursorSet->cursors = malloc(sizeof(NDR_RegexCursor) * cursorSet->memoryAllocated);
+    cursorSet->RSIndices = malloc(sizeof(int) * cursorSet->memoryAllocated);
+    cursorSet->regexStrings = malloc(sizeof(char*) * cursorSet->memoryAllocated);
+    cursorSet->liveCursors = malloc(sizeof(size_t) * cursorSet->memoryAllocated);
+    cursorSet->numLiveCursors = 0;
+    cursorSet->firstByteCursors = NULL;
+    memset(cursorSet->firstByteOffset, 0, sizeof(cursorSet->firstByteOffset));
+    cursorSet->tokenStarted = false;
+}
+
+void AddRegexCursor(RegexCursorSet* cursorSet, NDR_Regex* regex, int RSIndex, char* regexString){
+    if(cursorSet->numCursors >= cursorSet->memoryAllocated){
+        cursorSet->memoryAllocated = cursorSet->memoryAllocated * 2;
+        cursorSet->cursors = realloc(cursorSet->cursors, sizeof(NDR_RegexCursor) * cursorSet->memoryAllocated);
+        cursorSet->RSIndices = realloc(cursorSet->RSIndices, sizeof(int) * cursorSet->memoryAllocated);
+        cursorSet->regexStrings = realloc(cursorSet->regexStrings, sizeof(char*) * cursorSet->memoryAllocated);
+        cursorSet->liveCursors = realloc(cursorSet->liveCursors, sizeof(size_t) * cursorSet->memoryAllocated);
+    }
+    NDR_InitRegexCursor(&cursorSet->cursors[cursorSet->numCursors], regex);
+    cursorSet->RSIndices[cursorSet->numCursors] = RSIndex;
+    cursorSet->regexStrings[cursorSet->numCursors] = regexString;
+    cursorSet->numCursors++;
+}
+
+// Cursors are reset once the first character of the next token shows which of them can match it
+void ResetRegexCursorSet(RegexCursorSet* cursorSet){
+    cursorSet->numLiveCursors = 0;
+    cursorSet->tokenStarted = false;
+}
+
+// Sort the cursors into the byte values they can accept first. Regexes without an NFA program are kept for every byte value
+void BuildFirstByteTable(RegexCursorSet* cursorSet){
+    unsigned char (*firstBytes)[NDR_NFA_CLASSBYTES] = malloc(NDR_NFA_CLASSBYTES * (cursorSet->numCursors + 1));
+    for(size_t x = 0; x < cursorSet->numCursors; x++){
+        NDR_Regex* regex = cursorSet->cursors[x].regex;
+        if(NDR_Regex_IsCompiled(regex) == true && NDR_Regex_GetNFA(regex) != NULL)
+            NDR_NFAGetFirstBytes(NDR_Regex_GetNFA(regex), firstBytes[x]);
+        else
+            memset(firstBytes[x], 0xFF, NDR_NFA_CLASSBYTES);
+    }
+
+    size_t numEntries = 0;
+    for(size_t ch = 0; ch < 256; ch++){
+        cursorSet->firstByteOffset[ch] = numEntries;
+        for(size_t x = 0; x < cursorSet->numCursors; x++)
+            numEntries += NDR_NFA_CLASSHAS(firstBytes[x], ch);
+    }
+    cursorSet->firstByteOffset[256] = numEntries;
+
+    free(cursorSet->firstByteCursors);
+    cursorSet->firstByteCursors = malloc(sizeof(size_t) * (numEntries + 1));
+    numEntries = 0;
+    for(size_t ch = 0; ch < 256; ch++){
+        for(size_t x = 0; x < cursorSet->numCursors; x++){
+            if(NDR_NFA_CLASSHAS(firstBytes[x], ch))
+                cursorSet->firstByteCursors[numEntries++] = x;
+        }
+    }
+
+    free(firstBytes);
+    ResetRegexCursorSet(cursorSet);
+}
+
+void DestroyRegexCursorSet(RegexCursorSet* cursorSet){
+    for(size_t x = 0; x < cursorSet->numCursors; x++)
+        NDR_DestroyRegexCursor(&cursorSet->cursors[x]);
+    free(cursorSet->cursors);
+    free(cursorSet->RSIndices);
+    free(cursorSet->regexStrings);
+    free(cursorSet->liveCursors);
+    free(cursorSet->firstByteCursors);
+}
+
+// Create a cursor for every start regex of the lexer mode "mode" in the symbol table that is not served by the literal trie
+RegexCursorSet* CreateStartCursorSet(NDR_Context* context, int mode){
+    RegexCursorSet* cursorSet = malloc(sizeof(RegexCursorSet));
+    InitializeRegexCursorSet(cursorSet);
+    for(size_t x = 0; x < NDR_RSGetNumberOfStates(context->RSWrapper); x++){
+        NDR_RegexState* regexState = NDR_RSGetRegexState(context->RSWrapper, x);
+        if(NDR_RSIsInMode(regexState, mode) == false)
+            continue;
+        for(size_t i = 0; i < NDR_RSGetNumStartStates(regexState); i++){
+            if(NDR_LexerTrieHoldsRegex(regexState->compiledStartRegex[i]) == false)
+                AddRegexCursor(cursorSet, regexState->compiledStartRegex[i], x, NDR_RSGetStartRegex(regexState, i));
+        }
+    }
+    BuildFirstByteTable(cursorSet);
+    return cursorSet;
+}
+
+// Create a cursor for every end regex of the states sharing the keyword of the state at stateIndex
+RegexCursorSet* CreateEndCursorSet(NDR_Context* context, int stateIndex){
+    RegexCursorSet* cursorSet = malloc(sizeof(RegexCursorSet));
+    InitializeRegexCursorSet(cursorSet);
+    for(size_t x = 0; x < NDR_RSGetNumberOfStates(context->RSWrapper); x++){
+        NDR_RegexState* regexState = NDR_RSGetRegexState(context->RSWrapper, x);
+        if(NDR_RSGetStateFlag(regexState) == true && strcmp(NDR_RSGetKeyword(NDR_RSGetRegexState(context->RSWrapper, stateIndex)), NDR_RSGetKeyword(regexState)) == 0){
+            for(size_t i = 0; i < NDR_RSGetNumEndStates(regexState); i++)
+                AddRegexCursor(cursorSet, regexState->compiledEndRegex[i], x, NDR_RSGetEndRegex(regexState, i));
+        }
+    }
+    BuildFirstByteTable(cursorSet);
+    return cursorSet;
+}
+
 /*
 Tokens to manipulate TokenMatchingState structures
 */
@@ -896,12 +2134,17 @@ void InitializeTokenMatchingState(TokenMatchingState* matchingState){
     matchingState->allocatedLength = 50;
     matchingState->currentToken = malloc(matchingState->allocatedLength);
     strcpy(matchingState->currentToken, "");
+    matchingState->tokenLength = 0;
     matchingState->potentialFinalToken = malloc(matchingState->allocatedLength);
     strcpy(matchingState->potentialFinalToken, "");
 
     matchingState->backtrackAmount = 0;
-    matchingState->numNewLinesSeen = 0;
 
+    matchingState->dfaState = NDR_LEXERDFA_STARTSTATE;
+    matchingState->trieNode = NDR_LEXERTRIE_ROOTNODE;
+    matchingState->startDFAState = NDR_LEXERDFA_STARTSTATE;
+    matchingState->rootTrieNode = NDR_LEXERTRIE_ROOTNODE;
+    matchingState->cursorSet = NULL;
     matchingState->indexOfBestMatch = 0;
     matchingState->completeMatchFound = false;
     matchingState->potentialMatchFound = false;
@@ -918,11 +2161,15 @@ void ResetTokenMatchingState(TokenMatchingState* matchingState){
     matchingState->ch = 0;
 
     strcpy(matchingState->currentToken, "");
+    matchingState->tokenLength = 0;
     strcpy(matchingState->potentialFinalToken, "");
 
     matchingState->backtrackAmount = 0;
-    matchingState->numNewLinesSeen = 0;
 
+    matchingState->dfaState = matchingState->startDFAState;
+    matchingState->trieNode = matchingState->rootTrieNode;
+    if(matchingState->cursorSet != NULL)
+        ResetRegexCursorSet(matchingState->cursorSet);
     matchingState->indexOfBestMatch = 0;
     matchingState->completeMatchFound = false;
     matchingState->potentialMatchFound = false;
@@ -931,12 +2178,16 @@ void ResetTokenMatchingState(TokenMatchingState* matchingState){
 }
 
 void addCharToToken(TokenMatchingState* matchingState, char ch){
-    if(strlen(matchingState->currentToken) > matchingState->allocatedLength - 5){
+    // A NUL byte would end the token string early, so it is not stored
+    if(ch == '\0')
+        return;
+    if(matchingState->tokenLength > matchingState->allocatedLength - 5){
         matchingState->allocatedLength = matchingState->allocatedLength * 2;
         matchingState->currentToken = realloc(matchingState->currentToken, matchingState->allocatedLength);
         matchingState->potentialFinalToken = realloc(matchingState->potentialFinalToken, matchingState->allocatedLength);
     }
-    appendCharToString(matchingState->currentToken, ch);
+    matchingState->currentToken[matchingState->tokenLength++] = ch;
+    matchingState->currentToken[matchingState->tokenLength] = '\0';
 }
 
 void CapturePotentialMatch(TokenMatchingState* matchingState){
@@ -956,12 +2207,24 @@ void SetBestMatchIndex(TokenMatchingState* matchingState, int index){
 }
 
 void addStringToToken(TokenMatchingState* matchingState, char* src){
-    if(strlen(matchingState->currentToken) + strlen(src) > matchingState->allocatedLength - 5){
-        matchingState->allocatedLength = (matchingState->allocatedLength * 2) + strlen(src);
+    addRangeToToken(matchingState, src, strlen(src));
+}
+
+void addRangeToToken(TokenMatchingState* matchingState, const char* src, size_t length){
+    if(matchingState->tokenLength + length > matchingState->allocatedLength - 5){
+        matchingState->allocatedLength = (matchingState->allocatedLength * 2) + length;
         matchingState->currentToken = realloc(matchingState->currentToken, matchingState->allocatedLength);
         matchingState->potentialFinalToken = realloc(matchingState->potentialFinalToken, matchingState->allocatedLength);
     }
-    strcat(matchingState->currentToken, src);
+    memcpy(matchingState->currentToken + matchingState->tokenLength, src, length);
+    matchingState->tokenLength += length;
+    matchingState->currentToken[matchingState->tokenLength] = '\0';
+}
+
+// Drop the last amount characters of the current token
+void truncateToken(TokenMatchingState* matchingState, size_t amount){
+    matchingState->tokenLength -= amount;
+    matchingState->currentToken[matchingState->tokenLength] = '\0';
 }
 
 void AcknowledgePotentialMatch(TokenMatchingState* matchingState){
@@ -991,23 +2254,99 @@ size_t getNumberOfCompleteMatches(TokenMatchingState* matchingState){
     return matchingState->numberOfCompleteMatches;
 }
 
-static void calcBackTrack(TokenMatchingState* matchingState, char ch){
+static void calcBackTrack(TokenMatchingState* matchingState){
     matchingState->backtrackAmount++;
-    if(ch == ((int)'\n'))
-        matchingState->numNewLinesSeen++;
 }
 
 static int getBackTrackAmount(TokenMatchingState* matchingState){
     return matchingState->backtrackAmount;
 }
 
-static int getFileBackTrackAmount(TokenMatchingState* matchingState){
-    return (matchingState->backtrackAmount + (matchingState->numNewLinesSeen * NEWLINEMULTIPLIER));
-}
-
 static void resetBackTrackAmount(TokenMatchingState* matchingState){
     matchingState->backtrackAmount = 0;
-    matchingState->numNewLinesSeen = 0;
+}
+
+void InitializeLexerInput(LexerInput* input, const char* data, size_t len){
+    input->data = data;
+    input->base = 0;
+    input->length = len;
+    input->position = 0;
+    input->limit = len;
+    input->speculative = false;
+    input->furthestPosition = 0;
+    input->read = NULL;
+    input->userData = NULL;
+    input->buffer = NULL;
+    input->bufferSize = 0;
+    input->keepPosition = 0;
+    input->endOfInput = true;
+    input->lineIndex = NULL;
+}
+
+// Read more of a streamed input into its window after dropping the bytes that are no longer needed
+// Returns false once the read callback reports the end of the input
+static bool FillLexerInput(LexerInput* input){
+    if(input->endOfInput == true)
+        return false;
+
+    size_t numDropped = input->keepPosition - input->base;
+    size_t numKept = input->length - input->keepPosition;
+    if(numKept > 0)
+        memmove(input->buffer, input->buffer + numDropped, numKept);
+    input->base = input->keepPosition;
+
+    if(numKept + NDR_LEXSTREAM_READ_SIZE > input->bufferSize){
+        input->bufferSize = (input->bufferSize * 2) + NDR_LEXSTREAM_READ_SIZE;
+        input->buffer = realloc(input->buffer, input->bufferSize);
+    }
+    input->data = input->buffer;
+
+    size_t numRead = input->read(input->buffer + numKept, input->bufferSize - numKept, input->userData);
+    if(numRead == 0){
+        input->endOfInput = true;
+        return false;
+    }
+    if(input->lineIndex != NULL)
+        NDR_LineIndexAddText(input->lineIndex, input->buffer + numKept, numRead);
+    input->length += numRead;
+    return true;
+}
+
+// Returns the next character of the input as an unsigned char converted to an int or EOF once the input is exhausted
+static int readInputChar(LexerInput* input){
+    if(input->position >= input->furthestPosition)
+        input->furthestPosition = input->position + 1;
+    if(input->position >= input->length && FillLexerInput(input) == false)
+        return EOF;
+    return (unsigned char) input->data[input->position++ - input->base];
+}
+
+static int peekInputChar(LexerInput* input){
+    if(input->position >= input->furthestPosition)
+        input->furthestPosition = input->position + 1;
+    if(input->position >= input->length && FillLexerInput(input) == false)
+        return EOF;
+    return (unsigned char) input->data[input->position - input->base];
+}
+
+// A mark is a position of the input that lexing can return to. Marks are only taken inside the current token
+// and the window of a streamed input keeps everything from the start of the current token, so a mark is always still held
+static size_t markInput(LexerInput* input){
+    return input->position;
+}
+
+static void rewindInputToMark(LexerInput* input, size_t mark){
+    input->position = mark;
+}
+
+// Empty the current token so matching starts over from the next character
+static void startNewToken(TokenMatchingState* matchingState){
+    strcpy(getMatchToken(matchingState), "");
+    matchingState->tokenLength = 0;
+    matchingState->dfaState = matchingState->startDFAState;
+    matchingState->trieNode = matchingState->rootTrieNode;
+    if(matchingState->cursorSet != NULL)
+        ResetRegexCursorSet(matchingState->cursorSet);
 }
 
 static void setMatchingChar(TokenMatchingState* matchingState, char ch){
@@ -1045,43 +2384,171 @@ bool ProcessTokensAfterItems(LexerLineCategorizer* lineCategorizer, int index){
     return true;
 }
 
-bool HandleSettings(LexerLineCategorizer* lineCategorizer){
+// Get the mode action given by a token of a rule, either "pop", "push{mode}" or "switch{mode}". Returns NDR_MODE_NONE for any other token
+NDR_ModeAction GetModeAction(char* token){
+    char loweredToken[50];
+    size_t length = strlen(token);
+
+    if(length == 3 && strcmp(lowerCaseStringReturn(loweredToken, token, 3), "pop") == 0)
+        return NDR_MODE_POP;
+    if(length > 6 && token[length - 1] == '}' && strcmp(lowerCaseStringReturn(loweredToken, token, 5), "push{") == 0)
+        return NDR_MODE_PUSH;
+    if(length > 8 && token[length - 1] == '}' && strcmp(lowerCaseStringReturn(loweredToken, token, 7), "switch{") == 0)
+        return NDR_MODE_SWITCH;
+    return NDR_MODE_NONE;
+}
+
+// Give the last regex state the modes, mode action and regex engine found on its line. Every mode named for the first time is added to the symbol table
+// Rules without a list of modes are only matched in the initial mode and "*" gives a rule to every mode
+bool SetRegexStateModes(NDR_Context* context, LexerLineCategorizer* lineCategorizer, uint64_t* namedModes){
+
+    NDR_RegexState* regexState = NDR_RSGetLastRegexState(context->RSWrapper);
+
+    int index = containsCategory(lineCategorizer, NDR_STATE_MODES);
+    if(index != -1){
+        // The names are found between the braces and separated by commas
+        char* modeNames = malloc(strlen(lineCategorizer->tokens[index]) + 1);
+        strcpy(modeNames, lineCategorizer->tokens[index] + 2);
+        modeNames[strlen(modeNames) - 1] = '\0';
+
+        uint64_t modes = 0;
+        for(char* modeName = strtok(modeNames, ","); modeName != NULL; modeName = strtok(NULL, ",")){
+            if(strcmp(modeName, "*") == 0){
+                modes = ~((uint64_t) 0);
+                continue;
+            }
+            int mode = FindOrAddLexerMode(context, modeName);
+            if(mode == -1){
+                free(modeNames);
+                return false;
+            }
+            modes |= (uint64_t) 1 << mode;
+            *namedModes |= (uint64_t) 1 << mode;
+        }
+        free(modeNames);
+
+        if(modes == 0){
+            printf("No name found within mode brackets\n");
+            return false;
+        }
+        NDR_RSSetModes(regexState, modes);
+    }
+
+    index = containsCategory(lineCategorizer, NDR_STATE_MODEACTION);
+    if(index != -1){
+        NDR_ModeAction modeAction = GetModeAction(lineCategorizer->tokens[index]);
+        int mode = 0;
+        if(modeAction != NDR_MODE_POP){
+            char* modeName = malloc(strlen(lineCategorizer->tokens[index]) + 1);
+            strcpy(modeName, strchr(lineCategorizer->tokens[index], '{') + 1);
+            modeName[strlen(modeName) - 1] = '\0';
+            mode = FindOrAddLexerMode(context, modeName);
+            free(modeName);
+            if(mode == -1)
+                return false;
+        }
+        NDR_RSSetModeAction(regexState, modeAction, mode);
+    }
+
+    index = containsCategory(lineCategorizer, NDR_STATE_ENGINE);
+    if(index != -1)
+        NDR_RSSetEngine(regexState, (NDR_RegexEngine) GetRegexEngine(lineCategorizer->tokens[index]));
+
+    return true;
+}
+
+// Get the regex engine given by a token of a rule, either "e{auto}", "e{backtrack}" or "e{pikevm}". Returns -1 for any other token
+int GetRegexEngine(char* token){
+    char loweredToken[50];
+    size_t length = strlen(token);
+
+    if(length == 7 && strcmp(lowerCaseStringReturn(loweredToken, token, 7), "e{auto}") == 0)
+        return NDR_REGEX_ENGINE_AUTO;
+    if(length == 12 && strcmp(lowerCaseStringReturn(loweredToken, token, 12), "e{backtrack}") == 0)
+        return NDR_REGEX_ENGINE_BACKTRACK;
+    if(length == 9 && strcmp(lowerCaseStringReturn(loweredToken, token, 9), "e{pikevm}") == 0)
+        return NDR_REGEX_ENGINE_PIKEVM;
+    return -1;
+}
+
+// Give every regex the engine of its rule, or the engine of the context for rules that do not give one
+// When the context requires the Pike VM no rule may backtrack, so a configuration can never take exponential time to match
+bool ApplyRegexEngines(NDR_Context* context){
+    for(size_t x = 0; x < NDR_RSGetNumberOfStates(context->RSWrapper); x++){
+        NDR_RegexState* regexState = NDR_RSGetRegexState(context->RSWrapper, x);
+        NDR_RegexEngine engine = NDR_RSGetEngine(regexState);
+
+        if(context->regexEngine == NDR_REGEX_ENGINE_PIKEVM && engine == NDR_REGEX_ENGINE_BACKTRACK){
+            printf("\nThe rule for keyword \"%s\" cannot backtrack while the Pike VM is required\n", NDR_RSGetKeyword(regexState));
+            return false;
+        }
+        if(engine == NDR_REGEX_ENGINE_AUTO)
+            engine = context->regexEngine;
+        NDR_RSSetEngine(regexState, engine);
+
+        char* regexString = NDR_SetStateRegexEngine(regexState, engine);
+        if(regexString != NULL){
+            // The backtracker is refused for every regex the Pike VM can match, so it is only left for the rare regexes that cannot be converted
+            printf("\nThe regex \"%s\" for keyword \"%s\" cannot be matched by the %s\n", regexString, NDR_RSGetKeyword(regexState),
+                   (engine == NDR_REGEX_ENGINE_BACKTRACK) ? "backtracking matcher, use e{auto} or e{pikevm}" : "Pike VM");
+            return false;
+        }
+    }
+    return true;
+}
+
+int FindOrAddLexerMode(NDR_Context* context, char* modeName){
+    int mode = NDR_RSFindMode(context->RSWrapper, modeName);
+    if(mode != -1)
+        return mode;
+
+    if(strcmp(modeName, "") == 0 || strchr(modeName, '{') != NULL || strchr(modeName, '}') != NULL){
+        printf("\"%s\" is not a valid mode name\n", modeName);
+        return -1;
+    }
+    mode = NDR_RSAddMode(context->RSWrapper, modeName);
+    if(mode == -1)
+        printf("No more than %i lexer modes can be used\n", NDR_RS_MAXMODES);
+    return mode;
+}
+
+bool HandleSettings(NDR_Context* context, LexerLineCategorizer* lineCategorizer){
 
     bool isSetting = false;
 
     if(strcmp(lineCategorizer->tokens[0], "AUTO_CAP_ON") == 0){
-        AUTO_CAP = true;
+        context->autoCap = true;
         isSetting = true;
     }
     else if(strcmp(lineCategorizer->tokens[0], "AUTO_TRIM_ON") == 0){
-        AUTO_TRIM = true;
+        context->autoTrim = true;
         isSetting = true;
     }
     else if(strcmp(lineCategorizer->tokens[0], "MATCH_ALL_ON") == 0){
-        MATCH_ALL = true;
+        context->matchAll = true;
         isSetting = true;
     }
     else if(strcmp(lineCategorizer->tokens[0], "AUTO_CAP_OFF") == 0){
-        AUTO_CAP = false;
+        context->autoCap = false;
         isSetting = true;
     }
     else if(strcmp(lineCategorizer->tokens[0], "AUTO_TRIM_OFF") == 0){
-        AUTO_TRIM = false;
+        context->autoTrim = false;
         isSetting = true;
     }
     else if(strcmp(lineCategorizer->tokens[0], "MATCH_ALL_OFF") == 0){
-        MATCH_ALL = false;
+        context->matchAll = false;
         isSetting = true;
     }
 
     return isSetting;
 }
 
-bool IsOneTimeSettingSeen(LexerLineCategorizer* lineCategorizer){
+bool IsOneTimeSettingSeen(NDR_Context* context, LexerLineCategorizer* lineCategorizer){
 
     if(strcmp(lineCategorizer->tokens[0], "MATCH_ALL_ON") == 0 || strcmp(lineCategorizer->tokens[0], "MATCH_ALL_OFF") == 0){
-        if(MATCH_ALL_isSeen != true)
-            MATCH_ALL_isSeen = true;
+        if(context->matchAllSeen != true)
+            context->matchAllSeen = true;
         else
             return true;
     }
@@ -1132,12 +2599,16 @@ int ExtractRegexStrings(char* regex, char** extractedStrings){
 }
 
 
-bool doesCharMatchAllowRegex(int stateIndex, char* comparisonString){
+bool doesCharMatchAllowRegex(NDR_Context* context, int stateIndex, char* comparisonString){
     int matchValue;
-    for(size_t x = 0; x < NDR_RSGetNumberOfStates(RSWrapper); x++){
-        if(strcmp(NDR_RSGetKeyword(NDR_RSGetRegexState(RSWrapper, stateIndex)), NDR_RSGetKeyword(NDR_RSGetRegexState(RSWrapper, x))) == 0){
-            for(size_t i = 0; i < NDR_RSGetNumAllowStates(NDR_RSGetRegexState(RSWrapper, stateIndex)); i++){
-                matchValue = NDR_RSGetMatchResult(NDR_RSGetRegexState(RSWrapper, x), comparisonString, NDR_STATE_ALLOWSTATE, i);
+    for(size_t x = 0; x < NDR_RSGetNumberOfStates(context->RSWrapper); x++){
+        if(strcmp(NDR_RSGetKeyword(NDR_RSGetRegexState(context->RSWrapper, stateIndex)), NDR_RSGetKeyword(NDR_RSGetRegexState(context->RSWrapper, x))) == 0){
+            // Only the regex indices present in both states are compared
+            for(size_t i = 0; i < NDR_RSGetNumAllowStates(NDR_RSGetRegexState(context->RSWrapper, stateIndex)) && i < NDR_RSGetNumAllowStates(NDR_RSGetRegexState(context->RSWrapper, x)); i++){
+                // Regexes that failed to compile can never match and would only report that for every character
+                if(NDR_Regex_IsCompiled(NDR_RSGetRegexState(context->RSWrapper, x)->compiledAllowRegex[i]) == false)
+                    continue;
+                matchValue = NDR_RSGetMatchResult(NDR_RSGetRegexState(context->RSWrapper, x), comparisonString, NDR_STATE_ALLOWSTATE, i);
                 if(matchValue == NDR_REGEX_COMPLETEMATCH){
                     return true;
                 }
@@ -1147,12 +2618,16 @@ bool doesCharMatchAllowRegex(int stateIndex, char* comparisonString){
     return false;
 }
 
-bool doesCharMatchEscapeRegex(int stateIndex, char* comparisonString){
+bool doesCharMatchEscapeRegex(NDR_Context* context, int stateIndex, char* comparisonString){
     int matchValue;
-    for(size_t x = 0; x < NDR_RSGetNumberOfStates(RSWrapper); x++){
-        if(strcmp(NDR_RSGetKeyword(NDR_RSGetRegexState(RSWrapper, stateIndex)), NDR_RSGetKeyword(NDR_RSGetRegexState(RSWrapper, x))) == 0){
-            for(size_t i = 0; i < NDR_RSGetNumEscapeStates(NDR_RSGetRegexState(RSWrapper, stateIndex)); i++){
-                matchValue = NDR_RSGetMatchResult(NDR_RSGetRegexState(RSWrapper, x), comparisonString, NDR_STATE_ESCAPESTATE, i);
+    for(size_t x = 0; x < NDR_RSGetNumberOfStates(context->RSWrapper); x++){
+        if(strcmp(NDR_RSGetKeyword(NDR_RSGetRegexState(context->RSWrapper, stateIndex)), NDR_RSGetKeyword(NDR_RSGetRegexState(context->RSWrapper, x))) == 0){
+            // Only the regex indices present in both states are compared
+            for(size_t i = 0; i < NDR_RSGetNumEscapeStates(NDR_RSGetRegexState(context->RSWrapper, stateIndex)) && i < NDR_RSGetNumEscapeStates(NDR_RSGetRegexState(context->RSWrapper, x)); i++){
+                // Regexes that failed to compile can never match and would only report that for every character
+                if(NDR_Regex_IsCompiled(NDR_RSGetRegexState(context->RSWrapper, x)->compiledEscapeRegex[i]) == false)
+                    continue;
+                matchValue = NDR_RSGetMatchResult(NDR_RSGetRegexState(context->RSWrapper, x), comparisonString, NDR_STATE_ESCAPESTATE, i);
                 if(matchValue == NDR_REGEX_COMPLETEMATCH){
                     return true;
                 }
@@ -1162,19 +2637,84 @@ bool doesCharMatchEscapeRegex(int stateIndex, char* comparisonString){
     return false;
 }
 
+// Match every byte value as a one character string against the allow and escape regexes of each state
+// Bytes that also cannot begin an end regex of the states sharing the keyword are plain. The null byte is never plain
+void BuildStateByteTables(NDR_Context* context){
+    char sString[2];
+    sString[1] = '\0';
+    unsigned char endFirstBytes[NDR_NFA_CLASSBYTES];
+    unsigned char regexFirstBytes[NDR_NFA_CLASSBYTES];
+
+    for(size_t x = 0; x < NDR_RSGetNumberOfStates(context->RSWrapper); x++){
+        NDR_RegexState* regexState = NDR_RSGetRegexState(context->RSWrapper, x);
+        if(NDR_RSGetStateFlag(regexState) == false)
+            continue;
+        for(int ch = 0; ch < 256; ch++){
+            sString[0] = (char) ch;
+            NDR_RSSetAllowedByte(regexState, (char) ch, doesCharMatchAllowRegex(context, x, sString));
+            NDR_RSSetEscapedByte(regexState, (char) ch, doesCharMatchEscapeRegex(context, x, sString));
+        }
 
-void updatefilePosition(int* lineNumber, int* columnNumber, char* token){
-    int x = lastOccurrence(token, '\n', strlen(token));
-    if(x != -1){
-        for(size_t z = 0; z < strlen(token); z++){
-            if(token[z] == '\n')
-                (*lineNumber)++;
+        memset(endFirstBytes, 0, NDR_NFA_CLASSBYTES);
+        for(size_t i = 0; i < NDR_RSGetNumberOfStates(context->RSWrapper); i++){
+            NDR_RegexState* sibling = NDR_RSGetRegexState(context->RSWrapper, i);
+            if(NDR_RSGetStateFlag(sibling) == false || strcmp(NDR_RSGetKeyword(regexState), NDR_RSGetKeyword(sibling)) != 0)
+                continue;
+            for(size_t j = 0; j < NDR_RSGetNumEndStates(sibling); j++){
+                NDR_Regex* regex = sibling->compiledEndRegex[j];
+                if(NDR_Regex_IsCompiled(regex) == true && NDR_Regex_GetNFA(regex) != NULL)
+                    NDR_NFAGetFirstBytes(NDR_Regex_GetNFA(regex), regexFirstBytes);
+                else
+                    memset(regexFirstBytes, 0xFF, NDR_NFA_CLASSBYTES);
+                for(size_t k = 0; k < NDR_NFA_CLASSBYTES; k++)
+                    endFirstBytes[k] |= regexFirstBytes[k];
+            }
         }
-        *columnNumber = strlen(token) - (x - 1);
+
+        size_t numStopBytes = 0;
+        NDR_RSClearStopBytes(regexState);
+        for(int ch = 0; ch < 256; ch++){
+            bool plain = (ch != 0 && NDR_RSIsAllowedByte(regexState, (char) ch) == true && NDR_RSIsEscapedByte(regexState, (char) ch) == false && NDR_NFA_CLASSHAS(endFirstBytes, ch) == 0);
+            NDR_RSSetPlainByte(regexState, (char) ch, plain);
+            if(plain == false){
+                NDR_RSAddStopByte(regexState, (char) ch);
+                numStopBytes++;
+            }
+        }
+        if(numStopBytes > NDR_RS_MAXSTOPBYTES)
+            NDR_RSClearStopBytes(regexState);
     }
-    else{
-        *columnNumber += strlen(token);
+}
+
+// Find where the run of plain bytes starting at the current position ends within the data read so far
+// A state with few stop bytes is searched with memchr, remembering each result so the same text is never searched twice
+size_t FindPlainBytesEnd(LexerInput* input, NDR_RegexState* regexState, StopByteSearch* searches){
+    size_t position = input->position;
+    size_t dataEnd = input->length;
+    if(position >= dataEnd)
+        return position;
+
+    if(NDR_RSGetNumStopBytes(regexState) == 0){
+        while(position < dataEnd && NDR_RSIsPlainByte(regexState, input->data[position - input->base]) == true)
+            position++;
+        return position;
+    }
+
+    size_t plainEnd = dataEnd;
+    for(size_t x = 0; x < NDR_RSGetNumStopBytes(regexState); x++){
+        unsigned char stopByte = (unsigned char) NDR_RSGetStopByte(regexState, x);
+        StopByteSearch* search = &searches[stopByte];
+        bool known = (search->from <= position && position <= search->found && (search->found < search->searchedTo || search->searchedTo == dataEnd));
+        if(known == false){
+            const char* found = memchr(input->data + (position - input->base), stopByte, dataEnd - position);
+            search->from = position;
+            search->searchedTo = dataEnd;
+            search->found = (found == NULL) ? dataEnd : input->base + (size_t) (found - input->data);
+        }
+        if(search->found < plainEnd)
+            plainEnd = search->found;
     }
+    return plainEnd;
 }
 
 
@@ -1264,9 +2804,9 @@ void removeEscaped(char* string){
     }
 }
 
-char* lowerCaseStringReturn(char* arr, size_t neededLength){
+// lowered must hold at least neededLength + 1 characters. The longest length needed is 7 for "literal" and "states:" and so on at the moment
+char* lowerCaseStringReturn(char* lowered, char* arr, size_t neededLength){
     char answer[50];
-    static char lowered[50]; // The longest length needed is 7 for "literal" and "states:" and so on at the moment
     int intUsed;
     if(neededLength < strlen(arr))
         intUsed = neededLength;
@@ -1344,44 +2884,50 @@ void encapsulateString(const char* prepend, char* string, const char* append){
     free(strcatString);
 }
 
-void appendCharToString(char* dest, char src){
-    int length = strlen(dest);
-    dest[length] = (char) src;
-    dest[length+1] = '\0';
+void NDR_PrintSymbolTable(){
+    NDR_Context_PrintSymbolTable(NDR_GetDefaultContext());
+}
+
+void NDR_PrintTokenTable(){
+    NDR_Context_PrintTokenTable(NDR_GetDefaultContext());
+}
+
+void NDR_PrintTokenTableLocations(){
+    NDR_Context_PrintTokenTableLocations(NDR_GetDefaultContext());
 }
 
 // printSymbolTable prints each part of the symbol table
-void NDR_PrintSymbolTable(){
+void NDR_Context_PrintSymbolTable(NDR_Context* context){
     printf("\n\n************** Symbols ****************\n\n");
 
-    for(size_t i = 0; i < NDR_RSGetNumberOfStates(RSWrapper); i++){
+    for(size_t i = 0; i < NDR_RSGetNumberOfStates(context->RSWrapper); i++){
 
-        for(size_t x = 0; x < NDR_RSGetNumStartStates(NDR_RSGetRegexState(RSWrapper, i)); x++){
-            printf("%s ", NDR_RSGetKeyword(NDR_RSGetRegexState(RSWrapper, i)));
-            printf("%i ", NDR_RSGetCategory(NDR_RSGetRegexState(RSWrapper, i)));
-            printf("%i ", NDR_RSGetLiteralFlag(NDR_RSGetRegexState(RSWrapper, i)));
-            printf("%s ", NDR_RSGetStartRegex(NDR_RSGetRegexState(RSWrapper, i), x));
+        for(size_t x = 0; x < NDR_RSGetNumStartStates(NDR_RSGetRegexState(context->RSWrapper, i)); x++){
+            printf("%s ", NDR_RSGetKeyword(NDR_RSGetRegexState(context->RSWrapper, i)));
+            printf("%i ", NDR_RSGetCategory(NDR_RSGetRegexState(context->RSWrapper, i)));
+            printf("%i ", NDR_RSGetLiteralFlag(NDR_RSGetRegexState(context->RSWrapper, i)));
+            printf("%s ", NDR_RSGetStartRegex(NDR_RSGetRegexState(context->RSWrapper, i), x));
             printf("\n");
         }
-        for(size_t x = 0; x < NDR_RSGetNumAllowStates(NDR_RSGetRegexState(RSWrapper, i)); x++){
-            printf("%s ", NDR_RSGetKeyword(NDR_RSGetRegexState(RSWrapper, i)));
-            printf("%i ", NDR_RSGetCategory(NDR_RSGetRegexState(RSWrapper, i)));
-            printf("%i ", NDR_RSGetLiteralFlag(NDR_RSGetRegexState(RSWrapper, i)));
-            printf("%s ", NDR_RSGetAllowRegex(NDR_RSGetRegexState(RSWrapper, i), x));
+        for(size_t x = 0; x < NDR_RSGetNumAllowStates(NDR_RSGetRegexState(context->RSWrapper, i)); x++){
+            printf("%s ", NDR_RSGetKeyword(NDR_RSGetRegexState(context->RSWrapper, i)));
+            printf("%i ", NDR_RSGetCategory(NDR_RSGetRegexState(context->RSWrapper, i)));
+            printf("%i ", NDR_RSGetLiteralFlag(NDR_RSGetRegexState(context->RSWrapper, i)));
+            printf("%s ", NDR_RSGetAllowRegex(NDR_RSGetRegexState(context->RSWrapper, i), x));
             printf("\n");
         }
-        for(size_t x = 0; x < NDR_RSGetNumEscapeStates(NDR_RSGetRegexState(RSWrapper, i)); x++){
-            printf("%s ", NDR_RSGetKeyword(NDR_RSGetRegexState(RSWrapper, i)));
-            printf("%i ", NDR_RSGetCategory(NDR_RSGetRegexState(RSWrapper, i)));
-            printf("%i ", NDR_RSGetLiteralFlag(NDR_RSGetRegexState(RSWrapper, i)));
-            printf("%s ", NDR_RSGetEscapeRegex(NDR_RSGetRegexState(RSWrapper, i), x));
+        for(size_t x = 0; x < NDR_RSGetNumEscapeStates(NDR_RSGetRegexState(context->RSWrapper, i)); x++){
+            printf("%s ", NDR_RSGetKeyword(NDR_RSGetRegexState(context->RSWrapper, i)));
+            printf("%i ", NDR_RSGetCategory(NDR_RSGetRegexState(context->RSWrapper, i)));
+            printf("%i ", NDR_RSGetLiteralFlag(NDR_RSGetRegexState(context->RSWrapper, i)));
+            printf("%s ", NDR_RSGetEscapeRegex(NDR_RSGetRegexState(context->RSWrapper, i), x));
             printf("\n");
         }
-        for(size_t x = 0; x < NDR_RSGetNumEndStates(NDR_RSGetRegexState(RSWrapper, i)); x++){
-            printf("%s ", NDR_RSGetKeyword(NDR_RSGetRegexState(RSWrapper, i)));
-            printf("%i ", NDR_RSGetCategory(NDR_RSGetRegexState(RSWrapper, i)));
-            printf("%i ", NDR_RSGetLiteralFlag(NDR_RSGetRegexState(RSWrapper, i)));
-            printf("%s ", NDR_RSGetEndRegex(NDR_RSGetRegexState(RSWrapper, i), x));
+        for(size_t x = 0; x < NDR_RSGetNumEndStates(NDR_RSGetRegexState(context->RSWrapper, i)); x++){
+            printf("%s ", NDR_RSGetKeyword(NDR_RSGetRegexState(context->RSWrapper, i)));
+            printf("%i ", NDR_RSGetCategory(NDR_RSGetRegexState(context->RSWrapper, i)));
+            printf("%i ", NDR_RSGetLiteralFlag(NDR_RSGetRegexState(context->RSWrapper, i)));
+            printf("%s ", NDR_RSGetEndRegex(NDR_RSGetRegexState(context->RSWrapper, i), x));
             printf("\n");
         }
         printf("\n");
@@ -1389,20 +2935,20 @@ void NDR_PrintSymbolTable(){
 }
 
 // printTokenTable prints each part of the token table
-void NDR_PrintTokenTable(){
+void NDR_Context_PrintTokenTable(NDR_Context* context){
 
     printf("\n\n************** Tokens ****************\n\n");
 
-    for(size_t i = 0; i < NDR_TIGetNumberOfTokens(TIWrapper); i++){
-        printf("%s  ---  %s\n", NDR_TIGetTokenInfo(TIWrapper, i)->token, NDR_TIGetTokenInfo(TIWrapper, i)->keyword);
+    for(size_t i = 0; i < NDR_TIGetNumberOfTokens(context->TIWrapper); i++){
+        printf("%s  ---  %s\n", NDR_TIGetTokenInfo(context->TIWrapper, i)->token, NDR_TIGetTokenInfo(context->TIWrapper, i)->keyword);
     }
 }
 
-void NDR_PrintTokenTableLocations(){
+void NDR_Context_PrintTokenTableLocations(NDR_Context* context){
 
     printf("\n\n************** Token Locations ****************\n\n");
 
-    for(size_t i = 0; i < NDR_TIGetNumberOfTokens(TIWrapper); i++){
-        printf("%s: line - %u  --- column - %u\n", NDR_TIGetTokenInfo(TIWrapper, i)->token, (unsigned int) NDR_TIGetTokenInfo(TIWrapper, i)->lineNumber, (unsigned int) NDR_TIGetTokenInfo(TIWrapper, i)->columnNumber);
+    for(size_t i = 0; i < NDR_TIGetNumberOfTokens(context->TIWrapper); i++){
+        printf("%s: line - %u  --- column - %u\n", NDR_TIGetTokenInfo(context->TIWrapper, i)->token, (unsigned int) NDR_GetTokenInfoLine(NDR_TIGetTokenInfo(context->TIWrapper, i)), (unsigned int) NDR_GetTokenInfoColumn(NDR_TIGetTokenInfo(context->TIWrapper, i)));
     }
 }
@@ -37,6 +37,12 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef NDRLEXER_H
 #define NDRLEXER_H
 
+#include <stddef.h>
+#include <stdio.h>
+
+#include "ndr_context.h"
+#include "ndr_tokenstore.h"
+
 /** @brief Configure the lexer based on a text input file so that the lexer is aware of the allowed tokens
 * 
 * @param fileName in the name of a text file filled with allowd tokens
@@ -49,6 +55,162 @@ int NDR_Configure_Lexer(char* fileName);
 * @return The success status of the function. 0 for success and non-zero for error
 */
 int NDR_Lex(char* fileName);
+/** @brief Compare the tokens configured in function NDR_Configure_Lexer with the text found in a provided buffer
+*
+* @param data is the text that is to be processed. It does not need to be null terminated
+* @param len is the number of bytes of text found in data
+* @return The success status of the function. 0 for success and non-zero for error
+*/
+int NDR_LexBuffer(const char* data, size_t len);
+/** @brief Compare the tokens configured in function NDR_Configure_Lexer with the text read from an open file
+*
+* The file is read as lexing goes and is never rewound, so pipes and stdin can be lexed
+* @param file is an open file positioned at the start of the text that is to be processed
+* @return The success status of the function. 0 for success and non-zero for error
+*/
+int NDR_LexFile(FILE* file);
+/** @brief Compare the tokens configured in function NDR_Configure_Lexer with the text found in a provided buffer and keep the tokens in a compact store
+*
+* The token table used by the parser is not changed, so any number of buffers can be lexed into stores with one configuration
+* @param data is the text that is to be processed. The token text held by the store refers to it so it must outlive the store
+* @param len is the number of bytes of text found in data
+* @param store is an initialized NDR_TokenStore structure, the tokens it held before are removed
+* @return The success status of the function. 0 for success and non-zero for error
+*/
+int NDR_LexBufferToStore(const char* data, size_t len, NDR_TokenStore* store);
+
+/** @brief Configure the lexer of the provided context based on a text input file so that the lexer is aware of the allowed tokens
+*
+* @param context is an initialized NDR_Context structure that has not been used for lexer configuration yet
+* @param fileName in the name of a text file filled with allowd tokens
+* @return The success status of the function. 0 for success and non-zero for error
+*/
+int NDR_Context_Configure_Lexer(NDR_Context* context, char* fileName);
+/** @brief Compare the tokens configured in function NDR_Context_Configure_Lexer with the text found in a provided code file
+*
+* @param context is an NDR_Context structure that has been configured for lexing
+* @param fileName is the name of a provided code file that is to be processed
+* @return The success status of the function. 0 for success and non-zero for error
+*/
+int NDR_Context_Lex(NDR_Context* context, char* fileName);
+/** @brief Compare the tokens configured in function NDR_Context_Configure_Lexer with the text found in a provided buffer
+*
+* @param context is an NDR_Context structure that has been configured for lexing
+* @param data is the text that is to be processed. It does not need to be null terminated
+* @param len is the number of bytes of text found in data
+* @return The success status of the function. 0 for success and non-zero for error
+*/
+int NDR_Context_LexBuffer(NDR_Context* context, const char* data, size_t len);
+/** @brief Compare the tokens configured in function NDR_Context_Configure_Lexer with the text read from an open file
+*
+* @param context is an NDR_Context structure that has been configured for lexing
+* @param file is an open file positioned at the start of the text that is to be processed
+* @return The success status of the function. 0 for success and non-zero for error
+*/
+int NDR_Context_LexFile(NDR_Context* context, FILE* file);
+/** @brief Compare the tokens configured in function NDR_Context_Configure_Lexer with the text found in a provided buffer and keep the tokens in a compact store
+*
+* @param context is an NDR_Context structure that has been configured for lexing
+* @param data is the text that is to be processed. The token text held by the store refers to it so it must outlive the store
+* @param len is the number of bytes of text found in data
+* @param store is an initialized NDR_TokenStore structure, the tokens it held before are removed
+* @return The success status of the function. 0 for success and non-zero for error
+*/
+int NDR_Context_LexBufferToStore(NDR_Context* context, const char* data, size_t len, NDR_TokenStore* store);
+/** @brief A function that provides the text of a streamed input
+*
+* @param buffer is where the text is to be written
+* @param size is the largest number of bytes that can be written to buffer
+* @param userData is the pointer provided when creating the stream
+* @return The number of bytes written to buffer, or 0 once the input is exhausted
+*/
+typedef size_t (*NDR_ReadCallback)(char* buffer, size_t size, void* userData);
+/**
+* @struct NDR_LexStream
+* @brief A lexer that finds one token at a time from an input provided by an NDR_ReadCallback
+*
+* Only the text from the start of the token being matched onwards is held, so memory does not grow with the size of the input
+*/
+typedef struct NDR_LexStream NDR_LexStream;
+
+/** @brief Create a stream that lexes the text provided by a read function with the configuration of the default context, see NDR_Context_CreateLexStream */
+NDR_LexStream* NDR_CreateLexStream(NDR_ReadCallback read, void* userData);
+/** @brief Create a stream that lexes the text provided by a read function with the configuration of the provided context
+*
+* The stream does not change the token table of the context so several streams can share one context
+*
+* @param context is an NDR_Context structure that has been configured for lexing
+* @param read is called whenever more of the input is needed
+* @param userData is passed to every call of read
+* @return A stream to be passed to NDR_NextToken and freed with NDR_DestroyLexStream, or NULL on error
+*/
+NDR_LexStream* NDR_Context_CreateLexStream(NDR_Context* context, NDR_ReadCallback read, void* userData);
+/** @brief Lex the next accepted token of a stream
+*
+* @param stream is a stream created by NDR_Context_CreateLexStream
+* @return The next token which is valid until the next call with the same stream, or NULL once the input is exhausted or an error is found
+*/
+NDR_TokenInformation* NDR_NextToken(NDR_LexStream* stream);
+/** @brief Get the status of a stream
+*
+* @param stream is a stream created by NDR_Context_CreateLexStream
+* @return 0 if no error has been found and non-zero otherwise
+*/
+int NDR_GetLexStreamResult(NDR_LexStream* stream);
+/** @brief Free the memory of a stream
+*
+* @param stream is a stream created by NDR_Context_CreateLexStream
+*/
+void NDR_DestroyLexStream(NDR_LexStream* stream);
+
+/** @brief Update the token table of the default context after an edit to the input of its last lexical analysis, see NDR_Context_LexEdit */
+int NDR_LexEdit(const char* data, size_t len, size_t offset, size_t removedLength, size_t insertedLength);
+/** @brief Update the token table of the provided context after an edit to the input of its last lexical analysis
+*
+* Only the text from the first token that read the edited text up to the point where the tokens found match the previous tokens again is lexed.
+* The tokens after that point are kept with their positions moved by the edit. The syntax tree of the previous input is discarded.
+* If lexing the edit fails the input has to be reset and lexed again as a whole
+*
+* @param context is an NDR_Context structure whose last lexical analysis completed
+* @param data is the whole input after the edit. It does not need to be null terminated
+* @param len is the number of bytes of text found in data
+* @param offset is the position in the input where the edit starts
+* @param removedLength is the number of bytes of the previous input removed at offset
+* @param insertedLength is the number of bytes inserted at offset, found in data starting at offset
+* @return The success status of the function. 0 for success and non-zero for error
+*/
+int NDR_Context_LexEdit(NDR_Context* context, const char* data, size_t len, size_t offset, size_t removedLength, size_t insertedLength);
+
+/** @brief Set the number of threads used to lex a single input
+*
+* Inputs of at least a megabyte per thread are split into chunks that are lexed at the same time and joined into one token table.
+* The token table is the same as the one found when lexing on a single thread
+*
+* @param threads is the largest number of threads to use, 1 to always lex on the calling thread, or 0 to use one for every online processor
+*/
+void NDR_SetLexThreads(int threads);
+/** @brief Set the number of threads used to lex a single input with the provided context, see NDR_SetLexThreads
+*
+* @param context is an initialized NDR_Context structure
+* @param threads is the largest number of threads to use, 1 to always lex on the calling thread, or 0 to use one for every online processor
+*/
+void NDR_Context_SetLexThreads(NDR_Context* context, int threads);
+/** @brief Set how the regexes of the lexer configuration are matched when their rules do not give a regex engine
+*
+* A rule gives its own engine with "e{auto}", "e{backtrack}" or "e{pikevm}". With NDR_REGEX_ENGINE_PIKEVM every rule must use the Pike VM,
+* so configuring fails for rules that give "e{backtrack}" or whose regexes cannot be converted into NFA programs and no configuration can make matching take exponential time.
+* Rules using NDR_REGEX_ENGINE_BACKTRACK fail to configure when their regexes have NFA programs, see NDR_RegexEngine.
+* The engine must be set before the lexer is configured
+*
+* @param engine is the regex engine, NDR_REGEX_ENGINE_AUTO by default
+*/
+void NDR_SetRegexEngine(NDR_RegexEngine engine);
+/** @brief Set how the regexes of the lexer configuration are matched with the provided context, see NDR_SetRegexEngine
+*
+* @param context is an initialized NDR_Context structure
+* @param engine is the regex engine, NDR_REGEX_ENGINE_AUTO by default
+*/
+void NDR_Context_SetRegexEngine(NDR_Context* context, NDR_RegexEngine engine);
 
 /** @brief Print all of the tokens and associated regex found during parsing */
 void NDR_PrintSymbolTable();
@@ -57,4 +219,11 @@ void NDR_PrintTokenTable();
 /** @brief Print all of the toekn locations of tokens found during parsing */
 void NDR_PrintTokenTableLocations();
 
+/** @brief Print all of the tokens and associated regex held by the provided context */
+void NDR_Context_PrintSymbolTable(NDR_Context* context);
+/** @brief Print all of the tokens and associated keywords found during lexing with the provided context */
+void NDR_Context_PrintTokenTable(NDR_Context* context);
+/** @brief Print all of the token locations of tokens found during lexing with the provided context */
+void NDR_Context_PrintTokenTableLocations(NDR_Context* context);
+
 #endif
@@ -0,0 +1,439 @@
+
+/*********************************************************************************
+*                                 NDR Lexer DFA                                  *
+**********************************************************************************/
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Neil Runcie
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "ndr_lexerdfa.h"
+#include "ndr_lexertrie.h"
+#include "ndr_regexstate.h"
+#include "regex_engines/ndr_regex.h"
+#include "regex_engines/ndr_regexnfa.h"
+
+// Number of slots within the hash table used to find previously built states. Must be a power of two larger than the state limit
+#define NDR_LEXERDFA_HASHSIZE (NDR_LEXERDFA_MAXSTATES * 2)
+
+// Declaration of a single start regex NFA program taking part in the automaton
+typedef struct DFAProgram {
+    NDR_RegexNFA* nfa;
+    // rule is the regex state index the program belongs to
+    int rule;
+    // modes holds the lexer modes the program is matched in
+    uint64_t modes;
+    // offset is the first thread number used by the program's instructions
+    size_t offset;
+} DFAProgram;
+
+// Declaration of the state kept during the subset construction
+typedef struct DFABuilder {
+    DFAProgram* programs;
+    size_t numPrograms;
+    size_t numThreads;
+    // threadProgram maps every thread number back to its program
+    size_t* threadProgram;
+
+    // Every automaton state is a sorted set of threads stored contiguously within setData
+    size_t* setData;
+    size_t setDataLength;
+    size_t setDataAllocated;
+    size_t* setOffset;
+    size_t* setLength;
+    size_t setsAllocated;
+
+    size_t* hashTable;
+
+    // Scratch memory used while following the empty transitions of a set of threads
+    size_t* mark;
+    size_t generation;
+    size_t* stack;
+    size_t* work;
+    size_t workLength;
+} DFABuilder;
+
+static int CollectPrograms(DFABuilder* builder, NDR_Regex** regexes, int* rules, uint64_t* modes, size_t numRegexes);
+static void ComputeByteClasses(NDR_LexerDFA* dfa, DFABuilder* builder);
+static void AddThread(DFABuilder* builder, size_t thread);
+static size_t FindOrAddState(NDR_LexerDFA* dfa, DFABuilder* builder);
+static void AddDFAState(NDR_LexerDFA* dfa);
+static int CompareThreads(const void* first, const void* second);
+static void DestroyDFABuilder(DFABuilder* builder);
+
+
+void NDR_InitLexerDFA(NDR_LexerDFA* dfa){
+    dfa->numStates = 0;
+    dfa->memoryAllocated = 0;
+    dfa->numByteClasses = 0;
+    memset(dfa->byteClasses, 0, sizeof(dfa->byteClasses));
+    dfa->transitions = NULL;
+    dfa->acceptingRule = NULL;
+    dfa->numCompleteMatches = NULL;
+    dfa->numModes = 0;
+    dfa->startStates = NULL;
+    dfa->ownsTables = true;
+}
+
+void NDR_FreeLexerDFA(NDR_LexerDFA* dfa){
+    if(dfa->ownsTables == true){
+        free(dfa->transitions);
+        free(dfa->acceptingRule);
+        free(dfa->numCompleteMatches);
+        free(dfa->startStates);
+    }
+    NDR_InitLexerDFA(dfa);
+}
+
+size_t NDR_LexerDFAStep(NDR_LexerDFA* dfa, size_t state, char ch){
+    return dfa->transitions[(state * dfa->numByteClasses) + dfa->byteClasses[(unsigned char) ch]];
+}
+
+int NDR_LexerDFAGetAcceptingRule(NDR_LexerDFA* dfa, size_t state){
+    return dfa->acceptingRule[state];
+}
+
+size_t NDR_LexerDFAGetNumCompleteMatches(NDR_LexerDFA* dfa, size_t state){
+    return dfa->numCompleteMatches[state];
+}
+
+size_t NDR_LexerDFAGetStartState(NDR_LexerDFA* dfa, int mode){
+    return dfa->startStates[mode];
+}
+
+// Gather every start regex that is not served by the literal trie and combine them
+int NDR_BuildLexerDFA(NDR_LexerDFA* dfa, NDR_RegexStateWrapper* regexStateWrapper){
+
+    size_t numRegexes = 0;
+    size_t memoryAllocated = 10;
+    NDR_Regex** regexes = malloc(sizeof(NDR_Regex*) * memoryAllocated);
+    int* rules = malloc(sizeof(int) * memoryAllocated);
+    uint64_t* modes = malloc(sizeof(uint64_t) * memoryAllocated);
+
+    for(size_t x = 0; x < NDR_RSGetNumberOfStates(regexStateWrapper); x++){
+        NDR_RegexState* regexState = NDR_RSGetRegexState(regexStateWrapper, x);
+        for(size_t i = 0; i < NDR_RSGetNumStartStates(regexState); i++){
+            if(NDR_LexerTrieHoldsRegex(regexState->compiledStartRegex[i]) == true)
+                continue;
+            if(numRegexes >= memoryAllocated){
+                memoryAllocated = memoryAllocated * 2;
+                regexes = realloc(regexes, sizeof(NDR_Regex*) * memoryAllocated);
+                rules = realloc(rules, sizeof(int) * memoryAllocated);
+                modes = realloc(modes, sizeof(uint64_t) * memoryAllocated);
+            }
+            regexes[numRegexes] = regexState->compiledStartRegex[i];
+            rules[numRegexes] = (int) x;
+            modes[numRegexes] = NDR_RSGetModes(regexState);
+            numRegexes++;
+        }
+    }
+
+    int result = NDR_BuildRegexListDFA(dfa, regexes, rules, modes, numRegexes, NDR_RSGetNumberOfModes(regexStateWrapper));
+    free(regexes);
+    free(rules);
+    free(modes);
+    return result;
+}
+
+// Build the automaton using the subset construction over the NFA programs of every regex
+// Each automaton state records the lowest rule that completely matches so the rule order priority of the lexer is kept
+// Every lexer mode starts from the set of its own programs, so the states reached from it never follow the programs of rules that are not active in it
+int NDR_BuildRegexListDFA(NDR_LexerDFA* dfa, NDR_Regex** regexes, int* rules, uint64_t* modes, size_t numRegexes, size_t numModes){
+
+    NDR_FreeLexerDFA(dfa);
+
+    DFABuilder* builder = calloc(1, sizeof(DFABuilder));
+    if(numModes == 0 || numModes > NDR_RS_MAXMODES || CollectPrograms(builder, regexes, rules, modes, numRegexes) != 0){
+        DestroyDFABuilder(builder);
+        free(builder);
+        return 1;
+    }
+
+    ComputeByteClasses(dfa, builder);
+
+    builder->mark = calloc(builder->numThreads + 1, sizeof(size_t));
+    builder->stack = malloc(sizeof(size_t) * (builder->numThreads + 1));
+    builder->work = malloc(sizeof(size_t) * (builder->numThreads + 1));
+    builder->hashTable = calloc(NDR_LEXERDFA_HASHSIZE, sizeof(size_t));
+
+    // The dead state is the empty set of threads
+    builder->generation++;
+    builder->workLength = 0;
+    FindOrAddState(dfa, builder);
+
+    // The start state of a mode holds the beginning of every program matched in it, a mode without programs starts in the dead state
+    dfa->numModes = numModes;
+    dfa->startStates = malloc(sizeof(size_t) * numModes);
+    for(size_t mode = 0; mode < numModes; mode++){
+        builder->generation++;
+        builder->workLength = 0;
+        for(size_t x = 0; x < builder->numPrograms; x++){
+            if((builder->programs[x].modes & ((uint64_t) 1 << mode)) != 0)
+                AddThread(builder, builder->programs[x].offset + builder->programs[x].nfa->start);
+        }
+        dfa->startStates[mode] = FindOrAddState(dfa, builder);
+    }
+
+    // A representative byte is enough to compute the transition of a whole byte class
+    size_t representative[256];
+    for(int ch = 255; ch >= 0; ch--)
+        representative[dfa->byteClasses[ch]] = (size_t) ch;
+
+    int result = 0;
+    for(size_t state = NDR_LEXERDFA_STARTSTATE; state < dfa->numStates && result == 0; state++){
+        for(size_t byteClass = 0; byteClass < dfa->numByteClasses; byteClass++){
+            char ch = (char) representative[byteClass];
+
+            builder->generation++;
+            builder->workLength = 0;
+            for(size_t x = 0; x < builder->setLength[state]; x++){
+                size_t thread = builder->setData[builder->setOffset[state] + x];
+                DFAProgram* program = &builder->programs[builder->threadProgram[thread]];
+                size_t instruction = thread - program->offset;
+                if(program->nfa->instructions[instruction].operation == NDR_NFA_CHAR && NDR_NFAAcceptsChar(program->nfa, instruction, ch) == true)
+                    AddThread(builder, program->offset + program->nfa->instructions[instruction].next);
+            }
+
+            size_t next = FindOrAddState(dfa, builder);
+            if(dfa->numStates > NDR_LEXERDFA_MAXSTATES){
+                result = 1;
+                break;
+            }
+            dfa->transitions[(state * dfa->numByteClasses) + byteClass] = next;
+        }
+    }
+
+    DestroyDFABuilder(builder);
+    free(builder);
+
+    if(result != 0)
+        NDR_FreeLexerDFA(dfa);
+
+    return result;
+}
+
+// Gather the NFA program of every regex
+// Fails when any of them has no program or is not anchored to the beginning of the token, or when there are no regexes
+int CollectPrograms(DFABuilder* builder, NDR_Regex** regexes, int* rules, uint64_t* modes, size_t numRegexes){
+
+    builder->programs = malloc(sizeof(DFAProgram) * (numRegexes + 1));
+
+    for(size_t x = 0; x < numRegexes; x++){
+        NDR_Regex* regex = regexes[x];
+        if(NDR_Regex_IsCompiled(regex) == false || NDR_Regex_GetNFA(regex) == NULL || NDR_Regex_HasBeginFlag(regex) == false)
+            return 1;
+
+        builder->programs[builder->numPrograms].nfa = NDR_Regex_GetNFA(regex);
+        builder->programs[builder->numPrograms].rule = rules[x];
+        builder->programs[builder->numPrograms].modes = (modes != NULL) ? modes[x] : 1;
+        builder->programs[builder->numPrograms].offset = builder->numThreads;
+        builder->numThreads += NDR_Regex_GetNFA(regex)->numInstructions;
+        builder->numPrograms++;
+    }
+
+    if(builder->numPrograms == 0)
+        return 1;
+
+    builder->threadProgram = malloc(sizeof(size_t) * builder->numThreads);
+    for(size_t x = 0; x < builder->numPrograms; x++){
+        for(size_t i = 0; i < builder->programs[x].nfa->numInstructions; i++)
+            builder->threadProgram[builder->programs[x].offset + i] = x;
+    }
+
+    return 0;
+}
+
+// Split the 256 byte values into classes of bytes that are accepted by exactly the same character classes
+void ComputeByteClasses(NDR_LexerDFA* dfa, DFABuilder* builder){
+
+    size_t remap[2][256];
+
+    dfa->numByteClasses = 1;
+    memset(dfa->byteClasses, 0, sizeof(dfa->byteClasses));
+
+    for(size_t x = 0; x < builder->numPrograms; x++){
+        NDR_RegexNFA* nfa = builder->programs[x].nfa;
+        for(size_t i = 0; i < nfa->numClasses; i++){
+            size_t numByteClasses = 0;
+            for(size_t ch = 0; ch < 256; ch++){
+                remap[0][ch] = 256;
+                remap[1][ch] = 256;
+            }
+            for(size_t ch = 0; ch < 256; ch++){
+                size_t accepted = NDR_NFA_CLASSHAS(nfa->classes[i], ch);
+                if(remap[accepted][dfa->byteClasses[ch]] == 256)
+                    remap[accepted][dfa->byteClasses[ch]] = numByteClasses++;
+                dfa->byteClasses[ch] = remap[accepted][dfa->byteClasses[ch]];
+            }
+            dfa->numByteClasses = numByteClasses;
+        }
+    }
+}
+
+// Add a thread to the set being built along with every thread reachable from it without consuming a character
+void AddThread(DFABuilder* builder, size_t thread){
+
+    size_t stackSize = 0;
+    static const unsigned char emptyClass[NDR_NFA_CLASSBYTES] = {0};
+
+    if(builder->mark[thread] == builder->generation)
+        return;
+    builder->mark[thread] = builder->generation;
+    builder->stack[stackSize++] = thread;
+
+    while(stackSize > 0){
+        size_t current = builder->stack[--stackSize];
+        DFAProgram* program = &builder->programs[builder->threadProgram[current]];
+        NDR_NFAInstruction* instruction = &program->nfa->instructions[current - program->offset];
+        size_t follow[2];
+        size_t numFollow = 0;
+
+        switch(instruction->operation){
+            case NDR_NFA_CHAR:
+                // Characters that accept nothing can never progress so they are left out to keep dead states recognizable
+                if(memcmp(program->nfa->classes[instruction->charClass], emptyClass, NDR_NFA_CLASSBYTES) != 0)
+                    builder->work[builder->workLength++] = current;
+                break;
+            case NDR_NFA_MATCH:
+                builder->work[builder->workLength++] = current;
+                break;
+            case NDR_NFA_SPLIT:
+                follow[numFollow++] = program->offset + instruction->alternate;
+                follow[numFollow++] = program->offset + instruction->next;
+                break;
+            case NDR_NFA_JUMP:
+                follow[numFollow++] = program->offset + instruction->next;
+                break;
+        }
+
+        for(size_t x = 0; x < numFollow; x++){
+            if(builder->mark[follow[x]] != builder->generation){
+                builder->mark[follow[x]] = builder->generation;
+                builder->stack[stackSize++] = follow[x];
+            }
+        }
+    }
+}
+
+// Return the state holding the set of threads currently in the work area, adding a new state when the set has not been seen before
+size_t FindOrAddState(NDR_LexerDFA* dfa, DFABuilder* builder){
+
+    qsort(builder->work, builder->workLength, sizeof(size_t), CompareThreads);
+
+    size_t hash = 2166136261u;
+    for(size_t x = 0; x < builder->workLength; x++)
+        hash = (hash ^ builder->work[x]) * 16777619u;
+    hash = hash & (NDR_LEXERDFA_HASHSIZE - 1);
+
+    while(builder->hashTable[hash] != 0){
+        size_t state = builder->hashTable[hash] - 1;
+        if(builder->setLength[state] == builder->workLength && memcmp(&builder->setData[builder->setOffset[state]], builder->work, sizeof(size_t) * builder->workLength) == 0)
+            return state;
+        hash = (hash + 1) & (NDR_LEXERDFA_HASHSIZE - 1);
+    }
+
+    // Past the limit the set is not stored and the caller abandons the construction
+    if(dfa->numStates >= NDR_LEXERDFA_MAXSTATES){
+        dfa->numStates++;
+        return NDR_LEXERDFA_DEADSTATE;
+    }
+
+    size_t state = dfa->numStates;
+    AddDFAState(dfa);
+    builder->hashTable[hash] = state + 1;
+
+    if(builder->setsAllocated < dfa->memoryAllocated){
+        builder->setsAllocated = dfa->memoryAllocated;
+        builder->setOffset = realloc(builder->setOffset, sizeof(size_t) * builder->setsAllocated);
+        builder->setLength = realloc(builder->setLength, sizeof(size_t) * builder->setsAllocated);
+    }
+    if(builder->setDataLength + builder->workLength >= builder->setDataAllocated){
+        builder->setDataAllocated = (builder->setDataAllocated * 2) + builder->workLength + 50;
+        builder->setData = realloc(builder->setData, sizeof(size_t) * builder->setDataAllocated);
+    }
+    memcpy(&builder->setData[builder->setDataLength], builder->work, sizeof(size_t) * builder->workLength);
+    builder->setOffset[state] = builder->setDataLength;
+    builder->setLength[state] = builder->workLength;
+    builder->setDataLength += builder->workLength;
+
+    for(size_t x = 0; x < builder->workLength; x++){
+        DFAProgram* program = &builder->programs[builder->threadProgram[builder->work[x]]];
+        if(program->nfa->instructions[builder->work[x] - program->offset].operation == NDR_NFA_MATCH){
+            dfa->numCompleteMatches[state]++;
+            if(dfa->acceptingRule[state] == -1 || program->rule < dfa->acceptingRule[state])
+                dfa->acceptingRule[state] = program->rule;
+        }
+    }
+
+    return state;
+}
+
+void AddDFAState(NDR_LexerDFA* dfa){
+    if(dfa->memoryAllocated == 0){
+        dfa->memoryAllocated = 50;
+        dfa->transitions = malloc(sizeof(size_t) * dfa->numByteClasses * dfa->memoryAllocated);
+        dfa->acceptingRule = malloc(sizeof(int) * dfa->memoryAllocated);
+        dfa->numCompleteMatches = malloc(sizeof(size_t) * dfa->memoryAllocated);
+    }
+    else if(dfa->numStates >= dfa->memoryAllocated - 5){
+        dfa->memoryAllocated = dfa->memoryAllocated * 2;
+        dfa->transitions = realloc(dfa->transitions, sizeof(size_t) * dfa->numByteClasses * dfa->memoryAllocated);
+        dfa->acceptingRule = realloc(dfa->acceptingRule, sizeof(int) * dfa->memoryAllocated);
+        dfa->numCompleteMatches = realloc(dfa->numCompleteMatches, sizeof(size_t) * dfa->memoryAllocated);
+    }
+    for(size_t x = 0; x < dfa->numByteClasses; x++)
+        dfa->transitions[(dfa->numStates * dfa->numByteClasses) + x] = NDR_LEXERDFA_DEADSTATE;
+    dfa->acceptingRule[dfa->numStates] = -1;
+    dfa->numCompleteMatches[dfa->numStates] = 0;
+    dfa->numStates++;
+}
+
+int CompareThreads(const void* first, const void* second){
+    size_t a = *((const size_t*) first);
+    size_t b = *((const size_t*) second);
+    return (a > b) - (a < b);
+}
+
+void DestroyDFABuilder(DFABuilder* builder){
+    free(builder->programs);
+    free(builder->threadProgram);
+    free(builder->setData);
+    free(builder->setOffset);
+    free(builder->setLength);
+    free(builder->hashTable);
+    free(builder->mark);
+    free(builder->stack);
+    free(builder->work);
+}
@@ -0,0 +1,92 @@
+
+/*********************************************************************************
+*                                 NDR Lexer DFA                                  *
+**********************************************************************************/
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Neil Runcie
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef NDRLEXERDFA_H
+#define NDRLEXERDFA_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ndr_regexstate.h"
+
+// The state reached once no start regex can match the current token anymore
+#define NDR_LEXERDFA_DEADSTATE 0
+// The first state after the dead state, which is the state used at the beginning of every token of the initial lexer mode when that mode has start regexes
+#define NDR_LEXERDFA_STARTSTATE 1
+// Upper bound on the number of states. Configurations that need more are lexed with the individual regexes instead
+#define NDR_LEXERDFA_MAXSTATES 8192
+
+// Declaration of the combined automaton built over every start regex of the lexer configuration
+typedef struct NDR_LexerDFA {
+    size_t numStates;
+    size_t memoryAllocated;
+    // byteClasses maps every byte value onto a class of bytes that all start regexes treat identically
+    size_t numByteClasses;
+    size_t byteClasses[256];
+    // transitions holds numByteClasses entries for each state
+    size_t* transitions;
+    // acceptingRule holds the lowest regex state index completely matched in each state or -1 when nothing is matched
+    int* acceptingRule;
+    // numCompleteMatches holds the number of start regexes completely matched in each state
+    size_t* numCompleteMatches;
+    // startStates holds the state used at the beginning of every token for each lexer mode, reached from only the start regexes of that mode
+    size_t numModes;
+    size_t* startStates;
+    // ownsTables is false when the tables refer to a loaded lexer image and must not be freed
+    bool ownsTables;
+} NDR_LexerDFA;
+
+// Utility function to initialize an empty automaton
+void NDR_InitLexerDFA(NDR_LexerDFA* dfa);
+// Build the automaton from every start regex within the wrapper that is not a literal. Returns 0 on success and non-zero when any of them cannot be represented
+int NDR_BuildLexerDFA(NDR_LexerDFA* dfa, NDR_RegexStateWrapper* regexStateWrapper);
+// Build the automaton from a list of regexes, where rules holds the regex state index reported for each of them and modes the lexer modes each of them is matched in
+// When modes is NULL every regex is matched in the one mode. Returns 0 on success and non-zero when any of them cannot be represented
+int NDR_BuildRegexListDFA(NDR_LexerDFA* dfa, NDR_Regex** regexes, int* rules, uint64_t* modes, size_t numRegexes, size_t numModes);
+// Utility function to free the memory allocated to items within the automaton
+void NDR_FreeLexerDFA(NDR_LexerDFA* dfa);
+
+// Get the state reached from "state" after reading the character "ch"
+size_t NDR_LexerDFAStep(NDR_LexerDFA* dfa, size_t state, char ch);
+// Get the regex state index that wins the complete match in "state" or -1 when no start regex is completely matched
+int NDR_LexerDFAGetAcceptingRule(NDR_LexerDFA* dfa, size_t state);
+// Get the number of start regexes completely matched in "state"
+size_t NDR_LexerDFAGetNumCompleteMatches(NDR_LexerDFA* dfa, size_t state);
+// Get the state used at the beginning of every token of the lexer mode "mode"
+size_t NDR_LexerDFAGetStartState(NDR_LexerDFA* dfa, int mode);
+
+#endif
@@ -0,0 +1,868 @@
+
+/*********************************************************************************
+*                                NDR Lexer Image                                 *
+**********************************************************************************/
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Neil Runcie
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "ndr_lexerimage.h"
+#include "ndr_lexer.h"
+#include "ndr_debug.h"
+#include "ndr_fileprocessor.h"
+#include "ndr_regexstate.h"
+#include "regex_engines/ndr_regex.h"
+#include "regex_engines/ndr_regexprogram.h"
+#include "regex_engines/ndr_regexnfa.h"
+
+// The first bytes of every lexer image
+static const char imageMagic[8] = {'N', 'D', 'R', 'L', 'X', 'I', 'M', 'G'};
+// Written as one value so that an image written on a machine of another byte order is recognized
+#define NDR_LEXERIMAGE_BYTEORDER 0x01020304u
+
+// The bytes of an image being written. Every value is aligned to its size from the start of the image so that the tables can be used where they are mapped
+typedef struct ImageWriter {
+    char* data;
+    size_t length;
+    size_t memoryAllocated;
+} ImageWriter;
+
+// The position reached while reading an image, failed is set once a read goes past the end of the image or finds a value that is out of range
+typedef struct ImageReader {
+    const char* data;
+    size_t length;
+    size_t position;
+    bool failed;
+} ImageReader;
+
+static void InitImageWriter(ImageWriter* writer);
+static void AlignImageWriter(ImageWriter* writer, size_t alignment);
+static void WriteBytes(ImageWriter* writer, const void* data, size_t length);
+static void WriteSize(ImageWriter* writer, size_t value);
+static void WriteInts(ImageWriter* writer, const int* values, size_t count);
+static void WriteSizes(ImageWriter* writer, const size_t* values, size_t count);
+static void WriteString(ImageWriter* writer, const char* string);
+static void WriteByteTable(ImageWriter* writer, const bool* table);
+static void WriteRegexState(ImageWriter* writer, NDR_RegexState* regexState);
+static void WriteRegex(ImageWriter* writer, NDR_Regex* regex);
+static void WriteRegexNFA(ImageWriter* writer, NDR_RegexNFA* nfa);
+static void WriteLexerDFA(ImageWriter* writer, NDR_LexerDFA* dfa);
+static void WriteLexerTrie(ImageWriter* writer, NDR_LexerTrie* trie);
+
+static const void* ReadArray(ImageReader* reader, size_t count, size_t elementSize);
+static size_t ReadSize(ImageReader* reader);
+static char* ReadString(ImageReader* reader);
+static void ReadByteTable(ImageReader* reader, bool* table);
+static int ReadImageHeader(ImageReader* reader, uint64_t configHash, char* fileName, size_t* settings);
+static int ReadRegexState(ImageReader* reader, NDR_RegexState* regexState);
+static int ReadRegexList(ImageReader* reader, char*** regexStrings, NDR_Regex*** compiledRegexes, size_t* numRegexes);
+static NDR_Regex* ReadRegex(ImageReader* reader);
+static int ReadRegexProgram(ImageReader* reader, NDR_Regex* regex);
+static NDR_RegexNFA* ReadRegexNFA(ImageReader* reader);
+static NDR_LexerDFA* ReadLexerDFA(ImageReader* reader, size_t numRegexStates, size_t numModes);
+static NDR_LexerTrie* ReadLexerTrie(ImageReader* reader, size_t numRegexStates, size_t numModes);
+static int RequirePikeVM(NDR_RegexStateWrapper* regexStateWrapper);
+static bool AreTablesValid(const size_t* transitions, const int* acceptingRule, const size_t* numCompleteMatches, size_t numStates, size_t numByteClasses, const size_t* byteClasses, size_t numRegexStates);
+
+// The settings of the configuration file are kept in one value of the image header
+#define NDR_LEXERIMAGE_AUTOCAP 1
+#define NDR_LEXERIMAGE_AUTOTRIM 2
+#define NDR_LEXERIMAGE_MATCHALL 4
+#define NDR_LEXERIMAGE_MATCHALLSEEN 8
+
+
+int NDR_SaveLexerImage(char* fileName){
+    return NDR_Context_SaveLexerImage(NDR_GetDefaultContext(), fileName);
+}
+
+int NDR_Context_SaveLexerImage(NDR_Context* context, char* fileName){
+
+    if(context->lexerConfiguringCompleted == false || context->RSWrapper == NULL){
+        printf("\nThe lexer must be configured before a lexer image can be written\n");
+        return 1;
+    }
+    if(fileName == NULL || strcmp(fileName, "") == 0){
+        printf("A non-empty filename must be provided for the lexer image\n");
+        return 1;
+    }
+
+    ImageWriter writer;
+    InitImageWriter(&writer);
+
+    // The header is made of fixed size values so that it can be checked before the word size of the image is known
+    uint32_t header[4];
+    header[0] = NDR_LEXERIMAGE_VERSION;
+    header[1] = (uint32_t) sizeof(size_t);
+    header[2] = NDR_LEXERIMAGE_BYTEORDER;
+    header[3] = 0;
+    if(context->autoCap == true)
+        header[3] |= NDR_LEXERIMAGE_AUTOCAP;
+    if(context->autoTrim == true)
+        header[3] |= NDR_LEXERIMAGE_AUTOTRIM;
+    if(context->matchAll == true)
+        header[3] |= NDR_LEXERIMAGE_MATCHALL;
+    if(context->matchAllSeen == true)
+        header[3] |= NDR_LEXERIMAGE_MATCHALLSEEN;
+    WriteBytes(&writer, imageMagic, sizeof(imageMagic));
+    WriteBytes(&writer, header, sizeof(header));
+    WriteBytes(&writer, &context->lexerConfigHash, sizeof(uint64_t));
+    // The hash of the rest of the image is filled in once it has been written
+    size_t contentHashPosition = writer.length;
+    uint64_t contentHash = 0;
+    WriteBytes(&writer, &contentHash, sizeof(uint64_t));
+
+    WriteSize(&writer, NDR_RSGetNumberOfStates(context->RSWrapper));
+    for(size_t x = 0; x < NDR_RSGetNumberOfStates(context->RSWrapper); x++)
+        WriteRegexState(&writer, NDR_RSGetRegexState(context->RSWrapper, x));
+    // The initial mode is added with the symbol table so only the names of the modes after it are written
+    WriteSize(&writer, NDR_RSGetNumberOfModes(context->RSWrapper));
+    for(size_t x = 1; x < NDR_RSGetNumberOfModes(context->RSWrapper); x++)
+        WriteString(&writer, NDR_RSGetModeName(context->RSWrapper, x));
+    WriteLexerDFA(&writer, context->lexerDFA);
+    WriteLexerTrie(&writer, context->lexerTrie);
+    contentHash = NDR_HashBytes(NDR_HASH_SEED, writer.data + contentHashPosition + sizeof(uint64_t), writer.length - contentHashPosition - sizeof(uint64_t));
+    memcpy(writer.data + contentHashPosition, &contentHash, sizeof(uint64_t));
+
+    FILE* imageFile = fopen(fileName, "wb");
+    if(imageFile == NULL){
+        printf("Cannot open lexer image \"%s\" for writing\n", fileName);
+        free(writer.data);
+        return 1;
+    }
+    size_t numWritten = fwrite(writer.data, 1, writer.length, imageFile);
+    int closeResult = fclose(imageFile);
+    free(writer.data);
+    if(numWritten != writer.length || closeResult != 0){
+        printf("Failed to write lexer image \"%s\"\n", fileName);
+        return 1;
+    }
+
+    return 0;
+}
+
+int NDR_LoadLexerImage(char* fileName, char* configFileName){
+    return NDR_Context_LoadLexerImage(NDR_GetDefaultContext(), fileName, configFileName);
+}
+
+int NDR_Context_LoadLexerImage(NDR_Context* context, char* fileName, char* configFileName){
+
+    if(context->lexerConfiguringAttempted == true){
+        printf("\nLexer configuration has already been performed\n");
+        return 1;
+    }
+    if(fileName == NULL || strcmp(fileName, "") == 0 || configFileName == NULL || strcmp(configFileName, "") == 0){
+        printf("Non-empty filenames must be provided for the lexer image and the lexer configuration file\n");
+        return 1;
+    }
+
+    uint64_t configHash;
+    if(NDR_HashFile(configFileName, &configHash) != 0){
+        printf("Cannot open the lexer configuration file \"%s\"\n", configFileName);
+        return 1;
+    }
+
+    NDR_MappedFile* image = malloc(sizeof(NDR_MappedFile));
+    if(NDR_MapBinaryFile(fileName, image) != 0){
+        printf("Cannot open lexer image \"%s\"\n", fileName);
+        free(image);
+        return 1;
+    }
+
+    ImageReader reader;
+    reader.data = image->data;
+    reader.length = image->length;
+    reader.position = 0;
+    reader.failed = false;
+
+    size_t settings = 0;
+    if(ReadImageHeader(&reader, configHash, fileName, &settings) != 0){
+        NDR_UnmapFile(image);
+        free(image);
+        return 1;
+    }
+
+    NDR_RegexStateWrapper* regexStateWrapper = malloc(sizeof(NDR_RegexStateWrapper));
+    NDR_InitializeRegexStateWrapper(regexStateWrapper);
+    NDR_LexerDFA* lexerDFA = NULL;
+    NDR_LexerTrie* lexerTrie = NULL;
+
+    size_t numStates = ReadSize(&reader);
+    if(numStates == 0 || numStates > reader.length)
+        reader.failed = true;
+    for(size_t x = 0; x < numStates && reader.failed == false; x++){
+        NDR_AddRegexState(regexStateWrapper);
+        if(ReadRegexState(&reader, NDR_RSGetLastRegexState(regexStateWrapper)) != 0)
+            reader.failed = true;
+    }
+    size_t numModes = ReadSize(&reader);
+    if(numModes == 0 || numModes > NDR_RS_MAXMODES)
+        reader.failed = true;
+    for(size_t x = 1; x < numModes && reader.failed == false; x++){
+        char* modeName = ReadString(&reader);
+        if(modeName == NULL)
+            break;
+        NDR_RSAddMode(regexStateWrapper, modeName);
+        free(modeName);
+    }
+    for(size_t x = 0; x < numStates && reader.failed == false; x++){
+        NDR_RegexState* regexState = NDR_RSGetRegexState(regexStateWrapper, x);
+        if(NDR_RSGetModeAction(regexState) != NDR_MODE_NONE && (size_t) NDR_RSGetModeTarget(regexState) >= numModes)
+            reader.failed = true;
+    }
+    if(reader.failed == false)
+        lexerDFA = ReadLexerDFA(&reader, numStates, numModes);
+    if(reader.failed == false)
+        lexerTrie = ReadLexerTrie(&reader, numStates, numModes);
+
+    // An image written without the Pike VM being required may hold rules that backtrack
+    bool refused = false;
+    if(reader.failed == false && reader.position == reader.length && context->regexEngine == NDR_REGEX_ENGINE_PIKEVM && RequirePikeVM(regexStateWrapper) != 0){
+        printf("Lexer image \"%s\" has rules that cannot be matched by the Pike VM\n", fileName);
+        refused = true;
+    }
+
+    if(reader.failed == true || reader.position != reader.length || refused == true){
+        if(refused == false)
+            printf("Lexer image \"%s\" is damaged\n", fileName);
+        NDR_FreeRegexStateWrapper(regexStateWrapper);
+        free(regexStateWrapper);
+        if(lexerDFA != NULL){
+            NDR_FreeLexerDFA(lexerDFA);
+            free(lexerDFA);
+        }
+        if(lexerTrie != NULL){
+            NDR_FreeLexerTrie(lexerTrie);
+            free(lexerTrie);
+        }
+        NDR_UnmapFile(image);
+        free(image);
+        return 1;
+    }
+
+    context->lexerConfiguringAttempted = true;
+    context->autoCap = (settings & NDR_LEXERIMAGE_AUTOCAP) != 0;
+    context->autoTrim = (settings & NDR_LEXERIMAGE_AUTOTRIM) != 0;
+    context->matchAll = (settings & NDR_LEXERIMAGE_MATCHALL) != 0;
+    context->matchAllSeen = (settings & NDR_LEXERIMAGE_MATCHALLSEEN) != 0;
+    context->lexerConfigHash = configHash;
+    context->RSWrapper = regexStateWrapper;
+    context->lexerDFA = lexerDFA;
+    context->lexerTrie = lexerTrie;
+    context->lexerImage = image;
+
+    if (NDR_ST == true)
+        NDR_Context_PrintSymbolTable(context);
+
+    context->lexerConfiguringCompleted = true;
+
+    if (NDR_STAT == true)
+        printf("\nLexer configured from image successfully\n");
+
+    return 0;
+}
+
+uint64_t NDR_HashBytes(uint64_t hash, const void* data, size_t length){
+    const unsigned char* bytes = data;
+    for(size_t x = 0; x < length; x++){
+        hash ^= bytes[x];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+int NDR_HashFile(char* fileName, uint64_t* hash){
+    NDR_MappedFile file;
+    if(NDR_MapFile(fileName, &file) != 0)
+        return 1;
+    *hash = NDR_HashBytes(NDR_HASH_SEED, file.data, file.length);
+    NDR_UnmapFile(&file);
+    return 0;
+}
+
+/*
+Functions to write a lexer image
+*/
+
+void InitImageWriter(ImageWriter* writer){
+    writer->length = 0;
+    writer->memoryAllocated = 4096;
+    writer->data = malloc(writer->memoryAllocated);
+}
+
+void AlignImageWriter(ImageWriter* writer, size_t alignment){
+    static const char padding[sizeof(size_t)] = {0};
+    if(writer->length % alignment != 0)
+        WriteBytes(writer, padding, alignment - (writer->length % alignment));
+}
+
+void WriteBytes(ImageWriter* writer, const void* data, size_t length){
+    if(writer->length + length > writer->memoryAllocated){
+        while(writer->length + length > writer->memoryAllocated)
+            writer->memoryAllocated = writer->memoryAllocated * 2;
+        writer->data = realloc(writer->data, writer->memoryAllocated);
+    }
+    if(length > 0)
+        memcpy(writer->data + writer->length, data, length);
+    writer->length += length;
+}
+
+void WriteSize(ImageWriter* writer, size_t value){
+    WriteSizes(writer, &value, 1);
+}
+
+void WriteInts(ImageWriter* writer, const int* values, size_t count){
+    AlignImageWriter(writer, sizeof(int));
+    WriteBytes(writer, values, sizeof(int) * count);
+}
+
+void WriteSizes(ImageWriter* writer, const size_t* values, size_t count){
+    AlignImageWriter(writer, sizeof(size_t));
+    WriteBytes(writer, values, sizeof(size_t) * count);
+}
+
+void WriteString(ImageWriter* writer, const char* string){
+    WriteSize(writer, strlen(string));
+    WriteBytes(writer, string, strlen(string));
+}
+
+void WriteByteTable(ImageWriter* writer, const bool* table){
+    unsigned char bytes[256];
+    for(int x = 0; x < 256; x++)
+        bytes[x] = table[x] == true ? 1 : 0;
+    WriteBytes(writer, bytes, sizeof(bytes));
+}
+
+void WriteRegexState(ImageWriter* writer, NDR_RegexState* regexState){
+    WriteString(writer, regexState->keyword);
+    WriteSize(writer, regexState->isState == true ? 1 : 0);
+    WriteSize(writer, regexState->isLiteral == true ? 1 : 0);
+    WriteSize(writer, (size_t) regexState->category);
+    AlignImageWriter(writer, sizeof(uint64_t));
+    WriteBytes(writer, &regexState->modes, sizeof(uint64_t));
+    WriteSize(writer, (size_t) regexState->modeAction);
+    WriteSize(writer, (size_t) regexState->modeTarget);
+    WriteSize(writer, (size_t) regexState->engine);
+
+    WriteSize(writer, regexState->numStartStates);
+    for(size_t x = 0; x < regexState->numStartStates; x++){
+        WriteString(writer, regexState->startRegex[x]);
+        WriteRegex(writer, regexState->compiledStartRegex[x]);
+    }
+    WriteSize(writer, regexState->numAllowStates);
+    for(size_t x = 0; x < regexState->numAllowStates; x++){
+        WriteString(writer, regexState->allowRegex[x]);
+        WriteRegex(writer, regexState->compiledAllowRegex[x]);
+    }
+    WriteSize(writer, regexState->numEscapeStates);
+    for(size_t x = 0; x < regexState->numEscapeStates; x++){
+        WriteString(writer, regexState->escapeRegex[x]);
+        WriteRegex(writer, regexState->compiledEscapeRegex[x]);
+    }
+    WriteSize(writer, regexState->numEndStates);
+    for(size_t x = 0; x < regexState->numEndStates; x++){
+        WriteString(writer, regexState->endRegex[x]);
+        WriteRegex(writer, regexState->compiledEndRegex[x]);
+    }
+
+    WriteByteTable(writer, regexState->allowedBytes);
+    WriteByteTable(writer, regexState->escapedBytes);
+    WriteByteTable(writer, regexState->plainBytes);
+    // Only the listed stop bytes are written so that images of the same configuration are identical
+    unsigned char stopBytes[NDR_RS_MAXSTOPBYTES] = {0};
+    memcpy(stopBytes, regexState->stopBytes, regexState->numStopBytes);
+    WriteSize(writer, regexState->numStopBytes);
+    WriteBytes(writer, stopBytes, NDR_RS_MAXSTOPBYTES);
+}
+
+// The program of a regex only refers to its own instructions by index so it is written as it is held in memory
+void WriteRegex(ImageWriter* writer, NDR_Regex* regex){
+    size_t flags = 0;
+    if(regex->initialized == true)
+        flags |= 1;
+    if(regex->beginString == true)
+        flags |= 2;
+    if(regex->endString == true)
+        flags |= 4;
+    if(regex->isEmpty == true)
+        flags |= 8;
+    flags |= (size_t) regex->engine << 4;
+    WriteSize(writer, flags);
+    // Regexes that failed to compile are kept by the configuration but never matched, so only their flags are needed
+    if(regex->initialized == false)
+        return;
+
+    WriteSize(writer, regex->program->size);
+    WriteBytes(writer, regex->program, regex->program->size);
+
+    WriteRegexNFA(writer, regex->nfa);
+}
+
+void WriteRegexNFA(ImageWriter* writer, NDR_RegexNFA* nfa){
+    if(nfa == NULL){
+        WriteSize(writer, 0);
+        return;
+    }
+    WriteSize(writer, 1);
+
+    size_t flags = 0;
+    if(nfa->valid == true)
+        flags |= 1;
+    if(nfa->beginString == true)
+        flags |= 2;
+    if(nfa->endString == true)
+        flags |= 4;
+    WriteSize(writer, flags);
+    WriteSize(writer, nfa->start);
+    WriteSize(writer, nfa->numInstructions);
+    for(size_t x = 0; x < nfa->numInstructions; x++){
+        size_t instruction[4] = {(size_t) nfa->instructions[x].operation, nfa->instructions[x].charClass, nfa->instructions[x].next, nfa->instructions[x].alternate};
+        WriteSizes(writer, instruction, 4);
+    }
+    WriteSize(writer, nfa->numClasses);
+    WriteBytes(writer, nfa->classes, NDR_NFA_CLASSBYTES * nfa->numClasses);
+}
+
+// The tables of the automaton are written in the layout they are used in so that a loaded image can use them where they are mapped
+void WriteLexerDFA(ImageWriter* writer, NDR_LexerDFA* dfa){
+    if(dfa == NULL){
+        WriteSize(writer, 0);
+        return;
+    }
+    WriteSize(writer, 1);
+    WriteSize(writer, dfa->numStates);
+    WriteSize(writer, dfa->numByteClasses);
+    WriteSizes(writer, dfa->byteClasses, 256);
+    WriteSizes(writer, dfa->transitions, dfa->numStates * dfa->numByteClasses);
+    WriteInts(writer, dfa->acceptingRule, dfa->numStates);
+    WriteSizes(writer, dfa->numCompleteMatches, dfa->numStates);
+    WriteSizes(writer, dfa->startStates, dfa->numModes);
+}
+
+void WriteLexerTrie(ImageWriter* writer, NDR_LexerTrie* trie){
+    if(trie == NULL){
+        WriteSize(writer, 0);
+        return;
+    }
+    WriteSize(writer, 1);
+    WriteSize(writer, trie->numNodes);
+    WriteSize(writer, trie->numLiterals);
+    WriteSize(writer, trie->numModes);
+    WriteSize(writer, trie->numByteClasses);
+    WriteSizes(writer, trie->byteClasses, 256);
+    WriteSizes(writer, trie->transitions, trie->numNodes * trie->numByteClasses);
+    WriteInts(writer, trie->acceptingRule, trie->numNodes);
+    WriteSizes(writer, trie->numCompleteMatches, trie->numNodes);
+}
+
+/*
+Functions to read a lexer image
+*/
+
+// Returns a pointer to count elements within the image after aligning to the element size, or NULL when they would go past the end of the image
+const void* ReadArray(ImageReader* reader, size_t count, size_t elementSize){
+    if(reader->failed == true)
+        return NULL;
+    size_t position = reader->position;
+    if(position % elementSize != 0)
+        position += elementSize - (position % elementSize);
+    if(position > reader->length || count > (reader->length - position) / elementSize){
+        reader->failed = true;
+        return NULL;
+    }
+    reader->position = position + (count * elementSize);
+    return reader->data + position;
+}
+
+size_t ReadSize(ImageReader* reader){
+    const size_t* value = ReadArray(reader, 1, sizeof(size_t));
+    if(value == NULL)
+        return 0;
+    return *value;
+}
+
+char* ReadString(ImageReader* reader){
+    size_t length = ReadSize(reader);
+    const char* characters = ReadArray(reader, length, 1);
+    if(characters == NULL)
+        return NULL;
+    char* string = malloc(length + 1);
+    memcpy(string, characters, length);
+    string[length] = '\0';
+    return string;
+}
+
+void ReadByteTable(ImageReader* reader, bool* table){
+    const unsigned char* bytes = ReadArray(reader, 256, 1);
+    for(int x = 0; x < 256; x++)
+        table[x] = (bytes != NULL && bytes[x] != 0);
+}
+
+int ReadImageHeader(ImageReader* reader, uint64_t configHash, char* fileName, size_t* settings){
+    const char* magic = ReadArray(reader, sizeof(imageMagic), 1);
+    const uint32_t* header = ReadArray(reader, 4, sizeof(uint32_t));
+    const uint64_t* imageHash = ReadArray(reader, 1, sizeof(uint64_t));
+    const uint64_t* contentHash = ReadArray(reader, 1, sizeof(uint64_t));
+
+    if(reader->failed == true || memcmp(magic, imageMagic, sizeof(imageMagic)) != 0){
+        printf("\"%s\" is not a lexer image\n", fileName);
+        return 1;
+    }
+    if(header[0] != NDR_LEXERIMAGE_VERSION || header[1] != sizeof(size_t) || header[2] != NDR_LEXERIMAGE_BYTEORDER){
+        printf("Lexer image \"%s\" was written by another version of the library or for another platform\n", fileName);
+        return 1;
+    }
+    if(*imageHash != configHash){
+        printf("Lexer image \"%s\" was not created from the current lexer configuration file\n", fileName);
+        return 1;
+    }
+    // The contents are only checked for range errors as they are read, so damage that stays in range is found here
+    if(*contentHash != NDR_HashBytes(NDR_HASH_SEED, reader->data + reader->position, reader->length - reader->position)){
+        printf("Lexer image \"%s\" is damaged\n", fileName);
+        return 1;
+    }
+
+    *settings = header[3];
+    return 0;
+}
+
+int ReadRegexState(ImageReader* reader, NDR_RegexState* regexState){
+    char* keyword = ReadString(reader);
+    if(keyword == NULL)
+        return 1;
+    NDR_RSSetKeyword(regexState, keyword);
+    free(keyword);
+    NDR_RSSetStateFlag(regexState, ReadSize(reader) != 0);
+    NDR_RSSetLiteralFlag(regexState, ReadSize(reader) != 0);
+    size_t category = ReadSize(reader);
+    if(category > NDR_STATE_NOTAPPLICABLE)
+        return 1;
+    NDR_RSSetCategory(regexState, (NDR_StateCategories) category);
+    const uint64_t* modes = ReadArray(reader, 1, sizeof(uint64_t));
+    size_t modeAction = ReadSize(reader);
+    size_t modeTarget = ReadSize(reader);
+    size_t engine = ReadSize(reader);
+    if(modes == NULL || modeAction > NDR_MODE_SWITCH || modeTarget >= NDR_RS_MAXMODES || engine > NDR_REGEX_ENGINE_PIKEVM)
+        return 1;
+    NDR_RSSetModes(regexState, *modes);
+    NDR_RSSetModeAction(regexState, (NDR_ModeAction) modeAction, (int) modeTarget);
+    NDR_RSSetEngine(regexState, (NDR_RegexEngine) engine);
+
+    if(ReadRegexList(reader, &regexState->startRegex, &regexState->compiledStartRegex, &regexState->numStartStates) != 0 ||
+       ReadRegexList(reader, &regexState->allowRegex, &regexState->compiledAllowRegex, &regexState->numAllowStates) != 0 ||
+       ReadRegexList(reader, &regexState->escapeRegex, &regexState->compiledEscapeRegex, &regexState->numEscapeStates) != 0 ||
+       ReadRegexList(reader, &regexState->endRegex, &regexState->compiledEndRegex, &regexState->numEndStates) != 0)
+        return 1;
+
+    ReadByteTable(reader, regexState->allowedBytes);
+    ReadByteTable(reader, regexState->escapedBytes);
+    ReadByteTable(reader, regexState->plainBytes);
+    size_t numStopBytes = ReadSize(reader);
+    const unsigned char* stopBytes = ReadArray(reader, NDR_RS_MAXSTOPBYTES, 1);
+    if(stopBytes == NULL || numStopBytes > NDR_RS_MAXSTOPBYTES)
+        return 1;
+    regexState->numStopBytes = numStopBytes;
+    memcpy(regexState->stopBytes, stopBytes, NDR_RS_MAXSTOPBYTES);
+
+    return (reader->failed == true) ? 1 : 0;
+}
+
+// The strings and compiled regexes of one table of a regex state are added together so that a failed read leaves a table that can still be freed
+// Each regex is allocated on its own like the ones NDR_CompileStateRegex makes, so NDR_FreeRegexState releases loaded and compiled states alike
+int ReadRegexList(ImageReader* reader, char*** regexStrings, NDR_Regex*** compiledRegexes, size_t* numRegexes){
+    size_t count = ReadSize(reader);
+    if(reader->failed == true || count > reader->length)
+        return 1;
+
+    for(size_t x = 0; x < count; x++){
+        char* regexString = ReadString(reader);
+        if(regexString == NULL)
+            return 1;
+        NDR_Regex* regex = ReadRegex(reader);
+        if(regex == NULL){
+            free(regexString);
+            return 1;
+        }
+        *regexStrings = realloc(*regexStrings, sizeof(char*) * (*numRegexes + 2));
+        *compiledRegexes = realloc(*compiledRegexes, sizeof(NDR_Regex*) * (*numRegexes + 2));
+        (*regexStrings)[*numRegexes] = regexString;
+        (*compiledRegexes)[*numRegexes] = regex;
+        (*numRegexes)++;
+    }
+    return 0;
+}
+
+NDR_Regex* ReadRegex(ImageReader* reader){
+    size_t flags = ReadSize(reader);
+    if(reader->failed == true)
+        return NULL;
+
+    NDR_Regex* regex = malloc(sizeof(NDR_Regex));
+    NDR_InitRegex(regex);
+    regex->beginString = (flags & 2) != 0;
+    regex->endString = (flags & 4) != 0;
+    regex->isEmpty = (flags & 8) != 0;
+    if((flags & 1) == 0)
+        return regex;
+    regex->initialized = true;
+
+    if(ReadRegexProgram(reader, regex) != 0){
+        free(regex);
+        return NULL;
+    }
+
+    size_t hasNFA = ReadSize(reader);
+    if(hasNFA != 0)
+        regex->nfa = ReadRegexNFA(reader);
+    if(reader->failed == true || (hasNFA != 0 && regex->nfa == NULL) || (flags >> 4) > NDR_REGEX_ENGINE_PIKEVM ||
+       NDR_Regex_SetEngine(regex, (NDR_RegexEngine) (flags >> 4)) != 0){
+        NDR_DestroyRegex(regex);
+        free(regex);
+        return NULL;
+    }
+
+    return regex;
+}
+
+// The program is copied out of the image and checked before any of its indexes are followed
+int ReadRegexProgram(ImageReader* reader, NDR_Regex* regex){
+    size_t size = ReadSize(reader);
+    const char* data = ReadArray(reader, size, 1);
+    if(data == NULL || size < sizeof(NDR_RegexProgram))
+        return 1;
+
+    regex->program = malloc(size);
+    memcpy(regex->program, data, size);
+    // Only the start instruction of an empty regex can be left without a first child for the matcher to follow
+    if(NDR_IsRegexProgramValid(regex->program, size) == false ||
+       (regex->isEmpty == false && regex->program->instructions[0].numberOfChildren == 0)){
+        free(regex->program);
+        regex->program = NULL;
+        return 1;
+    }
+    return 0;
+}
+
+NDR_RegexNFA* ReadRegexNFA(ImageReader* reader){
+    NDR_RegexNFA* nfa = malloc(sizeof(NDR_RegexNFA));
+    NDR_InitRegexNFA(nfa);
+
+    size_t flags = ReadSize(reader);
+    nfa->valid = (flags & 1) != 0;
+    nfa->beginString = (flags & 2) != 0;
+    nfa->endString = (flags & 4) != 0;
+    nfa->start = ReadSize(reader);
+    size_t numInstructions = ReadSize(reader);
+    if(numInstructions > reader->length)
+        reader->failed = true;
+    const size_t* instructions = ReadArray(reader, numInstructions * 4, sizeof(size_t));
+    size_t numClasses = ReadSize(reader);
+    if(numClasses > reader->length)
+        reader->failed = true;
+    const unsigned char* classes = ReadArray(reader, numClasses * NDR_NFA_CLASSBYTES, 1);
+    if(instructions == NULL || classes == NULL || (numInstructions > 0 && nfa->start >= numInstructions)){
+        NDR_DestroyRegexNFA(nfa);
+        free(nfa);
+        reader->failed = true;
+        return NULL;
+    }
+
+    if(numInstructions > nfa->memoryAllocated){
+        nfa->memoryAllocated = numInstructions;
+        nfa->instructions = realloc(nfa->instructions, sizeof(NDR_NFAInstruction) * nfa->memoryAllocated);
+    }
+    for(size_t x = 0; x < numInstructions; x++){
+        const size_t* instruction = instructions + (x * 4);
+        if(instruction[0] > NDR_NFA_MATCH || instruction[2] >= numInstructions || instruction[3] >= numInstructions ||
+           (instruction[0] == NDR_NFA_CHAR && instruction[1] >= numClasses))
+            reader->failed = true;
+        nfa->instructions[x].operation = (NDR_NFAOperation) instruction[0];
+        nfa->instructions[x].charClass = instruction[1];
+        nfa->instructions[x].next = instruction[2];
+        nfa->instructions[x].alternate = instruction[3];
+    }
+    nfa->numInstructions = numInstructions;
+
+    if(numClasses > nfa->classMemoryAllocated){
+        nfa->classMemoryAllocated = numClasses;
+        nfa->classes = realloc(nfa->classes, NDR_NFA_CLASSBYTES * nfa->classMemoryAllocated);
+    }
+    if(numClasses > 0)
+        memcpy(nfa->classes, classes, NDR_NFA_CLASSBYTES * numClasses);
+    nfa->numClasses = numClasses;
+
+    if(reader->failed == true){
+        NDR_DestroyRegexNFA(nfa);
+        free(nfa);
+        return NULL;
+    }
+    return nfa;
+}
+
+// The tables of a loaded automaton refer to the image and are not copied
+NDR_LexerDFA* ReadLexerDFA(ImageReader* reader, size_t numRegexStates, size_t numModes){
+    if(ReadSize(reader) == 0)
+        return NULL;
+
+    size_t numStates = ReadSize(reader);
+    size_t numByteClasses = ReadSize(reader);
+    if(numStates > reader->length || numByteClasses == 0 || numByteClasses > 256){
+        reader->failed = true;
+        return NULL;
+    }
+    const size_t* byteClasses = ReadArray(reader, 256, sizeof(size_t));
+    const size_t* transitions = ReadArray(reader, numStates * numByteClasses, sizeof(size_t));
+    const int* acceptingRule = ReadArray(reader, numStates, sizeof(int));
+    const size_t* numCompleteMatches = ReadArray(reader, numStates, sizeof(size_t));
+    const size_t* startStates = ReadArray(reader, numModes, sizeof(size_t));
+    if(reader->failed == true || numStates <= NDR_LEXERDFA_STARTSTATE ||
+       AreTablesValid(transitions, acceptingRule, numCompleteMatches, numStates, numByteClasses, byteClasses, numRegexStates) == false){
+        reader->failed = true;
+        return NULL;
+    }
+    for(size_t x = 0; x < numModes; x++){
+        if(startStates[x] >= numStates){
+            reader->failed = true;
+            return NULL;
+        }
+    }
+
+    NDR_LexerDFA* dfa = malloc(sizeof(NDR_LexerDFA));
+    NDR_InitLexerDFA(dfa);
+    dfa->ownsTables = false;
+    dfa->numStates = numStates;
+    dfa->memoryAllocated = numStates;
+    dfa->numByteClasses = numByteClasses;
+    memcpy(dfa->byteClasses, byteClasses, sizeof(dfa->byteClasses));
+    dfa->transitions = (size_t*) transitions;
+    dfa->acceptingRule = (int*) acceptingRule;
+    dfa->numCompleteMatches = (size_t*) numCompleteMatches;
+    dfa->numModes = numModes;
+    dfa->startStates = (size_t*) startStates;
+    return dfa;
+}
+
+NDR_LexerTrie* ReadLexerTrie(ImageReader* reader, size_t numRegexStates, size_t numModes){
+    if(ReadSize(reader) == 0)
+        return NULL;
+
+    size_t numNodes = ReadSize(reader);
+    size_t numLiterals = ReadSize(reader);
+    size_t numTrieModes = ReadSize(reader);
+    size_t numByteClasses = ReadSize(reader);
+    if(numNodes > reader->length || numTrieModes != numModes || numByteClasses == 0 || numByteClasses > 256){
+        reader->failed = true;
+        return NULL;
+    }
+    const size_t* byteClasses = ReadArray(reader, 256, sizeof(size_t));
+    const size_t* transitions = ReadArray(reader, numNodes * numByteClasses, sizeof(size_t));
+    const int* acceptingRule = ReadArray(reader, numNodes, sizeof(int));
+    const size_t* numCompleteMatches = ReadArray(reader, numNodes, sizeof(size_t));
+    if(reader->failed == true || numNodes <= NDR_LEXERTRIE_ROOTNODE + numModes - 1 ||
+       AreTablesValid(transitions, acceptingRule, numCompleteMatches, numNodes, numByteClasses, byteClasses, numRegexStates) == false){
+        reader->failed = true;
+        return NULL;
+    }
+
+    NDR_LexerTrie* trie = malloc(sizeof(NDR_LexerTrie));
+    NDR_InitLexerTrie(trie);
+    trie->ownsTables = false;
+    trie->numNodes = numNodes;
+    trie->memoryAllocated = numNodes;
+    trie->numLiterals = numLiterals;
+    trie->numModes = numModes;
+    trie->numByteClasses = numByteClasses;
+    memcpy(trie->byteClasses, byteClasses, sizeof(trie->byteClasses));
+    trie->transitions = (size_t*) transitions;
+    trie->acceptingRule = (int*) acceptingRule;
+    trie->numCompleteMatches = (size_t*) numCompleteMatches;
+    return trie;
+}
+
+// Every transition has to lead to a state of the table and every accepting rule has to be a regex state so that a damaged image cannot be followed out of bounds
+bool AreTablesValid(const size_t* transitions, const int* acceptingRule, const size_t* numCompleteMatches, size_t numStates, size_t numByteClasses, const size_t* byteClasses, size_t numRegexStates){
+    for(size_t x = 0; x < 256; x++){
+        if(byteClasses[x] >= numByteClasses)
+            return false;
+    }
+    for(size_t x = 0; x < numStates * numByteClasses; x++){
+        if(transitions[x] >= numStates)
+            return false;
+    }
+    for(size_t x = 0; x < numStates; x++){
+        if(acceptingRule[x] < -1 || (acceptingRule[x] >= 0 && (size_t) acceptingRule[x] >= numRegexStates))
+            return false;
+        // A state without an accepting rule has no complete match for the lexer to report
+        if((acceptingRule[x] == -1) != (numCompleteMatches[x] == 0))
+            return false;
+    }
+    return true;
+}
+
+// Files are mapped where possible. NDR_MapFile reads in text mode where it cannot map, so the file is read in binary mode on Windows
+int NDR_MapBinaryFile(char* fileName, NDR_MappedFile* image){
+#ifdef _WIN32
+    FILE* imageFile = fopen(fileName, "rb");
+    if(imageFile == NULL)
+        return 1;
+    size_t memoryAllocated = 4096;
+    image->data = malloc(memoryAllocated);
+    image->length = 0;
+    image->mapped = false;
+    size_t numRead;
+    while((numRead = fread(image->data + image->length, 1, memoryAllocated - image->length, imageFile)) > 0){
+        image->length += numRead;
+        if(image->length == memoryAllocated){
+            memoryAllocated = memoryAllocated * 2;
+            image->data = realloc(image->data, memoryAllocated);
+        }
+    }
+    fclose(imageFile);
+    return 0;
+#else
+    return NDR_MapFile(fileName, image);
+#endif
+}
+
+// Give every regex the Pike VM as it would have been given when configuring from the lexer configuration file
+int RequirePikeVM(NDR_RegexStateWrapper* regexStateWrapper){
+    for(size_t x = 0; x < NDR_RSGetNumberOfStates(regexStateWrapper); x++){
+        NDR_RegexState* regexState = NDR_RSGetRegexState(regexStateWrapper, x);
+        if(NDR_RSGetEngine(regexState) == NDR_REGEX_ENGINE_BACKTRACK || NDR_SetStateRegexEngine(regexState, NDR_REGEX_ENGINE_PIKEVM) != NULL)
+            return 1;
+        NDR_RSSetEngine(regexState, NDR_REGEX_ENGINE_PIKEVM);
+    }
+    return 0;
+}
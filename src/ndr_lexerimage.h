@@ -0,0 +1,94 @@
+
+/*********************************************************************************
+*                                NDR Lexer Image                                 *
+**********************************************************************************/
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Neil Runcie
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef NDRLEXERIMAGE_H
+#define NDRLEXERIMAGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ndr_context.h"
+
+// Incremented whenever the layout of a lexer image changes so that images written by other versions are rejected
+#define NDR_LEXERIMAGE_VERSION 5
+// The starting value of NDR_HashBytes
+#define NDR_HASH_SEED 14695981039346656037ULL
+
+/** @brief Write the compiled lexer configuration of the default context to a lexer image, see NDR_Context_SaveLexerImage
+*
+* @param fileName is the name of the image file to be written
+* @return The success status of the function. 0 for success and non-zero for error
+*/
+int NDR_SaveLexerImage(char* fileName);
+/** @brief Write the compiled lexer configuration of a context to a lexer image
+*
+* The image holds the symbol table with its compiled regexes, the state byte tables, the combined automaton, the literal trie and the settings of the configuration file.
+* It records a hash of the configuration file so that NDR_Context_LoadLexerImage can tell when the image is out of date.
+* Every reference within the image is an index or an offset, so the image does not depend on where it is loaded
+*
+* @param context is an NDR_Context structure that has completed lexer configuration
+* @param fileName is the name of the image file to be written
+* @return The success status of the function. 0 for success and non-zero for error
+*/
+int NDR_Context_SaveLexerImage(NDR_Context* context, char* fileName);
+/** @brief Configure the lexer of the default context from a lexer image, see NDR_Context_LoadLexerImage
+*
+* @param fileName is the name of an image file written by NDR_SaveLexerImage
+* @param configFileName is the name of the lexer configuration file the image was written from
+* @return The success status of the function. 0 for success and non-zero for error
+*/
+int NDR_LoadLexerImage(char* fileName, char* configFileName);
+/** @brief Configure the lexer of a context from a lexer image instead of compiling the configuration file
+*
+* The image is mapped into memory and the combined automaton and literal trie are used from the mapping directly, while the regexes are rebuilt from their stored graphs without being compiled again.
+* The image is only used when it was written by this version of the library on a machine of the same word size and byte order, and the hash of configFileName matches the one it records.
+* When the image cannot be used the context is left unconfigured, so the lexer can still be configured with NDR_Context_Configure_Lexer and the image written again
+*
+* @param context is an initialized NDR_Context structure that has not been configured
+* @param fileName is the name of an image file written by NDR_Context_SaveLexerImage
+* @param configFileName is the name of the lexer configuration file the image was written from
+* @return The success status of the function. 0 for success and non-zero for error
+*/
+int NDR_Context_LoadLexerImage(NDR_Context* context, char* fileName, char* configFileName);
+
+// Continue an FNV-1a hash started with NDR_HASH_SEED over length more bytes of data
+uint64_t NDR_HashBytes(uint64_t hash, const void* data, size_t length);
+// Hash the contents of a file. Returns 0 on success and non-zero when the file cannot be read
+int NDR_HashFile(char* fileName, uint64_t* hash);
+// Map a file written in binary mode such as a lexer image. Returns 0 on success and non-zero when the file cannot be read
+int NDR_MapBinaryFile(char* fileName, NDR_MappedFile* image);
+
+#endif
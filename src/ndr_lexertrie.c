@@ -0,0 +1,209 @@
+
+/*********************************************************************************
+*                                 NDR Lexer Trie                                 *
+**********************************************************************************/
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Neil Runcie
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "ndr_lexertrie.h"
+#include "ndr_regexstate.h"
+#include "regex_engines/ndr_regex.h"
+#include "regex_engines/ndr_regexnfa.h"
+
+// Declaration of a literal start regex waiting to be inserted into the trie
+typedef struct TrieLiteral {
+    char* literal;
+    // rule is the regex state index the literal belongs to
+    int rule;
+    // modes holds the lexer modes the literal is matched in
+    uint64_t modes;
+} TrieLiteral;
+
+static char* GetRegexLiteral(NDR_Regex* regex);
+static void AddTrieNode(NDR_LexerTrie* trie);
+
+
+void NDR_InitLexerTrie(NDR_LexerTrie* trie){
+    trie->numNodes = 0;
+    trie->memoryAllocated = 0;
+    trie->numLiterals = 0;
+    trie->numModes = 0;
+    trie->numByteClasses = 0;
+    memset(trie->byteClasses, 0, sizeof(trie->byteClasses));
+    trie->transitions = NULL;
+    trie->acceptingRule = NULL;
+    trie->numCompleteMatches = NULL;
+    trie->ownsTables = true;
+}
+
+void NDR_FreeLexerTrie(NDR_LexerTrie* trie){
+    if(trie->ownsTables == true){
+        free(trie->transitions);
+        free(trie->acceptingRule);
+        free(trie->numCompleteMatches);
+    }
+    NDR_InitLexerTrie(trie);
+}
+
+bool NDR_LexerTrieHoldsRegex(NDR_Regex* regex){
+    char* literal = GetRegexLiteral(regex);
+    free(literal);
+    return literal != NULL;
+}
+
+size_t NDR_LexerTrieStep(NDR_LexerTrie* trie, size_t node, char ch){
+    return trie->transitions[(node * trie->numByteClasses) + trie->byteClasses[(unsigned char) ch]];
+}
+
+int NDR_LexerTrieGetAcceptingRule(NDR_LexerTrie* trie, size_t node){
+    return trie->acceptingRule[node];
+}
+
+size_t NDR_LexerTrieGetNumCompleteMatches(NDR_LexerTrie* trie, size_t node){
+    return trie->numCompleteMatches[node];
+}
+
+size_t NDR_LexerTrieGetRootNode(NDR_LexerTrie* trie, int mode){
+    (void) trie;
+    return NDR_LEXERTRIE_ROOTNODE + (size_t) mode;
+}
+
+// Build the trie from the literal of every start regex that only matches one fixed string
+// Each node records the lowest regex state index whose literal ends there so the rule order priority of the lexer is kept
+int NDR_BuildLexerTrie(NDR_LexerTrie* trie, NDR_RegexStateWrapper* regexStateWrapper){
+
+    NDR_FreeLexerTrie(trie);
+
+    size_t numLiterals = 0;
+    size_t memoryAllocated = 10;
+    TrieLiteral* literals = malloc(sizeof(TrieLiteral) * memoryAllocated);
+
+    for(size_t x = 0; x < NDR_RSGetNumberOfStates(regexStateWrapper); x++){
+        NDR_RegexState* regexState = NDR_RSGetRegexState(regexStateWrapper, x);
+        for(size_t i = 0; i < NDR_RSGetNumStartStates(regexState); i++){
+            char* literal = GetRegexLiteral(regexState->compiledStartRegex[i]);
+            if(literal == NULL)
+                continue;
+
+            if(numLiterals >= memoryAllocated){
+                memoryAllocated = memoryAllocated * 2;
+                literals = realloc(literals, sizeof(TrieLiteral) * memoryAllocated);
+            }
+            literals[numLiterals].literal = literal;
+            literals[numLiterals].rule = (int) x;
+            literals[numLiterals].modes = NDR_RSGetModes(regexState);
+            numLiterals++;
+        }
+    }
+
+    if(numLiterals == 0){
+        free(literals);
+        return 1;
+    }
+
+    // Only bytes found within a literal need their own class, every other byte leads straight to the dead node
+    trie->numByteClasses = 1;
+    for(size_t x = 0; x < numLiterals; x++){
+        for(unsigned char* ch = (unsigned char*) literals[x].literal; *ch != '\0'; ch++){
+            if(trie->byteClasses[*ch] == 0)
+                trie->byteClasses[*ch] = trie->numByteClasses++;
+        }
+    }
+
+    // The dead node is followed by the root node of every mode
+    trie->numModes = NDR_RSGetNumberOfModes(regexStateWrapper);
+    for(size_t x = 0; x <= trie->numModes; x++)
+        AddTrieNode(trie);
+
+    // A literal matched in several modes is inserted below the root node of each of them
+    for(size_t x = 0; x < numLiterals; x++){
+        for(size_t mode = 0; mode < trie->numModes; mode++){
+            if((literals[x].modes & ((uint64_t) 1 << mode)) == 0)
+                continue;
+
+            size_t node = NDR_LEXERTRIE_ROOTNODE + mode;
+            for(unsigned char* ch = (unsigned char*) literals[x].literal; *ch != '\0'; ch++){
+                size_t transition = (node * trie->numByteClasses) + trie->byteClasses[*ch];
+                if(trie->transitions[transition] == NDR_LEXERTRIE_DEADNODE){
+                    AddTrieNode(trie);
+                    trie->transitions[transition] = trie->numNodes - 1;
+                }
+                node = trie->transitions[transition];
+            }
+
+            // Literals are visited in regex state order so the first rule to end at a node keeps it
+            if(trie->acceptingRule[node] == -1)
+                trie->acceptingRule[node] = literals[x].rule;
+            trie->numCompleteMatches[node]++;
+        }
+
+        free(literals[x].literal);
+    }
+    trie->numLiterals = numLiterals;
+
+    free(literals);
+
+    return 0;
+}
+
+// Get the string matched by a start regex as a newly allocated string or NULL when it is not a literal
+char* GetRegexLiteral(NDR_Regex* regex){
+    if(NDR_Regex_IsCompiled(regex) == false || NDR_Regex_GetNFA(regex) == NULL)
+        return NULL;
+    return NDR_NFAGetLiteral(NDR_Regex_GetNFA(regex));
+}
+
+// Add a node with every transition leading to the dead node
+void AddTrieNode(NDR_LexerTrie* trie){
+    if(trie->memoryAllocated == 0){
+        trie->memoryAllocated = 50;
+        trie->transitions = malloc(sizeof(size_t) * trie->numByteClasses * trie->memoryAllocated);
+        trie->acceptingRule = malloc(sizeof(int) * trie->memoryAllocated);
+        trie->numCompleteMatches = malloc(sizeof(size_t) * trie->memoryAllocated);
+    }
+    else if(trie->numNodes >= trie->memoryAllocated - 5){
+        trie->memoryAllocated = trie->memoryAllocated * 2;
+        trie->transitions = realloc(trie->transitions, sizeof(size_t) * trie->numByteClasses * trie->memoryAllocated);
+        trie->acceptingRule = realloc(trie->acceptingRule, sizeof(int) * trie->memoryAllocated);
+        trie->numCompleteMatches = realloc(trie->numCompleteMatches, sizeof(size_t) * trie->memoryAllocated);
+    }
+    for(size_t x = 0; x < trie->numByteClasses; x++)
+        trie->transitions[(trie->numNodes * trie->numByteClasses) + x] = NDR_LEXERTRIE_DEADNODE;
+    trie->acceptingRule[trie->numNodes] = -1;
+    trie->numCompleteMatches[trie->numNodes] = 0;
+    trie->numNodes++;
+}
@@ -0,0 +1,90 @@
+
+/*********************************************************************************
+*                                 NDR Lexer Trie                                 *
+**********************************************************************************/
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Neil Runcie
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef NDRLEXERTRIE_H
+#define NDRLEXERTRIE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "ndr_regexstate.h"
+
+// The node reached once no literal start regex can match the current token anymore
+#define NDR_LEXERTRIE_DEADNODE 0
+// The node used at the beginning of every token of the initial lexer mode, every other mode has its own root node following it
+#define NDR_LEXERTRIE_ROOTNODE 1
+
+// Declaration of the byte trie serving every start regex that only matches one fixed string
+typedef struct NDR_LexerTrie {
+    size_t numNodes;
+    size_t memoryAllocated;
+    // numLiterals is the number of start regexes held within the trie
+    size_t numLiterals;
+    // numModes is the number of lexer modes, the literals of each mode hang from its own root node
+    size_t numModes;
+    // byteClasses maps every byte used by a literal onto its own class and every other byte onto class 0
+    size_t numByteClasses;
+    size_t byteClasses[256];
+    // transitions holds numByteClasses entries for each node
+    size_t* transitions;
+    // acceptingRule holds the lowest regex state index whose literal ends at each node or -1 when no literal ends there
+    int* acceptingRule;
+    // numCompleteMatches holds the number of literal start regexes ending at each node
+    size_t* numCompleteMatches;
+    // ownsTables is false when the tables refer to a loaded lexer image and must not be freed
+    bool ownsTables;
+} NDR_LexerTrie;
+
+// Utility function to initialize an empty trie
+void NDR_InitLexerTrie(NDR_LexerTrie* trie);
+// Build the trie from every literal start regex within the wrapper, with a root node for every lexer mode. Returns 0 on success and non-zero when no start regex is a literal
+int NDR_BuildLexerTrie(NDR_LexerTrie* trie, NDR_RegexStateWrapper* regexStateWrapper);
+// Utility function to free the memory allocated to items within the trie
+void NDR_FreeLexerTrie(NDR_LexerTrie* trie);
+
+// Get whether a start regex only matches one fixed string and is served by the trie instead of the regex matchers
+bool NDR_LexerTrieHoldsRegex(NDR_Regex* regex);
+
+// Get the node reached from "node" after reading the character "ch"
+size_t NDR_LexerTrieStep(NDR_LexerTrie* trie, size_t node, char ch);
+// Get the regex state index that wins the complete match at "node" or -1 when no literal ends there
+int NDR_LexerTrieGetAcceptingRule(NDR_LexerTrie* trie, size_t node);
+// Get the number of literal start regexes ending at "node"
+size_t NDR_LexerTrieGetNumCompleteMatches(NDR_LexerTrie* trie, size_t node);
+// Get the node used at the beginning of every token of the lexer mode "mode"
+size_t NDR_LexerTrieGetRootNode(NDR_LexerTrie* trie, int mode);
+
+#endif
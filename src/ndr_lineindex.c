@@ -0,0 +1,115 @@
+
+
+/*********************************************************************************
+*                                 NDR Line Index                                 *
+**********************************************************************************/
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Neil Runcie
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ndr_lineindex.h"
+
+static void AddLineStart(NDR_LineIndex* lineIndex, size_t offset);
+static size_t FindLine(NDR_LineIndex* lineIndex, size_t offset);
+
+void NDR_InitLineIndex(NDR_LineIndex* lineIndex){
+    lineIndex->memoryAllocated = 50;
+    lineIndex->lineStarts = malloc(sizeof(size_t) * lineIndex->memoryAllocated);
+    NDR_ResetLineIndex(lineIndex);
+}
+
+void NDR_FreeLineIndex(NDR_LineIndex* lineIndex){
+    free(lineIndex->lineStarts);
+}
+
+void NDR_ResetLineIndex(NDR_LineIndex* lineIndex){
+    lineIndex->lineStarts[0] = 0;
+    lineIndex->numLines = 1;
+    lineIndex->firstLine = 1;
+    lineIndex->scannedLength = 0;
+}
+
+void NDR_LineIndexAddText(NDR_LineIndex* lineIndex, const char* data, size_t length){
+    const char* end = data + length;
+    const char* newline = data;
+    while(newline < end && (newline = memchr(newline, '\n', (size_t) (end - newline))) != NULL){
+        newline++;
+        AddLineStart(lineIndex, lineIndex->scannedLength + (size_t) (newline - data));
+    }
+    lineIndex->scannedLength += length;
+}
+
+void NDR_LineIndexDiscardBefore(NDR_LineIndex* lineIndex, size_t offset){
+    size_t line = FindLine(lineIndex, offset);
+    // The kept lines are only moved once at least as many can be dropped so each line is moved a bounded number of times
+    if(line == 0 || line < lineIndex->numLines - line)
+        return;
+    memmove(lineIndex->lineStarts, &lineIndex->lineStarts[line], sizeof(size_t) * (lineIndex->numLines - line));
+    lineIndex->numLines -= line;
+    lineIndex->firstLine += line;
+}
+
+size_t NDR_LineIndexGetLine(NDR_LineIndex* lineIndex, size_t offset){
+    return lineIndex->firstLine + FindLine(lineIndex, offset);
+}
+
+size_t NDR_LineIndexGetColumn(NDR_LineIndex* lineIndex, size_t offset){
+    size_t lineStart = lineIndex->lineStarts[FindLine(lineIndex, offset)];
+    if(offset < lineStart)
+        return 1;
+    return offset - lineStart + 1;
+}
+
+void AddLineStart(NDR_LineIndex* lineIndex, size_t offset){
+    if(lineIndex->numLines > lineIndex->memoryAllocated - 5){
+        lineIndex->memoryAllocated = lineIndex->memoryAllocated * 2;
+        lineIndex->lineStarts = realloc(lineIndex->lineStarts, sizeof(size_t) * lineIndex->memoryAllocated);
+    }
+    lineIndex->lineStarts[lineIndex->numLines] = offset;
+    lineIndex->numLines++;
+}
+
+// Returns the index in lineStarts of the last line that starts at or before offset, or 0 when offset is before every line kept
+size_t FindLine(NDR_LineIndex* lineIndex, size_t offset){
+    size_t first = 0;
+    size_t last = lineIndex->numLines;
+    while(last - first > 1){
+        size_t middle = first + (last - first) / 2;
+        if(lineIndex->lineStarts[middle] <= offset)
+            first = middle;
+        else
+            last = middle;
+    }
+    return first;
+}
@@ -0,0 +1,100 @@
+
+
+/*********************************************************************************
+*                                 NDR Line Index                                 *
+**********************************************************************************/
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Neil Runcie
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef NDRLINEINDEX_H
+#define NDRLINEINDEX_H
+
+#include <stddef.h>
+
+/**
+* @struct NDR_LineIndex
+* @brief The offsets at which the lines of an input start, used to find the line and column of a token from its offset
+*/
+typedef struct NDR_LineIndex {
+    // lineStarts[x] is the offset of the first character of line firstLine + x
+    size_t* lineStarts;
+    size_t numLines;
+    size_t memoryAllocated;
+    size_t firstLine;
+    // scannedLength is the number of bytes of the input that have been searched for newlines
+    size_t scannedLength;
+} NDR_LineIndex;
+
+/** @brief Initialize an NDR_LineIndex structure for an input that has not been scanned yet
+*
+* @param lineIndex is a structure that has memory allocated to it
+*/
+void NDR_InitLineIndex(NDR_LineIndex* lineIndex);
+/** @brief Free the memory held by an NDR_LineIndex structure
+*
+* @param lineIndex is an initialized NDR_LineIndex structure
+*/
+void NDR_FreeLineIndex(NDR_LineIndex* lineIndex);
+/** @brief Empty an NDR_LineIndex structure so that it can be used for another input
+*
+* @param lineIndex is an initialized NDR_LineIndex structure
+*/
+void NDR_ResetLineIndex(NDR_LineIndex* lineIndex);
+/** @brief Record the lines started by the next bytes of the input
+*
+* @param lineIndex is an initialized NDR_LineIndex structure
+* @param data holds the bytes of the input that follow the bytes already scanned
+* @param length is the number of bytes found in data
+*/
+void NDR_LineIndexAddText(NDR_LineIndex* lineIndex, const char* data, size_t length);
+/** @brief Forget the lines that end before an offset so the index of an unbounded input stays small
+*
+* @param lineIndex is an initialized NDR_LineIndex structure
+* @param offset is the first offset whose position can still be found afterwards
+*/
+void NDR_LineIndexDiscardBefore(NDR_LineIndex* lineIndex, size_t offset);
+/** @brief Get the line number of an offset of the input
+*
+* @param lineIndex is an NDR_LineIndex structure that has scanned the input up to offset
+* @param offset is the position of a character in the input
+* @return The line number, counted from 1
+*/
+size_t NDR_LineIndexGetLine(NDR_LineIndex* lineIndex, size_t offset);
+/** @brief Get the column number of an offset of the input
+*
+* @param lineIndex is an NDR_LineIndex structure that has scanned the input up to offset
+* @param offset is the position of a character in the input
+* @return The column number, counted in bytes from 1
+*/
+size_t NDR_LineIndexGetColumn(NDR_LineIndex* lineIndex, size_t offset);
+
+#endif
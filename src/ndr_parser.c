@@ -38,6 +38,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <stdlib.h>
 #include <string.h>
 #include "ndr_parser.h"
+#include "ndr_context.h"
 #include "ndr_sequenceinformation.h"
 #include "ndr_asttokeninformation.h"
 #include "ndr_matchstate.h"
@@ -69,12 +70,12 @@ typedef struct SequenceMatchingState{
 static void InitializeSequenceMatchingState(SequenceMatchingState* matchingState);
 static void DestroySequenceMatchingState(SequenceMatchingState* matchingState);
 static void addStringToSequence(SequenceMatchingState* matchingState, char* src);
-static void AcknowledgePotentialSequence(SequenceMatchingState* matchingState, int treeIndex, int patternIndex);
+static void AcknowledgePotentialSequence(NDR_Context* context, SequenceMatchingState* matchingState, int treeIndex, int patternIndex);
 static void AcknowledgeCompleteSequence(SequenceMatchingState* matchingState);
 static void CapturePotentialSequence(SequenceMatchingState* matchingState, char* sequence);
 static char* GetCapturedSequence(SequenceMatchingState* matchingState);
-static bool IsPotentialSequence(SequenceMatchingState* matchingState, int RSIndex);
-static bool IsPartialSequence(SequenceMatchingState* matchingState, int RSIndex);
+static bool IsPotentialSequence(NDR_Context* context, SequenceMatchingState* matchingState, int RSIndex);
+static bool IsPartialSequence(NDR_Context* context, SequenceMatchingState* matchingState, int RSIndex);
 static bool IsPotentialSequenceWrong(SequenceMatchingState* matchingState);
 static bool IsCompleteSequence(SequenceMatchingState* matchingState);
 
@@ -83,41 +84,36 @@ static void AcknowledgeFoundKeyword(PStateRepresentation* pStateRepresentation);
 static void AcknowledgeTokenSeparator(PStateRepresentation* pStateRepresentation);
 static void AcknowledgeFoundToken(PStateRepresentation* pStateRepresentation);
 
-static bool compareTokenToParsingTable();
-static void condenseTable(int startingIndex, int amount, char* ID);
-bool IsTokenEligibleToBeID(char* token);
-static bool isTokenInTable(char* token);
-static bool verifyParseTokens(char* token, char* currentToken, PStateRepresentation* PSRep);
+static bool compareTokenToParsingTable(NDR_Context* context);
+static void condenseTable(NDR_Context* context, int startingIndex, int amount, char* ID);
+static NDR_ASTNode* NewASTNode(NDR_Context* context);
+bool IsTokenEligibleToBeID(NDR_Context* context, char* token);
+static bool isTokenInTable(NDR_Context* context, char* token);
+static bool verifyParseTokens(NDR_Context* context, char* token, char* currentToken, PStateRepresentation* PSRep);
 static void findEscapedParsing(char* string, int* indices);
 static void removeColonEscape(char* string);
 //static bool validateID(char* ID);
-static bool findParseID(char* ID);
+static bool findParseID(NDR_Context* context, char* ID);
 static bool sContainsInt(int* arr, int index);
 //static bool isEntryADuplicate(char* entry);
 //static int getLongestParseSequence();
-static void copyTTToMT();
-
-static bool configuringAttempted = false;
-static bool parsingAttempted = false;
-static bool configuringCompleted = false;
-static bool parsingCompleted = false;
-
-static NDR_SequenceInformationWrapper* PIWrapper = NULL;
-extern NDR_TokenInformationWrapper* TIWrapper;
-static NDR_TreeTokenInfoWrapper* TTIWrapper = NULL;
-static NDR_ASTNodeHolder* NWrapper;
-// head refers to the top level node in the syntax tree
+static void copyTTToMT(NDR_Context* context, NDR_TreeTokenInfoWrapper* tokenInfoWrapper);
+
+// NDR_ASThead refers to the top level node in the syntax tree built with the default context
 NDR_ASTNode* NDR_ASThead;
 
 
-// The Parse function is the driver for the Parser and should be called after Lex
 int NDR_Configure_Parser(char* fileName){
+    return NDR_Context_Configure_Parser(NDR_GetDefaultContext(), fileName);
+}
 
-    if(configuringAttempted == true){
+int NDR_Context_Configure_Parser(NDR_Context* context, char* fileName){
+
+    if(context->parserConfiguringAttempted == true){
         printf("\nParser configuration has already been performed\n");
         return 1;
     }
-    configuringAttempted = true;
+    context->parserConfiguringAttempted = true;
 
     if(fileName == NULL || strcmp(fileName, "") == 0){
         printf("A non-empty filename must be provided for lexer configuration\n");
@@ -136,8 +132,8 @@ int NDR_Configure_Parser(char* fileName){
         return 1;
     }
 
-    PIWrapper = malloc(sizeof(NDR_SequenceInformationWrapper));
-    NDR_InitSequenceInfoWrapper(PIWrapper);
+    context->PIWrapper = malloc(sizeof(NDR_SequenceInformationWrapper));
+    NDR_InitSequenceInfoWrapper(context->PIWrapper);
     PStateRepresentation* PSRepresentation = malloc(sizeof(PStateRepresentation));
     InitializePSR(PSRepresentation);
 
@@ -155,14 +151,14 @@ int NDR_Configure_Parser(char* fileName){
         }
 
         for(size_t x = 0; x < NDR_GetNumberOfTokens(NDR_GetLine(fileInfo, i)); x++){
-            if(!verifyParseTokens(NDR_GetToken(NDR_GetLine(fileInfo, i), x), currentToken, PSRepresentation)){
+            if(!verifyParseTokens(context, NDR_GetToken(NDR_GetLine(fileInfo, i), x), currentToken, PSRepresentation)){
                 printf("Error parsing parser config file at line %u\n", (unsigned int) parserLineNumber);
                 return 1;
             }
         }
 
-        if(NDR_GetNumberOfSequences(PIWrapper) > 0 && NDR_FindSequenceBeforeLast(PIWrapper, NDR_GetLastSequenceInfo(PIWrapper)->sequence) != -1){
-            printf("A duplicate parsing string \"%s\" has been found on line %u\n", NDR_GetLastSequenceInfo(PIWrapper)->sequence, (unsigned int) PIWrapper->numSequences);
+        if(NDR_GetNumberOfSequences(context->PIWrapper) > 0 && NDR_FindSequenceBeforeLast(context->PIWrapper, NDR_GetLastSequenceInfo(context->PIWrapper)->sequence) != -1){
+            printf("A duplicate parsing string \"%s\" has been found on line %u\n", NDR_GetLastSequenceInfo(context->PIWrapper)->sequence, (unsigned int) context->PIWrapper->numSequences);
             return 1;
         }
 
@@ -170,7 +166,7 @@ int NDR_Configure_Parser(char* fileName){
     }
 
     if(PSRepresentation->separatorWasPrevious == true){
-        printf("\nAnother token was expected after \"\\|\" for keyword \"%s\" but it was not found\n", NDR_GetLastSequenceInfo(PIWrapper)->keyword);
+        printf("\nAnother token was expected after \"\\|\" for keyword \"%s\" but it was not found\n", NDR_GetLastSequenceInfo(context->PIWrapper)->keyword);
         return 1;
     }
     else if(PSRepresentation->newPattern == true){
@@ -178,18 +174,18 @@ int NDR_Configure_Parser(char* fileName){
         return 1;
     }
 
-    if(NDR_GetNumberOfSequences(PIWrapper) == 0){
+    if(NDR_GetNumberOfSequences(context->PIWrapper) == 0){
         printf("\nNo parsing sequences were found in the parser configuration file\n");
         return 1;
     }
 
-    if(findParseID("*Accept") == false){
+    if(findParseID(context, "*Accept") == false){
         printf("\n\"*Accept\" token not found\n");
         return 1;
     }
 
     if (NDR_PT == true)
-        NDR_PrintParseTable();
+        NDR_Context_PrintParseTable(context);
 
     fclose(parserConfigFile);
 
@@ -199,7 +195,7 @@ int NDR_Configure_Parser(char* fileName){
 
     free(currentToken);
 
-    configuringCompleted = true;
+    context->parserConfiguringCompleted = true;
 
     if (NDR_STAT == true)
         printf("\nParser configured successfully\n");
@@ -209,38 +205,49 @@ int NDR_Configure_Parser(char* fileName){
 }
 
 
+// The Parse function is the driver for the Parser and should be called after Lex
 int NDR_Parse(){
+    int result = NDR_Context_Parse(NDR_GetDefaultContext());
+    NDR_ASThead = NDR_GetDefaultContext()->ASThead;
+    return result;
+}
+
+int NDR_Context_Parse(NDR_Context* context){
 
-    if(parsingAttempted == true){
-        printf("\nCode file  parsing has already been performed\n");
+    if(context->parsingAttempted == true){
+        printf("\nCode file  parsing has already been performed, reset the input before processing another code file\n");
         return 1;
     }
-    parsingAttempted = true;
-    if(configuringCompleted == false){
+    context->parsingAttempted = true;
+    if(context->parserConfiguringCompleted == false){
         printf("\nParser configuration failed so parsing cannot proceed\n");
         return 1;
     }
 
-    if(TIWrapper == NULL){
+    if(context->TIWrapper == NULL){
         printf("\nCall function \"int Lex(char* fileName)\" to read the source file before calling function \"int Parse()\"\n");
         return 1;
     }
 
-    if(PIWrapper == NULL){
+    if(context->PIWrapper == NULL){
         printf("\nCall function \"int Configure_Parser(char* fileName)\" to setup the parser configuration before calling function \"int Parse()\"\n");
         return 1;
     }
 
     // Copying needed information from the tokenTable and tokenLocationTable to the modifiedTokenTable which will be manipulated during processing
-    TTIWrapper = malloc(sizeof(NDR_TokenInformationWrapper));
-    NDR_InitTreeTokenInfoWrapper(TTIWrapper);
-    NWrapper = malloc(sizeof(NDR_ASTNodeHolder));
-    NDR_InitASTNodeHolder(NWrapper);
-    copyTTToMT(TTIWrapper);
-
-    NDR_ASThead = malloc(sizeof(NDR_ASTNode));
-    if(compareTokenToParsingTable()){
-        parsingCompleted = true;
+    // Both tables are kept by the context and recycled by NDR_Context_ResetInput
+    if(context->TTIWrapper == NULL){
+        context->TTIWrapper = malloc(sizeof(NDR_TreeTokenInfoWrapper));
+        NDR_InitTreeTokenInfoWrapper(context->TTIWrapper);
+    }
+    if(context->NWrapper == NULL){
+        context->NWrapper = malloc(sizeof(NDR_ASTNodeHolder));
+        NDR_InitASTNodeHolder(context->NWrapper);
+    }
+    copyTTToMT(context, context->TTIWrapper);
+
+    if(compareTokenToParsingTable(context)){
+        context->parsingCompleted = true;
         if (NDR_STAT == true)
             printf("\nParsing successful\n");
         return 0;
@@ -252,7 +259,7 @@ int NDR_Parse(){
 }
 
 // verifyParseTokens validates each token seen to make sure the parser config file is valid and registers the tokens in the parseTable
-bool verifyParseTokens(char* token, char* currentToken, PStateRepresentation* PSRep){
+bool verifyParseTokens(NDR_Context* context, char* token, char* currentToken, PStateRepresentation* PSRep){
 
     // if the token is only a newline then return true otherwise remove the newline from the end of the token
     if(strcmp(token, "\n") == 0)
@@ -276,7 +283,7 @@ bool verifyParseTokens(char* token, char* currentToken, PStateRepresentation* PS
         token[strlen(token) - 1] = '\0';
         strcpy(currentToken, token);
         removeColonEscape(currentToken);
-        if(IsTokenEligibleToBeID(currentToken) == false){
+        if(IsTokenEligibleToBeID(context, currentToken) == false){
             printf("The ID \"%s\" has already been seen\n", currentToken);
             return false;
         }
@@ -299,13 +306,13 @@ bool verifyParseTokens(char* token, char* currentToken, PStateRepresentation* PS
     else if(strlen(token) > 0){
         if (PSRep->startedID == true){
             if(PSRep->newPattern == true){
-                NDR_AddNewSequenceTokenInfo(PIWrapper);
-                NDR_SetSTokenInfoKeyword(NDR_GetLastSequenceInfo(PIWrapper), currentToken);
-                NDR_SetSTokenInfoSequence(NDR_GetLastSequenceInfo(PIWrapper), "");
+                NDR_AddNewSequenceTokenInfo(context->PIWrapper);
+                NDR_SetSTokenInfoKeyword(NDR_GetLastSequenceInfo(context->PIWrapper), currentToken);
+                NDR_SetSTokenInfoSequence(NDR_GetLastSequenceInfo(context->PIWrapper), "");
             }
-            NDR_AddToSTokenInfoSequence(NDR_GetLastSequenceInfo(PIWrapper), token);
-            removeColonEscape(NDR_GetLastSequenceInfo(PIWrapper)->sequence);
-            NDR_AddToSTokenInfoSequence(NDR_GetLastSequenceInfo(PIWrapper), " ");
+            NDR_AddToSTokenInfoSequence(NDR_GetLastSequenceInfo(context->PIWrapper), token);
+            removeColonEscape(NDR_GetLastSequenceInfo(context->PIWrapper)->sequence);
+            NDR_AddToSTokenInfoSequence(NDR_GetLastSequenceInfo(context->PIWrapper), " ");
 
             AcknowledgeFoundToken(PSRep);
         }
@@ -322,9 +329,9 @@ bool verifyParseTokens(char* token, char* currentToken, PStateRepresentation* PS
     return true;
 }
 
-bool IsTokenEligibleToBeID(char* token){
-    for(int x = 0; x < NDR_GetNumberOfSequences(PIWrapper); x++){
-        if(strcmp(NDR_GetSequenceInfo(PIWrapper, x)->keyword, token) == 0){
+bool IsTokenEligibleToBeID(NDR_Context* context, char* token){
+    for(int x = 0; x < NDR_GetNumberOfSequences(context->PIWrapper); x++){
+        if(strcmp(NDR_GetSequenceInfo(context->PIWrapper, x)->keyword, token) == 0){
             return false;
         }
     }
@@ -333,42 +340,44 @@ bool IsTokenEligibleToBeID(char* token){
 
 
 // compareTokenToParsingTable compares the current tokens to the parsing table to find the longest full match it can find
-bool compareTokenToParsingTable(){
+bool compareTokenToParsingTable(NDR_Context* context){
 
     SequenceMatchingState* matchingState = malloc(sizeof(SequenceMatchingState));
     InitializeSequenceMatchingState(matchingState);
 
-    size_t originalNumberOfTreeTokens = NDR_GetNumberOfTreeTokens(TTIWrapper);
+    size_t originalNumberOfTreeTokens = NDR_GetNumberOfTreeTokens(context->TTIWrapper);
     size_t nextStep = 0;
 
-    while(memcmp(NDR_GetTreeTokenInfo(TTIWrapper, 0)->tokenInfo->keyword, "*Accept", 6) != 0 || NDR_GetNumberOfTreeTokens(TTIWrapper) != 1){
+    while(memcmp(NDR_GetTreeTokenInfo(context->TTIWrapper, 0)->tokenInfo->keyword, "*Accept", 6) != 0 || NDR_GetNumberOfTreeTokens(context->TTIWrapper) != 1){
         nextStep = 0;
-        for (size_t i = 0; i < NDR_GetNumberOfTreeTokens(TTIWrapper)+1; i++){
+        for (size_t i = 0; i < NDR_GetNumberOfTreeTokens(context->TTIWrapper)+1; i++){
 
-            if(NDR_GetNumberOfTreeTokens(TTIWrapper) == i && NDR_GetNumberOfTreeTokens(TTIWrapper) == originalNumberOfTreeTokens){
+            if(NDR_GetNumberOfTreeTokens(context->TTIWrapper) == i && NDR_GetNumberOfTreeTokens(context->TTIWrapper) == originalNumberOfTreeTokens){
+                DestroySequenceMatchingState(matchingState);
+                free(matchingState);
                 return false;
             }
 
             if(matchingState->highestMatchSeen == NDR_COMP_PARTIALMATCH)
                 matchingState->highestMatchSeen = NDR_COMP_COMPLETEMATCH;
 
-            addStringToSequence(matchingState, NDR_GetTreeTokenInfo(TTIWrapper, i)->tokenInfo->keyword);
+            addStringToSequence(matchingState, NDR_GetTreeTokenInfo(context->TTIWrapper, i)->tokenInfo->keyword);
             addStringToSequence(matchingState, " ");
             matchingState->sequenceNumber++;
 
-            for (size_t x = 0; x < NDR_GetNumberOfSequences(PIWrapper); x++){
-                if(IsPotentialSequence(matchingState, x) == true){
-                    AcknowledgePotentialSequence(matchingState, i, x);
+            for (size_t x = 0; x < NDR_GetNumberOfSequences(context->PIWrapper); x++){
+                if(IsPotentialSequence(context, matchingState, x) == true){
+                    AcknowledgePotentialSequence(context, matchingState, i, x);
                     break;
                 }
-                else if(IsPartialSequence(matchingState, x) == true){
+                else if(IsPartialSequence(context, matchingState, x) == true){
                     matchingState->matched = true;
                 }
             }
 
             if(IsCompleteSequence(matchingState) == true){
 
-                condenseTable(matchingState->startIndex, matchingState->endIndex, GetCapturedSequence(matchingState));
+                condenseTable(context, matchingState->startIndex, matchingState->endIndex, GetCapturedSequence(matchingState));
                 AcknowledgeCompleteSequence(matchingState);
 
                 nextStep = 0;
@@ -391,13 +400,15 @@ bool compareTokenToParsingTable(){
                 matchingState->matched = false;
             }
 
-            if(NDR_GetNumberOfTreeTokens(TTIWrapper) == i){
+            if(NDR_GetNumberOfTreeTokens(context->TTIWrapper) == i){
+                DestroySequenceMatchingState(matchingState);
+                free(matchingState);
                 return false;
             }
 
         }
         if (NDR_TT == true)
-            NDR_PrintModifiedTokenTable();
+            NDR_Context_PrintModifiedTokenTable(context);
     }
 
     DestroySequenceMatchingState(matchingState);
@@ -407,82 +418,96 @@ bool compareTokenToParsingTable(){
 }
 // condenseTable takes the entries in the modifiedTokenTable and consolidates the rows between startingIndex and startingIndex+amount into just one row and moves all of the following rows up by amount to keep the table together
 // A parent node is created and all of the consolidated rows become children of the parent node
-void condenseTable(int startingIndex, int amount, char* ID){
+void condenseTable(NDR_Context* context, int startingIndex, int amount, char* ID){
 
     // Initial creation of the new parent node that will be added into the syntax tree
-    NDR_ASTNode* parent = malloc(sizeof(NDR_ASTNode));
-    NDR_InitASTNode(parent);
+    NDR_ASTNode* parent = NewASTNode(context);
     NDR_SetASTNodeKeyword(parent, ID);
-    NDR_SetASTNodeOrderNumber(parent, NDR_GetNumberOfASTNodes(NWrapper));
+    NDR_SetASTNodeOrderNumber(parent, NDR_GetNumberOfASTNodes(context->NWrapper));
     NDR_SetASTNodeNodeType(parent, 1);
 
     // The loop below adds all nodes that are being grouped together as children nodes of the new parent node
     char* newEntry = malloc(2);
     strcpy(newEntry, "");
     for(int i = startingIndex; i < startingIndex+amount; i++){
-        newEntry = realloc(newEntry, strlen(newEntry) + strlen(NDR_GetTreeTokenInfo(TTIWrapper, i)->tokenInfo->token) + 2);
-        strcat(newEntry, NDR_GetTreeTokenInfo(TTIWrapper, i)->tokenInfo->token);
+        newEntry = realloc(newEntry, strlen(newEntry) + strlen(NDR_GetTreeTokenInfo(context->TTIWrapper, i)->tokenInfo->token) + 2);
+        strcat(newEntry, NDR_GetTreeTokenInfo(context->TTIWrapper, i)->tokenInfo->token);
         strcat(newEntry, " ");
         // If the entry has not corresponding children meaning it has no node associated with it, a new node leaf is created to represent it and it is added to the parent node
-        if(isTokenInTable(NDR_GetTreeTokenInfo(TTIWrapper, i)->tokenInfo->keyword)){
-            NDR_ASTNode* leaf = malloc(sizeof(NDR_ASTNode));
-            NDR_InitASTNode(leaf);
-            NDR_SetASTNodeKeyword(leaf, NDR_GetTreeTokenInfo(TTIWrapper, i)->tokenInfo->keyword);
-            NDR_SetASTNodeToken(leaf, NDR_GetTreeTokenInfo(TTIWrapper, i)->tokenInfo->token);
+        if(isTokenInTable(context, NDR_GetTreeTokenInfo(context->TTIWrapper, i)->tokenInfo->keyword)){
+            NDR_ASTNode* leaf = NewASTNode(context);
+            NDR_SetASTNodeKeyword(leaf, NDR_GetTreeTokenInfo(context->TTIWrapper, i)->tokenInfo->keyword);
+            NDR_SetASTNodeToken(leaf, NDR_GetTreeTokenInfo(context->TTIWrapper, i)->tokenInfo->token);
             NDR_SetASTNodeOrderNumber(leaf, -1);
             NDR_SetASTNodeNodeType(leaf, 0);
-            NDR_SetASTNodeLineNumber(leaf, NDR_GetTreeTokenInfo(TTIWrapper, i)->tokenInfo->lineNumber);
-            NDR_SetASTNodeColumnNumber(leaf, NDR_GetTreeTokenInfo(TTIWrapper, i)->tokenInfo->columnNumber);
+            NDR_SetASTNodePosition(leaf, NDR_GetTreeTokenInfo(context->TTIWrapper, i)->tokenInfo->lineIndex, NDR_GetTreeTokenInfo(context->TTIWrapper, i)->tokenInfo->offset);
 
             NDR_AddChildASTNode(parent, leaf);
-            NDR_IncASTTotalNode(NWrapper);
+            NDR_IncASTTotalNode(context->NWrapper);
         }
         // If the entry has children and has already been allocated a node then the node is searched for and added to the parent node
         else{
-            for(size_t x = 0; x < NWrapper->numNodes; x++){
-                if(NDR_GetTreeTokenInfo(TTIWrapper, i)->nodeNumber == NWrapper->nodes[x]->orderNumber){
-                    NDR_AddChildASTNode(parent, NWrapper->nodes[x]);
+            for(size_t x = 0; x < context->NWrapper->numNodes; x++){
+                if(NDR_GetTreeTokenInfo(context->TTIWrapper, i)->nodeNumber == context->NWrapper->nodes[x]->orderNumber){
+                    NDR_AddChildASTNode(parent, context->NWrapper->nodes[x]);
                     break;
                 }
             }
         }
     }
-    NDR_SetASTNodeLineNumber(parent, NDR_GetTreeTokenInfo(TTIWrapper, startingIndex)->tokenInfo->lineNumber);
-    NDR_SetASTNodeColumnNumber(parent, NDR_GetTreeTokenInfo(TTIWrapper, startingIndex)->tokenInfo->columnNumber);
+    NDR_SetASTNodePosition(parent, NDR_GetTreeTokenInfo(context->TTIWrapper, startingIndex)->tokenInfo->lineIndex, NDR_GetTreeTokenInfo(context->TTIWrapper, startingIndex)->tokenInfo->offset);
     newEntry[strlen(newEntry) - 1] = '\0';
 
     // Updating the modifiedTokenTable so that the entries are still accurate after the nodes are grouped together and the table is consolidated
-    NDR_SetTreeTokenInfoToken(NDR_GetTreeTokenInfo(TTIWrapper, startingIndex), newEntry);
-    NDR_SetTreeTokenInfoKeyword(NDR_GetTreeTokenInfo(TTIWrapper, startingIndex), ID);
-    NDR_GetTreeTokenInfo(TTIWrapper, startingIndex)->nodeNumber = NDR_GetNumberOfASTNodes(NWrapper);
+    NDR_SetTreeTokenInfoToken(NDR_GetTreeTokenInfo(context->TTIWrapper, startingIndex), newEntry);
+    NDR_SetTreeTokenInfoKeyword(NDR_GetTreeTokenInfo(context->TTIWrapper, startingIndex), ID);
+    NDR_GetTreeTokenInfo(context->TTIWrapper, startingIndex)->nodeNumber = NDR_GetNumberOfASTNodes(context->NWrapper);
 
     // For each row being consolidated update the modified token table to accurately reflect the changes
     if(amount > 1){
         size_t x;
-        for(x = (startingIndex+1) ; x + (amount - 1) < NDR_GetNumberOfTreeTokens(TTIWrapper); x++){
-            NDR_SetTreeTokenInfoToken(NDR_GetTreeTokenInfo(TTIWrapper, x), NDR_GetTreeTokenInfo(TTIWrapper, x + (amount - 1))->tokenInfo->token);
-            NDR_SetTreeTokenInfoKeyword(NDR_GetTreeTokenInfo(TTIWrapper, x), NDR_GetTreeTokenInfo(TTIWrapper, x + (amount - 1))->tokenInfo->keyword);
-            NDR_SetTreeTokenInfoLine(NDR_GetTreeTokenInfo(TTIWrapper, x), NDR_GetTreeTokenInfo(TTIWrapper, x + (amount - 1))->tokenInfo->lineNumber);
-            NDR_SetTreeTokenInfoColumn(NDR_GetTreeTokenInfo(TTIWrapper, x), NDR_GetTreeTokenInfo(TTIWrapper, x + (amount - 1))->tokenInfo->columnNumber);
-            NDR_GetTreeTokenInfo(TTIWrapper, x)->nodeNumber = NDR_GetTreeTokenInfo(TTIWrapper, x + (amount - 1))->nodeNumber;
+        for(x = (startingIndex+1) ; x + (amount - 1) < NDR_GetNumberOfTreeTokens(context->TTIWrapper); x++){
+            NDR_SetTreeTokenInfoToken(NDR_GetTreeTokenInfo(context->TTIWrapper, x), NDR_GetTreeTokenInfo(context->TTIWrapper, x + (amount - 1))->tokenInfo->token);
+            NDR_SetTreeTokenInfoKeyword(NDR_GetTreeTokenInfo(context->TTIWrapper, x), NDR_GetTreeTokenInfo(context->TTIWrapper, x + (amount - 1))->tokenInfo->keyword);
+            NDR_SetTreeTokenInfoPosition(NDR_GetTreeTokenInfo(context->TTIWrapper, x), NDR_GetTreeTokenInfo(context->TTIWrapper, x + (amount - 1))->tokenInfo);
+            NDR_GetTreeTokenInfo(context->TTIWrapper, x)->nodeNumber = NDR_GetTreeTokenInfo(context->TTIWrapper, x + (amount - 1))->nodeNumber;
         }
-        TTIWrapper->numTokens = x;
+        context->TTIWrapper->numTokens = x;
     }
 
-    NDR_IncASTTotalNode(NWrapper);
+    NDR_IncASTTotalNode(context->NWrapper);
     // If the token equals *Accept but the modifiedTokenTable is not exhausted, add the parent node to the node array and continue
     // Otherwise, if the token equals *Accept make the parent the head and be done
-    if(NDR_GetNumberOfTreeTokens(TTIWrapper) != 1 || strcmp(ID, "*Accept") != 0){
-        NDR_AddNewASTNode(NWrapper, parent);
+    if(NDR_GetNumberOfTreeTokens(context->TTIWrapper) != 1 || strcmp(ID, "*Accept") != 0){
+        NDR_AddNewASTNode(context->NWrapper, parent);
     }
     else if(strcmp(ID, "*Accept") == 0){
-       NDR_ASThead = parent;
+       context->ASThead = parent;
     }
 
     free(newEntry);
 
 }
 
+// NewASTNode takes a node recycled by NDR_Context_ResetInput when one is available and allocates a new node otherwise
+NDR_ASTNode* NewASTNode(NDR_Context* context){
+    if(context->ASTNodePool == NULL || context->ASTNodePool->numNodes == 0){
+        NDR_ASTNode* node = malloc(sizeof(NDR_ASTNode));
+        NDR_InitASTNode(node);
+        return node;
+    }
+
+    context->ASTNodePool->numNodes--;
+    NDR_ASTNode* node = context->ASTNodePool->nodes[context->ASTNodePool->numNodes];
+    node->token[0] = '\0';
+    node->keyword[0] = '\0';
+    node->orderNumber = 0;
+    node->numberOfChildren = 0;
+    node->nodeType = 0;
+    node->offset = 0;
+    node->lineIndex = NULL;
+    return node;
+}
 
 void InitializeSequenceMatchingState(SequenceMatchingState* matchingState){
     matchingState->allocatedLength = 50;
@@ -514,10 +539,10 @@ void addStringToSequence(SequenceMatchingState* matchingState, char* src){
     strcat(matchingState->currentSequence, src);
 }
 
-void AcknowledgePotentialSequence(SequenceMatchingState* matchingState, int treeIndex, int patternIndex){
+void AcknowledgePotentialSequence(NDR_Context* context, SequenceMatchingState* matchingState, int treeIndex, int patternIndex){
     matchingState->startIndex = (treeIndex+1) - matchingState->sequenceNumber;
     matchingState->endIndex = matchingState->sequenceNumber;
-    CapturePotentialSequence(matchingState, NDR_GetSequenceInfo(PIWrapper, patternIndex)->keyword);
+    CapturePotentialSequence(matchingState, NDR_GetSequenceInfo(context->PIWrapper, patternIndex)->keyword);
     matchingState->matched = true;
     matchingState->matchBeforeLookAhead = true;
     matchingState->highestMatchSeen = NDR_COMP_PARTIALMATCH;
@@ -539,14 +564,14 @@ char* GetCapturedSequence(SequenceMatchingState* matchingState){
     return matchingState->potentialSequence;
 }
 
-bool IsPotentialSequence(SequenceMatchingState* matchingState, int RSIndex){
-    return strlen(matchingState->currentSequence) <= strlen(NDR_GetSequenceInfo(PIWrapper, RSIndex)->sequence) &&
-            strcmp(matchingState->currentSequence, NDR_GetSequenceInfo(PIWrapper, RSIndex)->sequence) == 0;
+bool IsPotentialSequence(NDR_Context* context, SequenceMatchingState* matchingState, int RSIndex){
+    return strlen(matchingState->currentSequence) <= strlen(NDR_GetSequenceInfo(context->PIWrapper, RSIndex)->sequence) &&
+            strcmp(matchingState->currentSequence, NDR_GetSequenceInfo(context->PIWrapper, RSIndex)->sequence) == 0;
 }
 
-bool IsPartialSequence(SequenceMatchingState* matchingState, int RSIndex){
-    return strlen(matchingState->currentSequence) <= strlen(NDR_GetSequenceInfo(PIWrapper, RSIndex)->sequence) &&
-            memcmp(matchingState->currentSequence, NDR_GetSequenceInfo(PIWrapper, RSIndex)->sequence, strlen(matchingState->currentSequence)) == 0;
+bool IsPartialSequence(NDR_Context* context, SequenceMatchingState* matchingState, int RSIndex){
+    return strlen(matchingState->currentSequence) <= strlen(NDR_GetSequenceInfo(context->PIWrapper, RSIndex)->sequence) &&
+            memcmp(matchingState->currentSequence, NDR_GetSequenceInfo(context->PIWrapper, RSIndex)->sequence, strlen(matchingState->currentSequence)) == 0;
 }
 
 bool IsPotentialSequenceWrong(SequenceMatchingState* matchingState){
@@ -593,9 +618,9 @@ void AcknowledgeFoundToken(PStateRepresentation* pStateRepresentation){
 }*/
 
 // findParseID finds the ID string in the parseTable
-bool findParseID(char* ID){
-    for(size_t i = 0; i < NDR_GetNumberOfSequences(PIWrapper); i++){
-        if(strcmp(NDR_GetSequenceInfo(PIWrapper, i)->keyword, ID) == 0){
+bool findParseID(NDR_Context* context, char* ID){
+    for(size_t i = 0; i < NDR_GetNumberOfSequences(context->PIWrapper); i++){
+        if(strcmp(NDR_GetSequenceInfo(context->PIWrapper, i)->keyword, ID) == 0){
             return true;
         }
     }
@@ -637,21 +662,20 @@ void findEscapedParsing(char* string, int* indices){
 }*/
 
 // copyTTToMT copies the content of the token table and token locations
-void copyTTToMT(NDR_TreeTokenInfoWrapper* tokenInfoWrapper){
-    for (size_t i = 0; i < NDR_TIGetNumberOfTokens(TIWrapper); i++){
+void copyTTToMT(NDR_Context* context, NDR_TreeTokenInfoWrapper* tokenInfoWrapper){
+    for (size_t i = 0; i < NDR_TIGetNumberOfTokens(context->TIWrapper); i++){
         NDR_AddTreeNewToken(tokenInfoWrapper);
         NDR_GetTreeTokenInfo(tokenInfoWrapper, i)->nodeNumber = -1;
-        NDR_SetTreeTokenInfoKeyword(NDR_GetTreeTokenInfo(tokenInfoWrapper, i), NDR_TIGetTokenInfo(TIWrapper, i)->keyword);
-        NDR_SetTreeTokenInfoToken(NDR_GetTreeTokenInfo(tokenInfoWrapper, i), NDR_TIGetTokenInfo(TIWrapper, i)->token);
-        NDR_SetTreeTokenInfoLine(NDR_GetTreeTokenInfo(tokenInfoWrapper, i), NDR_TIGetTokenInfo(TIWrapper, i)->lineNumber);
-        NDR_SetTreeTokenInfoColumn(NDR_GetTreeTokenInfo(tokenInfoWrapper, i), NDR_TIGetTokenInfo(TIWrapper, i)->columnNumber);
+        NDR_SetTreeTokenInfoKeyword(NDR_GetTreeTokenInfo(tokenInfoWrapper, i), NDR_TIGetTokenInfo(context->TIWrapper, i)->keyword);
+        NDR_SetTreeTokenInfoToken(NDR_GetTreeTokenInfo(tokenInfoWrapper, i), NDR_TIGetTokenInfo(context->TIWrapper, i)->token);
+        NDR_SetTreeTokenInfoPosition(NDR_GetTreeTokenInfo(tokenInfoWrapper, i), NDR_TIGetTokenInfo(context->TIWrapper, i));
     }
 }
 
 // isTokenInTable returns true if the provided token is in the token table
-bool isTokenInTable(char* token){
-    for(size_t i = 0; i < NDR_TIGetNumberOfTokens(TIWrapper); i++){
-        if(strcmp(NDR_TIGetTokenInfo(TIWrapper, i)->keyword, token) == 0){
+bool isTokenInTable(NDR_Context* context, char* token){
+    for(size_t i = 0; i < NDR_TIGetNumberOfTokens(context->TIWrapper); i++){
+        if(strcmp(NDR_TIGetTokenInfo(context->TIWrapper, i)->keyword, token) == 0){
             return true;
         }
     }
@@ -669,29 +693,37 @@ bool sContainsInt(int* arr, int index){
 
 // The functions for printing are below
 
-// printParseTable handles printing the parseTable
 void NDR_PrintParseTable(){
+    NDR_Context_PrintParseTable(NDR_GetDefaultContext());
+}
+
+void NDR_PrintModifiedTokenTable(){
+    NDR_Context_PrintModifiedTokenTable(NDR_GetDefaultContext());
+}
+
+// printParseTable handles printing the parseTable
+void NDR_Context_PrintParseTable(NDR_Context* context){
 
     printf("\n\n************** Patterns ****************\n\n");
 
-    for(size_t i = 0; i < NDR_GetNumberOfSequences(PIWrapper); i++){
-        printf("%s: ", NDR_GetSequenceInfo(PIWrapper, i)->keyword);
-        printf("%s ", NDR_GetSequenceInfo(PIWrapper, i)->sequence);
+    for(size_t i = 0; i < NDR_GetNumberOfSequences(context->PIWrapper); i++){
+        printf("%s: ", NDR_GetSequenceInfo(context->PIWrapper, i)->keyword);
+        printf("%s ", NDR_GetSequenceInfo(context->PIWrapper, i)->sequence);
         printf("\n");
     }
     //printModifiedTokenTable();
 }
 // printModifiedTokenTable handles printing the ModifiedTokenTable
-void NDR_PrintModifiedTokenTable(){
+void NDR_Context_PrintModifiedTokenTable(NDR_Context* context){
 
     printf("\n\n************** Tokens ****************\n\n");
 
-    for(size_t i = 0; i < NDR_GetNumberOfTreeTokens(TTIWrapper); i++){
-        printf("%s  ---   ", NDR_GetTreeTokenInfo(TTIWrapper, i)->tokenInfo->token);
-        printf("%s  ---   ", NDR_GetTreeTokenInfo(TTIWrapper, i)->tokenInfo->keyword);
-        printf("%u  ---   ", (unsigned int) NDR_GetTreeTokenInfo(TTIWrapper, i)->tokenInfo->lineNumber);
-        printf("%u  ---   ", (unsigned int) NDR_GetTreeTokenInfo(TTIWrapper, i)->tokenInfo->columnNumber);
-        printf("%ld", NDR_GetTreeTokenInfo(TTIWrapper, i)->nodeNumber);
+    for(size_t i = 0; i < NDR_GetNumberOfTreeTokens(context->TTIWrapper); i++){
+        printf("%s  ---   ", NDR_GetTreeTokenInfo(context->TTIWrapper, i)->tokenInfo->token);
+        printf("%s  ---   ", NDR_GetTreeTokenInfo(context->TTIWrapper, i)->tokenInfo->keyword);
+        printf("%u  ---   ", (unsigned int) NDR_GetTreeTokenInfoLine(NDR_GetTreeTokenInfo(context->TTIWrapper, i)));
+        printf("%u  ---   ", (unsigned int) NDR_GetTreeTokenInfoColumn(NDR_GetTreeTokenInfo(context->TTIWrapper, i)));
+        printf("%ld", NDR_GetTreeTokenInfo(context->TTIWrapper, i)->nodeNumber);
         printf("\n");
     }
 }
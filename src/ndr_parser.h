@@ -38,6 +38,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define NDRPARSER_H
 
 #include "ndr_astnode.h"
+#include "ndr_context.h"
 
 /** @brief NDR_ASThead points to the head of the Abstract Syntax Tree generated by the NDR_Parse function */
 extern NDR_ASTNode* NDR_ASThead;
@@ -55,9 +56,30 @@ int NDR_Configure_Parser(char* fileName);
 */
 int NDR_Parse();
 
+/** @brief Configure the parser of the provided context based on a text input file so that the parser is aware of the allowed parsing sequences
+*
+* @param context is an initialized NDR_Context structure that has not been used for parser configuration yet
+* @param fileName in the name of a text file filled with allowd parsing sequences
+* @return The success status of the function. 0 for success and non-zero for error
+*/
+int NDR_Context_Configure_Parser(NDR_Context* context, char* fileName);
+/** @brief Compare the sequences configured in function NDR_Context_Configure_Parser with the tokens found by lexing with the same context
+*
+* The head of the generated abstract syntax tree is available through NDR_Context_GetASTHead
+*
+* @param context is an NDR_Context structure that has been configured for parsing and used for lexing
+* @return The success status of the function. 0 for success and non-zero for error
+*/
+int NDR_Context_Parse(NDR_Context* context);
+
 /** @brief Print all of the sequences and associated keywords found during parsing */
 void NDR_PrintParseTable();
 /** @brief Print the final state of the parsing process of comparing tokens to the parsing sequences*/
 void NDR_PrintModifiedTokenTable();
 
+/** @brief Print all of the sequences and associated keywords held by the provided context */
+void NDR_Context_PrintParseTable(NDR_Context* context);
+/** @brief Print the final state of the parsing process of the provided context */
+void NDR_Context_PrintModifiedTokenTable(NDR_Context* context);
+
 #endif
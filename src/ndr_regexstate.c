@@ -46,6 +46,9 @@ void NDR_InitializeRegexStateWrapper(NDR_RegexStateWrapper* regexStateWrapper){
     regexStateWrapper->numStates = 0;
     regexStateWrapper->memoryAllocated = 50;
     regexStateWrapper->regexStates = malloc(sizeof(NDR_RegexState*) * regexStateWrapper->memoryAllocated);
+    regexStateWrapper->numModes = 0;
+    regexStateWrapper->modeNames = malloc(sizeof(char*) * NDR_RS_MAXMODES);
+    NDR_RSAddMode(regexStateWrapper, "initial");
 }
 
 
@@ -56,6 +59,9 @@ void NDR_FreeRegexStateWrapper(NDR_RegexStateWrapper* regexStateWrapper){
         free(regexStateWrapper->regexStates[x]);
     }
     free(regexStateWrapper->regexStates);
+    for(size_t x = 0; x < regexStateWrapper->numModes; x++)
+        free(regexStateWrapper->modeNames[x]);
+    free(regexStateWrapper->modeNames);
 }
 
 void NDR_AddRegexState(NDR_RegexStateWrapper* regexStateWrapper){
@@ -72,7 +78,7 @@ void NDR_AddRegexState(NDR_RegexStateWrapper* regexStateWrapper){
 int NDR_CheckAndAddStateRegex(NDR_RegexStateWrapper* regexStateWrapper, NDR_StateCategories state, char* regexString){
 
     if(state == NDR_STATE_STARTSTATE){
-        if(NDR_FindStartRegex(regexStateWrapper, regexString) != -1)
+        if(NDR_FindStartRegexInModes(regexStateWrapper, regexString, NDR_RSGetLastRegexState(regexStateWrapper)->modes) != -1)
             return -1;
         if(NDR_AddStartRegex(NDR_RSGetLastRegexState(regexStateWrapper), regexString) != 0)
             return -2;
@@ -96,7 +102,7 @@ int NDR_CheckAndAddStateRegex(NDR_RegexStateWrapper* regexStateWrapper, NDR_Stat
             return -2;
     }
     else{
-        if(NDR_FindStartRegex(regexStateWrapper, regexString) != -1)
+        if(NDR_FindStartRegexInModes(regexStateWrapper, regexString, NDR_RSGetLastRegexState(regexStateWrapper)->modes) != -1)
             return -1;
         if(NDR_AddStartRegex(NDR_RSGetLastRegexState(regexStateWrapper), regexString) != 0)
             return -2;
@@ -116,6 +122,20 @@ int NDR_FindStartRegex(NDR_RegexStateWrapper* regexStateWrapper, char* regexStri
     return -1;
 }
 
+// The same start regex may be used by regex states that are never active in the same lexer mode
+int NDR_FindStartRegexInModes(NDR_RegexStateWrapper* regexStateWrapper, char* regexString, uint64_t modes){
+    for(size_t x = 0; x < regexStateWrapper->numStates; x++){
+        if((NDR_RSGetRegexState(regexStateWrapper, x)->modes & modes) == 0)
+            continue;
+        for(size_t i = 0; i < NDR_RSGetRegexState(regexStateWrapper, x)->numStartStates; i++){
+            if(strcmp(NDR_RSGetRegexState(regexStateWrapper, x)->startRegex[i], regexString) == 0){
+                return x;
+            }
+        }
+    }
+    return -1;
+}
+
 int NDR_FindAllowRegex(NDR_RegexStateWrapper* regexStateWrapper, char* regexString){
     for(size_t x = 0; x < regexStateWrapper->numStates; x++){
         for(size_t i = 0; i < NDR_RSGetRegexState(regexStateWrapper, x)->numAllowStates; i++){
@@ -222,6 +242,32 @@ void NDR_RSSetLiteralFlag(NDR_RegexState* regexState, bool isLiteral){
 void NDR_RSSetCategory(NDR_RegexState* regexState, NDR_StateCategories category){
     regexState->category = category;
 }
+void NDR_RSSetAllowedByte(NDR_RegexState* regexState, char ch, bool allowed){
+    regexState->allowedBytes[(unsigned char) ch] = allowed;
+}
+void NDR_RSSetEscapedByte(NDR_RegexState* regexState, char ch, bool escaped){
+    regexState->escapedBytes[(unsigned char) ch] = escaped;
+}
+void NDR_RSSetPlainByte(NDR_RegexState* regexState, char ch, bool plain){
+    regexState->plainBytes[(unsigned char) ch] = plain;
+}
+void NDR_RSAddStopByte(NDR_RegexState* regexState, char ch){
+    if(regexState->numStopBytes < NDR_RS_MAXSTOPBYTES)
+        regexState->stopBytes[regexState->numStopBytes++] = (unsigned char) ch;
+}
+void NDR_RSClearStopBytes(NDR_RegexState* regexState){
+    regexState->numStopBytes = 0;
+}
+void NDR_RSSetModes(NDR_RegexState* regexState, uint64_t modes){
+    regexState->modes = modes;
+}
+void NDR_RSSetModeAction(NDR_RegexState* regexState, NDR_ModeAction modeAction, int modeTarget){
+    regexState->modeAction = modeAction;
+    regexState->modeTarget = modeTarget;
+}
+void NDR_RSSetEngine(NDR_RegexState* regexState, NDR_RegexEngine engine){
+    regexState->engine = engine;
+}
 
 char* NDR_RSGetKeyword(NDR_RegexState* regexState){
     return regexState->keyword;
@@ -235,6 +281,36 @@ bool NDR_RSGetLiteralFlag(NDR_RegexState* regexState){
 NDR_StateCategories NDR_RSGetCategory(NDR_RegexState* regexState){
     return regexState->category;
 }
+bool NDR_RSIsAllowedByte(NDR_RegexState* regexState, char ch){
+    return regexState->allowedBytes[(unsigned char) ch];
+}
+bool NDR_RSIsEscapedByte(NDR_RegexState* regexState, char ch){
+    return regexState->escapedBytes[(unsigned char) ch];
+}
+bool NDR_RSIsPlainByte(NDR_RegexState* regexState, char ch){
+    return regexState->plainBytes[(unsigned char) ch];
+}
+size_t NDR_RSGetNumStopBytes(NDR_RegexState* regexState){
+    return regexState->numStopBytes;
+}
+char NDR_RSGetStopByte(NDR_RegexState* regexState, int index){
+    return (char) regexState->stopBytes[index];
+}
+uint64_t NDR_RSGetModes(NDR_RegexState* regexState){
+    return regexState->modes;
+}
+bool NDR_RSIsInMode(NDR_RegexState* regexState, int mode){
+    return (regexState->modes & ((uint64_t) 1 << mode)) != 0;
+}
+NDR_ModeAction NDR_RSGetModeAction(NDR_RegexState* regexState){
+    return regexState->modeAction;
+}
+int NDR_RSGetModeTarget(NDR_RegexState* regexState){
+    return regexState->modeTarget;
+}
+NDR_RegexEngine NDR_RSGetEngine(NDR_RegexState* regexState){
+    return regexState->engine;
+}
 
 
 size_t NDR_RSGetNumStartStates(NDR_RegexState* regexState){
@@ -279,3 +355,29 @@ size_t NDR_RSGetNumberOfStates(NDR_RegexStateWrapper* regexStateWrapper){
     return regexStateWrapper->numStates;
 }
 
+// Returns the index of the new mode or -1 when there are already NDR_RS_MAXMODES modes
+int NDR_RSAddMode(NDR_RegexStateWrapper* regexStateWrapper, char* modeName){
+    if(regexStateWrapper->numModes >= NDR_RS_MAXMODES)
+        return -1;
+    regexStateWrapper->modeNames[regexStateWrapper->numModes] = malloc(strlen(modeName)+1);
+    strcpy(regexStateWrapper->modeNames[regexStateWrapper->numModes], modeName);
+    regexStateWrapper->numModes++;
+    return (int) regexStateWrapper->numModes - 1;
+}
+
+int NDR_RSFindMode(NDR_RegexStateWrapper* regexStateWrapper, char* modeName){
+    for(size_t x = 0; x < regexStateWrapper->numModes; x++){
+        if(strcmp(regexStateWrapper->modeNames[x], modeName) == 0)
+            return x;
+    }
+    return -1;
+}
+
+size_t NDR_RSGetNumberOfModes(NDR_RegexStateWrapper* regexStateWrapper){
+    return regexStateWrapper->numModes;
+}
+
+char* NDR_RSGetModeName(NDR_RegexStateWrapper* regexStateWrapper, int index){
+    return regexStateWrapper->modeNames[index];
+}
+
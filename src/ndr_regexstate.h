@@ -41,11 +41,17 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "ndr_cregex.h"
 
+// Upper bound on the number of lexer modes, one for every bit of the modes of a regex state
+#define NDR_RS_MAXMODES 64
+
 
 typedef struct NDR_RegexStateWrapper {
     size_t numStates;
     size_t memoryAllocated;
     NDR_RegexState** regexStates;
+    // modeNames holds the name of every lexer mode in the order they were first used, mode 0 is the initial mode
+    size_t numModes;
+    char** modeNames;
 } NDR_RegexStateWrapper;
 
 
@@ -56,6 +62,7 @@ void NDR_AddRegexState(NDR_RegexStateWrapper* regexStateWrapper);
 int NDR_CheckAndAddStateRegex(NDR_RegexStateWrapper* regexState, NDR_StateCategories state, char* regexString);
 
 int NDR_FindStartRegex(NDR_RegexStateWrapper* regexStateWrapper, char* regexString);
+int NDR_FindStartRegexInModes(NDR_RegexStateWrapper* regexStateWrapper, char* regexString, uint64_t modes);
 int NDR_FindAllowRegex(NDR_RegexStateWrapper* regexStateWrapper, char* regexString);
 int NDR_FindEscapeRegex(NDR_RegexStateWrapper* regexStateWrapper, char* regexString);
 int NDR_FindEndRegex(NDR_RegexStateWrapper* regexStateWrapper, char* regexString);
@@ -69,11 +76,29 @@ void NDR_RSTrimAndSetKeyword(NDR_RegexState* regexState, char* keyword);
 void NDR_RSSetStateFlag(NDR_RegexState* regexState, bool isState);
 void NDR_RSSetLiteralFlag(NDR_RegexState* regexState, bool literal);
 void NDR_RSSetCategory(NDR_RegexState* regexState, NDR_StateCategories category);
+void NDR_RSSetAllowedByte(NDR_RegexState* regexState, char ch, bool allowed);
+void NDR_RSSetEscapedByte(NDR_RegexState* regexState, char ch, bool escaped);
+void NDR_RSSetPlainByte(NDR_RegexState* regexState, char ch, bool plain);
+void NDR_RSAddStopByte(NDR_RegexState* regexState, char ch);
+void NDR_RSClearStopBytes(NDR_RegexState* regexState);
+void NDR_RSSetModes(NDR_RegexState* regexState, uint64_t modes);
+void NDR_RSSetModeAction(NDR_RegexState* regexState, NDR_ModeAction modeAction, int modeTarget);
+void NDR_RSSetEngine(NDR_RegexState* regexState, NDR_RegexEngine engine);
 
 char* NDR_RSGetKeyword(NDR_RegexState* regexState);
 bool NDR_RSGetStateFlag(NDR_RegexState* regexState);
 bool NDR_RSGetLiteralFlag(NDR_RegexState* regexState);
 NDR_StateCategories NDR_RSGetCategory(NDR_RegexState* regexState);
+bool NDR_RSIsAllowedByte(NDR_RegexState* regexState, char ch);
+bool NDR_RSIsEscapedByte(NDR_RegexState* regexState, char ch);
+bool NDR_RSIsPlainByte(NDR_RegexState* regexState, char ch);
+size_t NDR_RSGetNumStopBytes(NDR_RegexState* regexState);
+char NDR_RSGetStopByte(NDR_RegexState* regexState, int index);
+uint64_t NDR_RSGetModes(NDR_RegexState* regexState);
+bool NDR_RSIsInMode(NDR_RegexState* regexState, int mode);
+NDR_ModeAction NDR_RSGetModeAction(NDR_RegexState* regexState);
+int NDR_RSGetModeTarget(NDR_RegexState* regexState);
+NDR_RegexEngine NDR_RSGetEngine(NDR_RegexState* regexState);
 
 size_t NDR_RSGetNumStartStates(NDR_RegexState* regexState);
 size_t NDR_RSGetNumAllowStates(NDR_RegexState* regexState);
@@ -90,4 +115,9 @@ NDR_RegexState* NDR_RSGetRegexState(NDR_RegexStateWrapper* regexStateWrapper, in
 NDR_RegexState* NDR_RSGetLastRegexState(NDR_RegexStateWrapper* regexStateWrapper);
 size_t NDR_RSGetNumberOfStates(NDR_RegexStateWrapper* regexStateWrapper);
 
+int NDR_RSAddMode(NDR_RegexStateWrapper* regexStateWrapper, char* modeName);
+int NDR_RSFindMode(NDR_RegexStateWrapper* regexStateWrapper, char* modeName);
+size_t NDR_RSGetNumberOfModes(NDR_RegexStateWrapper* regexStateWrapper);
+char* NDR_RSGetModeName(NDR_RegexStateWrapper* regexStateWrapper, int index);
+
 #endif
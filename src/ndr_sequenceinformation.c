@@ -49,6 +49,15 @@ void NDR_InitSequenceInfoWrapper(NDR_SequenceInformationWrapper* sequenceInfoWra
     sequenceInfoWrapper->sequences = malloc(sizeof(NDR_SequenceInformation*) * sequenceInfoWrapper->memoryAllocated);
 }
 
+void NDR_FreeSequenceInfoWrapper(NDR_SequenceInformationWrapper* sequenceInfoWrapper){
+    for(size_t x = 0; x < sequenceInfoWrapper->numSequences; x++){
+        free(sequenceInfoWrapper->sequences[x]->keyword);
+        free(sequenceInfoWrapper->sequences[x]->sequence);
+        free(sequenceInfoWrapper->sequences[x]);
+    }
+    free(sequenceInfoWrapper->sequences);
+}
+
 void NDR_AddNewSequenceTokenInfo(NDR_SequenceInformationWrapper* sequenceInfoWrapper){
     if(sequenceInfoWrapper->numSequences > sequenceInfoWrapper->memoryAllocated - 5){
         sequenceInfoWrapper->memoryAllocated = sequenceInfoWrapper->memoryAllocated * 2;
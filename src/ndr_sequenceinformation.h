@@ -53,6 +53,7 @@ typedef struct NDR_SequenceInformationWrapper {
 } NDR_SequenceInformationWrapper;
 
 void NDR_InitSequenceInfoWrapper(NDR_SequenceInformationWrapper* sequenceInfoWrapper);
+void NDR_FreeSequenceInfoWrapper(NDR_SequenceInformationWrapper* sequenceInfoWrapper);
 
 void NDR_AddNewSequenceTokenInfo(NDR_SequenceInformationWrapper* sequenceInfoWrapper);
 void NDR_SetSTokenInfoKeyword(NDR_SequenceInformation* sequenceInfo, char* keyword);
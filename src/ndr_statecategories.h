@@ -38,7 +38,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define NDRSTATECATEGORIES_H
 
 typedef enum NDR_StateCategories{
-    NDR_STATE_INVALID, NDR_STATE_ACCEPT, NDR_STATE_IGNORE, NDR_STATE_ERROR, NDR_STATE_STARTSTATE, NDR_STATE_ALLOWSTATE, NDR_STATE_ESCAPESTATE, NDR_STATE_ENDSTATE, NDR_STATE_KEYWORD, NDR_STATE_LITERAL, NDR_STATE_STATES, NDR_STATE_ITEMS, NDR_STATE_SETTING, NDR_STATE_NOTAPPLICABLE
+    NDR_STATE_INVALID, NDR_STATE_ACCEPT, NDR_STATE_IGNORE, NDR_STATE_ERROR, NDR_STATE_STARTSTATE, NDR_STATE_ALLOWSTATE, NDR_STATE_ESCAPESTATE, NDR_STATE_ENDSTATE, NDR_STATE_KEYWORD, NDR_STATE_LITERAL, NDR_STATE_STATES, NDR_STATE_ITEMS, NDR_STATE_SETTING, NDR_STATE_NOTAPPLICABLE, NDR_STATE_MODES, NDR_STATE_MODEACTION, NDR_STATE_ENGINE
 } NDR_StateCategories;
 
 #endif
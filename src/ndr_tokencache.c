@@ -0,0 +1,373 @@
+
+/*********************************************************************************
+*                                NDR Token Cache                                 *
+**********************************************************************************/
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Neil Runcie
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "ndr_tokencache.h"
+#include "ndr_lexerimage.h"
+#include "ndr_fileprocessor.h"
+#include "ndr_tokeninformation.h"
+
+// The first bytes of every token cache file
+static const char cacheMagic[8] = {'N', 'D', 'R', 'T', 'O', 'K', 'E', 'N'};
+// Written as one value so that a file written on a machine of another byte order is recognized
+#define NDR_TOKENCACHE_BYTEORDER 0x01020304u
+// Marks a token whose keyword is its own text, or whose text is found within the input at its offset
+#define NDR_TOKENCACHE_NONE ((size_t) -1)
+// Number of values stored for every token, which are its offset, lookahead, keyword, text position and text length
+#define NDR_TOKENCACHE_TOKENFIELDS 5
+
+// The header of a cache file. It is followed by the keyword offsets, the token values and the text that both refer to
+typedef struct TokenCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t sizeOfSize;
+    uint32_t byteOrder;
+    uint32_t reserved;
+    // key is the hash of the lexer configuration file and of the input the tokens were found in
+    uint64_t key;
+    // contentHash is the hash of everything after the header
+    uint64_t contentHash;
+    size_t inputLength;
+    size_t numTokens;
+    size_t numKeywords;
+    // tokenDataLength is the number of bytes used by the token values, which are stored as variable length numbers
+    size_t tokenDataLength;
+    size_t textLength;
+} TokenCacheHeader;
+
+// Bytes of a cache file being written
+typedef struct CacheBuffer {
+    unsigned char* data;
+    size_t length;
+    size_t memoryAllocated;
+} CacheBuffer;
+
+static char* GetCacheFileName(NDR_Context* context, const char* data, size_t len, uint64_t* key);
+static void InitCacheBuffer(CacheBuffer* buffer);
+static void AddCacheBytes(CacheBuffer* buffer, const void* bytes, size_t length);
+static size_t AddCacheText(CacheBuffer* text, const char* string, size_t length);
+static void AddCacheNumber(CacheBuffer* buffer, size_t value);
+static bool ReadCacheNumber(const unsigned char** position, const unsigned char* end, size_t* value);
+static bool ReadCachedToken(const unsigned char** position, const unsigned char* end, size_t previousOffset, size_t* values);
+static int ReadCachedTokens(NDR_Context* context, NDR_MappedFile* cache, uint64_t key, const char* data, size_t len);
+
+
+int NDR_SetTokenCache(char* directory){
+    return NDR_Context_SetTokenCache(NDR_GetDefaultContext(), directory);
+}
+
+int NDR_Context_SetTokenCache(NDR_Context* context, char* directory){
+    if(directory != NULL && strcmp(directory, "") == 0){
+        printf("A non-empty directory must be provided for the token cache\n");
+        return 1;
+    }
+
+    free(context->tokenCacheDirectory);
+    context->tokenCacheDirectory = NULL;
+    if(directory != NULL){
+        context->tokenCacheDirectory = malloc(strlen(directory) + 1);
+        strcpy(context->tokenCacheDirectory, directory);
+    }
+
+    return 0;
+}
+
+int NDR_LoadCachedTokens(NDR_Context* context, const char* data, size_t len){
+    uint64_t key;
+    char* fileName = GetCacheFileName(context, data, len, &key);
+    if(fileName == NULL)
+        return 1;
+
+    NDR_MappedFile cache;
+    int result = NDR_MapBinaryFile(fileName, &cache);
+    free(fileName);
+    if(result != 0)
+        return 1;
+
+    result = ReadCachedTokens(context, &cache, key, data, len);
+    NDR_UnmapFile(&cache);
+
+    return result;
+}
+
+int NDR_SaveCachedTokens(NDR_Context* context, const char* data, size_t len){
+    uint64_t key;
+    char* fileName = GetCacheFileName(context, data, len, &key);
+    if(fileName == NULL)
+        return 1;
+
+    NDR_TokenInformationWrapper* tokenWrapper = context->TIWrapper;
+    size_t numTokens = NDR_TIGetNumberOfTokens(tokenWrapper);
+    CacheBuffer tokenData;
+    CacheBuffer text;
+    InitCacheBuffer(&tokenData);
+    InitCacheBuffer(&text);
+
+    // Every distinct keyword is kept once, most tokens share the keywords of a handful of regex states
+    size_t numKeywords = 0;
+    size_t keywordsAllocated = 50;
+    size_t* keywordOffsets = malloc(sizeof(size_t) * keywordsAllocated);
+
+    size_t previousOffset = 0;
+    bool ordered = true;
+    for(size_t x = 0; x < numTokens && ordered == true; x++){
+        NDR_TokenInformation* token = NDR_TIGetTokenInfo(tokenWrapper, x);
+        size_t tokenLength = strlen(token->token);
+        size_t keyword = NDR_TOKENCACHE_NONE;
+        size_t textPosition = NDR_TOKENCACHE_NONE;
+
+        if(strcmp(token->keyword, token->token) != 0){
+            for(size_t i = 0; i < numKeywords && keyword == NDR_TOKENCACHE_NONE; i++){
+                if(strcmp((char*) text.data + keywordOffsets[i], token->keyword) == 0)
+                    keyword = i;
+            }
+            if(keyword == NDR_TOKENCACHE_NONE){
+                if(numKeywords > keywordsAllocated - 5){
+                    keywordsAllocated = keywordsAllocated * 2;
+                    keywordOffsets = realloc(keywordOffsets, sizeof(size_t) * keywordsAllocated);
+                }
+                keywordOffsets[numKeywords] = AddCacheText(&text, token->keyword, strlen(token->keyword));
+                keyword = numKeywords++;
+            }
+        }
+
+        // Most token texts are the input at the offset of the token, only the others are stored
+        if(token->offset > len || tokenLength > len - token->offset || memcmp(data + token->offset, token->token, tokenLength) != 0)
+            textPosition = AddCacheText(&text, token->token, tokenLength);
+
+        // Offsets only grow from one token to the next so each is stored as the distance from the previous one, and the values marked with NONE are stored as 0
+        ordered = (token->offset >= previousOffset);
+        AddCacheNumber(&tokenData, token->offset - previousOffset);
+        AddCacheNumber(&tokenData, token->lookahead);
+        AddCacheNumber(&tokenData, keyword + 1);
+        AddCacheNumber(&tokenData, textPosition + 1);
+        AddCacheNumber(&tokenData, tokenLength);
+        previousOffset = token->offset;
+    }
+
+    TokenCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.version = NDR_TOKENCACHE_VERSION;
+    header.sizeOfSize = (uint32_t) sizeof(size_t);
+    header.byteOrder = NDR_TOKENCACHE_BYTEORDER;
+    header.key = key;
+    header.inputLength = len;
+    header.numTokens = numTokens;
+    header.numKeywords = numKeywords;
+    header.tokenDataLength = tokenData.length;
+    header.textLength = text.length;
+    header.contentHash = NDR_HashBytes(NDR_HASH_SEED, keywordOffsets, sizeof(size_t) * numKeywords);
+    header.contentHash = NDR_HashBytes(header.contentHash, tokenData.data, tokenData.length);
+    header.contentHash = NDR_HashBytes(header.contentHash, text.data, text.length);
+
+    // The file is written under another name and renamed once complete so that a partly written file is never loaded
+    char* tempFileName = malloc(strlen(fileName) + 5);
+    sprintf(tempFileName, "%s.tmp", fileName);
+    int result = 1;
+    FILE* cacheFile = (ordered == true) ? fopen(tempFileName, "wb") : NULL;
+    if(cacheFile != NULL){
+        bool written = (fwrite(&header, sizeof(header), 1, cacheFile) == 1);
+        written = written && fwrite(keywordOffsets, sizeof(size_t), numKeywords, cacheFile) == numKeywords;
+        written = written && fwrite(tokenData.data, 1, tokenData.length, cacheFile) == tokenData.length;
+        written = written && fwrite(text.data, 1, text.length, cacheFile) == text.length;
+        if(fclose(cacheFile) != 0)
+            written = false;
+#ifdef _WIN32
+        if(written == true)
+            remove(fileName);
+#endif
+        if(written == true && rename(tempFileName, fileName) == 0)
+            result = 0;
+        else
+            remove(tempFileName);
+    }
+    if(result != 0)
+        printf("Cannot write token cache file \"%s\"\n", fileName);
+
+    free(tempFileName);
+    free(fileName);
+    free(keywordOffsets);
+    free(tokenData.data);
+    free(text.data);
+
+    return result;
+}
+
+// Cache files are named after their key so that the file of an input is found without searching the directory
+char* GetCacheFileName(NDR_Context* context, const char* data, size_t len, uint64_t* key){
+    if(context->tokenCacheDirectory == NULL || context->lexerConfigHash == 0)
+        return NULL;
+
+    *key = NDR_HashBytes(NDR_HASH_SEED, &context->lexerConfigHash, sizeof(uint64_t));
+    *key = NDR_HashBytes(*key, data, len);
+
+    char* fileName = malloc(strlen(context->tokenCacheDirectory) + 32);
+    sprintf(fileName, "%s/%016llx.ndrtok", context->tokenCacheDirectory, (unsigned long long) *key);
+    return fileName;
+}
+
+void InitCacheBuffer(CacheBuffer* buffer){
+    buffer->length = 0;
+    buffer->memoryAllocated = 4096;
+    buffer->data = malloc(buffer->memoryAllocated);
+}
+
+void AddCacheBytes(CacheBuffer* buffer, const void* bytes, size_t length){
+    if(buffer->length + length > buffer->memoryAllocated){
+        while(buffer->length + length > buffer->memoryAllocated)
+            buffer->memoryAllocated = buffer->memoryAllocated * 2;
+        buffer->data = realloc(buffer->data, buffer->memoryAllocated);
+    }
+    memcpy(buffer->data + buffer->length, bytes, length);
+    buffer->length += length;
+}
+
+// Keywords and token texts are followed by a null character so that they can be used where they are mapped
+size_t AddCacheText(CacheBuffer* text, const char* string, size_t length){
+    size_t position = text->length;
+    AddCacheBytes(text, string, length);
+    AddCacheBytes(text, "", 1);
+    return position;
+}
+
+// Numbers are stored seven bits to a byte, lowest bits first, with the high bit set on every byte but the last
+void AddCacheNumber(CacheBuffer* buffer, size_t value){
+    unsigned char bytes[sizeof(size_t) * 2];
+    size_t length = 0;
+    while(value >= 0x80){
+        bytes[length++] = (unsigned char) ((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    bytes[length++] = (unsigned char) value;
+    AddCacheBytes(buffer, bytes, length);
+}
+
+bool ReadCacheNumber(const unsigned char** position, const unsigned char* end, size_t* value){
+    *value = 0;
+    for(size_t shift = 0; shift < sizeof(size_t) * 8; shift += 7){
+        if(*position == end)
+            return false;
+        unsigned char byte = *(*position)++;
+        *value |= (size_t) (byte & 0x7F) << shift;
+        if((byte & 0x80) == 0)
+            return true;
+    }
+    return false;
+}
+
+// Read the values of one token back into the offset, lookahead, keyword, text position and text length of the token
+bool ReadCachedToken(const unsigned char** position, const unsigned char* end, size_t previousOffset, size_t* values){
+    for(size_t x = 0; x < NDR_TOKENCACHE_TOKENFIELDS; x++){
+        if(ReadCacheNumber(position, end, &values[x]) == false)
+            return false;
+    }
+    values[0] += previousOffset;
+    values[2] -= 1;
+    values[3] -= 1;
+    return values[0] >= previousOffset;
+}
+
+// Every value of the file is checked before the first token is added so that a damaged file leaves the token table empty
+int ReadCachedTokens(NDR_Context* context, NDR_MappedFile* cache, uint64_t key, const char* data, size_t len){
+    if(cache->length < sizeof(TokenCacheHeader))
+        return 1;
+    const TokenCacheHeader* header = (const TokenCacheHeader*) cache->data;
+    if(memcmp(header->magic, cacheMagic, sizeof(cacheMagic)) != 0 || header->version != NDR_TOKENCACHE_VERSION ||
+       header->sizeOfSize != sizeof(size_t) || header->byteOrder != NDR_TOKENCACHE_BYTEORDER ||
+       header->key != key || header->inputLength != len || header->numTokens == 0)
+        return 1;
+
+    size_t remaining = cache->length - sizeof(TokenCacheHeader);
+    if(header->numKeywords > remaining / sizeof(size_t))
+        return 1;
+    remaining -= header->numKeywords * sizeof(size_t);
+    if(header->tokenDataLength > remaining || header->textLength != remaining - header->tokenDataLength)
+        return 1;
+    if(header->contentHash != NDR_HashBytes(NDR_HASH_SEED, cache->data + sizeof(TokenCacheHeader), cache->length - sizeof(TokenCacheHeader)))
+        return 1;
+
+    const size_t* keywordOffsets = (const size_t*) (cache->data + sizeof(TokenCacheHeader));
+    const unsigned char* tokenData = (const unsigned char*) (keywordOffsets + header->numKeywords);
+    const unsigned char* tokenDataEnd = tokenData + header->tokenDataLength;
+    const char* text = (const char*) tokenDataEnd;
+
+    for(size_t x = 0; x < header->numKeywords; x++){
+        if(keywordOffsets[x] >= header->textLength || memchr(text + keywordOffsets[x], '\0', header->textLength - keywordOffsets[x]) == NULL)
+            return 1;
+    }
+
+    size_t values[NDR_TOKENCACHE_TOKENFIELDS];
+    const unsigned char* position = tokenData;
+    size_t previousOffset = 0;
+    for(size_t x = 0; x < header->numTokens; x++){
+        if(ReadCachedToken(&position, tokenDataEnd, previousOffset, values) == false || values[0] > len)
+            return 1;
+        if(values[2] != NDR_TOKENCACHE_NONE && values[2] >= header->numKeywords)
+            return 1;
+        if(values[3] == NDR_TOKENCACHE_NONE && values[4] > len - values[0])
+            return 1;
+        if(values[3] != NDR_TOKENCACHE_NONE && (values[3] >= header->textLength || values[4] >= header->textLength - values[3] || text[values[3] + values[4]] != '\0'))
+            return 1;
+        previousOffset = values[0];
+    }
+    if(position != tokenDataEnd)
+        return 1;
+
+    position = tokenData;
+    previousOffset = 0;
+    for(size_t x = 0; x < header->numTokens; x++){
+        ReadCachedToken(&position, tokenDataEnd, previousOffset, values);
+        previousOffset = values[0];
+        NDR_AddNewToken(context->TIWrapper);
+        NDR_TokenInformation* token = NDR_TIGetLastTokenInfo(context->TIWrapper);
+        NDR_SetTokenInfoOffset(token, values[0]);
+        token->lookahead = values[1];
+        NDR_SetTokenInfoLineIndex(token, context->lineIndex);
+        NDR_SetTokenInfoTokenRange(token, (values[3] == NDR_TOKENCACHE_NONE) ? data + values[0] : text + values[3], values[4]);
+        if(values[2] == NDR_TOKENCACHE_NONE)
+            NDR_SetTokenInfoKeyword(token, token->token);
+        else
+            NDR_SetTokenInfoKeyword(token, (char*) text + keywordOffsets[values[2]]);
+    }
+
+    return 0;
+}
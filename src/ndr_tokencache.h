@@ -0,0 +1,70 @@
+
+/*********************************************************************************
+*                                NDR Token Cache                                 *
+**********************************************************************************/
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Neil Runcie
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef NDRTOKENCACHE_H
+#define NDRTOKENCACHE_H
+
+#include <stddef.h>
+
+#include "ndr_context.h"
+
+// Incremented whenever the layout of a token cache file changes so that files written by other versions are rejected
+#define NDR_TOKENCACHE_VERSION 1
+
+/** @brief Keep the token tables found with the default context in a token cache, see NDR_Context_SetTokenCache
+*
+* @param directory is the directory that holds the cache files, or NULL to stop using a token cache
+* @return The success status of the function. 0 for success and non-zero for error
+*/
+int NDR_SetTokenCache(char* directory);
+/** @brief Keep the token tables found with the provided context in a token cache
+*
+* Once an input has been lexed its token table is written to a file within directory, named after a hash of the input and of the lexer configuration file.
+* When the same input is lexed again with the same configuration the token table is loaded from that file instead of being matched, after the hashes recorded within it have been checked.
+* Inputs lexed from a buffer or a file name use the cache while inputs streamed from an open file are always matched. Cache files are never removed by the library
+*
+* @param context is an initialized NDR_Context structure
+* @param directory is an existing directory that holds the cache files, or NULL to stop using a token cache
+* @return The success status of the function. 0 for success and non-zero for error
+*/
+int NDR_Context_SetTokenCache(NDR_Context* context, char* directory);
+
+// Load the token table of an input from the token cache of the context. Returns 0 when the tokens were loaded and non-zero when the cache holds no valid file for the input
+int NDR_LoadCachedTokens(NDR_Context* context, const char* data, size_t len);
+// Write the token table of an input to the token cache of the context. Returns 0 on success and non-zero when the cache file cannot be written
+int NDR_SaveCachedTokens(NDR_Context* context, const char* data, size_t len);
+
+#endif
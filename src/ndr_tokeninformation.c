@@ -34,78 +34,173 @@ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <ctype.h>
-#include <stdbool.h>
-#include "ndr_tokeninformation.h"
-
-void NDR_InitTokenInfoWrapper(NDR_TokenInformationWrapper* tokenInfoWrapper){
-    tokenInfoWrapper->numTokens = 0;
-    tokenInfoWrapper->memoryAllocated = 50;
-    tokenInfoWrapper->tokens = malloc(sizeof(NDR_TokenInformation*) * tokenInfoWrapper->memoryAllocated);
-}
-
-void NDR_FreeTokenInfoWrapper(NDR_TokenInformationWrapper* tokenInfoWrapper){
-    for(size_t x = 0; x < tokenInfoWrapper->numTokens; x++){
-        NDR_FreeTokenInfo(tokenInfoWrapper->tokens[x]);
-        free(tokenInfoWrapper->tokens[x]);
-    }
-    free(tokenInfoWrapper->tokens);
-}
-void NDR_FreeTokenInfo(NDR_TokenInformation* tokenInformation){
-    free(tokenInformation->token);
-    free(tokenInformation->keyword);
-}
-
-void NDR_AddNewToken(NDR_TokenInformationWrapper* tokenInfoWrapper){
-    if(tokenInfoWrapper->numTokens > tokenInfoWrapper->memoryAllocated - 5){
-        tokenInfoWrapper->memoryAllocated = tokenInfoWrapper->memoryAllocated * 2;
-        tokenInfoWrapper->tokens = realloc(tokenInfoWrapper->tokens, sizeof(NDR_TokenInformation*) * tokenInfoWrapper->memoryAllocated);
-    }
-    tokenInfoWrapper->tokens[tokenInfoWrapper->numTokens] = malloc(sizeof(NDR_TokenInformation));
-    tokenInfoWrapper->tokens[tokenInfoWrapper->numTokens]->keyword = malloc(1);
-    tokenInfoWrapper->tokens[tokenInfoWrapper->numTokens]->token = malloc(1);
-    tokenInfoWrapper->numTokens++;
-}
-
-void NDR_SetTokenInfoKeyword(NDR_TokenInformation* tokenInformation, char* keyword){
-    tokenInformation->keyword = realloc(tokenInformation->keyword, strlen(keyword)+1);
-    strcpy(tokenInformation->keyword, keyword);
-}
-void NDR_SetTokenInfoToken(NDR_TokenInformation* tokenInformation, char* token){
-    tokenInformation->token = realloc(tokenInformation->token, strlen(token)+1);
-    strcpy(tokenInformation->token, token);
-}
-void NDR_SetTokenInfoLine(NDR_TokenInformation* tokenInformation, size_t lineNumber){
-    tokenInformation->lineNumber = lineNumber;
-}
-void NDR_SetTokenInfoColumn(NDR_TokenInformation* tokenInformation, size_t columnNumber){
-    tokenInformation->columnNumber = columnNumber;
-}
-
-char* NDR_GetTokenInfoKeyword(NDR_TokenInformation* tokenInformation){
-    return tokenInformation->keyword;
-}
-char* NDR_GetTokenInfoToken(NDR_TokenInformation* tokenInformation){
-    return tokenInformation->token;
-}
-size_t NDR_GetTokenInfoLine(NDR_TokenInformation* tokenInformation){
-    return tokenInformation->lineNumber;
-}
-size_t NDR_GetTokenInfoColumn(NDR_TokenInformation* tokenInformation){
-    return tokenInformation->columnNumber;
-}
-
-NDR_TokenInformation* NDR_TIGetTokenInfo(NDR_TokenInformationWrapper* tokenInfo, size_t index){
-    return tokenInfo->tokens[index];
-}
-NDR_TokenInformation* NDR_TIGetLastTokenInfo(NDR_TokenInformationWrapper* tokenInfo){
-    return tokenInfo->tokens[tokenInfo->numTokens-1];
-}
-size_t NDR_TIGetNumberOfTokens(NDR_TokenInformationWrapper* tokenInfoWrapper){
-    return tokenInfoWrapper->numTokens;
-}
-
-
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdbool.h>
+#include "ndr_tokeninformation.h"
+
+void NDR_InitTokenInfoWrapper(NDR_TokenInformationWrapper* tokenInfoWrapper){
+    tokenInfoWrapper->numTokens = 0;
+    tokenInfoWrapper->numTokensCreated = 0;
+    tokenInfoWrapper->memoryAllocated = 50;
+    tokenInfoWrapper->tokens = malloc(sizeof(NDR_TokenInformation*) * tokenInfoWrapper->memoryAllocated);
+}
+
+void NDR_FreeTokenInfoWrapper(NDR_TokenInformationWrapper* tokenInfoWrapper){
+    for(size_t x = 0; x < tokenInfoWrapper->numTokensCreated; x++){
+        NDR_FreeTokenInfo(tokenInfoWrapper->tokens[x]);
+        free(tokenInfoWrapper->tokens[x]);
+    }
+    free(tokenInfoWrapper->tokens);
+}
+void NDR_ResetTokenInfoWrapper(NDR_TokenInformationWrapper* tokenInfoWrapper){
+    tokenInfoWrapper->numTokens = 0;
+}
+void NDR_InitTokenInfo(NDR_TokenInformation* tokenInformation){
+    tokenInformation->token = malloc(1);
+    tokenInformation->token[0] = '\0';
+    tokenInformation->keyword = malloc(1);
+    tokenInformation->keyword[0] = '\0';
+    tokenInformation->offset = 0;
+    tokenInformation->lookahead = 0;
+    tokenInformation->lineIndex = NULL;
+}
+void NDR_FreeTokenInfo(NDR_TokenInformation* tokenInformation){
+    free(tokenInformation->token);
+    free(tokenInformation->keyword);
+}
+
+void NDR_AddNewToken(NDR_TokenInformationWrapper* tokenInfoWrapper){
+    if(tokenInfoWrapper->numTokens > tokenInfoWrapper->memoryAllocated - 5){
+        tokenInfoWrapper->memoryAllocated = tokenInfoWrapper->memoryAllocated * 2;
+        tokenInfoWrapper->tokens = realloc(tokenInfoWrapper->tokens, sizeof(NDR_TokenInformation*) * tokenInfoWrapper->memoryAllocated);
+    }
+    // A token left over from before the last reset keeps its strings so that they can be reused
+    if(tokenInfoWrapper->numTokens < tokenInfoWrapper->numTokensCreated){
+        tokenInfoWrapper->tokens[tokenInfoWrapper->numTokens]->keyword[0] = '\0';
+        tokenInfoWrapper->tokens[tokenInfoWrapper->numTokens]->token[0] = '\0';
+        tokenInfoWrapper->numTokens++;
+        return;
+    }
+    tokenInfoWrapper->tokens[tokenInfoWrapper->numTokens] = malloc(sizeof(NDR_TokenInformation));
+    tokenInfoWrapper->tokens[tokenInfoWrapper->numTokens]->keyword = malloc(1);
+    tokenInfoWrapper->tokens[tokenInfoWrapper->numTokens]->token = malloc(1);
+    tokenInfoWrapper->numTokens++;
+    tokenInfoWrapper->numTokensCreated++;
+}
+
+void NDR_MoveTokenInfo(NDR_TokenInformationWrapper* destination, NDR_TokenInformationWrapper* source, size_t first, size_t count){
+    for(size_t x = first; x < first + count; x++){
+        if(destination->numTokens > destination->memoryAllocated - 5){
+            destination->memoryAllocated = destination->memoryAllocated * 2;
+            destination->tokens = realloc(destination->tokens, sizeof(NDR_TokenInformation*) * destination->memoryAllocated);
+        }
+        NDR_TokenInformation* token = source->tokens[x];
+        // A spare token of the destination is given to the source in exchange so that both keep owning what they allocated
+        if(destination->numTokens < destination->numTokensCreated){
+            source->tokens[x] = destination->tokens[destination->numTokens];
+        }
+        else{
+            source->tokens[x] = NULL;
+            destination->numTokensCreated++;
+        }
+        destination->tokens[destination->numTokens] = token;
+        destination->numTokens++;
+    }
+
+    size_t numKept = 0;
+    for(size_t x = 0; x < source->numTokensCreated; x++){
+        if(source->tokens[x] != NULL)
+            source->tokens[numKept++] = source->tokens[x];
+    }
+    source->numTokensCreated = numKept;
+    source->numTokens = 0;
+}
+
+void NDR_ReplaceTokenInfo(NDR_TokenInformationWrapper* destination, size_t first, size_t count, NDR_TokenInformationWrapper* source){
+    size_t numInserted = source->numTokens;
+    size_t numSpare = source->numTokensCreated - source->numTokens;
+    size_t numCreated = destination->numTokensCreated - count + numInserted;
+
+    if(numCreated > destination->memoryAllocated - 5){
+        destination->memoryAllocated = (destination->memoryAllocated * 2) + numCreated;
+        destination->tokens = realloc(destination->tokens, sizeof(NDR_TokenInformation*) * destination->memoryAllocated);
+    }
+    if(count + numSpare > source->memoryAllocated){
+        source->memoryAllocated = count + numSpare;
+        source->tokens = realloc(source->tokens, sizeof(NDR_TokenInformation*) * source->memoryAllocated);
+    }
+
+    // The replaced tokens are given to the source in exchange so that both keep owning what they allocated
+    NDR_TokenInformation** inserted = malloc(sizeof(NDR_TokenInformation*) * (numInserted + 1));
+    memcpy(inserted, source->tokens, sizeof(NDR_TokenInformation*) * numInserted);
+    memmove(&source->tokens[count], &source->tokens[numInserted], sizeof(NDR_TokenInformation*) * numSpare);
+    memcpy(source->tokens, &destination->tokens[first], sizeof(NDR_TokenInformation*) * count);
+    memmove(&destination->tokens[first + numInserted], &destination->tokens[first + count], sizeof(NDR_TokenInformation*) * (destination->numTokensCreated - first - count));
+    memcpy(&destination->tokens[first], inserted, sizeof(NDR_TokenInformation*) * numInserted);
+    free(inserted);
+
+    destination->numTokens = destination->numTokens - count + numInserted;
+    destination->numTokensCreated = numCreated;
+    source->numTokensCreated = count + numSpare;
+    source->numTokens = 0;
+}
+
+void NDR_SetTokenInfoKeyword(NDR_TokenInformation* tokenInformation, char* keyword){
+    tokenInformation->keyword = realloc(tokenInformation->keyword, strlen(keyword)+1);
+    strcpy(tokenInformation->keyword, keyword);
+}
+void NDR_SetTokenInfoToken(NDR_TokenInformation* tokenInformation, char* token){
+    tokenInformation->token = realloc(tokenInformation->token, strlen(token)+1);
+    strcpy(tokenInformation->token, token);
+}
+void NDR_SetTokenInfoTokenRange(NDR_TokenInformation* tokenInformation, const char* token, size_t length){
+    tokenInformation->token = realloc(tokenInformation->token, length+1);
+    memcpy(tokenInformation->token, token, length);
+    tokenInformation->token[length] = '\0';
+}
+void NDR_SetTokenInfoOffset(NDR_TokenInformation* tokenInformation, size_t offset){
+    tokenInformation->offset = offset;
+}
+void NDR_SetTokenInfoLineIndex(NDR_TokenInformation* tokenInformation, NDR_LineIndex* lineIndex){
+    tokenInformation->lineIndex = lineIndex;
+}
+void NDR_CopyTokenInfoPosition(NDR_TokenInformation* destination, NDR_TokenInformation* source){
+    destination->offset = source->offset;
+    destination->lookahead = source->lookahead;
+    destination->lineIndex = source->lineIndex;
+}
+
+char* NDR_GetTokenInfoKeyword(NDR_TokenInformation* tokenInformation){
+    return tokenInformation->keyword;
+}
+char* NDR_GetTokenInfoToken(NDR_TokenInformation* tokenInformation){
+    return tokenInformation->token;
+}
+size_t NDR_GetTokenInfoLine(NDR_TokenInformation* tokenInformation){
+    if(tokenInformation->lineIndex == NULL)
+        return 0;
+    return NDR_LineIndexGetLine(tokenInformation->lineIndex, tokenInformation->offset);
+}
+size_t NDR_GetTokenInfoColumn(NDR_TokenInformation* tokenInformation){
+    if(tokenInformation->lineIndex == NULL)
+        return 0;
+    return NDR_LineIndexGetColumn(tokenInformation->lineIndex, tokenInformation->offset);
+}
+size_t NDR_GetTokenInfoOffset(NDR_TokenInformation* tokenInformation){
+    return tokenInformation->offset;
+}
+
+NDR_TokenInformation* NDR_TIGetTokenInfo(NDR_TokenInformationWrapper* tokenInfo, size_t index){
+    return tokenInfo->tokens[index];
+}
+NDR_TokenInformation* NDR_TIGetLastTokenInfo(NDR_TokenInformationWrapper* tokenInfo){
+    return tokenInfo->tokens[tokenInfo->numTokens-1];
+}
+size_t NDR_TIGetNumberOfTokens(NDR_TokenInformationWrapper* tokenInfoWrapper){
+    return tokenInfoWrapper->numTokens;
+}
+
+
@@ -34,42 +34,65 @@ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
-#ifndef TOKENINFORMATION_H
-#define TOKENINFORMATION_H
-
-typedef struct NDR_TokenInformation {
-    char* token;
-    char* keyword;
-    size_t lineNumber;
-    size_t columnNumber;
-} NDR_TokenInformation;
-
-typedef struct NDR_TokenInformationWrapper {
-    size_t numTokens;
-    size_t memoryAllocated;
-    NDR_TokenInformation** tokens;
-} NDR_TokenInformationWrapper;
-
-void NDR_InitTokenInfoWrapper(NDR_TokenInformationWrapper* tokenInfoWrapper);
-void NDR_FreeTokenInfoWrapper(NDR_TokenInformationWrapper* tokenInfoWrapper);
-void NDR_FreeTokenInfo(NDR_TokenInformation* tokenInformation);
-
-void NDR_AddNewToken(NDR_TokenInformationWrapper* tokenInfoWrapper);
-NDR_TokenInformation* NDR_GetTokenInfo(NDR_TokenInformationWrapper* tokenInfo, size_t index);
-NDR_TokenInformation* NDR_GetLastTokenInfo(NDR_TokenInformationWrapper* tokenInfo);
-
-void NDR_SetTokenInfoKeyword(NDR_TokenInformation* tokenInformation, char* keyword);
-void NDR_SetTokenInfoToken(NDR_TokenInformation* tokenInformation, char* token);
-void NDR_SetTokenInfoLine(NDR_TokenInformation* tokenInformation, size_t lineNumber);
-void NDR_SetTokenInfoColumn(NDR_TokenInformation* tokenInformation, size_t columnNumber);
-
-char* NDR_GetTokenInfoKeyword(NDR_TokenInformation* tokenInformation);
-char* NDR_GetTokenInfoToken(NDR_TokenInformation* tokenInformation);
-size_t NDR_GetTokenInfoLine(NDR_TokenInformation* tokenInformation);
-size_t NDR_GetTokenInfoColumn(NDR_TokenInformation* tokenInformation);
-
-NDR_TokenInformation* NDR_TIGetTokenInfo(NDR_TokenInformationWrapper* tokenInfo, size_t index);
-NDR_TokenInformation* NDR_TIGetLastTokenInfo(NDR_TokenInformationWrapper* tokenInfo);
-size_t NDR_TIGetNumberOfTokens(NDR_TokenInformationWrapper* tokenInfoWrapper);
-
-#endif
+#ifndef TOKENINFORMATION_H
+#define TOKENINFORMATION_H
+
+#include <stddef.h>
+
+#include "ndr_lineindex.h"
+
+typedef struct NDR_TokenInformation {
+    char* token;
+    char* keyword;
+    // offset is the position of the first character of the token in the input
+    size_t offset;
+    // lookahead counts the characters from offset that were read while lexing the token and the ignored text after it
+    size_t lookahead;
+    // lineIndex holds the line starts of the input so the line and column of offset are only found when asked for, NULL when unknown
+    NDR_LineIndex* lineIndex;
+} NDR_TokenInformation;
+
+typedef struct NDR_TokenInformationWrapper {
+    size_t numTokens;
+    // numTokensCreated counts every token allocated so far. Tokens past numTokens are reused after NDR_ResetTokenInfoWrapper
+    size_t numTokensCreated;
+    size_t memoryAllocated;
+    NDR_TokenInformation** tokens;
+} NDR_TokenInformationWrapper;
+
+void NDR_InitTokenInfoWrapper(NDR_TokenInformationWrapper* tokenInfoWrapper);
+void NDR_FreeTokenInfoWrapper(NDR_TokenInformationWrapper* tokenInfoWrapper);
+void NDR_ResetTokenInfoWrapper(NDR_TokenInformationWrapper* tokenInfoWrapper);
+// Initialize a token that is not held by a wrapper, it is freed with NDR_FreeTokenInfo
+void NDR_InitTokenInfo(NDR_TokenInformation* tokenInformation);
+void NDR_FreeTokenInfo(NDR_TokenInformation* tokenInformation);
+
+void NDR_AddNewToken(NDR_TokenInformationWrapper* tokenInfoWrapper);
+// Move tokens first to first + count - 1 of source to the end of destination and empty source
+void NDR_MoveTokenInfo(NDR_TokenInformationWrapper* destination, NDR_TokenInformationWrapper* source, size_t first, size_t count);
+// Replace tokens first to first + count - 1 of destination with every token of source and empty source
+void NDR_ReplaceTokenInfo(NDR_TokenInformationWrapper* destination, size_t first, size_t count, NDR_TokenInformationWrapper* source);
+NDR_TokenInformation* NDR_GetTokenInfo(NDR_TokenInformationWrapper* tokenInfo, size_t index);
+NDR_TokenInformation* NDR_GetLastTokenInfo(NDR_TokenInformationWrapper* tokenInfo);
+
+void NDR_SetTokenInfoKeyword(NDR_TokenInformation* tokenInformation, char* keyword);
+void NDR_SetTokenInfoToken(NDR_TokenInformation* tokenInformation, char* token);
+// Set the token to the first length characters of token, which does not need to be null terminated
+void NDR_SetTokenInfoTokenRange(NDR_TokenInformation* tokenInformation, const char* token, size_t length);
+void NDR_SetTokenInfoOffset(NDR_TokenInformation* tokenInformation, size_t offset);
+void NDR_SetTokenInfoLineIndex(NDR_TokenInformation* tokenInformation, NDR_LineIndex* lineIndex);
+// Give destination the position of source in the input
+void NDR_CopyTokenInfoPosition(NDR_TokenInformation* destination, NDR_TokenInformation* source);
+
+char* NDR_GetTokenInfoKeyword(NDR_TokenInformation* tokenInformation);
+char* NDR_GetTokenInfoToken(NDR_TokenInformation* tokenInformation);
+// The line and column are found in the line index of the token, they are 0 when the token has none
+size_t NDR_GetTokenInfoLine(NDR_TokenInformation* tokenInformation);
+size_t NDR_GetTokenInfoColumn(NDR_TokenInformation* tokenInformation);
+size_t NDR_GetTokenInfoOffset(NDR_TokenInformation* tokenInformation);
+
+NDR_TokenInformation* NDR_TIGetTokenInfo(NDR_TokenInformationWrapper* tokenInfo, size_t index);
+NDR_TokenInformation* NDR_TIGetLastTokenInfo(NDR_TokenInformationWrapper* tokenInfo);
+size_t NDR_TIGetNumberOfTokens(NDR_TokenInformationWrapper* tokenInfoWrapper);
+
+#endif
@@ -0,0 +1,162 @@
+
+
+/*********************************************************************************
+*                                NDR Token Store                                 *
+**********************************************************************************/
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Neil Runcie
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "ndr_tokenstore.h"
+
+static void CopyTokenString(char** destination, const char* source, size_t length);
+
+void NDR_InitTokenStore(NDR_TokenStore* store){
+    store->numTokens = 0;
+    store->memoryAllocated = 50;
+    store->rules = malloc(sizeof(int) * store->memoryAllocated);
+    store->offsets = malloc(sizeof(size_t) * store->memoryAllocated);
+    store->lengths = malloc(sizeof(size_t) * store->memoryAllocated);
+    store->textOffsets = malloc(sizeof(size_t) * store->memoryAllocated);
+    store->textLength = 0;
+    store->textAllocated = 50;
+    store->text = malloc(store->textAllocated);
+    store->input = NULL;
+    store->inputLength = 0;
+    NDR_InitLineIndex(&store->lineIndex);
+    store->RSWrapper = NULL;
+}
+
+void NDR_FreeTokenStore(NDR_TokenStore* store){
+    free(store->rules);
+    free(store->offsets);
+    free(store->lengths);
+    free(store->textOffsets);
+    free(store->text);
+    NDR_FreeLineIndex(&store->lineIndex);
+}
+
+void NDR_ResetTokenStore(NDR_TokenStore* store, const char* input, size_t inputLength, NDR_RegexStateWrapper* RSWrapper){
+    store->numTokens = 0;
+    store->textLength = 0;
+    store->input = input;
+    store->inputLength = inputLength;
+    NDR_ResetLineIndex(&store->lineIndex);
+    NDR_LineIndexAddText(&store->lineIndex, input, inputLength);
+    store->RSWrapper = RSWrapper;
+}
+
+void NDR_TSAddToken(NDR_TokenStore* store, int rule, size_t offset, const char* token, size_t length){
+    if(store->numTokens > store->memoryAllocated - 5){
+        store->memoryAllocated = store->memoryAllocated * 2;
+        store->rules = realloc(store->rules, sizeof(int) * store->memoryAllocated);
+        store->offsets = realloc(store->offsets, sizeof(size_t) * store->memoryAllocated);
+        store->lengths = realloc(store->lengths, sizeof(size_t) * store->memoryAllocated);
+        store->textOffsets = realloc(store->textOffsets, sizeof(size_t) * store->memoryAllocated);
+    }
+
+    size_t x = store->numTokens;
+    store->rules[x] = rule;
+    store->offsets[x] = offset;
+    store->lengths[x] = length;
+    store->textOffsets[x] = NDR_TOKENSTORE_SPAN;
+
+    // Escapes and NUL bytes are left out of states tokens so their text can differ from the input
+    if(offset > store->inputLength || length > store->inputLength - offset || memcmp(store->input + offset, token, length) != 0){
+        if(store->textLength + length > store->textAllocated - 5){
+            store->textAllocated = (store->textAllocated * 2) + length;
+            store->text = realloc(store->text, store->textAllocated);
+        }
+        memcpy(store->text + store->textLength, token, length);
+        store->textOffsets[x] = store->textLength;
+        store->textLength += length;
+    }
+    store->numTokens++;
+}
+
+size_t NDR_TSGetNumberOfTokens(NDR_TokenStore* store){
+    return store->numTokens;
+}
+
+const char* NDR_TSGetTokenText(NDR_TokenStore* store, size_t index, size_t* length){
+    *length = store->lengths[index];
+    if(store->textOffsets[index] == NDR_TOKENSTORE_SPAN)
+        return store->input + store->offsets[index];
+    return store->text + store->textOffsets[index];
+}
+
+const char* NDR_TSGetTokenKeyword(NDR_TokenStore* store, size_t index, size_t* length){
+    NDR_RegexState* regexState = NDR_RSGetRegexState(store->RSWrapper, store->rules[index]);
+    if(NDR_RSGetLiteralFlag(regexState) == true)
+        return NDR_TSGetTokenText(store, index, length);
+    *length = strlen(NDR_RSGetKeyword(regexState));
+    return NDR_RSGetKeyword(regexState);
+}
+
+int NDR_TSGetTokenRule(NDR_TokenStore* store, size_t index){
+    return store->rules[index];
+}
+
+size_t NDR_TSGetTokenOffset(NDR_TokenStore* store, size_t index){
+    return store->offsets[index];
+}
+
+size_t NDR_TSGetTokenLine(NDR_TokenStore* store, size_t index){
+    return NDR_LineIndexGetLine(&store->lineIndex, store->offsets[index]);
+}
+
+size_t NDR_TSGetTokenColumn(NDR_TokenStore* store, size_t index){
+    return NDR_LineIndexGetColumn(&store->lineIndex, store->offsets[index]);
+}
+
+void NDR_TSGetTokenInfo(NDR_TokenStore* store, size_t index, NDR_TokenInformation* tokenInformation){
+    size_t length;
+    const char* text = NDR_TSGetTokenText(store, index, &length);
+    CopyTokenString(&tokenInformation->token, text, length);
+    text = NDR_TSGetTokenKeyword(store, index, &length);
+    CopyTokenString(&tokenInformation->keyword, text, length);
+
+    tokenInformation->offset = store->offsets[index];
+    tokenInformation->lookahead = 0;
+    tokenInformation->lineIndex = &store->lineIndex;
+}
+
+// Replace a null terminated string of an NDR_TokenInformation structure with length bytes of source
+void CopyTokenString(char** destination, const char* source, size_t length){
+    *destination = realloc(*destination, length + 1);
+    memcpy(*destination, source, length);
+    (*destination)[length] = '\0';
+}
@@ -0,0 +1,160 @@
+
+
+/*********************************************************************************
+*                                NDR Token Store                                 *
+**********************************************************************************/
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Neil Runcie
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef NDRTOKENSTORE_H
+#define NDRTOKENSTORE_H
+
+#include <stddef.h>
+
+#include "ndr_regexstate.h"
+#include "ndr_tokeninformation.h"
+
+// textOffsets holds NDR_TOKENSTORE_SPAN for a token whose text is found unchanged in the input
+#define NDR_TOKENSTORE_SPAN ((size_t) -1)
+
+/**
+* @struct NDR_TokenStore
+* @brief A compact token table that keeps each field of the tokens in its own array and refers to the lexed input for the token text
+*
+* A token costs a few array entries instead of separate allocations for the token, its text and its keyword.
+* The text of a token is a span of the input, so the input must not be freed or changed while the store is used.
+* Only a token whose text differs from the input, such as a states token with escape characters removed, has its text copied
+*/
+typedef struct NDR_TokenStore {
+    size_t numTokens;
+    size_t memoryAllocated;
+    // The token at index x was matched by rule rules[x] of RSWrapper and is lengths[x] bytes long
+    int* rules;
+    size_t* offsets;
+    size_t* lengths;
+    // textOffsets[x] is the position of the text of token x in text when it is not a span of the input
+    size_t* textOffsets;
+    char* text;
+    size_t textLength;
+    size_t textAllocated;
+    // input is the lexed buffer that the spans refer to, it is not owned by the store
+    const char* input;
+    size_t inputLength;
+    // lineIndex holds the line starts of input so the line and column of a token are only found when asked for
+    NDR_LineIndex lineIndex;
+    NDR_RegexStateWrapper* RSWrapper;
+} NDR_TokenStore;
+
+/** @brief Initialize an NDR_TokenStore structure so that it can receive tokens
+*
+* @param store is a structure that has memory allocated to it
+*/
+void NDR_InitTokenStore(NDR_TokenStore* store);
+/** @brief Free the memory held by an NDR_TokenStore structure
+*
+* @param store is an initialized NDR_TokenStore structure
+*/
+void NDR_FreeTokenStore(NDR_TokenStore* store);
+/** @brief Remove every token of a store while keeping its memory for the next input
+*
+* @param store is an initialized NDR_TokenStore structure
+* @param input is the buffer that the tokens added next are found in
+* @param inputLength is the number of bytes of input
+* @param RSWrapper is the symbol table that the rules of the tokens added next refer to
+*/
+void NDR_ResetTokenStore(NDR_TokenStore* store, const char* input, size_t inputLength, NDR_RegexStateWrapper* RSWrapper);
+
+// Add a token matched by rule that starts at offset of the input. The text is only copied when it is not the same as the input at offset
+void NDR_TSAddToken(NDR_TokenStore* store, int rule, size_t offset, const char* token, size_t length);
+
+/** @brief Get the number of tokens held by a store
+*
+* @param store is an initialized NDR_TokenStore structure
+* @return The number of tokens
+*/
+size_t NDR_TSGetNumberOfTokens(NDR_TokenStore* store);
+/** @brief Get the text of a token without copying it
+*
+* @param store is an initialized NDR_TokenStore structure
+* @param index is the position of the token in the store
+* @param length receives the number of bytes of the text
+* @return The text of the token, which is not null terminated
+*/
+const char* NDR_TSGetTokenText(NDR_TokenStore* store, size_t index, size_t* length);
+/** @brief Get the keyword of a token without copying it
+*
+* The keyword of a token matched by a literal rule is its text, otherwise it is the keyword of the rule
+*
+* @param store is an initialized NDR_TokenStore structure
+* @param index is the position of the token in the store
+* @param length receives the number of bytes of the keyword
+* @return The keyword of the token, which is not null terminated
+*/
+const char* NDR_TSGetTokenKeyword(NDR_TokenStore* store, size_t index, size_t* length);
+/** @brief Get the index of the rule of the lexer configuration that matched a token
+*
+* @param store is an initialized NDR_TokenStore structure
+* @param index is the position of the token in the store
+* @return The index of the rule
+*/
+int NDR_TSGetTokenRule(NDR_TokenStore* store, size_t index);
+/** @brief Get the position of the first byte of a token in the input
+*
+* @param store is an initialized NDR_TokenStore structure
+* @param index is the position of the token in the store
+* @return The offset of the token
+*/
+size_t NDR_TSGetTokenOffset(NDR_TokenStore* store, size_t index);
+/** @brief Get the line number of a token
+*
+* @param store is an initialized NDR_TokenStore structure
+* @param index is the position of the token in the store
+* @return The line number of the token, found from its offset
+*/
+size_t NDR_TSGetTokenLine(NDR_TokenStore* store, size_t index);
+/** @brief Get the column number of a token
+*
+* @param store is an initialized NDR_TokenStore structure
+* @param index is the position of the token in the store
+* @return The column number of the token, found from its offset
+*/
+size_t NDR_TSGetTokenColumn(NDR_TokenStore* store, size_t index);
+/** @brief Copy a token of a store into an NDR_TokenInformation structure so that functions such as NDR_GetTokenInfoToken can be used on it
+*
+* @param store is an initialized NDR_TokenStore structure
+* @param index is the position of the token in the store
+* @param tokenInformation is a structure initialized by NDR_InitTokenInfo, it is freed with NDR_FreeTokenInfo
+* Its line and column are found through the store, so they are only available until the store is reset or freed
+*/
+void NDR_TSGetTokenInfo(NDR_TokenStore* store, size_t index, NDR_TokenInformation* tokenInformation);
+
+#endif
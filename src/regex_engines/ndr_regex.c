@@ -42,34 +42,30 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <ctype.h>
 
 #include "ndr_regexnode.h"
+#include "ndr_regexprogram.h"
 #include "ndr_regex.h"
 #include "ndr_regextracker.h"
+#include "ndr_regexnfa.h"
+#include "ndr_regexlazydfa.h"
 
 // Initialize the values in the struct for later use of the NDR_Regex pointer
 void NDR_InitRegex(NDR_Regex* cRegex);
-// Free the memory allocated to the struct for later use of the NDR_Regex pointer
-void NDR_DestroyRegexGraph(NDR_Regex* head);
-
-// For checking if the end of the regex graph can be reached only through optional paths given a node in the graph to start from
-bool IsPathOptional(NDR_RegexNode* follow);
-
-// Below are the functions corresponding to character matching special characters
-// '\N' and '.'
-int checkAllButNewLine(char comp);
-// \e
-int checkEverything(char comp);
-// \d
-int checkDecimalDigit(char comp);
-// \D
-int checkNotDecimalDigit(char comp);
-// \S
-int checkWhiteSpace(char comp);
-// \s
-int checkNotWhiteSpace(char comp);
-// \w
-int checkWordChar(char comp);
-// \W
-int checkNotWordChar(char comp);
+// Flatten the graph built during compilation into the program of the regex, freeing the graph
+int NDR_BuildProgramFromGraph(NDR_Regex* cRegex, NDR_RegexNode* start);
+void NDR_BuildNFAFromProgram(NDR_Regex* cRegex);
+
+// For checking if the end of the regex program can be reached only through optional paths given an instruction in the program to start from
+bool IsPathOptional(NDR_RegexProgram* program, NDR_RegexInstruction* follow, NDR_TrackerStack* wordReferences);
+// Make sure the Pike VM arrays of a scratch can hold a thread for every instruction of an NFA program
+static void ReserveScratchThreads(NDR_RegexScratch* scratch, size_t numInstructions);
+// Step the threads of an NFA program through the token from position i, starting from the threads a lazy DFA stopped at when resumeFrom is not NULL
+static NDR_MatchResult RunPikeVM(NDR_RegexNFA* nfa, char* token, size_t i, NDR_RegexLazyDFA* resumeFrom, NDR_RegexScratch* scratch);
+// Free the stacks and the partly built graph of a regex whose compilation failed. Always returns -1
+static int AbandonRegexCompile(NDR_RNodeStack* startStack, NDR_RNodeStack* endStack, NDR_RegexNode* start);
+// Fill the stats of a lazy DFA, which may be NULL when none has been built
+static void GetLazyDFAStats(NDR_RegexLazyDFA* lazyDFA, NDR_LazyDFAStats* stats);
+// Get the result of matching a cursor from the state of its lazy DFA
+static NDR_MatchResult GetLazyDFAResult(NDR_RegexLazyDFA* lazyDFA, int32_t state);
 
 
 //Based on a provided regex string, create a reference graph for later matching the regex to other strings
@@ -81,11 +77,19 @@ int NDR_CompileRegex(NDR_Regex* cRegex, char* regexString){
         NDR_InitRegex(cRegex);
     }
 
+    // The graph is only used while the regex is parsed and is flattened into the program of the regex once it is complete
+    NDR_RegexNode* start = malloc(sizeof(NDR_RegexNode));
+    NDR_InitRegexNode(start);
+    start->start = true;
+
     // If the matching pattern is empty, set the flag and exit
     if(strcmp(regexString, "") == 0){
         cRegex->isEmpty = true;
-        NDR_RemoveRNodeChild(cRegex->start);
+        NDR_RemoveRNodeChild(start);
+        if(NDR_BuildProgramFromGraph(cRegex, start) != 0)
+            return -1;
         cRegex->initialized = true;
+        NDR_BuildNFAFromProgram(cRegex);
         return 0;
     }
 
@@ -103,8 +107,8 @@ int NDR_CompileRegex(NDR_Regex* cRegex, char* regexString){
     NDR_RNodeStack* endStack = malloc(sizeof(NDR_RNodeStack));
     NDR_InitRNodeStack(endStack);
     // Pushing the starting node into the start and end stack
-    NDR_RNodeStackPush(startStack, cRegex->start);
-    NDR_RNodeStackPush(endStack, cRegex->start);
+    NDR_RNodeStackPush(startStack, start);
+    NDR_RNodeStackPush(endStack, start);
 
     // loop through each character in the regex string
     for(int x = 0; x < strlen(regexString); x++){
@@ -127,11 +131,7 @@ int NDR_CompileRegex(NDR_Regex* cRegex, char* regexString){
         // Perform look ahead for use of the or operator '|' without a word following it
         else if(orJustSeen == true && regexString[x] != '(' ){
             sprintf(cRegex->errorMessage, "Invalid use of '|' operator in regex at char %i. A parentheses enclosed \"word\" must follow the '|' symbol", x+1);
-            NDR_DestroyRegexStack(startStack);
-            NDR_DestroyRegexStack(endStack);
-            free(startStack);
-            free(endStack);
-            return -1;
+            return AbandonRegexCompile(startStack, endStack, start);
         }
         //Otherwise handle all characters
         else{
@@ -268,11 +268,7 @@ int NDR_CompileRegex(NDR_Regex* cRegex, char* regexString){
                         x++;
                         if(strlen(regexString) <= x+3){
                             sprintf(cRegex->errorMessage, "Invalid numerator in regex at char %i", x+1);
-                            NDR_DestroyRegexStack(startStack);
-                            NDR_DestroyRegexStack(endStack);
-                            free(startStack);
-                            free(endStack);
-                            return -1;
+                            return AbandonRegexCompile(startStack, endStack, start);
                         }
                         // Initialize the repeat numbers
                         char* repeatNum1 = malloc((strlen(regexString) - x) + 2);
@@ -295,11 +291,9 @@ int NDR_CompileRegex(NDR_Regex* cRegex, char* regexString){
                             }
                             else{
                                 sprintf(cRegex->errorMessage, "Invalid numerator in regex at char %i. Numerators should either contain one number or two numbers separated by a comma %c", x+1, regexString[x]);
-                                NDR_DestroyRegexStack(startStack);
-                                NDR_DestroyRegexStack(endStack);
-                                free(startStack);
-                                free(endStack);
-                                return -1;
+                                free(repeatNum1);
+                                free(repeatNum2);
+                                return AbandonRegexCompile(startStack, endStack, start);
                             }
                             jump = i;
                         }
@@ -348,21 +342,13 @@ int NDR_CompileRegex(NDR_Regex* cRegex, char* regexString){
                 }
                 else if(startedCharClass == true){
                     sprintf(cRegex->errorMessage, "Invalid character class in regex at char %i", x+1);
-                    NDR_DestroyRegexStack(startStack);
-                    NDR_DestroyRegexStack(endStack);
-                    free(startStack);
-                    free(endStack);
-                    return -1;
+                    return AbandonRegexCompile(startStack, endStack, start);
                 }
             }
             else if(regexString[x] == ']' && isCurrentlyEscaped == false){
                 if(startedCharClass == false){
                     sprintf(cRegex->errorMessage, "Invalid character class in regex at char %i", x+1);
-                    NDR_DestroyRegexStack(startStack);
-                    NDR_DestroyRegexStack(endStack);
-                    free(startStack);
-                    free(endStack);
-                    return -1;
+                    return AbandonRegexCompile(startStack, endStack, start);
                 }
                 else if(startedCharClass == true){
 
@@ -392,20 +378,12 @@ int NDR_CompileRegex(NDR_Regex* cRegex, char* regexString){
                             x++;
                             if(strlen(regexString) <= x+3){
                                 sprintf(cRegex->errorMessage, "Invalid character class in regex at char %i", x+1);
-                                NDR_DestroyRegexStack(startStack);
-                                NDR_DestroyRegexStack(endStack);
-                                free(startStack);
-                                free(endStack);
-                                return -1;
+                                return AbandonRegexCompile(startStack, endStack, start);
                             }
                             // trying to repeat a nonexistent character is invalid
                             else if(NDR_RNodeStackPeek(endStack)->numberOfChars == 0){
                                 sprintf(cRegex->errorMessage, "Invalid character class in regex at char %i", x+1);
-                                NDR_DestroyRegexStack(startStack);
-                                NDR_DestroyRegexStack(endStack);
-                                free(startStack);
-                                free(endStack);
-                                return -1;
+                                return AbandonRegexCompile(startStack, endStack, start);
                             }
                             // Initialize the repeat numbers
                             char* repeatNum1 = malloc((strlen(regexString) - x) + 2);
@@ -428,11 +406,9 @@ int NDR_CompileRegex(NDR_Regex* cRegex, char* regexString){
                                 }
                                 else{
                                     sprintf(cRegex->errorMessage, "Invalid numerator in regex at char %i. Numerators should either contain one number or two numbers separated by a comma %c", x+1, regexString[x]);
-                                    NDR_DestroyRegexStack(startStack);
-                                    NDR_DestroyRegexStack(endStack);
-                                    free(startStack);
-                                    free(endStack);
-                                    return -1;
+                                    free(repeatNum1);
+                                    free(repeatNum2);
+                                    return AbandonRegexCompile(startStack, endStack, start);
                                 }
                                 jump = i;
                             }
@@ -461,51 +437,27 @@ int NDR_CompileRegex(NDR_Regex* cRegex, char* regexString){
             }
             else if(regexString[x] == '{' && isCurrentlyEscaped == false && startedCharClass == false){
                 sprintf(cRegex->errorMessage, "Invalid '{' operator at char %i", x+1);
-                NDR_DestroyRegexStack(startStack);
-                NDR_DestroyRegexStack(endStack);
-                free(startStack);
-                free(endStack);
-                return -1;
+                return AbandonRegexCompile(startStack, endStack, start);
             }
             else if(regexString[x] == '}' && isCurrentlyEscaped == false && startedCharClass == false){
                 sprintf(cRegex->errorMessage, "Invalid numerator closing '}' at char %i", x+1);
-                NDR_DestroyRegexStack(startStack);
-                NDR_DestroyRegexStack(endStack);
-                free(startStack);
-                free(endStack);
-                return -1;
+                return AbandonRegexCompile(startStack, endStack, start);
             }
             else if(regexString[x] == '?' && isCurrentlyEscaped == false && startedCharClass == false){
                 sprintf(cRegex->errorMessage, "Invalid '?' operator at char %i", x+1);
-                NDR_DestroyRegexStack(startStack);
-                NDR_DestroyRegexStack(endStack);
-                free(startStack);
-                free(endStack);
-                return -1;
+                return AbandonRegexCompile(startStack, endStack, start);
             }
             else if(regexString[x] == '*' && isCurrentlyEscaped == false && startedCharClass == false){
                 sprintf(cRegex->errorMessage, "Invalid '*' operator at char %i", x+1);
-                NDR_DestroyRegexStack(startStack);
-                NDR_DestroyRegexStack(endStack);
-                free(startStack);
-                free(endStack);
-                return -1;
+                return AbandonRegexCompile(startStack, endStack, start);
             }
             else if(regexString[x] == '+' && isCurrentlyEscaped == false && startedCharClass == false){
                 sprintf(cRegex->errorMessage, "Invalid '+' operator at char %i", x+1);
-                NDR_DestroyRegexStack(startStack);
-                NDR_DestroyRegexStack(endStack);
-                free(startStack);
-                free(endStack);
-                return -1;
+                return AbandonRegexCompile(startStack, endStack, start);
             }
             else if(regexString[x] == '|' && isCurrentlyEscaped == false && startedCharClass == false){
                 sprintf(cRegex->errorMessage, "The '|' \"or\" operator at char %i must be used after a parentheses enclosed \"word\" or it must be escaped for literal use", x+1);
-                NDR_DestroyRegexStack(startStack);
-                NDR_DestroyRegexStack(endStack);
-                free(startStack);
-                free(endStack);
-                return -1;
+                return AbandonRegexCompile(startStack, endStack, start);
             }
             else if(startedCharClass == true){
                 if(isCurrentlyEscaped == true){
@@ -515,11 +467,7 @@ int NDR_CompileRegex(NDR_Regex* cRegex, char* regexString){
                     else{
                         if(HandleSpecialCharacters(NDR_RNodeStackPeek(endStack), regexString[x]) != 0){
                             sprintf(cRegex->errorMessage, "Invalid special character %c at char %i", regexString[x], x+1);
-                            NDR_DestroyRegexStack(startStack);
-                            NDR_DestroyRegexStack(endStack);
-                            free(startStack);
-                            free(endStack);
-                            return -1;
+                            return AbandonRegexCompile(startStack, endStack, start);
                         }
                     }
                 }
@@ -543,11 +491,7 @@ int NDR_CompileRegex(NDR_Regex* cRegex, char* regexString){
                         }
                         else{
                             sprintf(cRegex->errorMessage, "Invalid '-' operator at char %i", x+1);
-                            NDR_DestroyRegexStack(startStack);
-                            NDR_DestroyRegexStack(endStack);
-                            free(startStack);
-                            free(endStack);
-                            return -1;
+                            return AbandonRegexCompile(startStack, endStack, start);
                         }
 
                     }
@@ -572,11 +516,7 @@ int NDR_CompileRegex(NDR_Regex* cRegex, char* regexString){
                 if(isCurrentlyEscaped == true){
                     if(HandleSpecialCharacters(NDR_RNodeStackPeek(endStack), regexString[x]) != 0){
                         sprintf(cRegex->errorMessage, "Invalid special character %c at char %i", regexString[x], x+1);
-                        NDR_DestroyRegexStack(startStack);
-                        NDR_DestroyRegexStack(endStack);
-                        free(startStack);
-                        free(endStack);
-                        return -1;
+                        return AbandonRegexCompile(startStack, endStack, start);
                     }
                 }
                 else if(regexString[x] == '.'){
@@ -617,20 +557,12 @@ int NDR_CompileRegex(NDR_Regex* cRegex, char* regexString){
                         x++;
                         if(strlen(regexString) <= x+3){
                             sprintf(cRegex->errorMessage, "Invalid numerator in regex at char %i", x+1);
-                            NDR_DestroyRegexStack(startStack);
-                            NDR_DestroyRegexStack(endStack);
-                            free(startStack);
-                            free(endStack);
-                            return -1;
+                            return AbandonRegexCompile(startStack, endStack, start);
                         }
                         // trying to repeat a nonexistent character is invalid
                         else if(NDR_RNodeStackPeek(endStack)->numberOfChars == 0){
                             sprintf(cRegex->errorMessage, "Invalid numerator in regex at char %i", x+1);
-                            NDR_DestroyRegexStack(startStack);
-                            NDR_DestroyRegexStack(endStack);
-                            free(startStack);
-                            free(endStack);
-                            return -1;
+                            return AbandonRegexCompile(startStack, endStack, start);
                         }
                         // Initialize the repeat numbers
                         char* repeatNum1 = malloc((strlen(regexString) - x) + 2);
@@ -653,11 +585,9 @@ int NDR_CompileRegex(NDR_Regex* cRegex, char* regexString){
                             }
                             else{
                                 sprintf(cRegex->errorMessage, "Invalid numerator in regex at char %i. Numerators should either contain one number or two numbers separated by a comma %c", x+1, regexString[x]);
-                                NDR_DestroyRegexStack(startStack);
-                                NDR_DestroyRegexStack(endStack);
-                                free(startStack);
-                                free(endStack);
-                                return -1;
+                                free(repeatNum1);
+                                free(repeatNum2);
+                                return AbandonRegexCompile(startStack, endStack, start);
                             }
                             jump = i;
                         }
@@ -706,23 +636,15 @@ int NDR_CompileRegex(NDR_Regex* cRegex, char* regexString){
 
     if(startedCharClass == true){
         sprintf(cRegex->errorMessage, "Invalid character class in regex");
-        NDR_DestroyRegexStack(startStack);
-        NDR_DestroyRegexStack(endStack);
-        free(startStack);
-        free(endStack);
-        return -1;
+        return AbandonRegexCompile(startStack, endStack, start);
     }
     NDR_RNodeStackPop(endStack);
     if(NDR_RNodeStackIsEmpty(endStack) == false){
         sprintf(cRegex->errorMessage, "Invalid word in regex");
-        NDR_DestroyRegexStack(startStack);
-        NDR_DestroyRegexStack(endStack);
-        free(startStack);
-        free(endStack);
-        return -1;
+        return AbandonRegexCompile(startStack, endStack, start);
     }
 
-    /*NDR_RegexNode* x = cRegex->start;
+    /*NDR_RegexNode* x = start;
     printf("\n\nSTART\n");
     while(x->end != true){
         printf("AETH %i\n", x);
@@ -731,25 +653,54 @@ int NDR_CompileRegex(NDR_Regex* cRegex, char* regexString){
     printf("END\n\n");*/
 
 
-    cRegex->initialized = true;
-
     NDR_DestroyRegexStack(startStack);
     NDR_DestroyRegexStack(endStack);
     free(startStack);
     free(endStack);
 
+    if(NDR_BuildProgramFromGraph(cRegex, start) != 0)
+        return -1;
+
+    cRegex->initialized = true;
+
+    NDR_BuildNFAFromProgram(cRegex);
+
     return 0;
 
  }
 
 
-/// Compare a string to a pre-compiled regex graph
+/// Compare a string to a pre-compiled regex program
+// The backtracking matcher can take exponential time, so it is only used for regexes without an NFA program
 NDR_MatchResult NDR_MatchRegex(NDR_Regex* cRegex, char* token){
 
+    if(cRegex->initialized == true && cRegex->nfa != NULL && cRegex->engine != NDR_REGEX_ENGINE_BACKTRACK)
+        return NDR_MatchRegexPikeVM(cRegex, token);
+
+    NDR_RegexScratch scratch;
+    NDR_InitRegexScratch(&scratch);
+    NDR_MatchResult result = NDR_MatchRegexWithScratch(cRegex, token, &scratch);
+    NDR_DestroyRegexScratch(&scratch);
+
+    return result;
+}
+
+// Every word entered is tracked in the scratch, so matching only allocates memory when the scratch has to grow
+NDR_MatchResult NDR_MatchRegexWithScratch(NDR_Regex* cRegex, char* token, NDR_RegexScratch* scratch){
+
     if(cRegex->initialized == false){
         printf("Regex is not compiled yet\n");
         return NDR_REGEX_FAILURE;
     }
+    if(cRegex->engine == NDR_REGEX_ENGINE_PIKEVM || (cRegex->engine == NDR_REGEX_ENGINE_AUTO && cRegex->nfa != NULL)){
+        if(cRegex->nfa == NULL)
+            return NDR_REGEX_FAILURE;
+        if(token[0] == '\0')
+            return (cRegex->isEmpty == true) ? NDR_REGEX_COMPLETEMATCH : NDR_REGEX_NOMATCH;
+        else if(cRegex->isEmpty == true)
+            return NDR_REGEX_NOMATCH;
+        return RunPikeVM(cRegex->nfa, token, 0, NULL, scratch);
+    }
     // Compare the NDR_CharDescriptor** parts of NDR_Regex type to each consecutive character within the token string
 
     if(strcmp(token, "") == 0 && cRegex->isEmpty == true){
@@ -765,34 +716,38 @@ NDR_MatchResult NDR_MatchRegex(NDR_Regex* cRegex, char* token){
     int numTimesMatched = 0;
 
     // Setting up the stack for keeping track of all word paths within the graph
-    NDR_RegexNode* follow = cRegex->start->children[0];
-    NDR_TrackerStack* wordReferences = malloc(sizeof(NDR_TrackerStack));
-    NDR_InitTrackerStack(wordReferences);
+    NDR_RegexProgram* program = cRegex->program;
+    NDR_RegexInstruction* firstInstruction = NDR_RPROGRAM_CHILD(program, program->instructions, 0);
+    NDR_RegexInstruction* follow = firstInstruction;
+    NDR_TrackerStack* wordReferences = &scratch->wordReferences;
+    NDR_ClearTrackerStack(wordReferences);
 
-    for(int i = 0; i < strlen(token); i++){
+    int tokenLength = (int) strlen(token);
+    for(int i = 0; i < tokenLength; i++){
 
-        if(follow->end == true && cRegex->endString == true){
-            NDR_DestroyRegexTrackerStack(wordReferences);
-            free(wordReferences);
+        if(NDR_RINST_HAS(follow, NDR_RINST_END) == true && cRegex->endString == true){
             return NDR_REGEX_NOMATCH;
         }
 
-        while(follow->end != true){
+        while(NDR_RINST_HAS(follow, NDR_RINST_END) == false){
+
+            // Restarting the match and repeating an instruction both move through the token without the for loop checking its length
+            if(i >= tokenLength)
+                break;
 
-            if(follow->wordStart == true){
+            if(NDR_RINST_HAS(follow, NDR_RINST_WORDSTART) == true){
 
-                NDR_RegexTracker* ref = malloc(sizeof(NDR_RegexTracker));
-                NDR_InitRTracker(ref, follow);
-                NDR_TrackerStackPush(wordReferences, ref);
-                NDR_TrackerStackPeek(wordReferences)->stringPosition = i;
-                follow = follow->children[0];
+                NDR_TrackerStackPush(wordReferences, follow)->stringPosition = i;
+                follow = NDR_RPROGRAM_CHILD(program, follow, 0);
 
                 continue;
             }
-            else if(follow->wordEnd == true){
+            else if(NDR_RINST_HAS(follow, NDR_RINST_WORDEND) == true){
 
-                if(NDR_TrackerStackPeek(wordReferences)->reference->repeatPath == true &&
-                   NDR_TrackerStackPeek(wordReferences)->reference->maxMatches > NDR_TrackerStackPeek(wordReferences)->numberOfRepeats){
+                // A repetition whose last pass consumed no characters would only repeat that empty pass forever, so it is left instead
+                if(NDR_RINST_HAS(NDR_TrackerStackPeek(wordReferences)->reference, NDR_RINST_REPEATPATH) == true &&
+                   NDR_TrackerStackPeek(wordReferences)->reference->maxMatches > NDR_TrackerStackPeek(wordReferences)->numberOfRepeats &&
+                   NDR_TrackerStackPeek(wordReferences)->stringPosition != i){
 
                     (NDR_TrackerStackPeek(wordReferences)->numberOfRepeats)++;
                     follow = NDR_TrackerStackPeek(wordReferences)->reference;
@@ -802,31 +757,29 @@ NDR_MatchResult NDR_MatchRegex(NDR_Regex* cRegex, char* token){
                     NDR_TrackerStackPop(wordReferences);
                 }
 
-                follow = follow->children[0];
+                follow = NDR_RPROGRAM_CHILD(program, follow, 0);
 
                 continue;
 
             }
 
-            if(IsCharacterAccepted(follow, token[i]) == true){
+            if(NDR_RINST_ACCEPTS(follow, token[i]) == true){
                 numTimesMatched++;
                 result = NDR_REGEX_PARTIALMATCH;
 
                 if(numTimesMatched >= follow->minMatches){
                     if(numTimesMatched >= follow->maxMatches){
-                        if(follow->children[0]->end == true && strlen(token)-1 == i){
-                            NDR_DestroyRegexTrackerStack(wordReferences);
-                            free(wordReferences);
+                        if(NDR_RINST_HAS(NDR_RPROGRAM_CHILD(program, follow, 0), NDR_RINST_END) == true && strlen(token)-1 == i){
                             return NDR_REGEX_COMPLETEMATCH;
                         }
                     }
                     if(numTimesMatched >= follow->maxMatches && follow->maxMatches != -1){
-                        follow = follow->children[0];
+                        follow = NDR_RPROGRAM_CHILD(program, follow, 0);
                         numTimesMatched = 0;
                     }
 
                     if(NDR_TrackerStackIsEmpty(wordReferences) == false){
-                        if(follow->wordEnd == true && follow->children[0]->end == true){
+                        if(NDR_RINST_HAS(follow, NDR_RINST_WORDEND) == true && NDR_RINST_HAS(NDR_RPROGRAM_CHILD(program, follow, 0), NDR_RINST_END) == true){
                             continue;
                         }
                     }
@@ -842,23 +795,21 @@ NDR_MatchResult NDR_MatchRegex(NDR_Regex* cRegex, char* token){
                 bool isWord = false;
                 while(NDR_TrackerStackIsEmpty(wordReferences) == false){
                     isWord = true;
-                    if(NDR_TrackerStackPeek(wordReferences)->reference->optionalPath == true){
+                    if(NDR_RINST_HAS(NDR_TrackerStackPeek(wordReferences)->reference, NDR_RINST_OPTIONALPATH) == true){
                         i = NDR_TrackerStackPeek(wordReferences)->stringPosition;
                         NDR_RegexTracker* holdRef = NDR_TrackerStackPop(wordReferences);
 
-                        while(follow->wordReference != holdRef->reference){
-                            follow = follow->children[0];
+                        while(follow->wordReference != NDR_RPROGRAM_INDEX(program, holdRef->reference)){
+                            follow = NDR_RPROGRAM_CHILD(program, follow, 0);
                         }
-                        follow = follow->children[0];
+                        follow = NDR_RPROGRAM_CHILD(program, follow, 0);
 
                     }
-                    else if(NDR_TrackerStackPeek(wordReferences)->reference->repeatPath == true){
+                    else if(NDR_RINST_HAS(NDR_TrackerStackPeek(wordReferences)->reference, NDR_RINST_REPEATPATH) == true){
 
                         if(NDR_TrackerStackPeek(wordReferences)->reference->minMatches > NDR_TrackerStackPeek(wordReferences)->numberOfRepeats && cRegex->beginString == true){
                             NDR_TrackerStackPop(wordReferences);
                             if(NDR_TrackerStackIsEmpty(wordReferences) == true){
-                                NDR_DestroyRegexTrackerStack(wordReferences);
-                                free(wordReferences);
                                 return NDR_REGEX_NOMATCH;
                             }
                             else
@@ -868,7 +819,7 @@ NDR_MatchResult NDR_MatchRegex(NDR_Regex* cRegex, char* token){
                             NDR_TrackerStackPop(wordReferences);
                             if(NDR_TrackerStackIsEmpty(wordReferences) == true){
                                 i = currentIndex++;
-                                follow = cRegex->start->children[0];
+                                follow = firstInstruction;
                                 numTimesMatched = 0;
                             }
                             else
@@ -877,21 +828,19 @@ NDR_MatchResult NDR_MatchRegex(NDR_Regex* cRegex, char* token){
                         else if(NDR_TrackerStackPeek(wordReferences)->reference->minMatches <= NDR_TrackerStackPeek(wordReferences)->numberOfRepeats){
                             i = NDR_TrackerStackPeek(wordReferences)->stringPosition;
 
-                            while(follow->wordReference != NDR_TrackerStackPeek(wordReferences)->reference){
-                                follow = follow->children[0];
+                            while(follow->wordReference != NDR_RPROGRAM_INDEX(program, NDR_TrackerStackPeek(wordReferences)->reference)){
+                                follow = NDR_RPROGRAM_CHILD(program, follow, 0);
                             }
-                            follow = follow->children[0];
+                            follow = NDR_RPROGRAM_CHILD(program, follow, 0);
                             numTimesMatched = 0;
                             NDR_TrackerStackPop(wordReferences);
                         }
 
                     }
-                    else if(NDR_TrackerStackPeek(wordReferences)->reference->orPath == true){
+                    else if(NDR_RINST_HAS(NDR_TrackerStackPeek(wordReferences)->reference, NDR_RINST_ORPATH) == true){
                         if(NDR_TrackerStackPeek(wordReferences)->reference->numberOfChildren - 1 <= NDR_TrackerStackPeek(wordReferences)->currentChild && cRegex->beginString == true){
                             NDR_TrackerStackPop(wordReferences);
                             if(NDR_TrackerStackIsEmpty(wordReferences) == true){
-                                NDR_DestroyRegexTrackerStack(wordReferences);
-                                free(wordReferences);
                                 return NDR_REGEX_NOMATCH;
                             }
                             else
@@ -901,7 +850,7 @@ NDR_MatchResult NDR_MatchRegex(NDR_Regex* cRegex, char* token){
                             NDR_TrackerStackPop(wordReferences);
                             if(NDR_TrackerStackIsEmpty(wordReferences) == true){
                                 i = currentIndex++;
-                                follow = cRegex->start->children[0];
+                                follow = firstInstruction;
                                 numTimesMatched = 0;
                             }
                             else
@@ -909,7 +858,7 @@ NDR_MatchResult NDR_MatchRegex(NDR_Regex* cRegex, char* token){
                         }
                         else if(NDR_TrackerStackPeek(wordReferences)->reference->numberOfChildren - 1 > NDR_TrackerStackPeek(wordReferences)->currentChild){
                             i = NDR_TrackerStackPeek(wordReferences)->stringPosition;
-                            follow = NDR_TrackerStackPeek(wordReferences)->reference->children[++(NDR_TrackerStackPeek(wordReferences)->currentChild)];
+                            follow = NDR_RPROGRAM_CHILD(program, NDR_TrackerStackPeek(wordReferences)->reference, ++(NDR_TrackerStackPeek(wordReferences)->currentChild));
                             numTimesMatched = 0;
                         }
 
@@ -918,8 +867,6 @@ NDR_MatchResult NDR_MatchRegex(NDR_Regex* cRegex, char* token){
                         if(cRegex->beginString == true){
                             NDR_TrackerStackPop(wordReferences);
                             if(NDR_TrackerStackIsEmpty(wordReferences) == true){
-                                NDR_DestroyRegexTrackerStack(wordReferences);
-                                free(wordReferences);
                                 return NDR_REGEX_NOMATCH;
                             }
                             else
@@ -929,7 +876,7 @@ NDR_MatchResult NDR_MatchRegex(NDR_Regex* cRegex, char* token){
                             NDR_TrackerStackPop(wordReferences);
                             if(NDR_TrackerStackIsEmpty(wordReferences) == true){
                                 i = currentIndex++;
-                                follow = cRegex->start->children[0];
+                                follow = firstInstruction;
                                 numTimesMatched = 0;
                             }
                             else
@@ -942,13 +889,11 @@ NDR_MatchResult NDR_MatchRegex(NDR_Regex* cRegex, char* token){
                     continue;
 
                 if(follow->minMatches > numTimesMatched && cRegex->beginString == true){
-                    NDR_DestroyRegexTrackerStack(wordReferences);
-                    free(wordReferences);
                     return NDR_REGEX_NOMATCH;
                 }
                 else if(follow->minMatches > numTimesMatched){
                     i = currentIndex++;
-                    follow = cRegex->start->children[0];
+                    follow = firstInstruction;
                     numTimesMatched = 0;
                     while(NDR_TrackerStackIsEmpty(wordReferences) == false){
                         NDR_TrackerStackPop(wordReferences);
@@ -957,7 +902,7 @@ NDR_MatchResult NDR_MatchRegex(NDR_Regex* cRegex, char* token){
                 }
                 else if(follow->minMatches <= numTimesMatched){// If matching and there is a failure to match after the min number of matches has been met then proceed to the next node and restart
                     numTimesMatched = 0;
-                    follow = follow->children[0];
+                    follow = NDR_RPROGRAM_CHILD(program, follow, 0);
                     i--;
                 }
 
@@ -972,451 +917,440 @@ NDR_MatchResult NDR_MatchRegex(NDR_Regex* cRegex, char* token){
     }
 
 
-    NDR_DestroyRegexTrackerStack(wordReferences);
-    free(wordReferences);
-
-    if(follow->end == false && IsPathOptional(follow) == false){
+    if(NDR_RINST_HAS(follow, NDR_RINST_END) == false && IsPathOptional(program, follow, wordReferences) == false){
         return result;
     }
 
     return NDR_REGEX_COMPLETEMATCH;
 }
 
-bool IsPathOptional(NDR_RegexNode* follow){
+/// Compare a string to the NFA program of a compiled regex
+// Every thread of the program is advanced past each character together, so a token is read once and never rewound
+NDR_MatchResult NDR_MatchRegexPikeVM(NDR_Regex* cRegex, char* token){
+
+    if(cRegex->initialized == false){
+        printf("Regex is not compiled yet\n");
+        return NDR_REGEX_FAILURE;
+    }
+    if(cRegex->nfa == NULL)
+        return NDR_REGEX_FAILURE;
+
+    // The empty token is decided the same way as by the graph walker rather than by the threads at the start of the program
+    if(token[0] == '\0')
+        return (cRegex->isEmpty == true) ? NDR_REGEX_COMPLETEMATCH : NDR_REGEX_NOMATCH;
+    else if(cRegex->isEmpty == true)
+        return NDR_REGEX_NOMATCH;
+
+    NDR_RegexNFA* nfa = cRegex->nfa;
+    size_t i = 0;
+
+    // The lazy DFA is tried first. When it fails partway through the token, the NFA program continues from the threads it reached
+    bool resumeThreads = false;
+    if(cRegex->lazyDFACacheSize > 0){
+        if(cRegex->lazyDFA == NULL){
+            cRegex->lazyDFA = malloc(sizeof(NDR_RegexLazyDFA));
+            NDR_InitRegexLazyDFA(cRegex->lazyDFA, nfa, cRegex->lazyDFACacheSize);
+        }
+        int32_t state = (cRegex->lazyDFA->failed == true) ? NDR_LAZYDFA_FAILED : NDR_LAZYDFA_STARTSTATE;
+        while(state >= 0 && state != NDR_LAZYDFA_DEADSTATE && token[i] != '\0')
+            state = NDR_LazyDFAStep(cRegex->lazyDFA, state, token[i++]);
+        if(state >= 0)
+            return GetLazyDFAResult(cRegex->lazyDFA, state);
+        resumeThreads = (i > 0);
+    }
+
+    NDR_RegexScratch scratch;
+    NDR_InitRegexScratch(&scratch);
+    NDR_MatchResult result = RunPikeVM(nfa, token, i, (resumeThreads == true) ? cRegex->lazyDFA : NULL, &scratch);
+    NDR_DestroyRegexScratch(&scratch);
+
+    return result;
+}
+
+NDR_MatchResult RunPikeVM(NDR_RegexNFA* nfa, char* token, size_t i, NDR_RegexLazyDFA* resumeFrom, NDR_RegexScratch* scratch){
+
+    ReserveScratchThreads(scratch, nfa->numInstructions);
+    size_t* threads = scratch->threads;
+    size_t* nextThreads = scratch->nextThreads;
+
+    size_t numThreads = 0;
+    if(resumeFrom != NULL){
+        numThreads = resumeFrom->numThreads;
+        memcpy(threads, resumeFrom->threads, sizeof(size_t) * numThreads);
+    }
+    else{
+        scratch->generation++;
+        numThreads = NDR_NFAAddThread(nfa, nfa->start, threads, 0, scratch->mark, scratch->generation, scratch->stack);
+    }
+    for(; token[i] != '\0' && numThreads > 0; i++){
+        scratch->generation++;
+        numThreads = NDR_NFAStep(nfa, threads, numThreads, nextThreads, token[i], scratch->mark, scratch->generation, scratch->stack);
+
+        size_t* swap = threads;
+        threads = nextThreads;
+        nextThreads = swap;
+    }
+
+    NDR_MatchResult result = NDR_REGEX_NOMATCH;
+    if(NDR_NFAHasMatch(nfa, threads, numThreads) == true)
+        result = NDR_REGEX_COMPLETEMATCH;
+    else if(numThreads > 0)
+        result = NDR_REGEX_PARTIALMATCH;
+
+    return result;
+}
+
+bool IsPathOptional(NDR_RegexProgram* program, NDR_RegexInstruction* follow, NDR_TrackerStack* wordReferences){
 
-    NDR_TrackerStack* wordReferences = malloc(sizeof(NDR_TrackerStack));
-    NDR_InitTrackerStack(wordReferences);
+    NDR_ClearTrackerStack(wordReferences);
 
-    while(follow->end != true){
-        if(follow->wordStart == true){
-            NDR_RegexTracker* ref = malloc(sizeof(NDR_RegexTracker));
-            NDR_InitRTracker(ref, follow);
-            NDR_TrackerStackPush(wordReferences, ref);
+    while(NDR_RINST_HAS(follow, NDR_RINST_END) == false){
+        if(NDR_RINST_HAS(follow, NDR_RINST_WORDSTART) == true){
+            NDR_TrackerStackPush(wordReferences, follow);
         }
-        else if(follow->wordEnd == true){
+        else if(NDR_RINST_HAS(follow, NDR_RINST_WORDEND) == true){
             NDR_TrackerStackPop(wordReferences);
         }
         else if(follow->minMatches != 0 && NDR_TrackerStackIsEmpty(wordReferences) == false){
 
             while(NDR_TrackerStackIsEmpty(wordReferences) == false){
 
-                if(NDR_TrackerStackPeek(wordReferences)->reference->optionalPath == true){
-                    while(follow->wordReference != NDR_TrackerStackPeek(wordReferences)->reference){
-                        follow = follow->children[0];
+                if(NDR_RINST_HAS(NDR_TrackerStackPeek(wordReferences)->reference, NDR_RINST_OPTIONALPATH) == true){
+                    while(follow->wordReference != NDR_RPROGRAM_INDEX(program, NDR_TrackerStackPeek(wordReferences)->reference)){
+                        follow = NDR_RPROGRAM_CHILD(program, follow, 0);
                     }
                     NDR_TrackerStackPop(wordReferences);
                     break;
                 }
-                else if(NDR_TrackerStackPeek(wordReferences)->reference->orPath == true){
+                else if(NDR_RINST_HAS(NDR_TrackerStackPeek(wordReferences)->reference, NDR_RINST_ORPATH) == true){
                     if(NDR_TrackerStackPeek(wordReferences)->reference->numberOfChildren - 1 <= NDR_TrackerStackPeek(wordReferences)->currentChild){
-                        NDR_DestroyRegexTrackerStack(wordReferences);
-                        free(wordReferences);
                         return false;
                     }
                     else{
-                        follow = NDR_TrackerStackPeek(wordReferences)->reference->children[++(NDR_TrackerStackPeek(wordReferences)->currentChild)];
+                        follow = NDR_RPROGRAM_CHILD(program, NDR_TrackerStackPeek(wordReferences)->reference, ++(NDR_TrackerStackPeek(wordReferences)->currentChild));
                     }
                     break;
                 }
                 else{
                     NDR_TrackerStackPop(wordReferences);
                     if((NDR_TrackerStackIsEmpty(wordReferences) == true)){
-                        NDR_DestroyRegexTrackerStack(wordReferences);
-                        free(wordReferences);
                         return false;
                     }
                 }
             }
         }
         else if(follow->minMatches != 0 && NDR_TrackerStackIsEmpty(wordReferences) == true){
-            NDR_DestroyRegexTrackerStack(wordReferences);
-            free(wordReferences);
             return false;
         }
-        follow = follow->children[0];
+        follow = NDR_RPROGRAM_CHILD(program, follow, 0);
     }
 
-    NDR_DestroyRegexTrackerStack(wordReferences);
-    free(wordReferences);
-
     return true;
 }
 
-int checkAllButNewLine(char comp){
-    char compare[] = {'\n'};
-    int length = 1;
+void NDR_InitRegex(NDR_Regex* cRegex){
+    cRegex->initialized = false;
+    cRegex->beginString = false;
+    cRegex->endString = false;
+    cRegex->isEmpty = false;
+    cRegex->engine = NDR_REGEX_ENGINE_AUTO;
+    strcpy(cRegex->errorMessage, "");
+    cRegex->program = NULL;
+    cRegex->nfa = NULL;
+    cRegex->lazyDFACacheSize = NDR_LAZYDFA_DEFAULTCACHE;
+    cRegex->lazyDFA = NULL;
+}
 
-    for(int i = 0; i < length; i++){
-        if(compare[i] == comp){
-            return -1;
-        }
+void NDR_DestroyRegex(NDR_Regex* graph){
+    free(graph->program);
+    graph->program = NULL;
+    if(graph->nfa != NULL){
+        NDR_DestroyRegexNFA(graph->nfa);
+        free(graph->nfa);
+        graph->nfa = NULL;
+    }
+    if(graph->lazyDFA != NULL){
+        NDR_DestroyRegexLazyDFA(graph->lazyDFA);
+        free(graph->lazyDFA);
+        graph->lazyDFA = NULL;
     }
+}
 
-    return 0;
+// Words that are still open are not linked into the graph yet, so the nodes on the stacks are freed along with it
+int AbandonRegexCompile(NDR_RNodeStack* startStack, NDR_RNodeStack* endStack, NDR_RegexNode* start){
+    NDR_RegexNode** roots = malloc(sizeof(NDR_RegexNode*) * (1 + startStack->numNodes + endStack->numNodes));
+    roots[0] = start;
+    memcpy(roots + 1, startStack->nodes, sizeof(NDR_RegexNode*) * startStack->numNodes);
+    memcpy(roots + 1 + startStack->numNodes, endStack->nodes, sizeof(NDR_RegexNode*) * endStack->numNodes);
+    NDR_FreeRegexGraph(roots, 1 + startStack->numNodes + endStack->numNodes);
+    free(roots);
+
+    NDR_DestroyRegexStack(startStack);
+    NDR_DestroyRegexStack(endStack);
+    free(startStack);
+    free(endStack);
+    return -1;
 }
 
-int checkEverything(char comp){
+// The graph is freed whether or not it could be flattened
+int NDR_BuildProgramFromGraph(NDR_Regex* cRegex, NDR_RegexNode* start){
+    cRegex->program = NDR_BuildRegexProgram(start);
+    if(cRegex->program == NULL){
+        sprintf(cRegex->errorMessage, "Regex is too large to compile");
+        return -1;
+    }
     return 0;
 }
 
-int checkDecimalDigit(char comp){
-    char compare[] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9'};
-    int length = 10;
-
-    for(int i = 0; i < length; i++){
-        if(compare[i] == comp){
-            return 0;
-        }
+// Convert the compiled regex program into an NFA program
+// Regexes that cannot be converted are left without an NFA program so that only the backtracking matcher is used for them
+void NDR_BuildNFAFromProgram(NDR_Regex* cRegex){
+    cRegex->nfa = malloc(sizeof(NDR_RegexNFA));
+    NDR_InitRegexNFA(cRegex->nfa);
+    if(NDR_BuildRegexNFA(cRegex->nfa, cRegex->program, cRegex->beginString, cRegex->endString, cRegex->isEmpty) != 0){
+        NDR_DestroyRegexNFA(cRegex->nfa);
+        free(cRegex->nfa);
+        cRegex->nfa = NULL;
     }
+}
 
-    return -1;
+bool NDR_Regex_IsCompiled(NDR_Regex* ndrregex){
+    return ndrregex->initialized;
 }
 
-int checkNotDecimalDigit(char comp){
-    char compare[] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9'};
-    int length = 10;
+bool NDR_Regex_HasBeginFlag(NDR_Regex* ndrregex){
+    return ndrregex->beginString;
+}
 
-    for(int i = 0; i < length; i++){
-        if(compare[i] == comp){
-            return -1;
-        }
-    }
+bool NDR_Regex_HasEndFlag(NDR_Regex* ndrregex){
+    return ndrregex->endString;
+}
+
+bool NDR_Regex_IsEmpty(NDR_Regex* ndrregex){
+    return ndrregex->isEmpty;
+}
 
+int NDR_Regex_SetEngine(NDR_Regex* ndrregex, NDR_RegexEngine engine){
+    if(engine == NDR_REGEX_ENGINE_PIKEVM && (ndrregex->initialized == false || ndrregex->nfa == NULL)){
+        strcpy(ndrregex->errorMessage, "The regex cannot be converted into an NFA program for the Pike VM");
+        return 1;
+    }
+    // The graph walker gives wrong results for repeated and optional parts, so it is only kept for regexes the Pike VM cannot match
+    if(engine == NDR_REGEX_ENGINE_BACKTRACK && (ndrregex->initialized == false || ndrregex->nfa != NULL)){
+        strcpy(ndrregex->errorMessage, "The backtracking matcher can only be used by regexes without an NFA program, use the auto or pikevm engine");
+        return 1;
+    }
+    ndrregex->engine = engine;
     return 0;
 }
 
-int checkWhiteSpace(char comp){
-    char compare[] = {' ', '\t'};
-    int length = 2;
+NDR_RegexEngine NDR_Regex_GetEngine(NDR_Regex* ndrregex){
+    return ndrregex->engine;
+}
 
-    for(int i = 0; i < length; i++){
-        if(compare[i] == comp){
-            return 0;
-        }
+// The states cached so far are discarded and built again within the new size by the next match
+void NDR_Regex_SetLazyDFACacheSize(NDR_Regex* ndrregex, size_t cacheSize){
+    if(ndrregex->lazyDFA != NULL){
+        NDR_DestroyRegexLazyDFA(ndrregex->lazyDFA);
+        free(ndrregex->lazyDFA);
+        ndrregex->lazyDFA = NULL;
     }
+    ndrregex->lazyDFACacheSize = cacheSize;
+}
 
-    return -1;
+size_t NDR_Regex_GetLazyDFACacheSize(NDR_Regex* ndrregex){
+    return ndrregex->lazyDFACacheSize;
 }
 
-int checkNotWhiteSpace(char comp){
-    char compare[] = {' ', '\t'};
-    int length = 2;
+void NDR_Regex_GetLazyDFAStats(NDR_Regex* ndrregex, NDR_LazyDFAStats* stats){
+    GetLazyDFAStats(ndrregex->lazyDFA, stats);
+}
 
-    for(int i = 0; i < length; i++){
-        if(compare[i] == comp){
-            return -1;
-        }
-    }
+char* NDR_Regex_GetErrorMessage(NDR_Regex* ndrregex){
+    return ndrregex->errorMessage;
+}
 
-    return 0;
+NDR_RegexProgram* NDR_Regex_GetProgram(NDR_Regex* ndrregex){
+    return ndrregex->program;
 }
 
-int checkWordChar(char comp){
-    char compare[] = {'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z',
-    'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z',
-    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '_'};
-    int length = 63;
+NDR_RegexNFA* NDR_Regex_GetNFA(NDR_Regex* ndrregex){
+    return ndrregex->nfa;
+}
 
-    for(int i = 0; i < length; i++){
-        if(compare[i] == comp){
-            return 0;
-        }
-    }
 
-    return -1;
+void NDR_InitRegexScratch(NDR_RegexScratch* scratch){
+    NDR_InitTrackerStack(&scratch->wordReferences);
+    scratch->threads = NULL;
+    scratch->nextThreads = NULL;
+    scratch->mark = NULL;
+    scratch->stack = NULL;
+    scratch->threadsAllocated = 0;
+    scratch->generation = 0;
 }
 
-int checkNotWordChar(char comp){
-    char compare[] = {'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z',
-    'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z',
-    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '_'};
-    int length = 63;
+void NDR_DestroyRegexScratch(NDR_RegexScratch* scratch){
+    NDR_DestroyRegexTrackerStack(&scratch->wordReferences);
+    free(scratch->threads);
+    free(scratch->nextThreads);
+    free(scratch->mark);
+    free(scratch->stack);
+}
 
-    for(int i = 0; i < length; i++){
-        if(compare[i] == comp){
-            return -1;
+// The marks are only compared against the generation of the current step, so they are cleared only when the arrays are replaced
+void ReserveScratchThreads(NDR_RegexScratch* scratch, size_t numInstructions){
+    if(numInstructions <= scratch->threadsAllocated)
+        return;
+
+    free(scratch->threads);
+    free(scratch->nextThreads);
+    free(scratch->mark);
+    free(scratch->stack);
+    scratch->threadsAllocated = numInstructions;
+    scratch->threads = malloc(sizeof(size_t) * numInstructions);
+    scratch->nextThreads = malloc(sizeof(size_t) * numInstructions);
+    scratch->mark = calloc(numInstructions, sizeof(size_t));
+    scratch->stack = malloc(sizeof(size_t) * numInstructions);
+    scratch->generation = 0;
+}
+
+void NDR_InitRegexCursor(NDR_RegexCursor* cursor, NDR_Regex* cRegex){
+    cursor->regex = cRegex;
+    cursor->threads = NULL;
+    cursor->nextThreads = NULL;
+    cursor->mark = NULL;
+    cursor->stack = NULL;
+    cursor->lazyDFA = NULL;
+    cursor->lazyDFAState = NDR_LAZYDFA_FAILED;
+    cursor->token = NULL;
+    cursor->memoryAllocated = 0;
+    NDR_InitRegexScratch(&cursor->scratch);
+
+    // Regexes with an NFA program are stepped through their threads, any others are matched by the graph walker over the stored token
+    if(cRegex->initialized == true && cRegex->nfa != NULL && cRegex->engine != NDR_REGEX_ENGINE_BACKTRACK){
+        size_t numInstructions = cRegex->nfa->numInstructions;
+        cursor->threads = malloc(sizeof(size_t) * numInstructions);
+        cursor->nextThreads = malloc(sizeof(size_t) * numInstructions);
+        cursor->mark = calloc(numInstructions, sizeof(size_t));
+        cursor->stack = malloc(sizeof(size_t) * numInstructions);
+        // Each cursor keeps its own lazy DFA so that cursors for the same regex can be used on different threads
+        if(cRegex->lazyDFACacheSize > 0){
+            cursor->lazyDFA = malloc(sizeof(NDR_RegexLazyDFA));
+            NDR_InitRegexLazyDFA(cursor->lazyDFA, cRegex->nfa, cRegex->lazyDFACacheSize);
         }
     }
+    else{
+        cursor->memoryAllocated = 50;
+        cursor->token = malloc(cursor->memoryAllocated);
+    }
+    cursor->generation = 0;
 
-    return 0;
+    NDR_ResetRegexCursor(cursor);
 }
 
-int HandleSpecialCharacters(NDR_RegexNode* node, char comp){
+void NDR_ResetRegexCursor(NDR_RegexCursor* cursor){
+    cursor->result = NDR_REGEX_PARTIALMATCH;
+    cursor->numThreads = 0;
+    cursor->tokenLength = 0;
 
-    // Below are the special characters for denoting specific classes of characters
-    if(comp == 'N'){
-        node->allButNewLine = true;
-    }
-    else if(comp == 'e'){
-        node->everything = true;
-    }
-    else if(comp == 'E'){
-        node->nothing = true;
-    }
-    else if(comp == 'd'){
-        node->decimalDigit = true;
-    }
-    else if(comp == 'D'){
-        node->notDecimalDigit = true;
-    }
-    else if(comp == 's'){
-        node->whiteSpace = true;
-    }
-    else if(comp == 'S'){
-        node->notWhiteSpace = true;
-    }
-    else if(comp == 'w'){
-        node->wordChar = true;
-    }
-    else if(comp == 'W'){
-        node->notWordChar = true;
-    }
-    // Below are the special characters for structural specification within the regex engine
-    else if(comp == '['){
-        NDR_AddRNodeChar(node, '[');
-    }
-    else if(comp == ']'){
-        NDR_AddRNodeChar(node, ']');
-    }
-    else if(comp == '('){
-        NDR_AddRNodeChar(node, '(');
-    }
-    else if(comp == ')'){
-        NDR_AddRNodeChar(node, ')');
-    }
-    else if(comp == '{'){
-        NDR_AddRNodeChar(node, '{');
-    }
-    else if(comp == '}'){
-        NDR_AddRNodeChar(node, '}');
-    }
-    else if(comp == '|'){
-        NDR_AddRNodeChar(node, '|');
+    if(cursor->regex->initialized == false){
+        cursor->result = NDR_REGEX_FAILURE;
     }
-    else if(comp == '$'){
-        NDR_AddRNodeChar(node, '$');
+    else if(cursor->lazyDFA != NULL && cursor->lazyDFA->failed == false){
+        cursor->lazyDFAState = NDR_LAZYDFA_STARTSTATE;
     }
-    else if(comp == '%'){
-        NDR_AddRNodeChar(node, '%');
-    }
-    else if(comp == '?'){
-        NDR_AddRNodeChar(node, '?');
-    }
-    else if(comp == '*'){
-        NDR_AddRNodeChar(node, '*');
-    }
-    else if(comp == '+'){
-        NDR_AddRNodeChar(node, '+');
-    }
-    else if(comp == '.'){
-        NDR_AddRNodeChar(node, '.');
-    }
-    else if(comp == '^'){
-        NDR_AddRNodeChar(node, '^');
-    }
-    // Below are the special characters within the c language
-    else if(comp == 'a'){
-        NDR_AddRNodeChar(node, '\a');
-    }
-    else if(comp == 'b'){
-        NDR_AddRNodeChar(node, '\b');
-    }
-    else if(comp == 'f'){
-        NDR_AddRNodeChar(node, '\f');
-    }
-    else if(comp == 'n'){
-        NDR_AddRNodeChar(node, '\n');
-    }
-    else if(comp == 'r'){
-        NDR_AddRNodeChar(node, '\r');
-    }
-    else if(comp == 't'){
-        NDR_AddRNodeChar(node, '\t');
-    }
-    else if(comp == 'v'){
-        NDR_AddRNodeChar(node, '\v');
-    }
-    else if(comp == '\\'){
-        NDR_AddRNodeChar(node, '\\');
+    else if(cursor->mark != NULL){
+        cursor->lazyDFAState = NDR_LAZYDFA_FAILED;
+        cursor->generation++;
+        cursor->numThreads = NDR_NFAAddThread(cursor->regex->nfa, cursor->regex->nfa->start, cursor->threads, 0, cursor->mark, cursor->generation, cursor->stack);
     }
     else{
-        return -1;
+        cursor->token[0] = '\0';
     }
-
-    return 0;
 }
 
-bool IsCharacterAccepted(NDR_RegexNode* node, char comp){
+NDR_MatchResult NDR_RegexStep(NDR_RegexCursor* cursor, char ch){
 
-    bool validChar = false;
+    if(cursor->result == NDR_REGEX_NOMATCH || cursor->result == NDR_REGEX_FAILURE)
+        return cursor->result;
 
-    for(int x = 0; x < node->numberOfChars; x++){
-        //printf("trying %c %c %i %i\n", comp, node->acceptChars[x], node->minMatches, node->maxMatches);
-        if(comp == node->acceptChars[x]){
-            //printf("matched %c %c\n", comp, node->acceptChars[x]);
-            validChar = true;
-            break;
-        }
-    }
-
-    if(node->allButNewLine == true){//printf("trying allButNewLine %c %i %i\n", comp, node->minMatches, node->maxMatches);
-        if(checkAllButNewLine(comp) == 0){//printf("matched allButNewLine %c\n", comp);
-            validChar = true;
-        }
-        else
-            validChar = false;
-    }
-    if(node->everything == true){//printf("trying everything %c %i %i\n", comp, node->minMatches, node->maxMatches);
-        if(checkEverything(comp) == 0){//printf("matched everything %c\n", comp);
-            validChar = true;
-        }
-        else
-            validChar = false;
-    }
-    if(node->decimalDigit == true){//printf("trying decimalDigit %c %i %i\n", comp, node->minMatches, node->maxMatches);
-        if(checkDecimalDigit(comp) == 0){//printf("matched decimalDigit %c\n", comp);
-            validChar = true;
-        }
-        else
-            validChar = false;
-    }
-   if(node->notDecimalDigit == true){//printf("trying notDecimalDigit %c %i %i\n", comp, node->minMatches, node->maxMatches);
-        if(checkNotDecimalDigit(comp) == 0){//printf("matched notDecimalDigit %c\n", comp);
-            validChar = true;
-        }
-        else
-            validChar = false;
-    }
-    if(node->whiteSpace == true){//printf("trying whiteSpace %c %i %i\n", comp, node->minMatches, node->maxMatches);
-        if(checkWhiteSpace(comp) == 0){//printf("matched whiteSpace %c\n", comp);
-            validChar = true;
-        }
-        else
-            validChar = false;
-    }
-    if(node->notWhiteSpace == true){//printf("trying notWhiteSpace %c %i %i\n", comp, node->minMatches, node->maxMatches);
-        if(checkNotWhiteSpace(comp) == 0){//printf("matched notWhiteSpace %c\n", comp);
-            validChar = true;
+    if(cursor->mark == NULL){
+        if(cursor->tokenLength + 2 > cursor->memoryAllocated){
+            cursor->memoryAllocated = cursor->memoryAllocated * 2;
+            cursor->token = realloc(cursor->token, cursor->memoryAllocated);
         }
-        else
-            validChar = false;
-    }
-    if(node->wordChar == true){//printf("trying wordChar %c %i %i\n", comp, node->minMatches, node->maxMatches);
-        if(checkWordChar(comp) == 0){//printf("matched wordChar %c\n", comp);
-            validChar = true;
+        cursor->token[cursor->tokenLength++] = ch;
+        cursor->token[cursor->tokenLength] = '\0';
+        cursor->result = NDR_MatchRegexWithScratch(cursor->regex, cursor->token, &cursor->scratch);
+        return cursor->result;
+    }
+
+    if(cursor->lazyDFAState >= 0){
+        int32_t state = NDR_LazyDFAStep(cursor->lazyDFA, cursor->lazyDFAState, ch);
+        if(state != NDR_LAZYDFA_FAILED){
+            cursor->lazyDFAState = state;
+            cursor->result = GetLazyDFAResult(cursor->lazyDFA, state);
+            return cursor->result;
         }
-        else
-            validChar = false;
+        // The lazy DFA failed on this character, the rest of the token is matched from the threads it reached
+        cursor->lazyDFAState = NDR_LAZYDFA_FAILED;
+        cursor->numThreads = cursor->lazyDFA->numThreads;
+        memcpy(cursor->threads, cursor->lazyDFA->threads, sizeof(size_t) * cursor->numThreads);
     }
+    else{
+        cursor->generation++;
+        cursor->numThreads = NDR_NFAStep(cursor->regex->nfa, cursor->threads, cursor->numThreads, cursor->nextThreads, ch, cursor->mark, cursor->generation, cursor->stack);
 
-    if(node->notWordChar == true){//printf("trying notWordChar %c %i %i\n", comp, node->minMatches, node->maxMatches);
-        if(checkNotWordChar(comp) == 0){//printf("matched notWordChar %c\n", comp);
-            validChar = true;
-        }
-        else
-            validChar = false;
+        size_t* swap = cursor->threads;
+        cursor->threads = cursor->nextThreads;
+        cursor->nextThreads = swap;
     }
 
-    if(node->negatedClass){
-        if(validChar == true)
-            validChar = false;
-        else
-            validChar = true;
-    }
+    if(NDR_NFAHasMatch(cursor->regex->nfa, cursor->threads, cursor->numThreads) == true)
+        cursor->result = NDR_REGEX_COMPLETEMATCH;
+    else if(cursor->numThreads > 0)
+        cursor->result = NDR_REGEX_PARTIALMATCH;
+    else
+        cursor->result = NDR_REGEX_NOMATCH;
 
-    return validChar;
+    return cursor->result;
 }
 
-
-void NDR_InitRegex(NDR_Regex* cRegex){
-    cRegex->initialized = false;
-    cRegex->beginString = false;
-    cRegex->endString = false;
-    cRegex->isEmpty = false;
-    strcpy(cRegex->errorMessage, "");
-    cRegex->start = malloc(sizeof(NDR_RegexNode));
-    NDR_InitRegexNode(cRegex->start);
-    cRegex->start->start = true;
-}
-
-void NDR_DestroyRegex(NDR_Regex* graph){
-    NDR_DestroyRegexGraph(graph);
-}
-
-void NDR_DestroyRegexGraph(NDR_Regex* head){
-
-    if(head->initialized == true){
-        if(head != NULL){
-            size_t duplicatePostDepthTrackerCount = 0;
-            size_t dupeTrackerMemoryAllocated = 50;
-
-            NDR_RNodeStack* depthTracker = malloc(sizeof(NDR_RNodeStack));
-            NDR_InitRNodeStack(depthTracker);
-            NDR_RegexNode** duplicateTracker = malloc(sizeof(NDR_RegexNode*) * dupeTrackerMemoryAllocated);
-
-            NDR_RegexNode* follow = head->start;
-
-            NDR_RNodeStackPush(depthTracker, follow);
-
-            size_t count;
-            while(!NDR_RNodeStackIsEmpty(depthTracker)){
-                count = 0;
-                while(count < follow->numberOfChildren){
-                    if(!NDR_RNodeDuplicate(follow->children[count], duplicateTracker, duplicatePostDepthTrackerCount)){
-                        follow = follow->children[count];
-                        NDR_RNodeStackPush(depthTracker, follow);
-                        count = 0;
-                        continue;
-                    }
-                    count++;
-                }
-
-                if(!NDR_RNodeDuplicate(follow, duplicateTracker, duplicatePostDepthTrackerCount)){
-                    duplicateTracker[duplicatePostDepthTrackerCount++] = (follow);
-                    if(duplicatePostDepthTrackerCount >= dupeTrackerMemoryAllocated - 2){
-                        dupeTrackerMemoryAllocated = dupeTrackerMemoryAllocated * 2;
-                        duplicateTracker = realloc(duplicateTracker, sizeof(NDR_RegexNode*) * dupeTrackerMemoryAllocated);
-                    }
-                }
-
-                NDR_RNodeStackPop(depthTracker);
-
-                if(!NDR_RNodeStackIsEmpty(depthTracker))
-                    follow = NDR_RNodeStackPeek(depthTracker);
-            }
-
-            for(size_t x = 0; x < duplicatePostDepthTrackerCount; x++){
-                NDR_DestroyRegexNode(duplicateTracker[x]);
-                free(duplicateTracker[x]);
-            }
-            NDR_DestroyRegexStack(depthTracker);
-            free(depthTracker);
-            free(duplicateTracker);
-        }
+void NDR_DestroyRegexCursor(NDR_RegexCursor* cursor){
+    free(cursor->threads);
+    free(cursor->nextThreads);
+    free(cursor->mark);
+    free(cursor->stack);
+    free(cursor->token);
+    NDR_DestroyRegexScratch(&cursor->scratch);
+    if(cursor->lazyDFA != NULL){
+        NDR_DestroyRegexLazyDFA(cursor->lazyDFA);
+        free(cursor->lazyDFA);
     }
-
-}
-
-bool NDR_Regex_IsCompiled(NDR_Regex* ndrregex){
-    return ndrregex->initialized;
 }
 
-bool NDR_Regex_HasBeginFlag(NDR_Regex* ndrregex){
-    return ndrregex->beginString;
+void NDR_RegexCursor_GetLazyDFAStats(NDR_RegexCursor* cursor, NDR_LazyDFAStats* stats){
+    GetLazyDFAStats(cursor->lazyDFA, stats);
 }
 
-bool NDR_Regex_HasEndFlag(NDR_Regex* ndrregex){
-    return ndrregex->endString;
+void GetLazyDFAStats(NDR_RegexLazyDFA* lazyDFA, NDR_LazyDFAStats* stats){
+    memset(stats, 0, sizeof(NDR_LazyDFAStats));
+    if(lazyDFA == NULL)
+        return;
+    stats->used = true;
+    stats->failed = lazyDFA->failed;
+    stats->cacheSize = lazyDFA->cacheSize;
+    stats->memoryUsed = lazyDFA->memoryUsed;
+    stats->numStates = lazyDFA->numStates;
+    stats->statesBuilt = lazyDFA->statesBuilt;
+    stats->flushes = lazyDFA->flushes;
+    stats->bytesMatched = lazyDFA->bytesMatched;
 }
 
-bool NDR_Regex_IsEmpty(NDR_Regex* ndrregex){
-    return ndrregex->isEmpty;
-}
-
-char* NDR_Regex_GetErrorMessage(NDR_Regex* ndrregex){
-    return ndrregex->errorMessage;
-}
-
-NDR_RegexNode*  NDR_Regex_GetStartNode(NDR_Regex* ndrregex){
-    return ndrregex->start;
+NDR_MatchResult GetLazyDFAResult(NDR_RegexLazyDFA* lazyDFA, int32_t state){
+    if(NDR_LazyDFAIsMatch(lazyDFA, state) == true)
+        return NDR_REGEX_COMPLETEMATCH;
+    else if(state != NDR_LAZYDFA_DEADSTATE)
+        return NDR_REGEX_PARTIALMATCH;
+    return NDR_REGEX_NOMATCH;
 }
@@ -38,21 +38,71 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef NDRREGEX_H
 #define NDRREGEX_H
 
+#include <stddef.h>
 #include <stdbool.h>
 
+#include "ndr_regextracker.h"
+
 /**
 * \enum NDR_MatchResult
 * \brief Provides codes for the result of the regex matching process
+*
+* With an NFA program NDR_REGEX_COMPLETEMATCH means the string holds a match, NDR_REGEX_PARTIALMATCH means more characters could still complete one
+* and NDR_REGEX_NOMATCH means no string starting with it can match. A match may start at any character unless the regex begins with '$',
+* so a regex without '$' gives NDR_REGEX_PARTIALMATCH rather than NDR_REGEX_NOMATCH for strings it does not match yet,
+* and a regex ending with '%' completes on any string whose last characters match, e.g. "[a]%" on "aaaa".
+* Releases that only had the backtracking matcher gave NDR_REGEX_NOMATCH for these strings
 */
 typedef enum NDR_MatchResult {
     NDR_REGEX_FAILURE, NDR_REGEX_NOMATCH, NDR_REGEX_PARTIALMATCH, NDR_REGEX_COMPLETEMATCH
 } NDR_MatchResult;
 
 /**
-* \struct NDR_RegexNode
-* \brief The regex node struct acts as the nodes within the regex graphs used for regular expression comparison
+* \enum NDR_RegexEngine
+* \brief Selects how a compiled regex is matched
+*
+* NDR_REGEX_ENGINE_AUTO matches with the NFA program of the regex, both one character at a time and for whole strings, and uses the backtracking graph walker only for regexes without a program.
+* NDR_REGEX_ENGINE_BACKTRACK always uses the graph walker, and can only be used by regexes without a program since it gives wrong results for repeated and optional parts.
+* NDR_REGEX_ENGINE_PIKEVM always simulates the NFA program, taking time proportional to the size of the program times the length of the string, and can only be used by regexes with a program
+*/
+typedef enum NDR_RegexEngine {
+    NDR_REGEX_ENGINE_AUTO, NDR_REGEX_ENGINE_BACKTRACK, NDR_REGEX_ENGINE_PIKEVM
+} NDR_RegexEngine;
+
+/**
+* \struct NDR_RegexProgram
+* \brief The regex program struct holds a compiled regex as a single block of instructions that refer to each other by index
+*/
+typedef struct NDR_RegexProgram NDR_RegexProgram;
+
+/**
+* \struct NDR_RegexNFA
+* \brief The regex NFA struct holds a flat automaton equivalent to the regex graph, used for building combined lexer automata
 */
-typedef struct NDR_RegexNode NDR_RegexNode;
+typedef struct NDR_RegexNFA NDR_RegexNFA;
+
+/**
+* \struct NDR_RegexLazyDFA
+* \brief The regex lazy DFA struct caches DFA states built from the NFA program of a regex as characters are matched
+*/
+typedef struct NDR_RegexLazyDFA NDR_RegexLazyDFA;
+
+/**
+* \struct NDR_LazyDFAStats
+* \brief Describes the work done by the lazy DFA of a regex or cursor
+*/
+typedef struct NDR_LazyDFAStats {
+    // used is false when no lazy DFA has been built, in which case the other values are 0
+    bool used;
+    // failed is true once the cache was flushed too often to be worth keeping and the NFA program is stepped through instead
+    bool failed;
+    size_t cacheSize;
+    size_t memoryUsed;
+    size_t numStates;
+    size_t statesBuilt;
+    size_t flushes;
+    size_t bytesMatched;
+} NDR_LazyDFAStats;
 
 /**
 * \struct NDR_Regex
@@ -63,36 +113,151 @@ typedef struct NDR_Regex {
     bool beginString;
     bool endString;
     bool isEmpty;
+    NDR_RegexEngine engine;
     char errorMessage[200];
-    NDR_RegexNode* start;
+    NDR_RegexProgram* program;
+    NDR_RegexNFA* nfa;
+    // lazyDFACacheSize is the number of bytes of DFA states kept for the regex and each of its cursors, 0 to step through the NFA program instead
+    size_t lazyDFACacheSize;
+    NDR_RegexLazyDFA* lazyDFA;
 } NDR_Regex;
 
+/**
+* \struct NDR_RegexScratch
+* \brief The regex scratch struct holds the memory a match works in so that it is allocated once by the caller and reused by every match
+*
+* All of the state changed while matching through a scratch lives in the scratch, so one compiled regex can be matched on several threads at once when each thread has its own scratch
+*/
+typedef struct NDR_RegexScratch {
+    // wordReferences tracks the words entered by the backtracking matcher
+    NDR_TrackerStack wordReferences;
+    // threads, nextThreads, mark and stack are used by the Pike VM and hold threadsAllocated values each
+    size_t* threads;
+    size_t* nextThreads;
+    size_t* mark;
+    size_t* stack;
+    size_t threadsAllocated;
+    size_t generation;
+} NDR_RegexScratch;
+
+/**
+* \struct NDR_RegexCursor
+* \brief The regex cursor struct keeps the progress of a regex match so a token can be matched one character at a time without comparing earlier characters again
+*/
+typedef struct NDR_RegexCursor {
+    NDR_Regex* regex;
+    NDR_MatchResult result;
+    size_t* threads;
+    size_t numThreads;
+    size_t* nextThreads;
+    size_t* mark;
+    size_t generation;
+    size_t* stack;
+    NDR_RegexLazyDFA* lazyDFA;
+    int lazyDFAState;
+    char* token;
+    size_t tokenLength;
+    size_t memoryAllocated;
+    // scratch is used to match the stored token when the cursor has no NFA program to step through
+    NDR_RegexScratch scratch;
+} NDR_RegexCursor;
+
 
 /** @brief Initialize the NDR_Regex structure that will be used for regular expression comparision
 *
 * @param cRegex is an NDR_Regex pointer with sufficient memory already allocated
 */
 void NDR_InitRegex(NDR_Regex* cRegex);
-/** @brief Based on a provided regex string, create a reference graph for later matching the regex to other strings
+/** @brief Based on a provided regex string, create a regex program for later matching the regex to other strings
+*
+* The regex is parsed into a graph that is then flattened into a single block of instructions, so a compiled regex is freed with one call to free
 *
 * @param cRegex is an NDR_Regex pointer with sufficient memory already allocated
-* @param regexString is the regex pattern that will be used to create the regex graph
+* @param regexString is the regex pattern that will be used to create the regex program
 * @return The success status of the function. 0 for success and non-zero for error
 */
 int NDR_CompileRegex(NDR_Regex* cRegex, char* regexString);
-/** @brief Compare a string to a pre-compiled regex graph
+/** @brief Compare a string to a pre-compiled regex program
+*
+* Regexes set to NDR_REGEX_ENGINE_PIKEVM, and regexes set to NDR_REGEX_ENGINE_AUTO that have an NFA program, are matched with NDR_MatchRegexPikeVM.
+* Only the remaining regexes are matched by backtracking through the instructions of the program
 *
 * @param cRegex is an NDR_Regex pointer with sufficient memory already allocated that has been used previously in the NDR_CompileRegex function
-* @param token is the string that will be compared to the compiled regex graph
+* @param token is the string that will be compared to the compiled regex program
 * @return The result of the match
 */
 NDR_MatchResult NDR_MatchRegex(NDR_Regex* cRegex, char* token);
+/** @brief Compare a string to a pre-compiled regex program using memory kept in a scratch instead of memory allocated for the match
+*
+* Once the scratch has grown to fit the regexes it is used with, matching does not allocate memory. The regex is not changed, so regexes matched
+* with the Pike VM use their NFA program alone, without the lazy DFA cache of the regex
+*
+* @param cRegex is an NDR_Regex pointer with sufficient memory already allocated that has been used previously in the NDR_CompileRegex function
+* @param token is the string that will be compared to the compiled regex program
+* @param scratch is an NDR_RegexScratch pointer that has been used previously in the NDR_InitRegexScratch function and is not in use by another thread
+* @return The result of the match, the same result NDR_MatchRegex gives
+*/
+NDR_MatchResult NDR_MatchRegexWithScratch(NDR_Regex* cRegex, char* token, NDR_RegexScratch* scratch);
+/** @brief Compare a string to a pre-compiled regex by simulating every path through its NFA program at once
+*
+* No character of the token is compared more than once for each instruction of the program, so no pattern can make the match take exponential time.
+* The DFA states reached are cached by the regex so that later matches take one table lookup for each character. As the cache is changed while matching,
+* a regex with a lazy DFA cache must not be matched by NDR_MatchRegexPikeVM on several threads at once
+*
+* @param cRegex is an NDR_Regex pointer with sufficient memory already allocated that has been used previously in the NDR_CompileRegex function
+* @param token is the string that will be compared to the NFA program of the regex
+* @return The result of the match, the same result a cursor gives after stepping through the token. NDR_REGEX_FAILURE when the regex has no NFA program
+*/
+NDR_MatchResult NDR_MatchRegexPikeVM(NDR_Regex* cRegex, char* token);
 /** @brief Free the memory associated with items within the regex struct
 *
 * @param graph is a NDR_Regex pointer that has had memory assigned to it for compilation
 */
 void NDR_DestroyRegex(NDR_Regex* graph);
 
+/** @brief Initialize a scratch for matching with NDR_MatchRegexWithScratch. No memory is allocated until the scratch is first used
+*
+* @param scratch is an NDR_RegexScratch pointer with sufficient memory already allocated
+*/
+void NDR_InitRegexScratch(NDR_RegexScratch* scratch);
+/** @brief Free the memory associated with items within the scratch struct
+*
+* @param scratch is an NDR_RegexScratch pointer that has been used previously in the NDR_InitRegexScratch function
+*/
+void NDR_DestroyRegexScratch(NDR_RegexScratch* scratch);
+
+/** @brief Initialize a cursor for matching a token against a compiled regex one character at a time
+*
+* @param cursor is an NDR_RegexCursor pointer with sufficient memory already allocated
+* @param cRegex is an NDR_Regex pointer that has been used previously in the NDR_CompileRegex function
+*/
+void NDR_InitRegexCursor(NDR_RegexCursor* cursor, NDR_Regex* cRegex);
+/** @brief Return a cursor to the beginning of a new token without releasing its memory
+*
+* @param cursor is an NDR_RegexCursor pointer that has been used previously in the NDR_InitRegexCursor function
+*/
+void NDR_ResetRegexCursor(NDR_RegexCursor* cursor);
+/** @brief Add the next character of the token to the match kept by the cursor
+*
+* Once a cursor returns NDR_REGEX_NOMATCH no longer token can match and every following step returns NDR_REGEX_NOMATCH until the cursor is reset
+*
+* @param cursor is an NDR_RegexCursor pointer that has been used previously in the NDR_InitRegexCursor function
+* @param ch is the next character of the token
+* @return The result of matching the token seen so far, the same result NDR_MatchRegex gives for the whole token
+*/
+NDR_MatchResult NDR_RegexStep(NDR_RegexCursor* cursor, char ch);
+/** @brief Free the memory associated with items within the cursor struct
+*
+* @param cursor is an NDR_RegexCursor pointer that has been used previously in the NDR_InitRegexCursor function
+*/
+void NDR_DestroyRegexCursor(NDR_RegexCursor* cursor);
+/** @brief Get the work done by the lazy DFA of a cursor
+*
+* @param cursor is an NDR_RegexCursor pointer that has been used previously in the NDR_InitRegexCursor function
+* @param stats is filled with the state of the lazy DFA
+*/
+void NDR_RegexCursor_GetLazyDFAStats(NDR_RegexCursor* cursor, NDR_LazyDFAStats* stats);
+
 /** @brief Get whether or not the NDR_Regex pointer has been compiled with a pattern
 *
 * @param ndrregex is a NDR_Regex pointer that has had memory assigned to it and has been used with the NDR_InitRegex function
@@ -117,17 +282,57 @@ bool NDR_Regex_HasEndFlag(NDR_Regex* ndrregex);
 * @return true or false value of whether or not the NDR_Regex pointer was compiled with an empty regex pattern string
 */
 bool NDR_Regex_IsEmpty(NDR_Regex* ndrregex);
+/** @brief Set how the NDR_Regex pointer is matched, see NDR_RegexEngine
+*
+* @param ndrregex is a NDR_Regex pointer that has had memory assigned to it and has been used with the NDR_InitRegex function
+* @param engine is the engine used for matching
+* @return The success status of the function. 0 for success and non-zero when NDR_REGEX_ENGINE_PIKEVM is given to a regex without an NFA program
+* or NDR_REGEX_ENGINE_BACKTRACK is given to a regex with one
+*/
+int NDR_Regex_SetEngine(NDR_Regex* ndrregex, NDR_RegexEngine engine);
+/** @brief Get how the NDR_Regex pointer is matched, see NDR_RegexEngine
+*
+* @param ndrregex is a NDR_Regex pointer that has had memory assigned to it and has been used with the NDR_InitRegex function
+* @return the engine used for matching
+*/
+NDR_RegexEngine NDR_Regex_GetEngine(NDR_Regex* ndrregex);
+/** @brief Set the number of bytes of DFA states cached by the regex and each cursor created for it afterwards
+*
+* The states are flushed when the cache is full. A pattern that fills the cache again soon after every flush stops using its lazy DFA and steps through the NFA program instead
+*
+* @param ndrregex is a NDR_Regex pointer that has had memory assigned to it and has been used with the NDR_InitRegex function
+* @param cacheSize is the number of bytes, 0 to never build a lazy DFA
+*/
+void NDR_Regex_SetLazyDFACacheSize(NDR_Regex* ndrregex, size_t cacheSize);
+/** @brief Get the number of bytes of DFA states cached by the regex and each of its cursors
+*
+* @param ndrregex is a NDR_Regex pointer that has had memory assigned to it and has been used with the NDR_InitRegex function
+* @return the number of bytes, 0 when no lazy DFA is built
+*/
+size_t NDR_Regex_GetLazyDFACacheSize(NDR_Regex* ndrregex);
+/** @brief Get the work done by the lazy DFA the regex uses in NDR_MatchRegexPikeVM
+*
+* @param ndrregex is a NDR_Regex pointer that has had memory assigned to it and has been used with the NDR_InitRegex function
+* @param stats is filled with the state of the lazy DFA
+*/
+void NDR_Regex_GetLazyDFAStats(NDR_Regex* ndrregex, NDR_LazyDFAStats* stats);
 /** @brief Get the message describing what happened during compilation if an error occured
 *
 * @param ndrregex is a NDR_Regex pointer that has had memory assigned to it and has been used with the NDR_InitRegex function
 * @return the error message string
 */
 char* NDR_Regex_GetErrorMessage(NDR_Regex* ndrregex);
-/** @brief Get the start node of the graph used for regex comparison
+/** @brief Get the program used for regex comparison
+*
+* @param ndrregex is a NDR_Regex pointer that has had memory assigned to it and has been used with the NDR_InitRegex function
+* @return the program used for regex comparison or NULL if the regex is not compiled
+*/
+NDR_RegexProgram* NDR_Regex_GetProgram(NDR_Regex* ndrregex);
+/** @brief Get the NFA program built from the regex graph during compilation
 *
 * @param ndrregex is a NDR_Regex pointer that has had memory assigned to it and has been used with the NDR_InitRegex function
-* @return the start node of the graph used for regex comparison
+* @return the NFA program or NULL if the regex graph could not be converted
 */
-NDR_RegexNode* NDR_Regex_GetStartNode(NDR_Regex* ndrregex);
+NDR_RegexNFA* NDR_Regex_GetNFA(NDR_Regex* ndrregex);
 
 #endif
@@ -0,0 +1,280 @@
+
+/*********************************************************************************
+*                               NDR Regex Lazy DFA                               *
+**********************************************************************************/
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Neil Runcie
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "ndr_regexnfa.h"
+#include "ndr_regexlazydfa.h"
+
+static size_t GetStateMemory(size_t numThreads);
+static int CompareThreads(const void* first, const void* second);
+static size_t HashThreads(size_t* threads, size_t numThreads);
+static int32_t FindState(NDR_RegexLazyDFA* lazyDFA, size_t* threads, size_t numThreads);
+static int32_t AddState(NDR_RegexLazyDFA* lazyDFA, size_t* threads, size_t numThreads);
+static void InsertState(NDR_RegexLazyDFA* lazyDFA, int32_t state);
+static void GrowTable(NDR_RegexLazyDFA* lazyDFA);
+static void BuildFixedStates(NDR_RegexLazyDFA* lazyDFA);
+static void FlushStates(NDR_RegexLazyDFA* lazyDFA);
+static int32_t BuildTransition(NDR_RegexLazyDFA* lazyDFA, int32_t state, char ch);
+
+
+void NDR_InitRegexLazyDFA(NDR_RegexLazyDFA* lazyDFA, NDR_RegexNFA* nfa, size_t cacheSize){
+    lazyDFA->nfa = nfa;
+    lazyDFA->cacheSize = cacheSize;
+    lazyDFA->memoryUsed = 0;
+    lazyDFA->failed = false;
+    lazyDFA->numStates = 0;
+    lazyDFA->statesAllocated = 0;
+    lazyDFA->transitions = NULL;
+    lazyDFA->matches = NULL;
+    lazyDFA->setStarts = NULL;
+    lazyDFA->sets = NULL;
+    lazyDFA->setsUsed = 0;
+    lazyDFA->setsAllocated = 0;
+    lazyDFA->tableSize = 16;
+    lazyDFA->table = calloc(lazyDFA->tableSize, sizeof(size_t));
+
+    lazyDFA->startThreads = malloc(sizeof(size_t) * nfa->numInstructions);
+    lazyDFA->threads = malloc(sizeof(size_t) * nfa->numInstructions);
+    lazyDFA->numThreads = 0;
+    lazyDFA->mark = calloc(nfa->numInstructions, sizeof(size_t));
+    lazyDFA->generation = 1;
+    lazyDFA->stack = malloc(sizeof(size_t) * nfa->numInstructions);
+
+    lazyDFA->statesBuilt = 0;
+    lazyDFA->flushes = 0;
+    lazyDFA->bytesMatched = 0;
+    lazyDFA->statesBuiltSinceFlush = 0;
+    lazyDFA->bytesMatchedSinceFlush = 0;
+    lazyDFA->wastefulFlushes = 0;
+
+    lazyDFA->numStartThreads = NDR_NFAAddThread(nfa, nfa->start, lazyDFA->startThreads, 0, lazyDFA->mark, lazyDFA->generation, lazyDFA->stack);
+    qsort(lazyDFA->startThreads, lazyDFA->numStartThreads, sizeof(size_t), CompareThreads);
+    BuildFixedStates(lazyDFA);
+
+    if(lazyDFA->memoryUsed + GetStateMemory(lazyDFA->numStartThreads) > cacheSize)
+        lazyDFA->failed = true;
+}
+
+void NDR_DestroyRegexLazyDFA(NDR_RegexLazyDFA* lazyDFA){
+    free(lazyDFA->transitions);
+    free(lazyDFA->matches);
+    free(lazyDFA->setStarts);
+    free(lazyDFA->sets);
+    free(lazyDFA->table);
+    free(lazyDFA->startThreads);
+    free(lazyDFA->threads);
+    free(lazyDFA->mark);
+    free(lazyDFA->stack);
+}
+
+int32_t NDR_LazyDFAStep(NDR_RegexLazyDFA* lazyDFA, int32_t state, char ch){
+    if(lazyDFA->failed == true)
+        return NDR_LAZYDFA_FAILED;
+
+    int32_t next = lazyDFA->transitions[(size_t) state * 256 + (unsigned char) ch];
+    if(next == NDR_LAZYDFA_UNKNOWN)
+        next = BuildTransition(lazyDFA, state, ch);
+    if(next != NDR_LAZYDFA_FAILED){
+        lazyDFA->bytesMatched++;
+        lazyDFA->bytesMatchedSinceFlush++;
+    }
+    return next;
+}
+
+bool NDR_LazyDFAIsMatch(NDR_RegexLazyDFA* lazyDFA, int32_t state){
+    return lazyDFA->matches[state];
+}
+
+// Find the threads reached from the threads of "state" by "ch" and get the state holding them, adding it when it is new
+int32_t BuildTransition(NDR_RegexLazyDFA* lazyDFA, int32_t state, char ch){
+    NDR_RegexNFA* nfa = lazyDFA->nfa;
+    size_t* stateThreads = &lazyDFA->sets[lazyDFA->setStarts[state]];
+    size_t numStateThreads = lazyDFA->setStarts[state + 1] - lazyDFA->setStarts[state];
+
+    lazyDFA->generation++;
+    lazyDFA->numThreads = NDR_NFAStep(nfa, stateThreads, numStateThreads, lazyDFA->threads, ch, lazyDFA->mark, lazyDFA->generation, lazyDFA->stack);
+    qsort(lazyDFA->threads, lazyDFA->numThreads, sizeof(size_t), CompareThreads);
+
+    int32_t next = FindState(lazyDFA, lazyDFA->threads, lazyDFA->numThreads);
+    if(next != NDR_LAZYDFA_UNKNOWN){
+        lazyDFA->transitions[(size_t) state * 256 + (unsigned char) ch] = next;
+        return next;
+    }
+
+    // The transition into the new state is lost when the state it comes from is flushed, it is built again if that state is reached again
+    if(lazyDFA->memoryUsed + GetStateMemory(lazyDFA->numThreads) > lazyDFA->cacheSize){
+        FlushStates(lazyDFA);
+        if(lazyDFA->failed == true)
+            return NDR_LAZYDFA_FAILED;
+        return AddState(lazyDFA, lazyDFA->threads, lazyDFA->numThreads);
+    }
+
+    next = AddState(lazyDFA, lazyDFA->threads, lazyDFA->numThreads);
+    lazyDFA->transitions[(size_t) state * 256 + (unsigned char) ch] = next;
+    return next;
+}
+
+// Remove every state but the dead and start states
+// Flushing again soon after the previous flush means the pattern reaches too many sets of threads for the cache, so the lazy DFA stops being used
+void FlushStates(NDR_RegexLazyDFA* lazyDFA){
+    lazyDFA->flushes++;
+    if(lazyDFA->bytesMatchedSinceFlush < NDR_LAZYDFA_MINBYTESPERSTATE * lazyDFA->statesBuiltSinceFlush)
+        lazyDFA->wastefulFlushes++;
+    else
+        lazyDFA->wastefulFlushes = 0;
+    if(lazyDFA->wastefulFlushes >= NDR_LAZYDFA_MAXWASTEFULFLUSHES){
+        lazyDFA->failed = true;
+        return;
+    }
+
+    lazyDFA->numStates = 0;
+    lazyDFA->setsUsed = 0;
+    lazyDFA->memoryUsed = 0;
+    memset(lazyDFA->table, 0, sizeof(size_t) * lazyDFA->tableSize);
+    BuildFixedStates(lazyDFA);
+
+    lazyDFA->statesBuiltSinceFlush = 0;
+    lazyDFA->bytesMatchedSinceFlush = 0;
+}
+
+// The dead state leads only to itself, the start state is added without looking for an equal set so that it is always state 1
+void BuildFixedStates(NDR_RegexLazyDFA* lazyDFA){
+    int32_t dead = AddState(lazyDFA, NULL, 0);
+    memset(&lazyDFA->transitions[(size_t) dead * 256], 0, sizeof(int32_t) * 256);
+    AddState(lazyDFA, lazyDFA->startThreads, lazyDFA->numStartThreads);
+}
+
+int32_t AddState(NDR_RegexLazyDFA* lazyDFA, size_t* threads, size_t numThreads){
+    if(lazyDFA->statesAllocated == 0){
+        lazyDFA->statesAllocated = 8;
+        lazyDFA->transitions = malloc(sizeof(int32_t) * 256 * lazyDFA->statesAllocated);
+        lazyDFA->matches = malloc(sizeof(bool) * lazyDFA->statesAllocated);
+        lazyDFA->setStarts = malloc(sizeof(size_t) * (lazyDFA->statesAllocated + 1));
+        lazyDFA->setStarts[0] = 0;
+    }
+    else if(lazyDFA->numStates >= lazyDFA->statesAllocated){
+        lazyDFA->statesAllocated = lazyDFA->statesAllocated * 2;
+        lazyDFA->transitions = realloc(lazyDFA->transitions, sizeof(int32_t) * 256 * lazyDFA->statesAllocated);
+        lazyDFA->matches = realloc(lazyDFA->matches, sizeof(bool) * lazyDFA->statesAllocated);
+        lazyDFA->setStarts = realloc(lazyDFA->setStarts, sizeof(size_t) * (lazyDFA->statesAllocated + 1));
+    }
+    if(lazyDFA->setsUsed + numThreads > lazyDFA->setsAllocated){
+        lazyDFA->setsAllocated = (lazyDFA->setsAllocated == 0) ? 64 : lazyDFA->setsAllocated;
+        while(lazyDFA->setsUsed + numThreads > lazyDFA->setsAllocated)
+            lazyDFA->setsAllocated = lazyDFA->setsAllocated * 2;
+        lazyDFA->sets = realloc(lazyDFA->sets, sizeof(size_t) * lazyDFA->setsAllocated);
+    }
+
+    int32_t state = (int32_t) lazyDFA->numStates;
+    if(numThreads > 0)
+        memcpy(&lazyDFA->sets[lazyDFA->setsUsed], threads, sizeof(size_t) * numThreads);
+    lazyDFA->setsUsed += numThreads;
+    lazyDFA->setStarts[state + 1] = lazyDFA->setsUsed;
+    // Setting every byte to 0xFF sets every transition to NDR_LAZYDFA_UNKNOWN
+    memset(&lazyDFA->transitions[(size_t) state * 256], 0xFF, sizeof(int32_t) * 256);
+    lazyDFA->matches[state] = NDR_NFAHasMatch(lazyDFA->nfa, threads, numThreads);
+
+    InsertState(lazyDFA, state);
+    lazyDFA->numStates++;
+    lazyDFA->memoryUsed += GetStateMemory(numThreads);
+    lazyDFA->statesBuilt++;
+    lazyDFA->statesBuiltSinceFlush++;
+
+    return state;
+}
+
+int32_t FindState(NDR_RegexLazyDFA* lazyDFA, size_t* threads, size_t numThreads){
+    size_t slot = HashThreads(threads, numThreads) & (lazyDFA->tableSize - 1);
+    while(lazyDFA->table[slot] != 0){
+        size_t state = lazyDFA->table[slot] - 1;
+        size_t numStateThreads = lazyDFA->setStarts[state + 1] - lazyDFA->setStarts[state];
+        if(numStateThreads == numThreads && (numThreads == 0 || memcmp(&lazyDFA->sets[lazyDFA->setStarts[state]], threads, sizeof(size_t) * numThreads) == 0))
+            return (int32_t) state;
+        slot = (slot + 1) & (lazyDFA->tableSize - 1);
+    }
+    return NDR_LAZYDFA_UNKNOWN;
+}
+
+// The table is kept at most half full so that every search reaches an empty entry quickly
+// The state is inserted before it is counted so that growing the table does not insert it twice
+void InsertState(NDR_RegexLazyDFA* lazyDFA, int32_t state){
+    if((lazyDFA->numStates + 1) * 2 > lazyDFA->tableSize)
+        GrowTable(lazyDFA);
+
+    size_t numThreads = lazyDFA->setStarts[state + 1] - lazyDFA->setStarts[state];
+    size_t slot = HashThreads(&lazyDFA->sets[lazyDFA->setStarts[state]], numThreads) & (lazyDFA->tableSize - 1);
+    while(lazyDFA->table[slot] != 0)
+        slot = (slot + 1) & (lazyDFA->tableSize - 1);
+    lazyDFA->table[slot] = (size_t) state + 1;
+}
+
+void GrowTable(NDR_RegexLazyDFA* lazyDFA){
+    lazyDFA->tableSize = lazyDFA->tableSize * 2;
+    free(lazyDFA->table);
+    lazyDFA->table = calloc(lazyDFA->tableSize, sizeof(size_t));
+
+    for(size_t state = 0; state < lazyDFA->numStates; state++){
+        size_t numThreads = lazyDFA->setStarts[state + 1] - lazyDFA->setStarts[state];
+        size_t slot = HashThreads(&lazyDFA->sets[lazyDFA->setStarts[state]], numThreads) & (lazyDFA->tableSize - 1);
+        while(lazyDFA->table[slot] != 0)
+            slot = (slot + 1) & (lazyDFA->tableSize - 1);
+        lazyDFA->table[slot] = state + 1;
+    }
+}
+
+// Each state costs its row of transitions, its match flag, its threads and the two table entries kept for it
+size_t GetStateMemory(size_t numThreads){
+    return sizeof(int32_t) * 256 + sizeof(bool) + sizeof(size_t) * (numThreads + 1) + sizeof(size_t) * 2;
+}
+
+int CompareThreads(const void* first, const void* second){
+    size_t a = *(const size_t*) first;
+    size_t b = *(const size_t*) second;
+    return (a > b) - (a < b);
+}
+
+size_t HashThreads(size_t* threads, size_t numThreads){
+    size_t hash = (size_t) 14695981039346656037ULL;
+    for(size_t x = 0; x < numThreads; x++){
+        hash ^= threads[x];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
@@ -0,0 +1,121 @@
+
+/*********************************************************************************
+*                               NDR Regex Lazy DFA                               *
+**********************************************************************************/
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Neil Runcie
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef NDRREGEXLAZYDFA_H
+#define NDRREGEXLAZYDFA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "ndr_regexnfa.h"
+
+// The number of bytes of states a lazy DFA may hold before they are flushed, unless another size is given to the regex
+#ifndef NDR_LAZYDFA_DEFAULTCACHE
+#define NDR_LAZYDFA_DEFAULTCACHE 65536
+#endif
+// A flush is wasteful when fewer than this many bytes were matched for each state built since the previous flush
+#define NDR_LAZYDFA_MINBYTESPERSTATE 10
+// The lazy DFA stops being used after this many wasteful flushes in a row, leaving the NFA program to be stepped through on its own
+#define NDR_LAZYDFA_MAXWASTEFULFLUSHES 3
+
+// Transitions that have not been built yet
+#define NDR_LAZYDFA_UNKNOWN -1
+// Returned by NDR_LazyDFAStep once the lazy DFA has stopped being used
+#define NDR_LAZYDFA_FAILED -2
+// The state reached once no thread of the NFA program is left. It is always state 0 and rebuilt after every flush
+#define NDR_LAZYDFA_DEADSTATE 0
+// The state holding the threads at the start of the NFA program. It is always state 1 and rebuilt after every flush
+#define NDR_LAZYDFA_STARTSTATE 1
+
+// Declaration of a DFA built from an NFA program one state at a time as characters are matched
+// Every state is the set of NFA threads reached by the characters matched so far and is only built the first time that set is reached
+typedef struct NDR_RegexLazyDFA {
+    NDR_RegexNFA* nfa;
+    // cacheSize is the number of bytes the states may use, memoryUsed is the number of bytes they use now
+    size_t cacheSize;
+    size_t memoryUsed;
+    // failed is true once the cache has been flushed too often to be worth keeping
+    bool failed;
+
+    size_t numStates;
+    size_t statesAllocated;
+    // transitions holds 256 entries for every state, the next state for each byte value or NDR_LAZYDFA_UNKNOWN
+    int32_t* transitions;
+    bool* matches;
+    // The threads of state x are found in sets from setStarts[x] until setStarts[x + 1]
+    size_t* setStarts;
+    size_t* sets;
+    size_t setsUsed;
+    size_t setsAllocated;
+    // table finds the state holding a set of threads. Each entry is a state index plus one, or 0 when empty
+    size_t* table;
+    size_t tableSize;
+
+    // startThreads holds the threads of the start state so it can be rebuilt after a flush
+    size_t* startThreads;
+    size_t numStartThreads;
+    // threads holds the set of threads found for the last transition built, used to continue on the NFA program after failing
+    size_t* threads;
+    size_t numThreads;
+    size_t* mark;
+    size_t generation;
+    size_t* stack;
+
+    // Counts reported by NDR_Regex_GetLazyDFAStats and NDR_RegexCursor_GetLazyDFAStats
+    size_t statesBuilt;
+    size_t flushes;
+    size_t bytesMatched;
+    size_t statesBuiltSinceFlush;
+    size_t bytesMatchedSinceFlush;
+    size_t wastefulFlushes;
+} NDR_RegexLazyDFA;
+
+// Initialize a lazy DFA for an NFA program holding no more than cacheSize bytes of states
+// A cache that cannot hold the dead and start states along with one more leaves the lazy DFA failed from the start
+void NDR_InitRegexLazyDFA(NDR_RegexLazyDFA* lazyDFA, NDR_RegexNFA* nfa, size_t cacheSize);
+// Utility function to free the memory allocated to items within the lazy DFA
+void NDR_DestroyRegexLazyDFA(NDR_RegexLazyDFA* lazyDFA);
+
+// Get the state reached from "state" by the character "ch", building it when it has not been reached before
+// Building a state may flush every other state from the cache, so only the returned state can be used afterwards
+// Returns NDR_LAZYDFA_FAILED when the lazy DFA has stopped being used, the threads reached are then left in "threads"
+int32_t NDR_LazyDFAStep(NDR_RegexLazyDFA* lazyDFA, int32_t state, char ch);
+// Utility function to get whether a state holds a thread that has matched the whole pattern
+bool NDR_LazyDFAIsMatch(NDR_RegexLazyDFA* lazyDFA, int32_t state);
+
+#endif
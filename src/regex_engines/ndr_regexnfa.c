@@ -0,0 +1,584 @@
+
+/*********************************************************************************
+*                                 NDR Regex NFA                                  *
+**********************************************************************************/
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Neil Runcie
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "ndr_regexprogram.h"
+#include "ndr_regexnfa.h"
+
+// Upper bound on the number of regex instructions visited during conversion, protecting against malformed programs
+#define NDR_NFA_MAXVISITS 200000
+
+// Declaration of a partially built piece of an NFA program
+typedef struct NFAFragment {
+    // start is the index of the first instruction of the fragment
+    size_t start;
+    // holes holds the instruction links that still need to be pointed to whatever follows the fragment
+    // Each hole is stored as (instruction index * 2) + (0 for "next", 1 for "alternate")
+    size_t* holes;
+    size_t numHoles;
+    size_t memoryAllocated;
+} NFAFragment;
+
+// Declaration of the state kept while a regex program is converted into an NFA program
+typedef struct NFABuilder {
+    NDR_RegexNFA* nfa;
+    NDR_RegexProgram* program;
+    bool failed;
+    size_t nodesVisited;
+} NFABuilder;
+
+static size_t AddInstruction(NFABuilder* builder, NDR_NFAOperation operation, size_t charClass);
+static size_t AddNodeClass(NFABuilder* builder, NDR_RegexInstruction* node);
+static size_t AddAnyClass(NFABuilder* builder);
+
+static void InitFragment(NFAFragment* fragment);
+static void FreeFragment(NFAFragment* fragment);
+static void AddHole(NFAFragment* fragment, size_t instruction, int link);
+static void MoveHoles(NFAFragment* destination, NFAFragment* source);
+static void PatchHoles(NFABuilder* builder, NFAFragment* fragment, size_t target);
+
+static void BuildEmpty(NFABuilder* builder, NFAFragment* fragment);
+static void BuildClass(NFABuilder* builder, size_t charClass, NFAFragment* fragment);
+static void Concatenate(NFABuilder* builder, NFAFragment* first, NFAFragment* second);
+static void Alternate(NFABuilder* builder, NFAFragment* first, NFAFragment* second);
+static void MakeOptional(NFABuilder* builder, NFAFragment* fragment);
+static void MakeStar(NFABuilder* builder, NFAFragment* fragment);
+
+static void BuildChain(NFABuilder* builder, NDR_RegexInstruction* node, NDR_RegexInstruction* wordStart, NFAFragment* fragment, NDR_RegexInstruction** stoppedAt);
+static void BuildWordOnce(NFABuilder* builder, NDR_RegexInstruction* wordStart, NFAFragment* fragment, NDR_RegexInstruction** after);
+static void BuildAtom(NFABuilder* builder, NDR_RegexInstruction* node, NFAFragment* fragment, NDR_RegexInstruction** after);
+
+
+void NDR_InitRegexNFA(NDR_RegexNFA* nfa){
+    nfa->valid = false;
+    nfa->beginString = false;
+    nfa->endString = false;
+    nfa->start = 0;
+    nfa->numInstructions = 0;
+    nfa->memoryAllocated = 0;
+    nfa->instructions = NULL;
+    nfa->numClasses = 0;
+    nfa->classMemoryAllocated = 0;
+    nfa->classes = NULL;
+}
+
+void NDR_DestroyRegexNFA(NDR_RegexNFA* nfa){
+    free(nfa->instructions);
+    free(nfa->classes);
+    NDR_InitRegexNFA(nfa);
+}
+
+bool NDR_NFAAcceptsChar(NDR_RegexNFA* nfa, size_t instruction, char ch){
+    return NDR_NFA_CLASSHAS(nfa->classes[nfa->instructions[instruction].charClass], ch);
+}
+
+size_t NDR_NFAAddThread(NDR_RegexNFA* nfa, size_t instruction, size_t* threads, size_t numThreads, size_t* mark, size_t generation, size_t* stack){
+
+    static const unsigned char emptyClass[NDR_NFA_CLASSBYTES] = {0};
+    size_t stackSize = 0;
+
+    if(mark[instruction] == generation)
+        return numThreads;
+    mark[instruction] = generation;
+    stack[stackSize++] = instruction;
+
+    while(stackSize > 0){
+        NDR_NFAInstruction* current = &nfa->instructions[stack[--stackSize]];
+        size_t currentIndex = (size_t) (current - nfa->instructions);
+
+        switch(current->operation){
+            case NDR_NFA_CHAR:
+                // Characters that accept nothing can never progress so they are not kept as threads
+                if(memcmp(nfa->classes[current->charClass], emptyClass, NDR_NFA_CLASSBYTES) != 0)
+                    threads[numThreads++] = currentIndex;
+                break;
+            case NDR_NFA_MATCH:
+                threads[numThreads++] = currentIndex;
+                break;
+            case NDR_NFA_SPLIT:
+                if(mark[current->alternate] != generation){
+                    mark[current->alternate] = generation;
+                    stack[stackSize++] = current->alternate;
+                }
+                if(mark[current->next] != generation){
+                    mark[current->next] = generation;
+                    stack[stackSize++] = current->next;
+                }
+                break;
+            case NDR_NFA_JUMP:
+                if(mark[current->next] != generation){
+                    mark[current->next] = generation;
+                    stack[stackSize++] = current->next;
+                }
+                break;
+        }
+    }
+
+    return numThreads;
+}
+
+size_t NDR_NFAStep(NDR_RegexNFA* nfa, size_t* threads, size_t numThreads, size_t* nextThreads, char ch, size_t* mark, size_t generation, size_t* stack){
+
+    size_t numNextThreads = 0;
+
+    for(size_t x = 0; x < numThreads; x++){
+        if(nfa->instructions[threads[x]].operation == NDR_NFA_CHAR && NDR_NFAAcceptsChar(nfa, threads[x], ch) == true)
+            numNextThreads = NDR_NFAAddThread(nfa, nfa->instructions[threads[x]].next, nextThreads, numNextThreads, mark, generation, stack);
+    }
+
+    return numNextThreads;
+}
+
+bool NDR_NFAHasMatch(NDR_RegexNFA* nfa, size_t* threads, size_t numThreads){
+    for(size_t x = 0; x < numThreads; x++){
+        if(nfa->instructions[threads[x]].operation == NDR_NFA_MATCH)
+            return true;
+    }
+    return false;
+}
+
+// A program accepts a single string when following it from the start never reaches a split and every character class holds one byte
+char* NDR_NFAGetLiteral(NDR_RegexNFA* nfa){
+    if(nfa->valid == false)
+        return NULL;
+
+    char* literal = malloc(nfa->numInstructions + 1);
+    size_t length = 0;
+    size_t instruction = nfa->start;
+
+    // A path without splits visits each instruction at most once, so a longer walk means the program loops through jumps
+    for(size_t steps = 0; steps <= nfa->numInstructions; steps++){
+        NDR_NFAInstruction* current = &nfa->instructions[instruction];
+        if(current->operation == NDR_NFA_MATCH){
+            if(length == 0)
+                break;
+            literal[length] = '\0';
+            return literal;
+        }
+        else if(current->operation == NDR_NFA_JUMP){
+            instruction = current->next;
+        }
+        else if(current->operation == NDR_NFA_CHAR){
+            int onlyByte = -1;
+            for(int ch = 1; ch < 256; ch++){
+                if(NDR_NFA_CLASSHAS(nfa->classes[current->charClass], ch) == 0)
+                    continue;
+                if(onlyByte != -1){
+                    onlyByte = -2;
+                    break;
+                }
+                onlyByte = ch;
+            }
+            if(onlyByte < 0 || NDR_NFA_CLASSHAS(nfa->classes[current->charClass], 0) != 0)
+                break;
+            literal[length++] = (char) onlyByte;
+            instruction = current->next;
+        }
+        else{
+            break;
+        }
+    }
+
+    free(literal);
+    return NULL;
+}
+
+// The first bytes are the union of the character classes reached from the start of the program without consuming a character
+void NDR_NFAGetFirstBytes(NDR_RegexNFA* nfa, unsigned char firstBytes[NDR_NFA_CLASSBYTES]){
+    memset(firstBytes, 0, NDR_NFA_CLASSBYTES);
+    if(nfa->valid == false)
+        return;
+
+    size_t* threads = malloc(sizeof(size_t) * nfa->numInstructions);
+    size_t* mark = calloc(nfa->numInstructions, sizeof(size_t));
+    size_t* stack = malloc(sizeof(size_t) * nfa->numInstructions);
+
+    size_t numThreads = NDR_NFAAddThread(nfa, nfa->start, threads, 0, mark, 1, stack);
+    for(size_t x = 0; x < numThreads; x++){
+        if(nfa->instructions[threads[x]].operation != NDR_NFA_CHAR)
+            continue;
+        for(size_t i = 0; i < NDR_NFA_CLASSBYTES; i++)
+            firstBytes[i] |= nfa->classes[nfa->instructions[threads[x]].charClass][i];
+    }
+
+    free(threads);
+    free(mark);
+    free(stack);
+}
+
+// Build an NFA program from the instructions of a compiled regex program
+// The NFA program accepts the same strings as the regex program, including the unanchored behaviour when the begin or end anchor is absent
+int NDR_BuildRegexNFA(NDR_RegexNFA* nfa, NDR_RegexProgram* regexProgram, bool beginString, bool endString, bool isEmpty){
+
+    NDR_DestroyRegexNFA(nfa);
+    nfa->beginString = beginString;
+    nfa->endString = endString;
+
+    NFABuilder builder;
+    builder.nfa = nfa;
+    builder.program = regexProgram;
+    builder.failed = false;
+    builder.nodesVisited = 0;
+
+    // An empty pattern only ever matches the empty string
+    if(isEmpty == true){
+        nfa->start = AddInstruction(&builder, NDR_NFA_MATCH, 0);
+        nfa->valid = true;
+        return 0;
+    }
+
+    NFAFragment program;
+    InitFragment(&program);
+    NDR_RegexInstruction* stoppedAt = NULL;
+
+    // Without the begin anchor a match may start at any character so any prefix is consumed first
+    if(beginString == false){
+        BuildClass(&builder, AddAnyClass(&builder), &program);
+        MakeStar(&builder, &program);
+    }
+    else{
+        BuildEmpty(&builder, &program);
+    }
+
+    NFAFragment body;
+    InitFragment(&body);
+    BuildChain(&builder, regexProgram->instructions, NULL, &body, &stoppedAt);
+    Concatenate(&builder, &program, &body);
+
+    // Without the end anchor a match is kept regardless of the characters that follow it
+    if(endString == false){
+        NFAFragment suffix;
+        InitFragment(&suffix);
+        BuildClass(&builder, AddAnyClass(&builder), &suffix);
+        MakeStar(&builder, &suffix);
+        Concatenate(&builder, &program, &suffix);
+    }
+
+    size_t match = AddInstruction(&builder, NDR_NFA_MATCH, 0);
+    PatchHoles(&builder, &program, match);
+    nfa->start = program.start;
+
+    FreeFragment(&program);
+
+    if(builder.failed == true){
+        NDR_DestroyRegexNFA(nfa);
+        return 1;
+    }
+
+    nfa->valid = true;
+    return 0;
+}
+
+// Convert the chain of instructions beginning at "node" until the word end instruction of "wordStart" is reached (or the end instruction when wordStart is NULL)
+void BuildChain(NFABuilder* builder, NDR_RegexInstruction* node, NDR_RegexInstruction* wordStart, NFAFragment* fragment, NDR_RegexInstruction** stoppedAt){
+
+    BuildEmpty(builder, fragment);
+
+    while(builder->failed == false){
+        if(node == NULL || ++(builder->nodesVisited) > NDR_NFA_MAXVISITS){
+            builder->failed = true;
+            break;
+        }
+
+        if(NDR_RINST_HAS(node, NDR_RINST_END) == true){
+            if(wordStart != NULL)
+                builder->failed = true;
+            *stoppedAt = node;
+            break;
+        }
+        if(NDR_RINST_HAS(node, NDR_RINST_WORDEND) == true){
+            if(wordStart == NULL || node->wordReference != NDR_RPROGRAM_INDEX(builder->program, wordStart))
+                builder->failed = true;
+            *stoppedAt = node;
+            break;
+        }
+        if(NDR_RINST_HAS(node, NDR_RINST_START) == true){
+            if(node->numberOfChildren == 0){
+                builder->failed = true;
+                break;
+            }
+            node = NDR_RPROGRAM_CHILD(builder->program, node, 0);
+            continue;
+        }
+
+        NFAFragment atom;
+        InitFragment(&atom);
+        NDR_RegexInstruction* after = NULL;
+        BuildAtom(builder, node, &atom, &after);
+        Concatenate(builder, fragment, &atom);
+        node = after;
+    }
+}
+
+// Convert a "word" a single time without its repetition, following every path of an "or" word
+void BuildWordOnce(NFABuilder* builder, NDR_RegexInstruction* wordStart, NFAFragment* fragment, NDR_RegexInstruction** after){
+
+    NDR_RegexInstruction* stoppedAt = NULL;
+
+    if(wordStart->numberOfChildren == 0){
+        builder->failed = true;
+        BuildEmpty(builder, fragment);
+        return;
+    }
+
+    BuildChain(builder, NDR_RPROGRAM_CHILD(builder->program, wordStart, 0), wordStart, fragment, &stoppedAt);
+
+    if(NDR_RINST_HAS(wordStart, NDR_RINST_ORPATH) == true){
+        for(size_t x = 1; x < wordStart->numberOfChildren && builder->failed == false; x++){
+            NFAFragment path;
+            InitFragment(&path);
+            NDR_RegexInstruction* pathStop = NULL;
+            BuildChain(builder, NDR_RPROGRAM_CHILD(builder->program, wordStart, x), wordStart, &path, &pathStop);
+            if(pathStop != stoppedAt)
+                builder->failed = true;
+            Alternate(builder, fragment, &path);
+        }
+    }
+
+    if(builder->failed == false && (stoppedAt == NULL || stoppedAt->numberOfChildren == 0))
+        builder->failed = true;
+
+    *after = (builder->failed == true) ? NULL : NDR_RPROGRAM_CHILD(builder->program, stoppedAt, 0);
+}
+
+// Convert a single character instruction or word along with the repetition attached to it
+void BuildAtom(NFABuilder* builder, NDR_RegexInstruction* node, NFAFragment* fragment, NDR_RegexInstruction** after){
+
+    int minMatches;
+    int maxMatches;
+    size_t charClass = 0;
+
+    if(NDR_RINST_HAS(node, NDR_RINST_WORDSTART) == true){
+        // The "or" word cannot carry its own repetition within the regex syntax
+        if(NDR_RINST_HAS(node, NDR_RINST_ORPATH) == true && (NDR_RINST_HAS(node, NDR_RINST_REPEATPATH) == true || NDR_RINST_HAS(node, NDR_RINST_OPTIONALPATH) == true)){
+            builder->failed = true;
+            BuildEmpty(builder, fragment);
+            return;
+        }
+        minMatches = (NDR_RINST_HAS(node, NDR_RINST_OPTIONALPATH) == true) ? 0 : ((NDR_RINST_HAS(node, NDR_RINST_REPEATPATH) == true) ? node->minMatches : 1);
+        maxMatches = (NDR_RINST_HAS(node, NDR_RINST_REPEATPATH) == true) ? node->maxMatches : 1;
+    }
+    else{
+        if(node->numberOfChildren == 0){
+            builder->failed = true;
+            BuildEmpty(builder, fragment);
+            return;
+        }
+        charClass = AddNodeClass(builder, node);
+        minMatches = node->minMatches;
+        maxMatches = node->maxMatches;
+        *after = NDR_RPROGRAM_CHILD(builder->program, node, 0);
+    }
+
+    if(minMatches < 0 || maxMatches < -1 || (maxMatches != -1 && maxMatches < minMatches)){
+        builder->failed = true;
+        BuildEmpty(builder, fragment);
+        return;
+    }
+
+    // Build the required repetitions followed by either a loop or the remaining optional repetitions
+    BuildEmpty(builder, fragment);
+    int copies = (maxMatches == -1) ? minMatches + 1 : maxMatches;
+    for(int x = 0; x < copies && builder->failed == false; x++){
+        NFAFragment copy;
+        InitFragment(&copy);
+        if(NDR_RINST_HAS(node, NDR_RINST_WORDSTART) == true)
+            BuildWordOnce(builder, node, &copy, after);
+        else
+            BuildClass(builder, charClass, &copy);
+
+        if(x >= minMatches){
+            if(maxMatches == -1)
+                MakeStar(builder, &copy);
+            else
+                MakeOptional(builder, &copy);
+        }
+        Concatenate(builder, fragment, &copy);
+    }
+
+    // A word that is never repeated still has to be walked to know where the regex program continues
+    if(copies == 0 && NDR_RINST_HAS(node, NDR_RINST_WORDSTART) == true){
+        NFAFragment unused;
+        InitFragment(&unused);
+        BuildWordOnce(builder, node, &unused, after);
+        FreeFragment(&unused);
+    }
+}
+
+
+size_t AddInstruction(NFABuilder* builder, NDR_NFAOperation operation, size_t charClass){
+    NDR_RegexNFA* nfa = builder->nfa;
+    if(nfa->numInstructions >= NDR_NFA_MAXINSTRUCTIONS){
+        builder->failed = true;
+        return 0;
+    }
+    if(nfa->memoryAllocated == 0){
+        nfa->memoryAllocated = 32;
+        nfa->instructions = malloc(sizeof(NDR_NFAInstruction) * nfa->memoryAllocated);
+    }
+    else if(nfa->numInstructions >= nfa->memoryAllocated){
+        nfa->memoryAllocated = nfa->memoryAllocated * 2;
+        nfa->instructions = realloc(nfa->instructions, sizeof(NDR_NFAInstruction) * nfa->memoryAllocated);
+    }
+    nfa->instructions[nfa->numInstructions].operation = operation;
+    nfa->instructions[nfa->numInstructions].charClass = charClass;
+    nfa->instructions[nfa->numInstructions].next = 0;
+    nfa->instructions[nfa->numInstructions].alternate = 0;
+    return nfa->numInstructions++;
+}
+
+static size_t AddClass(NFABuilder* builder, unsigned char* charClass){
+    NDR_RegexNFA* nfa = builder->nfa;
+    for(size_t x = 0; x < nfa->numClasses; x++){
+        if(memcmp(nfa->classes[x], charClass, NDR_NFA_CLASSBYTES) == 0)
+            return x;
+    }
+    if(nfa->classMemoryAllocated == 0){
+        nfa->classMemoryAllocated = 8;
+        nfa->classes = malloc(NDR_NFA_CLASSBYTES * nfa->classMemoryAllocated);
+    }
+    else if(nfa->numClasses >= nfa->classMemoryAllocated){
+        nfa->classMemoryAllocated = nfa->classMemoryAllocated * 2;
+        nfa->classes = realloc(nfa->classes, NDR_NFA_CLASSBYTES * nfa->classMemoryAllocated);
+    }
+    memcpy(nfa->classes[nfa->numClasses], charClass, NDR_NFA_CLASSBYTES);
+    return nfa->numClasses++;
+}
+
+// The class of an instruction is the accepted set already folded into the regex program so both matchers agree on every byte
+size_t AddNodeClass(NFABuilder* builder, NDR_RegexInstruction* node){
+    return AddClass(builder, node->accepts);
+}
+
+size_t AddAnyClass(NFABuilder* builder){
+    unsigned char charClass[NDR_NFA_CLASSBYTES];
+    memset(charClass, 0xFF, NDR_NFA_CLASSBYTES);
+    return AddClass(builder, charClass);
+}
+
+
+void InitFragment(NFAFragment* fragment){
+    fragment->start = 0;
+    fragment->holes = NULL;
+    fragment->numHoles = 0;
+    fragment->memoryAllocated = 0;
+}
+
+void FreeFragment(NFAFragment* fragment){
+    free(fragment->holes);
+    InitFragment(fragment);
+}
+
+void AddHole(NFAFragment* fragment, size_t instruction, int link){
+    if(fragment->memoryAllocated == 0){
+        fragment->memoryAllocated = 4;
+        fragment->holes = malloc(sizeof(size_t) * fragment->memoryAllocated);
+    }
+    else if(fragment->numHoles >= fragment->memoryAllocated){
+        fragment->memoryAllocated = fragment->memoryAllocated * 2;
+        fragment->holes = realloc(fragment->holes, sizeof(size_t) * fragment->memoryAllocated);
+    }
+    fragment->holes[fragment->numHoles++] = (instruction * 2) + link;
+}
+
+// Move every hole of the source fragment into the destination fragment and release the source
+void MoveHoles(NFAFragment* destination, NFAFragment* source){
+    for(size_t x = 0; x < source->numHoles; x++)
+        AddHole(destination, source->holes[x] / 2, (int) (source->holes[x] % 2));
+    FreeFragment(source);
+}
+
+void PatchHoles(NFABuilder* builder, NFAFragment* fragment, size_t target){
+    if(builder->failed == false){
+        for(size_t x = 0; x < fragment->numHoles; x++){
+            if(fragment->holes[x] % 2 == 0)
+                builder->nfa->instructions[fragment->holes[x] / 2].next = target;
+            else
+                builder->nfa->instructions[fragment->holes[x] / 2].alternate = target;
+        }
+    }
+    fragment->numHoles = 0;
+}
+
+void BuildEmpty(NFABuilder* builder, NFAFragment* fragment){
+    fragment->numHoles = 0;
+    fragment->start = AddInstruction(builder, NDR_NFA_JUMP, 0);
+    AddHole(fragment, fragment->start, 0);
+}
+
+void BuildClass(NFABuilder* builder, size_t charClass, NFAFragment* fragment){
+    fragment->numHoles = 0;
+    fragment->start = AddInstruction(builder, NDR_NFA_CHAR, charClass);
+    AddHole(fragment, fragment->start, 0);
+}
+
+// Append the second fragment to the first. The second fragment is released
+void Concatenate(NFABuilder* builder, NFAFragment* first, NFAFragment* second){
+    PatchHoles(builder, first, second->start);
+    MoveHoles(first, second);
+}
+
+// Combine both fragments into the first fragment so that either one may be followed. The second fragment is released
+void Alternate(NFABuilder* builder, NFAFragment* first, NFAFragment* second){
+    size_t split = AddInstruction(builder, NDR_NFA_SPLIT, 0);
+    if(builder->failed == false){
+        builder->nfa->instructions[split].next = first->start;
+        builder->nfa->instructions[split].alternate = second->start;
+    }
+    first->start = split;
+    MoveHoles(first, second);
+}
+
+void MakeOptional(NFABuilder* builder, NFAFragment* fragment){
+    size_t split = AddInstruction(builder, NDR_NFA_SPLIT, 0);
+    if(builder->failed == false)
+        builder->nfa->instructions[split].next = fragment->start;
+    fragment->start = split;
+    AddHole(fragment, split, 1);
+}
+
+void MakeStar(NFABuilder* builder, NFAFragment* fragment){
+    size_t split = AddInstruction(builder, NDR_NFA_SPLIT, 0);
+    if(builder->failed == false)
+        builder->nfa->instructions[split].next = fragment->start;
+    PatchHoles(builder, fragment, split);
+    fragment->start = split;
+    AddHole(fragment, split, 1);
+}
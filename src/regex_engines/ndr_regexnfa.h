@@ -0,0 +1,118 @@
+
+/*********************************************************************************
+*                                 NDR Regex NFA                                  *
+**********************************************************************************/
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Neil Runcie
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef NDRREGEXNFA_H
+#define NDRREGEXNFA_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+// Forward declaration of Regex program for converting a compiled regex into an NFA program
+typedef struct NDR_RegexProgram NDR_RegexProgram;
+
+// The number of bytes needed to represent the set of all 256 byte values as a bitmap
+#define NDR_NFA_CLASSBYTES 32
+// Upper bound on the number of instructions in a single NFA program so that large counted repetitions cannot exhaust memory
+#define NDR_NFA_MAXINSTRUCTIONS 20000
+
+// Test whether a byte value is present within a character class bitmap
+#define NDR_NFA_CLASSHAS(charClass, ch) (((charClass)[((unsigned char)(ch)) >> 3] >> (((unsigned char)(ch)) & 7)) & 1)
+
+// Declaration of the operations that can be performed by a single NFA instruction
+typedef enum NDR_NFAOperation {
+    // Consume one character that is found within the instruction's character class and continue to "next"
+    NDR_NFA_CHAR,
+    // Continue on both "next" and "alternate" without consuming a character
+    NDR_NFA_SPLIT,
+    // Continue to "next" without consuming a character
+    NDR_NFA_JUMP,
+    // The whole pattern has been matched
+    NDR_NFA_MATCH
+} NDR_NFAOperation;
+
+// Declaration of a single NFA instruction
+typedef struct NDR_NFAInstruction {
+    NDR_NFAOperation operation;
+    // charClass is the index of the character class bitmap used by NDR_NFA_CHAR instructions
+    size_t charClass;
+    // next is the index of the instruction that follows this one
+    size_t next;
+    // alternate is the index of the second instruction followed by NDR_NFA_SPLIT instructions
+    size_t alternate;
+} NDR_NFAInstruction;
+
+// Declaration of an NFA program equivalent to a compiled regex program
+typedef struct NDR_RegexNFA {
+    // valid is false when the regex program could not be converted and the backtracking matcher must be used instead
+    bool valid;
+    // beginString and endString mirror the anchors of the regex the program was built from
+    bool beginString;
+    bool endString;
+    // start is the index of the first instruction of the program
+    size_t start;
+    size_t numInstructions;
+    size_t memoryAllocated;
+    NDR_NFAInstruction* instructions;
+    size_t numClasses;
+    size_t classMemoryAllocated;
+    unsigned char (*classes)[NDR_NFA_CLASSBYTES];
+} NDR_RegexNFA;
+
+// Utility function to initialize an empty NFA program
+void NDR_InitRegexNFA(NDR_RegexNFA* nfa);
+// Build an NFA program from a compiled regex program. Returns 0 on success and non-zero when the regex program cannot be converted
+int NDR_BuildRegexNFA(NDR_RegexNFA* nfa, NDR_RegexProgram* regexProgram, bool beginString, bool endString, bool isEmpty);
+// Utility function to free the memory allocated to items within the NFA program
+void NDR_DestroyRegexNFA(NDR_RegexNFA* nfa);
+
+// Utility function to get whether a character is accepted by a NDR_NFA_CHAR instruction
+bool NDR_NFAAcceptsChar(NDR_RegexNFA* nfa, size_t instruction, char ch);
+
+// Follow every transition from "instruction" that does not consume a character, adding the NDR_NFA_CHAR and NDR_NFA_MATCH instructions reached to "threads"
+// "mark" holds one entry per instruction and instructions already marked with "generation" are skipped. "stack" needs one entry per instruction
+// Returns the new number of threads
+size_t NDR_NFAAddThread(NDR_RegexNFA* nfa, size_t instruction, size_t* threads, size_t numThreads, size_t* mark, size_t generation, size_t* stack);
+// Advance every thread past the character "ch", storing the threads reached in "nextThreads". Returns the number of threads reached
+size_t NDR_NFAStep(NDR_RegexNFA* nfa, size_t* threads, size_t numThreads, size_t* nextThreads, char ch, size_t* mark, size_t generation, size_t* stack);
+// Utility function to get whether any of the threads has matched the whole pattern
+bool NDR_NFAHasMatch(NDR_RegexNFA* nfa, size_t* threads, size_t numThreads);
+// Get the only string accepted by the program as a newly allocated string
+// Returns NULL when the program can accept more than one string, only accepts the empty string, or needs a null byte
+char* NDR_NFAGetLiteral(NDR_RegexNFA* nfa);
+// Fill "firstBytes" with the bitmap of every byte value the program can accept as its first character
+void NDR_NFAGetFirstBytes(NDR_RegexNFA* nfa, unsigned char firstBytes[NDR_NFA_CLASSBYTES]);
+
+#endif
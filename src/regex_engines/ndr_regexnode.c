@@ -88,8 +88,12 @@ void NDR_InitRegexNode(NDR_RegexNode* node){
     node->numberOfChildren = 0;
     node->memoryAllocatedChildren = 5;
     node->children = malloc(sizeof(NDR_RegexNode*) * node->memoryAllocatedChildren);
-    NDR_RegexNode* newNode = malloc(sizeof(NDR_RegexNode));
+    // The child is only a placeholder until it is initialized as the next node, it is kept empty so a graph abandoned before then can still be freed
+    NDR_RegexNode* newNode = calloc(1, sizeof(NDR_RegexNode));
+    newNode->programIndex = NDR_RNODE_NOINDEX;
     NDR_AddRNodeChild(node, newNode);
+
+    node->programIndex = NDR_RNODE_NOINDEX;
 }
 
 void NDR_RemoveRNodeChild(NDR_RegexNode* node){
@@ -165,15 +169,6 @@ void NDR_AddRNodeChild(NDR_RegexNode* node, NDR_RegexNode* child){
     node->numberOfChildren++;
 }
 
-bool NDR_RNodeDuplicate(NDR_RegexNode* address, NDR_RegexNode** nodes, size_t index){
-    for(size_t i = 0; i < index; i++){
-        if(address == nodes[i]){
-            return true;
-        }
-    }
-    return false;
-}
-
 // Utility function to initialize the stack
 void NDR_InitRNodeStack(NDR_RNodeStack* ndrstack){
     ndrstack->memoryAllocated = 50;
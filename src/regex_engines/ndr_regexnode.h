@@ -37,6 +37,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef NDRREGEXNODE_H
 #define NDRREGEXNODE_H
 
+// The program index of a node that has not been placed within a regex program yet
+#define NDR_RNODE_NOINDEX ((size_t) -1)
+
 typedef struct NDR_RegexNode {
     bool start;
     bool end;
@@ -70,6 +73,9 @@ typedef struct NDR_RegexNode {
     size_t memoryAllocatedChildren;
     struct NDR_RegexNode** children;
 
+    // programIndex is the position of the node within the regex program it is flattened into
+    size_t programIndex;
+
 } NDR_RegexNode;
 
 typedef struct NDR_RNodeStack{
@@ -81,14 +87,12 @@ typedef struct NDR_RNodeStack{
 
 void ContinueAfterWord(NDR_RNodeStack* startStack, NDR_RNodeStack* endStack);
 int HandleSpecialCharacters(NDR_RegexNode* node, char comp);
-bool IsCharacterAccepted(NDR_RegexNode* node, char comp);
 
 void NDR_InitRegexNode(NDR_RegexNode* node);
 bool NDR_IsRNodeEmpty(NDR_RegexNode* node);
 bool NDR_IsRNodeSetForComparison(NDR_RegexNode* node);
 void NDR_AddRNodeChar(NDR_RegexNode* node, char character);
 void NDR_AddRNodeChild(NDR_RegexNode* node, NDR_RegexNode* child);
-bool NDR_RNodeDuplicate(NDR_RegexNode* address, NDR_RegexNode** nodes, size_t index);
 
 void NDR_InitRNodeStack(NDR_RNodeStack* ndrstack);
 size_t NDR_RNodeStackSize(NDR_RNodeStack* ndrstack);
@@ -0,0 +1,450 @@
+
+/*********************************************************************************
+*                               NDR Regex Program                                *
+**********************************************************************************/
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Neil Runcie
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "ndr_regexnode.h"
+#include "ndr_regexprogram.h"
+
+static size_t CollectRegexNodes(NDR_RegexNode** roots, size_t numRoots, NDR_RegexNode*** nodes);
+static uint32_t GetRegexNodeFlags(NDR_RegexNode* node);
+static void GetRegexNodeClass(NDR_RegexNode* node, unsigned char* accepts);
+
+// Below are the functions corresponding to character matching special characters
+// '\N' and '.'
+static int checkAllButNewLine(char comp);
+// \e
+static int checkEverything(char comp);
+// \d
+static int checkDecimalDigit(char comp);
+// \D
+static int checkNotDecimalDigit(char comp);
+// \S
+static int checkWhiteSpace(char comp);
+// \s
+static int checkNotWhiteSpace(char comp);
+// \w
+static int checkWordChar(char comp);
+// \W
+static int checkNotWordChar(char comp);
+
+
+// The nodes are laid out in the order a match walks them so that each node is usually followed by its first child
+NDR_RegexProgram* NDR_BuildRegexProgram(NDR_RegexNode* start){
+
+    NDR_RegexNode** nodes;
+    size_t numNodes = CollectRegexNodes(&start, 1, &nodes);
+
+    size_t numChildren = 0;
+    for(size_t x = 0; x < numNodes; x++)
+        numChildren += nodes[x]->numberOfChildren;
+    size_t size = sizeof(NDR_RegexProgram) + (sizeof(NDR_RegexInstruction) * numNodes) + (sizeof(uint32_t) * numChildren);
+
+    NDR_RegexProgram* program = NULL;
+    if(size <= UINT32_MAX){
+        program = malloc(size);
+        program->size = (uint32_t) size;
+        program->numInstructions = (uint32_t) numNodes;
+        program->numChildren = (uint32_t) numChildren;
+
+        uint32_t* children = NDR_RPROGRAM_CHILDREN(program);
+        uint32_t childPosition = 0;
+        for(size_t x = 0; x < numNodes; x++){
+            NDR_RegexNode* node = nodes[x];
+            NDR_RegexInstruction* instruction = &program->instructions[x];
+            instruction->flags = GetRegexNodeFlags(node);
+            instruction->minMatches = node->minMatches;
+            instruction->maxMatches = node->maxMatches;
+            instruction->wordReference = (node->wordReference == NULL) ? NDR_RINST_NONE : (uint32_t) node->wordReference->programIndex;
+
+            GetRegexNodeClass(node, instruction->accepts);
+
+            instruction->children = childPosition;
+            instruction->numberOfChildren = (uint32_t) node->numberOfChildren;
+            for(size_t y = 0; y < node->numberOfChildren; y++)
+                children[childPosition++] = (uint32_t) node->children[y]->programIndex;
+        }
+    }
+
+    // Every node was listed exactly once so the graph is freed without looking for shared nodes
+    for(size_t x = 0; x < numNodes; x++){
+        NDR_DestroyRegexNode(nodes[x]);
+        free(nodes[x]);
+    }
+    free(nodes);
+
+    return program;
+}
+
+void NDR_FreeRegexGraph(NDR_RegexNode** roots, size_t numRoots){
+    NDR_RegexNode** nodes;
+    size_t numNodes = CollectRegexNodes(roots, numRoots, &nodes);
+    for(size_t x = 0; x < numNodes; x++){
+        NDR_DestroyRegexNode(nodes[x]);
+        free(nodes[x]);
+    }
+    free(nodes);
+}
+
+NDR_RegexProgram* NDR_CopyRegexProgram(NDR_RegexProgram* program){
+    NDR_RegexProgram* copy = malloc(program->size);
+    memcpy(copy, program, program->size);
+    return copy;
+}
+
+// Every count is checked against the size of the block before it is used so that a damaged block cannot cause a read outside of it
+bool NDR_IsRegexProgramValid(NDR_RegexProgram* program, size_t size){
+    if(size < sizeof(NDR_RegexProgram) || program->size != size)
+        return false;
+    size_t remaining = size - sizeof(NDR_RegexProgram);
+    if(program->numInstructions == 0 || program->numInstructions > remaining / sizeof(NDR_RegexInstruction))
+        return false;
+    remaining -= sizeof(NDR_RegexInstruction) * program->numInstructions;
+    if(sizeof(uint32_t) * program->numChildren != remaining)
+        return false;
+
+    uint32_t* children = NDR_RPROGRAM_CHILDREN(program);
+    for(uint32_t x = 0; x < program->numInstructions; x++){
+        NDR_RegexInstruction* instruction = &program->instructions[x];
+        if(instruction->children > program->numChildren || instruction->numberOfChildren > program->numChildren - instruction->children)
+            return false;
+        // Only the end instruction and the start instruction of an empty regex have nowhere to continue to
+        if(instruction->numberOfChildren == 0 && NDR_RINST_HAS(instruction, NDR_RINST_END) == false && x != 0)
+            return false;
+        if(instruction->wordReference != NDR_RINST_NONE && instruction->wordReference >= program->numInstructions)
+            return false;
+        if(NDR_RINST_HAS(instruction, NDR_RINST_WORDEND) == true && instruction->wordReference == NDR_RINST_NONE)
+            return false;
+        for(uint32_t y = 0; y < instruction->numberOfChildren; y++){
+            if(children[instruction->children + y] >= program->numInstructions)
+                return false;
+        }
+    }
+    return true;
+}
+
+// List every node reachable from the roots through their children or word references, with the first root first and each node before its first child
+// Each node is given its position in the list. Returns the number of nodes, the list is allocated and has to be freed by the caller
+size_t CollectRegexNodes(NDR_RegexNode** roots, size_t numRoots, NDR_RegexNode*** nodes){
+    size_t numNodes = 0;
+    size_t memoryAllocated = 50;
+    *nodes = malloc(sizeof(NDR_RegexNode*) * memoryAllocated);
+
+    NDR_RNodeStack* stack = malloc(sizeof(NDR_RNodeStack));
+    NDR_InitRNodeStack(stack);
+    for(size_t x = numRoots; x > 0; x--)
+        NDR_RNodeStackPush(stack, roots[x - 1]);
+
+    while(NDR_RNodeStackIsEmpty(stack) == false){
+        NDR_RegexNode* node = NDR_RNodeStackPop(stack);
+        if(node->programIndex != NDR_RNODE_NOINDEX)
+            continue;
+        if(numNodes > memoryAllocated - 5){
+            memoryAllocated = memoryAllocated * 2;
+            *nodes = realloc(*nodes, sizeof(NDR_RegexNode*) * memoryAllocated);
+        }
+        node->programIndex = numNodes;
+        (*nodes)[numNodes++] = node;
+
+        if(node->wordReference != NULL && node->wordReference->programIndex == NDR_RNODE_NOINDEX)
+            NDR_RNodeStackPush(stack, node->wordReference);
+        for(size_t y = node->numberOfChildren; y > 0; y--){
+            if(node->children[y - 1]->programIndex == NDR_RNODE_NOINDEX)
+                NDR_RNodeStackPush(stack, node->children[y - 1]);
+        }
+    }
+
+    NDR_DestroyRegexStack(stack);
+    free(stack);
+    return numNodes;
+}
+
+uint32_t GetRegexNodeFlags(NDR_RegexNode* node){
+    bool fields[] = {node->start, node->end, node->optionalPath, node->repeatPath, node->orPath, node->wordStart, node->wordEnd,
+                     node->allButNewLine, node->everything, node->nothing, node->decimalDigit, node->notDecimalDigit,
+                     node->whiteSpace, node->notWhiteSpace, node->wordChar, node->notWordChar, node->negatedClass};
+    uint32_t flags = 0;
+    for(size_t x = 0; x < sizeof(fields) / sizeof(fields[0]); x++){
+        if(fields[x] == true)
+            flags |= ((uint32_t) 1) << x;
+    }
+    return flags;
+}
+
+// Fold everything that decides whether a node accepts a character into one bit per possible byte
+// Each escape class that is set replaces the result of the character list and of the classes checked before it, and negation is applied last
+void GetRegexNodeClass(NDR_RegexNode* node, unsigned char* accepts){
+    memset(accepts, 0, NDR_RINST_CLASSBYTES);
+    for(int ch = 0; ch < 256; ch++){
+        char comp = (char) ch;
+        bool validChar = false;
+        for(size_t x = 0; x < node->numberOfChars; x++){
+            if(comp == node->acceptChars[x]){
+                validChar = true;
+                break;
+            }
+        }
+
+        if(node->allButNewLine == true)
+            validChar = (checkAllButNewLine(comp) == 0);
+        if(node->everything == true)
+            validChar = (checkEverything(comp) == 0);
+        if(node->decimalDigit == true)
+            validChar = (checkDecimalDigit(comp) == 0);
+        if(node->notDecimalDigit == true)
+            validChar = (checkNotDecimalDigit(comp) == 0);
+        if(node->whiteSpace == true)
+            validChar = (checkWhiteSpace(comp) == 0);
+        if(node->notWhiteSpace == true)
+            validChar = (checkNotWhiteSpace(comp) == 0);
+        if(node->wordChar == true)
+            validChar = (checkWordChar(comp) == 0);
+        if(node->notWordChar == true)
+            validChar = (checkNotWordChar(comp) == 0);
+        if(node->negatedClass == true)
+            validChar = !validChar;
+
+        if(validChar == true)
+            accepts[ch >> 3] |= (unsigned char) (1 << (ch & 7));
+    }
+}
+
+int checkAllButNewLine(char comp){
+    char compare[] = {'\n'};
+    int length = 1;
+
+    for(int i = 0; i < length; i++){
+        if(compare[i] == comp){
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int checkEverything(char comp){
+    return 0;
+}
+
+int checkDecimalDigit(char comp){
+    char compare[] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    int length = 10;
+
+    for(int i = 0; i < length; i++){
+        if(compare[i] == comp){
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+int checkNotDecimalDigit(char comp){
+    char compare[] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    int length = 10;
+
+    for(int i = 0; i < length; i++){
+        if(compare[i] == comp){
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int checkWhiteSpace(char comp){
+    char compare[] = {' ', '\t'};
+    int length = 2;
+
+    for(int i = 0; i < length; i++){
+        if(compare[i] == comp){
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+int checkNotWhiteSpace(char comp){
+    char compare[] = {' ', '\t'};
+    int length = 2;
+
+    for(int i = 0; i < length; i++){
+        if(compare[i] == comp){
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int checkWordChar(char comp){
+    char compare[] = {'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z',
+    'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z',
+    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '_'};
+    int length = 63;
+
+    for(int i = 0; i < length; i++){
+        if(compare[i] == comp){
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+int checkNotWordChar(char comp){
+    char compare[] = {'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z',
+    'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z',
+    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '_'};
+    int length = 63;
+
+    for(int i = 0; i < length; i++){
+        if(compare[i] == comp){
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int HandleSpecialCharacters(NDR_RegexNode* node, char comp){
+
+    // Below are the special characters for denoting specific classes of characters
+    if(comp == 'N'){
+        node->allButNewLine = true;
+    }
+    else if(comp == 'e'){
+        node->everything = true;
+    }
+    else if(comp == 'E'){
+        node->nothing = true;
+    }
+    else if(comp == 'd'){
+        node->decimalDigit = true;
+    }
+    else if(comp == 'D'){
+        node->notDecimalDigit = true;
+    }
+    else if(comp == 's'){
+        node->whiteSpace = true;
+    }
+    else if(comp == 'S'){
+        node->notWhiteSpace = true;
+    }
+    else if(comp == 'w'){
+        node->wordChar = true;
+    }
+    else if(comp == 'W'){
+        node->notWordChar = true;
+    }
+    // Below are the special characters for structural specification within the regex engine
+    else if(comp == '['){
+        NDR_AddRNodeChar(node, '[');
+    }
+    else if(comp == ']'){
+        NDR_AddRNodeChar(node, ']');
+    }
+    else if(comp == '('){
+        NDR_AddRNodeChar(node, '(');
+    }
+    else if(comp == ')'){
+        NDR_AddRNodeChar(node, ')');
+    }
+    else if(comp == '{'){
+        NDR_AddRNodeChar(node, '{');
+    }
+    else if(comp == '}'){
+        NDR_AddRNodeChar(node, '}');
+    }
+    else if(comp == '|'){
+        NDR_AddRNodeChar(node, '|');
+    }
+    else if(comp == '$'){
+        NDR_AddRNodeChar(node, '$');
+    }
+    else if(comp == '%'){
+        NDR_AddRNodeChar(node, '%');
+    }
+    else if(comp == '?'){
+        NDR_AddRNodeChar(node, '?');
+    }
+    else if(comp == '*'){
+        NDR_AddRNodeChar(node, '*');
+    }
+    else if(comp == '+'){
+        NDR_AddRNodeChar(node, '+');
+    }
+    else if(comp == '.'){
+        NDR_AddRNodeChar(node, '.');
+    }
+    else if(comp == '^'){
+        NDR_AddRNodeChar(node, '^');
+    }
+    // Below are the special characters within the c language
+    else if(comp == 'a'){
+        NDR_AddRNodeChar(node, '\a');
+    }
+    else if(comp == 'b'){
+        NDR_AddRNodeChar(node, '\b');
+    }
+    else if(comp == 'f'){
+        NDR_AddRNodeChar(node, '\f');
+    }
+    else if(comp == 'n'){
+        NDR_AddRNodeChar(node, '\n');
+    }
+    else if(comp == 'r'){
+        NDR_AddRNodeChar(node, '\r');
+    }
+    else if(comp == 't'){
+        NDR_AddRNodeChar(node, '\t');
+    }
+    else if(comp == 'v'){
+        NDR_AddRNodeChar(node, '\v');
+    }
+    else if(comp == '\\'){
+        NDR_AddRNodeChar(node, '\\');
+    }
+    else{
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,115 @@
+
+/*********************************************************************************
+*                               NDR Regex Program                                *
+**********************************************************************************/
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Neil Runcie
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef NDRREGEXPROGRAM_H
+#define NDRREGEXPROGRAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Forward declaration of Regex node for flattening the graph built while a regex is compiled
+typedef struct NDR_RegexNode NDR_RegexNode;
+
+// Flag bits of a regex instruction, one for each boolean of the graph node it was flattened from
+#define NDR_RINST_START (1u << 0)
+#define NDR_RINST_END (1u << 1)
+#define NDR_RINST_OPTIONALPATH (1u << 2)
+#define NDR_RINST_REPEATPATH (1u << 3)
+#define NDR_RINST_ORPATH (1u << 4)
+#define NDR_RINST_WORDSTART (1u << 5)
+#define NDR_RINST_WORDEND (1u << 6)
+#define NDR_RINST_ALLBUTNEWLINE (1u << 7)
+#define NDR_RINST_EVERYTHING (1u << 8)
+#define NDR_RINST_NOTHING (1u << 9)
+#define NDR_RINST_DECIMALDIGIT (1u << 10)
+#define NDR_RINST_NOTDECIMALDIGIT (1u << 11)
+#define NDR_RINST_WHITESPACE (1u << 12)
+#define NDR_RINST_NOTWHITESPACE (1u << 13)
+#define NDR_RINST_WORDCHAR (1u << 14)
+#define NDR_RINST_NOTWORDCHAR (1u << 15)
+#define NDR_RINST_NEGATEDCLASS (1u << 16)
+// The word reference of instructions that do not end a word
+#define NDR_RINST_NONE UINT32_MAX
+// Number of bytes in the set of accepted characters of an instruction, one bit for each possible byte
+#define NDR_RINST_CLASSBYTES 32
+
+// Declaration of a single instruction of a regex program, equivalent to one node of the regex graph
+typedef struct NDR_RegexInstruction {
+    uint32_t flags;
+    int32_t minMatches;
+    int32_t maxMatches;
+    // wordReference is the index of the instruction that starts the word ended by this instruction
+    uint32_t wordReference;
+    // children is the position of the first child index within the child indexes of the program
+    uint32_t children;
+    uint32_t numberOfChildren;
+    // accepts holds the characters accepted by the instruction, folded from its character list, escape classes and negation when the program is built
+    unsigned char accepts[NDR_RINST_CLASSBYTES];
+} NDR_RegexInstruction;
+
+// Declaration of a compiled regex as one block of memory that can be copied or freed as a whole
+// The instructions are followed by the child indexes, and the start instruction is always the first
+typedef struct NDR_RegexProgram {
+    // size is the number of bytes of the whole block, including this header
+    uint32_t size;
+    uint32_t numInstructions;
+    uint32_t numChildren;
+    NDR_RegexInstruction instructions[];
+} NDR_RegexProgram;
+
+// Access the child indexes that follow the instructions of a program
+#define NDR_RPROGRAM_CHILDREN(program) ((uint32_t*) ((program)->instructions + (program)->numInstructions))
+// Get the instruction reached through child "n" of "instruction"
+#define NDR_RPROGRAM_CHILD(program, instruction, n) (&(program)->instructions[NDR_RPROGRAM_CHILDREN(program)[(instruction)->children + (n)]])
+// Get the position of "instruction" within the program
+#define NDR_RPROGRAM_INDEX(program, instruction) ((uint32_t) ((instruction) - (program)->instructions))
+// Test whether a flag bit is set on an instruction
+#define NDR_RINST_HAS(instruction, flag) (((instruction)->flags & (flag)) != 0)
+// Test whether a character is accepted by a single instruction of a program
+#define NDR_RINST_ACCEPTS(instruction, comp) (((instruction)->accepts[(unsigned char) (comp) >> 3] & (1u << ((unsigned char) (comp) & 7))) != 0)
+
+// Flatten the graph reachable from "start" into a newly allocated program and free every node of the graph
+// Returns NULL when the graph is too large to be indexed with 32 bits
+NDR_RegexProgram* NDR_BuildRegexProgram(NDR_RegexNode* start);
+// Free every node reachable from "roots", used for graphs that are abandoned part way through compilation instead of flattened
+void NDR_FreeRegexGraph(NDR_RegexNode** roots, size_t numRoots);
+// Get a newly allocated copy of a program
+NDR_RegexProgram* NDR_CopyRegexProgram(NDR_RegexProgram* program);
+// Check that a block of "size" bytes read from outside the library is a program whose indexes all stay within the block
+bool NDR_IsRegexProgramValid(NDR_RegexProgram* program, size_t size);
+
+#endif
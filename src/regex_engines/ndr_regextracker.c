@@ -42,9 +42,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "ndr_regextracker.h"
 
-// Utility function to initialize the struct used to keep track of progression through the regex graph
-void NDR_InitRTracker(NDR_RegexTracker* ref, NDR_RegexNode* node){
-    ref->reference = node;
+// Utility function to initialize the struct used to keep track of progression through the regex program
+void NDR_InitRTracker(NDR_RegexTracker* ref, NDR_RegexInstruction* instruction){
+    ref->reference = instruction;
     ref->numberOfRepeats = 0;
     ref->currentChild = 0;
     ref->stringPosition = 0;
@@ -52,12 +52,9 @@ void NDR_InitRTracker(NDR_RegexTracker* ref, NDR_RegexNode* node){
 
 // Utility function to initialize the stack
 void NDR_InitTrackerStack(NDR_TrackerStack* ndrstack){
-    ndrstack->memoryAllocated = 50;
-    ndrstack->references = malloc(ndrstack->memoryAllocated * sizeof(NDR_RegexTracker*));
-    ndrstack->disposalMemoryAllocated = 50;
-    ndrstack->disposal = malloc(ndrstack->disposalMemoryAllocated * sizeof(NDR_RegexTracker*));
+    ndrstack->memoryAllocated = 0;
+    ndrstack->trackers = NULL;
     ndrstack->numNodes = 0;
-    ndrstack->numDisposalNodes = 0;
 }
 
 // Utility function to return the size of the stack
@@ -70,31 +67,16 @@ bool NDR_TrackerStackIsEmpty(NDR_TrackerStack* ndrstack) {
     return ndrstack->numNodes <= 0;
 }
 
-// Utility function to add an element `x` to the stack
-void NDR_TrackerStackPush(NDR_TrackerStack* ndrstack, NDR_RegexTracker* node){
-    // Allocate memory if needed and keep track of it
-    if(ndrstack->numNodes > ndrstack->memoryAllocated - 5){
-        ndrstack->memoryAllocated = ndrstack->memoryAllocated * 2;
-        ndrstack->references = realloc(ndrstack->references, sizeof(NDR_RegexTracker*) * ndrstack->memoryAllocated);
-    }
-    // Allocate memory if needed and keep track of it for later removal of allocated memory
-    if(ndrstack->numNodes > ndrstack->disposalMemoryAllocated - 5){
-        ndrstack->disposalMemoryAllocated = ndrstack->disposalMemoryAllocated * 2;
-        ndrstack->references = realloc(ndrstack->references, sizeof(NDR_RegexTracker*) * ndrstack->disposalMemoryAllocated);
-    }
-    // add the node to the stack
-    ndrstack->references[ndrstack->numNodes++] = node;
-
-    // If the node is unique then add it to the disposal array
-    bool check = false;
-    for(int x = 0; x < ndrstack->numDisposalNodes; x++){
-        if(ndrstack->disposal[x] == node){
-            check = true;
-        }
-    }
-    if(check == false){
-        ndrstack->disposal[ndrstack->numDisposalNodes++] = node;
+// Utility function to add a tracker for `instruction` to the stack and return it
+NDR_RegexTracker* NDR_TrackerStackPush(NDR_TrackerStack* ndrstack, NDR_RegexInstruction* instruction){
+    // Allocate memory if needed, which moves the trackers so references from earlier pushes and peeks must not be kept
+    if(ndrstack->numNodes == ndrstack->memoryAllocated){
+        ndrstack->memoryAllocated = (ndrstack->memoryAllocated == 0) ? 50 : ndrstack->memoryAllocated * 2;
+        ndrstack->trackers = realloc(ndrstack->trackers, sizeof(NDR_RegexTracker) * ndrstack->memoryAllocated);
     }
+    NDR_RegexTracker* tracker = &ndrstack->trackers[ndrstack->numNodes++];
+    NDR_InitRTracker(tracker, instruction);
+    return tracker;
 }
 
 // Utility function to return a reference to the top of the stack
@@ -102,7 +84,7 @@ NDR_RegexTracker* NDR_TrackerStackPeek(NDR_TrackerStack* ndrstack){
     if(NDR_TrackerStackIsEmpty(ndrstack))
         return NULL;
     else{
-        return ndrstack->references[ndrstack->numNodes - 1];
+        return &ndrstack->trackers[ndrstack->numNodes - 1];
     }
 }
 
@@ -111,22 +93,16 @@ NDR_RegexTracker* NDR_TrackerStackPop(NDR_TrackerStack* ndrstack){
     if (NDR_TrackerStackIsEmpty(ndrstack))
         return NULL;
     else{
-        return ndrstack->references[--ndrstack->numNodes];
+        return &ndrstack->trackers[--ndrstack->numNodes];
     }
 }
 
-// Utility function to free the memory allocated to items with the struct
-void NDR_DestroyRegexTracker(NDR_RegexTracker* tracker){
-    free(tracker->reference);
+// Utility function to remove every tracker from the stack while keeping its memory
+void NDR_ClearTrackerStack(NDR_TrackerStack* ndrstack){
+    ndrstack->numNodes = 0;
 }
 
-
 // Utility function to free the memory allocated to items with the stack
 void NDR_DestroyRegexTrackerStack(NDR_TrackerStack* stack){
-    for(int x = 0; x < stack->numDisposalNodes; x++){
-        free(stack->disposal[x]);
-    }
-
-    free(stack->references);
-    free(stack->disposal);
+    free(stack->trackers);
 }
@@ -37,13 +37,13 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef NDRREGEXTRACKER_H
 #define NDRREGEXTRACKER_H
 
-// Forward declaration of Regex node for reference with the tracker struct
-typedef struct NDR_RegexNode NDR_RegexNode;
+// Forward declaration of Regex instruction for reference with the tracker struct
+typedef struct NDR_RegexInstruction NDR_RegexInstruction;
 
 // Declaration of Regex tracker to keep track of regex matching process
 typedef struct NDR_RegexTracker {
-    // Node reference to know which "word" start node corresponds to this tracker
-    NDR_RegexNode* reference;
+    // Instruction reference to know which "word" start instruction corresponds to this tracker
+    NDR_RegexInstruction* reference;
     // numberOfRepeats keeps track of the number of times that the graph path has been followed
     size_t numberOfRepeats;
     // currentChild refers to the the child path currently being followed in an "or" path
@@ -53,38 +53,33 @@ typedef struct NDR_RegexTracker {
 } NDR_RegexTracker;
 
 // Declaration of a stack structure for the NDR_RegexTracker struct
+// The trackers are held by value so that once the stack has grown large enough pushing a tracker does not allocate memory
 typedef struct NDR_TrackerStack{
-    // references holds a pointer for each tracker struct pushed into the stack
-    NDR_RegexTracker** references;
-    // disposal holds unique pointers for each tracker struct pushed into the stack for later memory freeing
-    NDR_RegexTracker** disposal;
-    // memoryAllocated to the references pointer
+    // trackers holds each tracker struct pushed into the stack, allocated on the first push
+    NDR_RegexTracker* trackers;
+    // memoryAllocated to the trackers pointer
     size_t memoryAllocated;
-    // numNodes holds the number of nodes in the references array
+    // numNodes holds the number of trackers in the stack
     size_t numNodes;
-    // disposalMemoryAllocated to the disposal pointer
-    size_t disposalMemoryAllocated;
-    // numDisposalNodes holds the number of nodes in the references array
-    size_t numDisposalNodes;
 } NDR_TrackerStack;
 
-// Utility function to initialize the struct used to keep track of progression through the regex graph
-void NDR_InitRTracker(NDR_RegexTracker* ref, NDR_RegexNode* node);
+// Utility function to initialize the struct used to keep track of progression through the regex program
+void NDR_InitRTracker(NDR_RegexTracker* ref, NDR_RegexInstruction* instruction);
 // Utility function to initialize the stack
 void NDR_InitTrackerStack(NDR_TrackerStack* ndrstack);
 // Utility function to return the size of the stack
 size_t NDR_TrackerStackSize(NDR_TrackerStack* ndrstack);
 // Utility function to check if the stack is empty or not
 bool NDR_TrackerStackIsEmpty(NDR_TrackerStack* ndrstack);
-// Utility function to add an element `x` to the stack
-void NDR_TrackerStackPush(NDR_TrackerStack* ndrstack, NDR_RegexTracker* node);
+// Utility function to add a tracker for `instruction` to the stack and return it
+NDR_RegexTracker* NDR_TrackerStackPush(NDR_TrackerStack* ndrstack, NDR_RegexInstruction* instruction);
 // Utility function to return a reference to the top of the stack
 NDR_RegexTracker* NDR_TrackerStackPeek(NDR_TrackerStack* ndrstack);
-// Utility function to return a reference to the top of the stack and then remove it
+// Utility function to return a reference to the top of the stack and then remove it, the reference stays valid until the next push
 NDR_RegexTracker* NDR_TrackerStackPop(NDR_TrackerStack* ndrstack);
+// Utility function to remove every tracker from the stack while keeping its memory
+void NDR_ClearTrackerStack(NDR_TrackerStack* ndrstack);
 
-// Utility function to free the memory allocated to items with the struct
-void NDR_DestroyRegexTracker(NDR_RegexTracker* tracker);
 // Utility function to free the memory allocated to items with the stack
 void NDR_DestroyRegexTrackerStack(NDR_TrackerStack* stack);
 
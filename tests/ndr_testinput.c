@@ -0,0 +1,186 @@
+
+/*********************************************************************************
+*                                   Test Input                                   *
+**********************************************************************************/
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Neil Runcie
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ndr_testinput.h"
+
+// Lines start with indentation so the ignored text around a chunk boundary is read by the chunks on both sides
+static char* pieces[] = {"num", "true", "numnumtrue", "x1", "42", "3.25", "\"a \\\"b\\\" 1\"", "!! note\n  ", "=", "+=", ";", "(", ")", "   ", "\n ", "\n    ", "\n\t\t"};
+
+// Reads the input of a stream in pieces no larger than readSize, so tokens are split across reads
+typedef struct TestStreamReader {
+    const char* input;
+    size_t length;
+    size_t position;
+    size_t readSize;
+} TestStreamReader;
+
+static size_t ReadTestStream(char* buffer, size_t size, void* userData);
+static int CompareToken(NDR_TokenInformation* expectedToken, const char* token, size_t tokenLength, const char* keyword, size_t keywordLength,
+                        size_t offset, size_t line, size_t column, size_t index, char* description);
+
+int ConfigureTestLexer(NDR_Context* context){
+
+    int result = NDR_Context_Configure_Lexer(context, NDR_TEST_CONFIG);
+    if(result != 0)
+        printf("Could not configure the lexer with %s\n", NDR_TEST_CONFIG);
+    return result;
+}
+
+char* GenerateTestInput(size_t size, size_t* length){
+
+    char* input = malloc(size + 64);
+    unsigned int seed = 12345;
+    size_t position = 0;
+    char* previous = "\n ";
+    while(position < size){
+        seed = seed * 1103515245 + 12345;
+        char* piece = pieces[(seed >> 16) % (sizeof(pieces) / sizeof(pieces[0]))];
+        // Words and numbers are kept apart so each piece stays one token
+        if(strchr(" \n\t;=()", previous[strlen(previous) - 1]) == NULL && strchr(" \n\t;=()+", piece[0]) == NULL)
+            input[position++] = ' ';
+        memcpy(input + position, piece, strlen(piece));
+        position += strlen(piece);
+        previous = piece;
+    }
+    input[position] = '\0';
+    *length = position;
+    return input;
+}
+
+int CompareTokenTables(NDR_Context* expected, NDR_Context* found, char* description){
+
+    size_t numExpected = NDR_TIGetNumberOfTokens(expected->TIWrapper);
+    size_t numFound = NDR_TIGetNumberOfTokens(found->TIWrapper);
+    if(numExpected != numFound){
+        printf("%s found %zu tokens instead of %zu\n", description, numFound, numExpected);
+        return 1;
+    }
+
+    int failures = 0;
+    for(size_t x = 0; x < numExpected && failures < 10; x++){
+        NDR_TokenInformation* expectedToken = NDR_TIGetTokenInfo(expected->TIWrapper, x);
+        NDR_TokenInformation* foundToken = NDR_TIGetTokenInfo(found->TIWrapper, x);
+        failures += CompareToken(expectedToken, foundToken->token, strlen(foundToken->token), foundToken->keyword, strlen(foundToken->keyword),
+                                 foundToken->offset, NDR_GetTokenInfoLine(foundToken), NDR_GetTokenInfoColumn(foundToken), x, description);
+        if(expectedToken->lookahead != foundToken->lookahead){
+            printf("%s, token %zu: %s reads %zu characters ahead instead of %zu\n", description, x, foundToken->token, foundToken->lookahead, expectedToken->lookahead);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+int CompareTokenStore(NDR_Context* expected, NDR_TokenStore* store, char* description){
+
+    size_t numExpected = NDR_TIGetNumberOfTokens(expected->TIWrapper);
+    size_t numFound = NDR_TSGetNumberOfTokens(store);
+    if(numExpected != numFound){
+        printf("%s found %zu tokens instead of %zu\n", description, numFound, numExpected);
+        return 1;
+    }
+
+    int failures = 0;
+    for(size_t x = 0; x < numExpected && failures < 10; x++){
+        size_t tokenLength, keywordLength;
+        const char* token = NDR_TSGetTokenText(store, x, &tokenLength);
+        const char* keyword = NDR_TSGetTokenKeyword(store, x, &keywordLength);
+        failures += CompareToken(NDR_TIGetTokenInfo(expected->TIWrapper, x), token, tokenLength, keyword, keywordLength,
+                                 NDR_TSGetTokenOffset(store, x), NDR_TSGetTokenLine(store, x), NDR_TSGetTokenColumn(store, x), x, description);
+    }
+    return failures;
+}
+
+int CompareTokenStream(NDR_Context* expected, NDR_Context* configured, const char* input, size_t length, size_t readSize, char* description){
+
+    TestStreamReader reader = {input, length, 0, readSize};
+    NDR_LexStream* stream = NDR_Context_CreateLexStream(configured, ReadTestStream, &reader);
+    if(stream == NULL){
+        printf("%s could not create a stream\n", description);
+        return 1;
+    }
+
+    int failures = 0;
+    size_t numExpected = NDR_TIGetNumberOfTokens(expected->TIWrapper);
+    size_t numFound = 0;
+    NDR_TokenInformation* found;
+    while((found = NDR_NextToken(stream)) != NULL){
+        if(numFound < numExpected && failures < 10)
+            failures += CompareToken(NDR_TIGetTokenInfo(expected->TIWrapper, numFound), found->token, strlen(found->token), found->keyword,
+                                     strlen(found->keyword), found->offset, NDR_GetTokenInfoLine(found), NDR_GetTokenInfoColumn(found), numFound, description);
+        numFound++;
+    }
+    if(NDR_GetLexStreamResult(stream) != 0){
+        printf("%s failed\n", description);
+        failures++;
+    }
+    else if(numFound != numExpected){
+        printf("%s found %zu tokens instead of %zu\n", description, numFound, numExpected);
+        failures++;
+    }
+    NDR_DestroyLexStream(stream);
+    return failures;
+}
+
+size_t ReadTestStream(char* buffer, size_t size, void* userData){
+
+    TestStreamReader* reader = userData;
+    size_t amount = reader->length - reader->position;
+    if(amount > size)
+        amount = size;
+    if(amount > reader->readSize)
+        amount = reader->readSize;
+    memcpy(buffer, reader->input + reader->position, amount);
+    reader->position += amount;
+    return amount;
+}
+
+int CompareToken(NDR_TokenInformation* expectedToken, const char* token, size_t tokenLength, const char* keyword, size_t keywordLength,
+                 size_t offset, size_t line, size_t column, size_t index, char* description){
+
+    if(strlen(expectedToken->token) == tokenLength && strncmp(expectedToken->token, token, tokenLength) == 0 &&
+       strlen(expectedToken->keyword) == keywordLength && strncmp(expectedToken->keyword, keyword, keywordLength) == 0 &&
+       expectedToken->offset == offset && NDR_GetTokenInfoLine(expectedToken) == line && NDR_GetTokenInfoColumn(expectedToken) == column)
+        return 0;
+
+    printf("%s, token %zu: %.*s (%.*s) at %zu, line %zu column %zu instead of %s (%s) at %zu, line %zu column %zu\n", description, index,
+           (int) tokenLength, token, (int) keywordLength, keyword, offset, line, column, expectedToken->token, expectedToken->keyword,
+           expectedToken->offset, NDR_GetTokenInfoLine(expectedToken), NDR_GetTokenInfoColumn(expectedToken));
+    return 1;
+}
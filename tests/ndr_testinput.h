@@ -0,0 +1,55 @@
+
+/*********************************************************************************
+*                                   Test Input                                   *
+**********************************************************************************/
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Neil Runcie
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef NDRTESTINPUT_H
+#define NDRTESTINPUT_H
+
+#include <stddef.h>
+
+#include "ndr_lap.h"
+
+// Configure the context with the lexer configuration of tests/ndr_testconfig.txt, which NDR_TEST_CONFIG holds the path of
+int ConfigureTestLexer(NDR_Context* context);
+// Generate the same pseudo random input of at least size bytes on every call, every newline is followed by indentation
+char* GenerateTestInput(size_t size, size_t* length);
+// Compare the text, keyword, offset, line, column and lookahead of every token, description names the lexing checked in the messages printed
+int CompareTokenTables(NDR_Context* expected, NDR_Context* found, char* description);
+// Compare the text, keyword, offset, line and column of every token of a store with the token table of a context
+int CompareTokenStore(NDR_Context* expected, NDR_TokenStore* store, char* description);
+// Lex input with a stream of the configured context that reads readSize bytes at a time, and compare its tokens like CompareTokenStore
+int CompareTokenStream(NDR_Context* expected, NDR_Context* configured, const char* input, size_t length, size_t readSize, char* description);
+
+#endif
@@ -0,0 +1,185 @@
+
+/*********************************************************************************
+*                                Lexer edit tests                                *
+**********************************************************************************/
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Neil Runcie
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ndr_lap.h"
+#include "ndr_testinput.h"
+
+// Large enough to be split into two chunks of at least a megabyte
+#define INPUT_SIZE 2200000
+
+typedef struct TestEdit {
+    char* description;
+    size_t offset;
+    size_t removedLength;
+    char* insertedText;
+} TestEdit;
+
+size_t FindAfter(char* input, size_t length, size_t start, char ch);
+int CheckEdit(NDR_Context* configured, char* input, size_t length, TestEdit* edit, int threads);
+int CheckFileEdit(NDR_Context* configured);
+
+int main(){
+
+    NDR_Context configured;
+    NDR_InitContext(&configured);
+    if(ConfigureTestLexer(&configured) != 0)
+        return 1;
+
+    size_t length = 0;
+    char* input = GenerateTestInput(INPUT_SIZE, &length);
+    // A second chunk starts after the first newline from the middle of the input, which is followed by indentation
+    size_t chunkJoin = FindAfter(input, length, length / 2, '\n') + 1;
+
+    TestEdit edits[] = {
+        {"Insert at the chunk join", chunkJoin, 0, "zz "},
+        {"Insert in the indentation at the chunk join", chunkJoin + 1, 0, " zz"},
+        {"Remove indentation at the chunk join", chunkJoin, 1, ""},
+        {"Comment out a line after the chunk join", FindAfter(input, length, chunkJoin + 1, '\n') + 1, 0, "!!"},
+        {"Insert at the start", 0, 0, "x1 "},
+        {"Append at the end", length, 0, " true"},
+        {"Insert a string in the first half", FindAfter(input, length, length / 4, ' '), 0, " \"q\\\"\""},
+        {"Replace a number", FindAfter(input, length, length / 3, '4'), 1, "7.5"},
+    };
+
+    int failures = 0;
+    for(size_t x = 0; x < sizeof(edits) / sizeof(edits[0]); x++){
+        failures += CheckEdit(&configured, input, length, &edits[x], 1);
+        failures += CheckEdit(&configured, input, length, &edits[x], 2);
+    }
+    failures += CheckFileEdit(&configured);
+
+    NDR_DestroyContext(&configured);
+    free(input);
+
+    if(failures != 0){
+        printf("%d lexer edit checks failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
+
+size_t FindAfter(char* input, size_t length, size_t start, char ch){
+    const char* found = memchr(input + start, ch, length - start);
+    return found == NULL ? length : (size_t) (found - input);
+}
+
+// The token table after lexing the edit has to be the one found by lexing the edited input from the start
+int CheckEdit(NDR_Context* configured, char* input, size_t length, TestEdit* edit, int threads){
+
+    size_t insertedLength = strlen(edit->insertedText);
+    size_t editedLength = length - edit->removedLength + insertedLength;
+    char* edited = malloc(editedLength + 1);
+    memcpy(edited, input, edit->offset);
+    memcpy(edited + edit->offset, edit->insertedText, insertedLength);
+    memcpy(edited + edit->offset + insertedLength, input + edit->offset + edit->removedLength, length - edit->offset - edit->removedLength);
+    edited[editedLength] = '\0';
+
+    char description[128];
+    sprintf(description, "%s after lexing on %d threads", edit->description, threads);
+
+    NDR_Context editedContext;
+    NDR_InitContext(&editedContext);
+    NDR_Context_ShareConfiguration(&editedContext, configured);
+    NDR_Context_SetLexThreads(&editedContext, threads);
+    NDR_Context freshContext;
+    NDR_InitContext(&freshContext);
+    NDR_Context_ShareConfiguration(&freshContext, configured);
+    NDR_Context_SetLexThreads(&freshContext, 1);
+
+    int failures = 0;
+    int freshResult = NDR_Context_LexBuffer(&freshContext, edited, editedLength);
+    if(NDR_Context_LexBuffer(&editedContext, input, length) != 0){
+        printf("%s: the input could not be lexed\n", description);
+        failures++;
+    }
+    else if(NDR_Context_LexEdit(&editedContext, edited, editedLength, edit->offset, edit->removedLength, insertedLength) != freshResult){
+        printf("%s: lexing the edit and lexing the edited input gave different results\n", description);
+        failures++;
+    }
+    else if(freshResult == 0)
+        failures += CompareTokenTables(&freshContext, &editedContext, description);
+
+    NDR_DestroyContext(&editedContext);
+    NDR_DestroyContext(&freshContext);
+    free(edited);
+    return failures;
+}
+
+// A file is read through a window as it is lexed, the edit still has to know the whole length of the file
+int CheckFileEdit(NDR_Context* configured){
+
+    char* original = "num x = 1;\n";
+    char* edited = "num x = 1;\ny = 2;\n";
+    FILE* file = tmpfile();
+    if(file == NULL){
+        printf("Could not create a file to lex\n");
+        return 1;
+    }
+    fputs(original, file);
+    rewind(file);
+
+    NDR_Context fileContext;
+    NDR_InitContext(&fileContext);
+    NDR_Context_ShareConfiguration(&fileContext, configured);
+    NDR_Context freshContext;
+    NDR_InitContext(&freshContext);
+    NDR_Context_ShareConfiguration(&freshContext, configured);
+
+    int failures = 0;
+    if(NDR_Context_LexFile(&fileContext, file) != 0){
+        printf("The file could not be lexed\n");
+        failures++;
+    }
+    else if(NDR_Context_LexEdit(&fileContext, edited, strlen(edited), strlen(original), 0, strlen(edited) - strlen(original)) != 0){
+        printf("Appending to a lexed file failed\n");
+        failures++;
+    }
+    else if(NDR_Context_LexBuffer(&freshContext, edited, strlen(edited)) != 0){
+        printf("The edited file could not be lexed\n");
+        failures++;
+    }
+    else
+        failures += CompareTokenTables(&freshContext, &fileContext, "Appending to a lexed file");
+
+    NDR_DestroyContext(&fileContext);
+    NDR_DestroyContext(&freshContext);
+    fclose(file);
+    return failures;
+}
@@ -0,0 +1,170 @@
+
+/*********************************************************************************
+*                                Lexer mode tests                                *
+**********************************************************************************/
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Neil Runcie
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ndr_lap.h"
+#include "ndr_testinput.h"
+
+#define CONFIG_NAME "test_lexer_modes_config.txt"
+#define IMAGE_NAME "test_lexer_modes_image.bin"
+
+// The template example of the instruction manual, text is only split into tokens between "{{" and "}}"
+static char* modesConfigText = "ignore m{initial,code} {\\n}\n"
+                               "accept k{open} push{code} {[\\{][\\{]}\n"
+                               "accept k{text} {[a-zA-Z0-9 !]+}\n"
+                               "ignore m{code} {[ \\t]+}\n"
+                               "accept k{close} m{code} pop {[\\}][\\}]}\n"
+                               "accept k{id} m{code} {[a-z]+}\n"
+                               "accept k{str} m{code} switch{quoted} {[\"]}\n"
+                               "accept k{qtext} m{quoted} {[a-zA-Z0-9 ]+}\n"
+                               "accept k{qend} m{quoted} switch{code} {[\"]}\n";
+
+static char* templateLines[] = {"Hello {{ name \"big world\" }} bye!\n", "see {{ id }}\n", "{{\"x\"}}{{ a  b }}\n", "plain text 42\n"};
+static char* firstLineKeywords[] = {"text", "open", "id", "str", "qtext", "qend", "close", "text"};
+
+#define NUM_ELEMENTS(array) (sizeof(array) / sizeof(array[0]))
+
+int CheckModeKeywords(NDR_Context* buffer);
+int CheckImage(NDR_Context* buffer, char* input, size_t length);
+
+int main(){
+
+    FILE* config = fopen(CONFIG_NAME, "w");
+    if(config == NULL){
+        printf("Could not write the configuration %s\n", CONFIG_NAME);
+        return 1;
+    }
+    fputs(modesConfigText, config);
+    fclose(config);
+
+    NDR_Context buffer;
+    NDR_InitContext(&buffer);
+    if(NDR_Context_Configure_Lexer(&buffer, CONFIG_NAME) != 0){
+        printf("Could not configure the lexer\n");
+        remove(CONFIG_NAME);
+        return 1;
+    }
+
+    // Enough lines for the stream to read the input in many pieces
+    size_t length = 0;
+    char* input = malloc(200 * 64);
+    for(size_t x = 0; x < 200; x++){
+        char* line = templateLines[x % NUM_ELEMENTS(templateLines)];
+        memcpy(input + length, line, strlen(line));
+        length += strlen(line);
+    }
+    // The last text token is ended by the end of the input rather than by a newline
+    length--;
+
+    int failures = 0;
+    if(NDR_Context_LexBuffer(&buffer, input, length) != 0){
+        printf("Could not lex the template\n");
+        failures++;
+    }
+    else{
+        failures += CheckModeKeywords(&buffer);
+        failures += CompareTokenStream(&buffer, &buffer, input, length, 7, "Lexing a stream");
+
+        NDR_TokenStore store;
+        NDR_InitTokenStore(&store);
+        if(NDR_Context_LexBufferToStore(&buffer, input, length, &store) != 0){
+            printf("Could not lex the template into a store\n");
+            failures++;
+        }
+        else
+            failures += CompareTokenStore(&buffer, &store, "Lexing into a store");
+        NDR_FreeTokenStore(&store);
+
+        failures += CheckImage(&buffer, input, length);
+    }
+
+    NDR_DestroyContext(&buffer);
+    free(input);
+    remove(CONFIG_NAME);
+
+    if(failures != 0){
+        printf("%d lexer mode checks failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
+
+// The code mode is entered and left again, so the text after "}}" is one token
+int CheckModeKeywords(NDR_Context* buffer){
+
+    if(NDR_TIGetNumberOfTokens(buffer->TIWrapper) < NUM_ELEMENTS(firstLineKeywords)){
+        printf("The template only has %zu tokens\n", NDR_TIGetNumberOfTokens(buffer->TIWrapper));
+        return 1;
+    }
+    for(size_t x = 0; x < NUM_ELEMENTS(firstLineKeywords); x++){
+        NDR_TokenInformation* token = NDR_TIGetTokenInfo(buffer->TIWrapper, x);
+        if(strcmp(token->keyword, firstLineKeywords[x]) != 0){
+            printf("Token %zu \"%s\" is %s instead of %s\n", x, token->token, token->keyword, firstLineKeywords[x]);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// The modes are written to the image with the rules, so a lexer configured from it lexes the template the same way
+int CheckImage(NDR_Context* buffer, char* input, size_t length){
+
+    if(NDR_Context_SaveLexerImage(buffer, IMAGE_NAME) != 0){
+        printf("Could not save the lexer image\n");
+        return 1;
+    }
+
+    int failures = 0;
+    NDR_Context image;
+    NDR_InitContext(&image);
+    if(NDR_Context_LoadLexerImage(&image, IMAGE_NAME, CONFIG_NAME) != 0){
+        printf("Could not load the lexer image\n");
+        failures++;
+    }
+    else if(NDR_Context_LexBuffer(&image, input, length) != 0){
+        printf("Could not lex the template with the lexer image\n");
+        failures++;
+    }
+    else
+        failures += CompareTokenTables(buffer, &image, "Lexing with the lexer image");
+
+    NDR_DestroyContext(&image);
+    remove(IMAGE_NAME);
+    return failures;
+}
@@ -0,0 +1,121 @@
+
+/*********************************************************************************
+*                                Lexer path tests                                *
+**********************************************************************************/
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Neil Runcie
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ndr_lap.h"
+#include "ndr_testinput.h"
+
+// Large enough for many reads of a stream, while still lexed as a single chunk
+#define INPUT_SIZE 200000
+// An odd read size splits tokens and lines between the reads of a stream
+#define STREAM_READ_SIZE 1021
+
+// Generated by ndr_lexgen from the configuration of the tests
+int NDR_TestScan(NDR_Context* context, const char* data, size_t len);
+
+// Every way of lexing an input gives the tokens NDR_Context_LexBuffer gives, with the same line and column
+int main(){
+
+    NDR_Context configured;
+    NDR_InitContext(&configured);
+    if(ConfigureTestLexer(&configured) != 0)
+        return 1;
+
+    size_t length = 0;
+    char* input = GenerateTestInput(INPUT_SIZE, &length);
+
+    NDR_Context buffer;
+    NDR_InitContext(&buffer);
+    NDR_Context_ShareConfiguration(&buffer, &configured);
+    if(NDR_Context_LexBuffer(&buffer, input, length) != 0){
+        printf("Could not lex the input from a buffer\n");
+        return 1;
+    }
+
+    int failures = 0;
+    failures += CompareTokenStream(&buffer, &configured, input, length, STREAM_READ_SIZE, "Lexing a stream");
+
+    NDR_TokenStore store;
+    NDR_InitTokenStore(&store);
+    if(NDR_Context_LexBufferToStore(&configured, input, length, &store) != 0){
+        printf("Could not lex the input into a store\n");
+        failures++;
+    }
+    else
+        failures += CompareTokenStore(&buffer, &store, "Lexing into a store");
+    NDR_FreeTokenStore(&store);
+
+    NDR_Context scanned;
+    NDR_InitContext(&scanned);
+    if(NDR_TestScan(&scanned, input, length) != 0){
+        printf("Could not lex the input with the generated scanner\n");
+        failures++;
+    }
+    else
+        failures += CompareTokenTables(&buffer, &scanned, "Lexing with the generated scanner");
+    NDR_DestroyContext(&scanned);
+
+    // The tokens matched for the buffer are written to the cache, so lexing the input again has to load them
+    NDR_Context cached;
+    NDR_InitContext(&cached);
+    NDR_Context_ShareConfiguration(&cached, &configured);
+    NDR_Context_SetTokenCache(&buffer, NDR_TEST_CACHE);
+    NDR_Context_SetTokenCache(&cached, NDR_TEST_CACHE);
+    if(NDR_SaveCachedTokens(&buffer, input, length) != 0 || NDR_Context_LexBuffer(&cached, input, length) != 0){
+        printf("Could not lex the input through the token cache\n");
+        failures++;
+    }
+    else{
+        failures += CompareTokenTables(&buffer, &cached, "Loading from the token cache");
+        if(NDR_LoadCachedTokens(&cached, input, length) != 0){
+            printf("The token cache holds no tokens for the input\n");
+            failures++;
+        }
+    }
+    NDR_DestroyContext(&cached);
+
+    NDR_DestroyContext(&buffer);
+    NDR_DestroyContext(&configured);
+    free(input);
+
+    if(failures != 0){
+        printf("%d lexer path checks failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,157 @@
+
+/*********************************************************************************
+*                               Lexer thread tests                               *
+**********************************************************************************/
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Neil Runcie
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "ndr_lap.h"
+#include "ndr_testinput.h"
+
+// Large enough for up to four chunks of at least a megabyte
+#define INPUT_SIZE 5000000
+// The number of bytes around the start of a chunk that a multi-line string or comment covers on each side
+#define COVER_SIZE 256
+
+int CompareThreadCounts(NDR_Context* configured, char* input, size_t length, char* inputName);
+void CoverChunkStarts(char* input, size_t length, char* open, char* line, char* close);
+
+int main(){
+
+    NDR_Context configured;
+    NDR_InitContext(&configured);
+    if(ConfigureTestLexer(&configured) != 0)
+        return 1;
+
+    size_t length = 0;
+    char* input = GenerateTestInput(INPUT_SIZE, &length);
+    int failures = CompareThreadCounts(&configured, input, length, "plain input");
+
+    // Chunks that start inside a string or a comment guess the wrong state, so their tokens must be lexed again from where the previous chunk stopped
+    // The lines inside each one look like the start of the other to a chunk that guesses
+    char* stringInput = malloc(length + 1);
+    memcpy(stringInput, input, length + 1);
+    CoverChunkStarts(stringInput, length, "\"", "!! x /* y\n", "\"");
+    failures += CompareThreadCounts(&configured, stringInput, length, "strings over the chunk starts");
+    free(stringInput);
+
+    CoverChunkStarts(input, length, "/*", " \" !! z\n", "*/");
+    failures += CompareThreadCounts(&configured, input, length, "comments over the chunk starts");
+
+    NDR_DestroyContext(&configured);
+    free(input);
+
+    if(failures != 0){
+        printf("%d lexer thread checks failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
+
+// Lexing on two to four threads gives the same tokens as lexing on one
+int CompareThreadCounts(NDR_Context* configured, char* input, size_t length, char* inputName){
+
+    NDR_Context singleThread;
+    NDR_InitContext(&singleThread);
+    NDR_Context_ShareConfiguration(&singleThread, configured);
+    NDR_Context_SetLexThreads(&singleThread, 1);
+    if(NDR_Context_LexBuffer(&singleThread, input, length) != 0){
+        printf("Could not lex the %s on a single thread\n", inputName);
+        NDR_DestroyContext(&singleThread);
+        return 1;
+    }
+
+    int failures = 0;
+    for(int threads = 2; threads <= 4; threads++){
+        NDR_Context chunked;
+        NDR_InitContext(&chunked);
+        NDR_Context_ShareConfiguration(&chunked, configured);
+        NDR_Context_SetLexThreads(&chunked, threads);
+
+        char description[96];
+        sprintf(description, "Lexing the %s on %d threads", inputName, threads);
+        if(NDR_Context_LexBuffer(&chunked, input, length) != 0){
+            printf("%s failed\n", description);
+            failures++;
+        }
+        else
+            failures += CompareTokenTables(&singleThread, &chunked, description);
+        NDR_DestroyContext(&chunked);
+    }
+
+    NDR_DestroyContext(&singleThread);
+    return failures;
+}
+
+// Replace the whole lines around every point the lexer splits the input at for two to four threads with open, repeated lines and close
+// The rest of the lines is filled with spaces so the input keeps its length and the lexer splits it at the same points
+// Points a few bytes apart, such as half of the input for two and four threads, are covered once
+void CoverChunkStarts(char* input, size_t length, char* open, char* line, char* close){
+
+    size_t covered[6];
+    size_t numCovered = 0;
+    for(size_t numChunks = 2; numChunks <= 4; numChunks++){
+        for(size_t x = 1; x < numChunks; x++){
+            size_t share = length / numChunks * x;
+            bool near = false;
+            for(size_t y = 0; y < numCovered; y++){
+                if(share < covered[y] + COVER_SIZE && covered[y] < share + COVER_SIZE)
+                    near = true;
+            }
+            if(near == true)
+                continue;
+            covered[numCovered++] = share;
+
+            size_t first = share - COVER_SIZE;
+            while(first > 0 && input[first - 1] != '\n')
+                first--;
+            char* newline = memchr(input + share + COVER_SIZE, '\n', length - share - COVER_SIZE);
+            size_t last = (size_t) (newline - input);
+
+            size_t position = first;
+            memcpy(input + position, open, strlen(open));
+            position += strlen(open);
+            while(position + strlen(line) + strlen(close) <= last){
+                memcpy(input + position, line, strlen(line));
+                position += strlen(line);
+            }
+            memcpy(input + position, close, strlen(close));
+            position += strlen(close);
+            memset(input + position, ' ', last - position);
+        }
+    }
+}
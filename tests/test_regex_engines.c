@@ -0,0 +1,263 @@
+
+/*********************************************************************************
+*                               Regex engine tests                               *
+**********************************************************************************/
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Neil Runcie
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "ndr_lap.h"
+#include "regex_engines/ndr_regex.h"
+
+// Every engine must give an answer for these patterns, their repetitions can be entered without consuming a character
+char* nestedPatterns[] = {"(([a]*)*)*[b]", "$((a)?)*b%", "$((a[a-c]?)?)*[0-9]%", "$([a]*)*b%", "((a?)*)*"};
+// Anchored patterns with repeated and optional words, which the backtracker used to get wrong
+char* anchoredPatterns[] = {"$((a)?)*b%", "$(a)*b%", "$(ab)+c%", "$((a)*)*b%", "$(ab)*c%", "$([ab])?c%", "$(ab)*%", "$(c){2}%", "$[1-3]{1,3}%"};
+// Compiling these fails part way through the pattern, with words still open or a node waiting for its characters
+char* invalidPatterns[] = {"a|b", "[abc", "(a", "a{2,x}", "(a){x}", "((a)", "[a]{y}", "((a)b{1,z})"};
+char* testStrings[] = {"", "a", "b", "ab", "aab", "a1", "aaa", "aaab", "abc", "ababc", "ac", "c", "aabcb", "ba"};
+
+#define NUM_ELEMENTS(array) (sizeof(array) / sizeof(array[0]))
+
+// The results documented for regexes matched with their NFA program, where a match may start at any character without '$'
+typedef struct ExpectedResult {
+    char* pattern;
+    char* token;
+    NDR_MatchResult result;
+} ExpectedResult;
+
+ExpectedResult expectedResults[] = {
+    {"[a]", "b", NDR_REGEX_PARTIALMATCH}, {"\\d+", "a", NDR_REGEX_PARTIALMATCH}, {"[a]%", "aaaa", NDR_REGEX_COMPLETEMATCH},
+    {"$[a]", "b", NDR_REGEX_NOMATCH}, {"$[a]%", "ab", NDR_REGEX_NOMATCH}, {"$(ab)*%", "abab", NDR_REGEX_COMPLETEMATCH},
+    {"$(ab)*%", "b", NDR_REGEX_NOMATCH}, {"$(c){2}%", "cc", NDR_REGEX_COMPLETEMATCH}, {"$[1-3]{1,3}%", "1", NDR_REGEX_COMPLETEMATCH}
+};
+
+int MatchWithEngine(char* pattern, char* token, NDR_RegexEngine engine, NDR_MatchResult* result);
+int CheckNestedPatterns();
+int CheckExpectedResults();
+int CheckBacktrackRejected(char** patterns, size_t numPatterns);
+int CheckCursors(char** patterns, size_t numPatterns, size_t cacheSize);
+int CheckInvalidPatterns();
+int CheckNestedAllowRegex();
+
+int main(){
+
+    int failures = 0;
+    failures += CheckNestedPatterns();
+    failures += CheckExpectedResults();
+    failures += CheckBacktrackRejected(nestedPatterns, NUM_ELEMENTS(nestedPatterns));
+    failures += CheckBacktrackRejected(anchoredPatterns, NUM_ELEMENTS(anchoredPatterns));
+    // A cache too small for a single state makes the cursors flush it on every step and fall back to the NFA program
+    failures += CheckCursors(nestedPatterns, NUM_ELEMENTS(nestedPatterns), 1 << 16);
+    failures += CheckCursors(nestedPatterns, NUM_ELEMENTS(nestedPatterns), 1);
+    failures += CheckCursors(anchoredPatterns, NUM_ELEMENTS(anchoredPatterns), 1 << 16);
+    failures += CheckNestedAllowRegex();
+    failures += CheckInvalidPatterns();
+
+    if(failures != 0){
+        printf("%d regex engine checks failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
+
+int MatchWithEngine(char* pattern, char* token, NDR_RegexEngine engine, NDR_MatchResult* result){
+
+    NDR_Regex regex;
+    NDR_InitRegex(&regex);
+    if(NDR_CompileRegex(&regex, pattern) != 0 || NDR_Regex_SetEngine(&regex, engine) != 0){
+        printf("Could not compile the regex %s\n", pattern);
+        NDR_DestroyRegex(&regex);
+        return 1;
+    }
+    *result = NDR_MatchRegex(&regex, token);
+    NDR_DestroyRegex(&regex);
+    return 0;
+}
+
+// The automatic engine, the scratch matcher and the Pike VM give the same answer
+int CheckNestedPatterns(){
+
+    int failures = 0;
+    NDR_RegexScratch scratch;
+    NDR_InitRegexScratch(&scratch);
+
+    for(size_t p = 0; p < NUM_ELEMENTS(nestedPatterns); p++){
+        NDR_Regex regex;
+        NDR_InitRegex(&regex);
+        if(NDR_CompileRegex(&regex, nestedPatterns[p]) != 0){
+            printf("Could not compile the regex %s\n", nestedPatterns[p]);
+            failures++;
+            NDR_DestroyRegex(&regex);
+            continue;
+        }
+        for(size_t s = 0; s < NUM_ELEMENTS(testStrings); s++){
+            NDR_MatchResult pikeResult = NDR_MatchRegexPikeVM(&regex, testStrings[s]);
+            NDR_MatchResult autoResult = NDR_MatchRegex(&regex, testStrings[s]);
+            NDR_MatchResult scratchResult = NDR_MatchRegexWithScratch(&regex, testStrings[s], &scratch);
+
+            if(pikeResult == NDR_REGEX_FAILURE || autoResult != pikeResult || scratchResult != pikeResult){
+                printf("%s on \"%s\": Pike VM %d, auto %d, scratch %d\n", nestedPatterns[p], testStrings[s], pikeResult, autoResult, scratchResult);
+                failures++;
+            }
+        }
+        NDR_DestroyRegex(&regex);
+    }
+
+    NDR_DestroyRegexScratch(&scratch);
+    return failures;
+}
+
+int CheckExpectedResults(){
+
+    int failures = 0;
+    for(size_t e = 0; e < NUM_ELEMENTS(expectedResults); e++){
+        NDR_MatchResult autoResult, pikeResult;
+        failures += MatchWithEngine(expectedResults[e].pattern, expectedResults[e].token, NDR_REGEX_ENGINE_AUTO, &autoResult);
+        failures += MatchWithEngine(expectedResults[e].pattern, expectedResults[e].token, NDR_REGEX_ENGINE_PIKEVM, &pikeResult);
+        if(autoResult != expectedResults[e].result || pikeResult != expectedResults[e].result){
+            printf("%s on \"%s\": expected %d, auto %d, Pike VM %d\n", expectedResults[e].pattern, expectedResults[e].token, expectedResults[e].result, autoResult, pikeResult);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+// Regexes with an NFA program refuse the backtracker and keep matching with the engine they had
+int CheckBacktrackRejected(char** patterns, size_t numPatterns){
+
+    int failures = 0;
+    for(size_t p = 0; p < numPatterns; p++){
+        NDR_Regex regex;
+        NDR_InitRegex(&regex);
+        if(NDR_CompileRegex(&regex, patterns[p]) != 0){
+            printf("Could not compile the regex %s\n", patterns[p]);
+            failures++;
+        }
+        else if(NDR_Regex_SetEngine(&regex, NDR_REGEX_ENGINE_BACKTRACK) == 0 || NDR_Regex_GetEngine(&regex) != NDR_REGEX_ENGINE_AUTO){
+            printf("The backtracker was accepted for %s\n", patterns[p]);
+            failures++;
+        }
+        NDR_DestroyRegex(&regex);
+    }
+    return failures;
+}
+
+// A cursor stepped through a token, with its lazy DFA or without, ends with the result the Pike VM gives for the whole token
+int CheckCursors(char** patterns, size_t numPatterns, size_t cacheSize){
+
+    int failures = 0;
+    for(size_t p = 0; p < numPatterns; p++){
+        NDR_Regex regex;
+        NDR_InitRegex(&regex);
+        NDR_Regex_SetLazyDFACacheSize(&regex, cacheSize);
+        if(NDR_CompileRegex(&regex, patterns[p]) != 0){
+            printf("Could not compile the regex %s\n", patterns[p]);
+            failures++;
+            NDR_DestroyRegex(&regex);
+            continue;
+        }
+        NDR_RegexCursor cursor;
+        NDR_InitRegexCursor(&cursor, &regex);
+        for(size_t s = 0; s < NUM_ELEMENTS(testStrings); s++){
+            if(testStrings[s][0] == '\0')
+                continue;
+            NDR_ResetRegexCursor(&cursor);
+            NDR_MatchResult cursorResult = NDR_REGEX_NOMATCH;
+            for(size_t c = 0; testStrings[s][c] != '\0'; c++)
+                cursorResult = NDR_RegexStep(&cursor, testStrings[s][c]);
+            NDR_MatchResult pikeResult = NDR_MatchRegexPikeVM(&regex, testStrings[s]);
+            if(cursorResult != pikeResult){
+                printf("%s on \"%s\" with a %zu byte cache: cursor %d, Pike VM %d\n", patterns[p], testStrings[s], cacheSize, cursorResult, pikeResult);
+                failures++;
+            }
+        }
+        NDR_DestroyRegexCursor(&cursor);
+        NDR_DestroyRegex(&regex);
+    }
+    return failures;
+}
+
+// A failed compilation frees the graph it started, and the regex can still be compiled again afterwards
+int CheckInvalidPatterns(){
+
+    int failures = 0;
+    NDR_Regex regex;
+    NDR_InitRegex(&regex);
+    for(size_t p = 0; p < NUM_ELEMENTS(invalidPatterns); p++){
+        if(NDR_CompileRegex(&regex, invalidPatterns[p]) == 0){
+            printf("The invalid regex %s was compiled\n", invalidPatterns[p]);
+            failures++;
+        }
+        if(NDR_CompileRegex(&regex, "(ab)+c") != 0 || NDR_MatchRegex(&regex, "ababc") != NDR_REGEX_COMPLETEMATCH){
+            printf("The regex could not be compiled again after %s failed\n", invalidPatterns[p]);
+            failures++;
+        }
+    }
+    NDR_DestroyRegex(&regex);
+    return failures;
+}
+
+// Building the byte tables of a state token matches its allow regex against every byte
+int CheckNestedAllowRegex(){
+
+    char* configName = "test_regex_engines_config.txt";
+    FILE* config = fopen(configName, "w");
+    if(config == NULL){
+        printf("Could not write the configuration %s\n", configName);
+        return 1;
+    }
+    fprintf(config, "ignore k{space} {[ \\t\\n]+}\n"
+                    "accept k{s} states:\n"
+                    "start {[\"]}\n"
+                    "allow {(([a]*)*)*[b]}\n"
+                    "end {[\"]}\n");
+    fclose(config);
+
+    NDR_Context context;
+    NDR_InitContext(&context);
+    int failures = 0;
+    if(NDR_Context_Configure_Lexer(&context, configName) != 0){
+        printf("Could not configure a lexer with the allow regex (([a]*)*)*[b]\n");
+        failures++;
+    }
+    else if(NDR_Context_LexBuffer(&context, "\"bb\" \"b\"", 8) != 0){
+        printf("Could not lex with the allow regex (([a]*)*)*[b]\n");
+        failures++;
+    }
+    NDR_DestroyContext(&context);
+    remove(configName);
+    return failures;
+}
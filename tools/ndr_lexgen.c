@@ -0,0 +1,862 @@
+
+/*********************************************************************************
+*                              NDR Lexer Generator                               *
+**********************************************************************************/
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Neil Runcie
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "ndr_lap.h"
+
+// Name given to the generated lexing function when none is provided
+#define LEXGEN_DEFAULTNAME "NDR_GeneratedLex"
+// Number of values written on each line of a generated table
+#define LEXGEN_VALUESPERLINE 16
+
+// Declaration of one automaton written out as a switch based step function
+typedef struct GeneratedAutomaton {
+    size_t numStates;
+    size_t numByteClasses;
+    const size_t* byteClasses;
+    const size_t* transitions;
+    const int* acceptingRule;
+    const size_t* numCompleteMatches;
+} GeneratedAutomaton;
+
+// Declaration of the state kept while a scanner is generated
+typedef struct LexerGenerator {
+    NDR_Context* context;
+    const char* name;
+    FILE* output;
+    // stateTables maps every regex state index onto its row of the state byte tables or -1 for tokens that are not states
+    int* stateTables;
+    size_t numStateTables;
+    // endSets maps every row of the state byte tables onto the automaton of the end regexes shared by every state with its keyword
+    int* endSets;
+    // endAutomata holds NULL for a keyword without any end regexes
+    NDR_LexerDFA** endAutomata;
+    size_t numEndAutomata;
+} LexerGenerator;
+
+static bool IsIdentifier(const char* name);
+static bool CanGenerateScanner(NDR_Context* context);
+static int BuildEndAutomata(LexerGenerator* generator);
+static void FreeLexerGenerator(LexerGenerator* generator);
+static void GetGeneratedAutomaton(GeneratedAutomaton* automaton, size_t numStates, size_t numByteClasses, const size_t* byteClasses, const size_t* transitions, const int* acceptingRule, const size_t* numCompleteMatches);
+static void WriteCode(LexerGenerator* generator, const char* code);
+static void WriteString(FILE* output, const char* string);
+static void WriteAutomaton(LexerGenerator* generator, const char* prefix, GeneratedAutomaton* automaton, bool withAcceptingRules);
+static void WriteSymbolTables(LexerGenerator* generator);
+static int WriteScanner(LexerGenerator* generator, char* configFileName, char* fileName);
+
+// The automaton used in place of one that could not be built, every step of it ends in the dead state
+static const size_t emptyByteClasses[256] = {0};
+static const size_t emptyTransitions[2] = {0, 0};
+static const int emptyAcceptingRule[2] = {-1, -1};
+static const size_t emptyCompleteMatches[2] = {0, 0};
+
+// The scanner written after the tables, '@' is replaced by the name of the generated function
+// It follows the matching done by the lexer one step at a time so the token table is identical to the one from NDR_Lex
+static const char* scannerCode[] = {
+    "enum { @_NOMATCH, @_PARTIALMATCH, @_COMPLETEMATCH };",
+    "",
+    "// The text of a token as it is matched. NUL bytes are not kept, as within the lexer",
+    "typedef struct @_Text {",
+    "    char* text;",
+    "    size_t length;",
+    "    size_t allocated;",
+    "} @_Text;",
+    "",
+    "typedef struct @_Input {",
+    "    const char* data;",
+    "    size_t length;",
+    "    size_t position;",
+    "    // furthest is one past the furthest position read so far and gives the lookahead of each token",
+    "    size_t furthest;",
+    "} @_Input;",
+    "",
+    "static void @_InitText(@_Text* token){",
+    "    token->allocated = 50;",
+    "    token->text = malloc(token->allocated);",
+    "    token->text[0] = '\\0';",
+    "    token->length = 0;",
+    "}",
+    "",
+    "static void @_AddRange(@_Text* token, const char* src, size_t length){",
+    "    if(token->length + length + 1 > token->allocated){",
+    "        token->allocated = (token->allocated * 2) + length;",
+    "        token->text = realloc(token->text, token->allocated);",
+    "    }",
+    "    memcpy(token->text + token->length, src, length);",
+    "    token->length += length;",
+    "    token->text[token->length] = '\\0';",
+    "}",
+    "",
+    "static void @_AddChar(@_Text* token, char ch){",
+    "    if(ch != '\\0')",
+    "        @_AddRange(token, &ch, 1);",
+    "}",
+    "",
+    "static void @_Truncate(@_Text* token, size_t amount){",
+    "    token->length -= amount;",
+    "    token->text[token->length] = '\\0';",
+    "}",
+    "",
+    "static void @_Clear(@_Text* token){",
+    "    token->length = 0;",
+    "    token->text[0] = '\\0';",
+    "}",
+    "",
+    "static int @_Read(@_Input* input){",
+    "    if(input->position >= input->furthest)",
+    "        input->furthest = input->position + 1;",
+    "    if(input->position >= input->length)",
+    "        return EOF;",
+    "    return (unsigned char) input->data[input->position++];",
+    "}",
+    "",
+    "static int @_Peek(@_Input* input){",
+    "    if(input->position >= input->furthest)",
+    "        input->furthest = input->position + 1;",
+    "    if(input->position >= input->length)",
+    "        return EOF;",
+    "    return (unsigned char) input->data[input->position];",
+    "}",
+    "",
+    "static void @_AddToken(NDR_Context* context, size_t offset, const char* keyword, const char* text){",
+    "    NDR_AddNewToken(context->TIWrapper);",
+    "    NDR_TokenInformation* token = NDR_TIGetLastTokenInfo(context->TIWrapper);",
+    "    NDR_SetTokenInfoOffset(token, offset);",
+    "    token->lookahead = 0;",
+    "    NDR_SetTokenInfoLineIndex(token, context->lineIndex);",
+    "    NDR_SetTokenInfoKeyword(token, (char*) keyword);",
+    "    NDR_SetTokenInfoToken(token, (char*) text);",
+    "}",
+    "",
+    "// The lookahead of a token covers everything read until the next token starts",
+    "static void @_UpdateLookahead(NDR_Context* context, size_t firstToken, @_Input* input){",
+    "    if(NDR_TIGetNumberOfTokens(context->TIWrapper) > firstToken){",
+    "        NDR_TokenInformation* token = NDR_TIGetLastTokenInfo(context->TIWrapper);",
+    "        token->lookahead = input->furthest - token->offset;",
+    "    }",
+    "}",
+    "",
+    "// Add the rest of a state token to token, checking each character for the end of the state",
+    "static int @_MatchState(@_Input* input, @_Text* token, @_Text* endToken, int rule){",
+    "    const unsigned char* stateBytes = @_StateBytes[@_StateTables[rule]];",
+    "    int endSet = @_EndSets[@_StateTables[rule]];",
+    "    int ch = 0;",
+    "    char endCh = 0;",
+    "    bool currentlyEscaped = false;",
+    "    bool allowMatch = false;",
+    "    bool escapeMatch = false;",
+    "    bool endMatch = false;",
+    "    bool endCheckComplete = false;",
+    "    size_t probeStart = 0;",
+    "    size_t endMatchEnd = 0;",
+    "",
+    "    while(ch != EOF){",
+    "        // A run of plain bytes can neither end nor escape anything so it is added to the token in one step",
+    "        size_t plainEnd = input->position;",
+    "        while(plainEnd < input->length && (stateBytes[(unsigned char) input->data[plainEnd]] & @_PLAINBYTE) != 0)",
+    "            plainEnd++;",
+    "        if(plainEnd > input->position){",
+    "            @_AddRange(token, input->data + input->position, plainEnd - input->position);",
+    "            input->position = plainEnd;",
+    "            if(input->position > input->furthest)",
+    "                input->furthest = input->position;",
+    "            currentlyEscaped = false;",
+    "        }",
+    "",
+    "        ch = @_Peek(input);",
+    "        if(ch == EOF){",
+    "            printf(\"Reached end of file during parsing\\n\");",
+    "            return 1;",
+    "        }",
+    "",
+    "        allowMatch = (stateBytes[(unsigned char) ch] & @_ALLOWEDBYTE) != 0;",
+    "        escapeMatch = (stateBytes[(unsigned char) ch] & @_ESCAPEDBYTE) != 0;",
+    "",
+    "        size_t endState = 1;",
+    "        bool endComplete = false;",
+    "        bool endPotential = false;",
+    "        int endNumComplete = 0;",
+    "        int endBacktrack = 0;",
+    "        int endHighest = @_NOMATCH;",
+    "        @_Clear(endToken);",
+    "        endCh = 0;",
+    "        endCheckComplete = false;",
+    "        probeStart = input->position;",
+    "",
+    "        while(endCh != EOF && endCheckComplete == false){",
+    "            endCh = (char) @_Read(input);",
+    "            @_AddChar(endToken, endCh);",
+    "            endHighest = @_NOMATCH;",
+    "",
+    "            endState = @_EndSteps[endSet](endState, (unsigned char) endCh);",
+    "            if(@_EndMatches[endSet][endState] > 0){",
+    "                endBacktrack = 0;",
+    "                endComplete = true;",
+    "                endNumComplete += (int) @_EndMatches[endSet][endState];",
+    "                endHighest = @_COMPLETEMATCH;",
+    "            }",
+    "            else if(endState != 0 && endHighest == @_NOMATCH){",
+    "                endBacktrack++;",
+    "                endPotential = true;",
+    "                endHighest = @_PARTIALMATCH;",
+    "            }",
+    "            if(endHighest == @_COMPLETEMATCH)",
+    "                endMatchEnd = input->position;",
+    "",
+    "            if(endComplete == false && endPotential == false){",
+    "                // The checked character belongs to the token so matching carries on just after it",
+    "                input->position = probeStart + 1;",
+    "                endMatch = false;",
+    "                endCheckComplete = true;",
+    "                break;",
+    "            }",
+    "            if(endNumComplete == 0 && endPotential == false && endComplete == true){",
+    "                input->position = endMatchEnd;",
+    "                @_Truncate(endToken, 1 + endBacktrack);",
+    "                endMatch = true;",
+    "                endCheckComplete = true;",
+    "                break;",
+    "            }",
+    "",
+    "            endNumComplete = 0;",
+    "            endPotential = false;",
+    "        }",
+    "",
+    "        // Whether the end of the state is taken depends on whether it is escaped",
+    "        if(escapeMatch == true && currentlyEscaped == false){",
+    "            currentlyEscaped = true;",
+    "        }",
+    "        else if(escapeMatch == true && currentlyEscaped == true){",
+    "            currentlyEscaped = false;",
+    "            @_Truncate(token, 1);",
+    "        }",
+    "        else if(endMatch == true && currentlyEscaped == true){",
+    "            currentlyEscaped = false;",
+    "            @_Truncate(token, 1);",
+    "        }",
+    "        else if(endMatch == true && currentlyEscaped == false){",
+    "            @_AddRange(token, endToken->text, endToken->length);",
+    "            break;",
+    "        }",
+    "        else if(allowMatch == true){",
+    "            currentlyEscaped = false;",
+    "        }",
+    "        else{",
+    "            printf(\"Found invalid character \\\"%c\\\" during parsing of state for keyword \\\"%s\\\"\\n\", ch, @_Keywords[rule]);",
+    "            return 1;",
+    "        }",
+    "        @_AddChar(token, (char) ch);",
+    "    }",
+    "",
+    "    return 0;",
+    "}",
+    "",
+    "// Add a matched token to the token table, or stop at an error token",
+    "static int @_EmitToken(NDR_Context* context, size_t tokenStart, @_Text* token, int rule){",
+    "    if(@_Categories[rule] == NDR_STATE_ERROR){",
+    "        printf(\"\\nError token found: %s\\n\", token->text);",
+    "        return 1;",
+    "    }",
+    "    if(@_Categories[rule] == NDR_STATE_ACCEPT)",
+    "        @_AddToken(context, tokenStart, (@_IsLiteral[rule] == true && @_StateTables[rule] < 0) ? token->text : @_Keywords[rule], token->text);",
+    "    return 0;",
+    "}",
+    "",
+    "static int @_Scan(NDR_Context* context, @_Input* input, @_Text* token, @_Text* endToken){",
+    "    size_t firstToken = NDR_TIGetNumberOfTokens(context->TIWrapper);",
+    "    char ch = 0;",
+    "    size_t tokenStart = 0;",
+    "    size_t matchEnd = input->position;",
+    "    size_t dfaState = 1;",
+    "    size_t trieNode = 1;",
+    "    int bestMatch = 0;",
+    "    bool completeMatch = false;",
+    "    bool potentialMatch = false;",
+    "    int numCompleteMatches = 0;",
+    "    int backtrack = 0;",
+    "    int highestMatch = @_NOMATCH;",
+    "",
+    "    while(ch != EOF){",
+    "",
+    "        // The token is empty only at a boundary between two tokens",
+    "        if(token->length == 0){",
+    "            @_UpdateLookahead(context, firstToken, input);",
+    "            if(input->position >= input->length)",
+    "                return 0;",
+    "            tokenStart = input->position;",
+    "        }",
+    "",
+    "        ch = (char) @_Read(input);",
+    "        @_AddChar(token, ch);",
+    "        highestMatch = @_NOMATCH;",
+    "",
+    "        // Literal start regexes are matched by the trie and every other start regex by the automaton",
+    "        if(trieNode != 0){",
+    "            trieNode = @_TrieStep(trieNode, (unsigned char) ch);",
+    "            if(@_TrieMatches[trieNode] > 0){",
+    "                if(completeMatch == false || numCompleteMatches == 0 || @_TrieAccepting[trieNode] < bestMatch)",
+    "                    bestMatch = @_TrieAccepting[trieNode];",
+    "                backtrack = 0;",
+    "                completeMatch = true;",
+    "                numCompleteMatches += (int) @_TrieMatches[trieNode];",
+    "                highestMatch = @_COMPLETEMATCH;",
+    "            }",
+    "            else if(trieNode != 0 && highestMatch == @_NOMATCH){",
+    "                backtrack++;",
+    "                potentialMatch = true;",
+    "                highestMatch = @_PARTIALMATCH;",
+    "            }",
+    "        }",
+    "        dfaState = @_StartStep(dfaState, (unsigned char) ch);",
+    "        if(@_StartMatches[dfaState] > 0){",
+    "            if(completeMatch == false || numCompleteMatches == 0 || @_StartAccepting[dfaState] < bestMatch)",
+    "                bestMatch = @_StartAccepting[dfaState];",
+    "            backtrack = 0;",
+    "            completeMatch = true;",
+    "            numCompleteMatches += (int) @_StartMatches[dfaState];",
+    "            highestMatch = @_COMPLETEMATCH;",
+    "        }",
+    "        else if(dfaState != 0 && highestMatch == @_NOMATCH){",
+    "            backtrack++;",
+    "            potentialMatch = true;",
+    "            highestMatch = @_PARTIALMATCH;",
+    "        }",
+    "        if(highestMatch == @_COMPLETEMATCH)",
+    "            matchEnd = input->position;",
+    "",
+    "        // A token is complete once nothing matches the character after its longest complete match",
+    "        if(numCompleteMatches == 0 && potentialMatch == false && completeMatch == true){",
+    "            if(@_StateTables[bestMatch] >= 0){",
+    "                @_Truncate(token, (backtrack > 0) ? (size_t) backtrack : 1);",
+    "                input->position = matchEnd;",
+    "                if(@_MatchState(input, token, endToken, bestMatch) != 0)",
+    "                    return 1;",
+    "            }",
+    "            else{",
+    "                @_Truncate(token, 1 + (size_t) backtrack);",
+    "                input->position = matchEnd;",
+    "            }",
+    "            if(@_EmitToken(context, tokenStart, token, bestMatch) != 0)",
+    "                return 1;",
+    "",
+    "            completeMatch = false;",
+    "            @_Clear(token);",
+    "            dfaState = 1;",
+    "            trieNode = 1;",
+    "            bestMatch = 0;",
+    "        }",
+    "        if(numCompleteMatches == 1 && token->length > 1 && ch == EOF){",
+    "            printf(\"\\nIncomplete matching from line: %i column: %i\\nPotentially an opening of item with no closing\\n\", (int) NDR_LineIndexGetLine(context->lineIndex, tokenStart), (int) NDR_LineIndexGetColumn(context->lineIndex, tokenStart));",
+    "            return 1;",
+    "        }",
+    "        else if(numCompleteMatches == 0 && token->length > 1 && ch == EOF && @_MATCHALL == true){",
+    "            printf(\"\\nMatching error from line: %i column: %i\\n\", (int) NDR_LineIndexGetLine(context->lineIndex, tokenStart), (int) NDR_LineIndexGetColumn(context->lineIndex, tokenStart));",
+    "            return 1;",
+    "        }",
+    "",
+    "        numCompleteMatches = 0;",
+    "        potentialMatch = false;",
+    "    }",
+    "    @_UpdateLookahead(context, firstToken, input);",
+    "",
+    "    return 0;",
+    "}",
+    "",
+    "int @(NDR_Context* context, const char* data, size_t len){",
+    "",
+    "    if(context->lexingAttempted == true){",
+    "        printf(\"\\nCode file lexical analysis has already been performed, reset the input before processing another code file\\n\");",
+    "        return 1;",
+    "    }",
+    "    context->lexingAttempted = true;",
+    "    if(data == NULL && len > 0){",
+    "        printf(\"A valid buffer must be provided for processing\\n\");",
+    "        return 1;",
+    "    }",
+    "",
+    "    if(context->TIWrapper == NULL){",
+    "        context->TIWrapper = malloc(sizeof(NDR_TokenInformationWrapper));",
+    "        NDR_InitTokenInfoWrapper(context->TIWrapper);",
+    "    }",
+    "    if(context->lineIndex == NULL){",
+    "        context->lineIndex = malloc(sizeof(NDR_LineIndex));",
+    "        NDR_InitLineIndex(context->lineIndex);",
+    "    }",
+    "    NDR_ResetLineIndex(context->lineIndex);",
+    "    NDR_LineIndexAddText(context->lineIndex, data, len);",
+    "    context->inputLength = len;",
+    "",
+    "    @_Input input;",
+    "    input.data = data;",
+    "    input.length = len;",
+    "    input.position = 0;",
+    "    input.furthest = 0;",
+    "    @_Text token;",
+    "    @_Text endToken;",
+    "    @_InitText(&token);",
+    "    @_InitText(&endToken);",
+    "",
+    "    int result = @_Scan(context, &input, &token, &endToken);",
+    "    free(token.text);",
+    "    free(endToken.text);",
+    "    if(result != 0)",
+    "        return 1;",
+    "",
+    "    if(NDR_TIGetNumberOfTokens(context->TIWrapper) == 0){",
+    "        printf(\"\\nNo text was matched during parsing of the source file.\\n\");",
+    "        return 1;",
+    "    }",
+    "    if (NDR_TT == true)",
+    "        NDR_Context_PrintTokenTable(context);",
+    "    if (NDR_TL == true)",
+    "        NDR_Context_PrintTokenTableLocations(context);",
+    "",
+    "    context->lexingCompleted = true;",
+    "",
+    "    if (NDR_STAT == true)",
+    "        printf(\"\\nLexical analysis successful\\n\");",
+    "",
+    "    return 0;",
+    "}",
+    NULL
+};
+
+
+
+int main(int argc, char** argv){
+
+    if(argc < 3 || argc > 4){
+        printf("Usage: ndr_lexgen <lexer configuration file> <output C file> [function name]\n");
+        return 1;
+    }
+    const char* name = (argc == 4) ? argv[3] : LEXGEN_DEFAULTNAME;
+    if(IsIdentifier(name) == false){
+        printf("\"%s\" cannot be used as the name of a C function\n", name);
+        return 1;
+    }
+
+    NDR_Context* context = malloc(sizeof(NDR_Context));
+    NDR_InitContext(context);
+    if(NDR_Context_Configure_Lexer(context, argv[1]) != 0){
+        printf("\nFailed to configure the lexer from \"%s\"\n", argv[1]);
+        NDR_DestroyContext(context);
+        free(context);
+        return 1;
+    }
+
+    LexerGenerator generator;
+    generator.context = context;
+    generator.name = name;
+    generator.output = NULL;
+    generator.stateTables = NULL;
+    generator.numStateTables = 0;
+    generator.endSets = NULL;
+    generator.endAutomata = NULL;
+    generator.numEndAutomata = 0;
+
+    int result = 1;
+    // The scanner keeps no mode stack so it can only follow configurations that stay in the initial mode
+    if(NDR_RSGetNumberOfModes(context->RSWrapper) > 1)
+        printf("\n\"%s\" uses lexer modes, which generated scanners do not support\n", argv[1]);
+    else if(CanGenerateScanner(context) == false)
+        printf("\nThe start regexes of \"%s\" cannot be combined into one automaton so no scanner can be generated\n", argv[1]);
+    else if(BuildEndAutomata(&generator) == 0)
+        result = WriteScanner(&generator, argv[1], argv[2]);
+
+    FreeLexerGenerator(&generator);
+    NDR_DestroyContext(context);
+    free(context);
+
+    return result;
+}
+
+bool IsIdentifier(const char* name){
+    if(name[0] == '\0' || (name[0] >= '0' && name[0] <= '9'))
+        return false;
+    for(size_t x = 0; name[x] != '\0'; x++){
+        char ch = name[x];
+        if(!((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9') || ch == '_'))
+            return false;
+    }
+    return true;
+}
+
+// Every start regex must be matched by the combined automaton or the literal trie since the scanner has no regexes left to fall back on
+bool CanGenerateScanner(NDR_Context* context){
+    if(context->lexerDFA != NULL)
+        return true;
+    for(size_t x = 0; x < NDR_RSGetNumberOfStates(context->RSWrapper); x++){
+        NDR_RegexState* regexState = NDR_RSGetRegexState(context->RSWrapper, x);
+        for(size_t i = 0; i < NDR_RSGetNumStartStates(regexState); i++){
+            if(context->lexerTrie == NULL || NDR_LexerTrieHoldsRegex(regexState->compiledStartRegex[i]) == false)
+                return false;
+        }
+    }
+    return true;
+}
+
+// States sharing a keyword share their end regexes, as they do within the lexer, so one automaton is built for each keyword
+int BuildEndAutomata(LexerGenerator* generator){
+    NDR_RegexStateWrapper* RSWrapper = generator->context->RSWrapper;
+    size_t numStates = NDR_RSGetNumberOfStates(RSWrapper);
+
+    generator->stateTables = malloc(sizeof(int) * numStates);
+    generator->endSets = malloc(sizeof(int) * numStates);
+    generator->endAutomata = malloc(sizeof(NDR_LexerDFA*) * numStates);
+
+    for(size_t x = 0; x < numStates; x++){
+        NDR_RegexState* regexState = NDR_RSGetRegexState(RSWrapper, x);
+        generator->stateTables[x] = -1;
+        if(NDR_RSGetStateFlag(regexState) == false)
+            continue;
+
+        int endSet = -1;
+        for(size_t y = 0; y < x && endSet == -1; y++){
+            NDR_RegexState* previous = NDR_RSGetRegexState(RSWrapper, y);
+            if(NDR_RSGetStateFlag(previous) == true && strcmp(NDR_RSGetKeyword(regexState), NDR_RSGetKeyword(previous)) == 0)
+                endSet = generator->endSets[generator->stateTables[y]];
+        }
+
+        if(endSet == -1){
+            size_t numRegexes = 0;
+            for(size_t y = 0; y < numStates; y++){
+                NDR_RegexState* sibling = NDR_RSGetRegexState(RSWrapper, y);
+                if(NDR_RSGetStateFlag(sibling) == true && strcmp(NDR_RSGetKeyword(regexState), NDR_RSGetKeyword(sibling)) == 0)
+                    numRegexes += NDR_RSGetNumEndStates(sibling);
+            }
+
+            NDR_LexerDFA* endAutomaton = NULL;
+            if(numRegexes > 0){
+                NDR_Regex** regexes = malloc(sizeof(NDR_Regex*) * numRegexes);
+                int* rules = malloc(sizeof(int) * numRegexes);
+                size_t numAdded = 0;
+                for(size_t y = 0; y < numStates; y++){
+                    NDR_RegexState* sibling = NDR_RSGetRegexState(RSWrapper, y);
+                    if(NDR_RSGetStateFlag(sibling) == false || strcmp(NDR_RSGetKeyword(regexState), NDR_RSGetKeyword(sibling)) != 0)
+                        continue;
+                    for(size_t i = 0; i < NDR_RSGetNumEndStates(sibling); i++){
+                        regexes[numAdded] = sibling->compiledEndRegex[i];
+                        rules[numAdded++] = (int) y;
+                    }
+                }
+
+                endAutomaton = malloc(sizeof(NDR_LexerDFA));
+                NDR_InitLexerDFA(endAutomaton);
+                int result = NDR_BuildRegexListDFA(endAutomaton, regexes, rules, NULL, numRegexes, 1);
+                free(regexes);
+                free(rules);
+                if(result != 0){
+                    free(endAutomaton);
+                    printf("\nThe end regexes of state \"%s\" cannot be combined into one automaton so no scanner can be generated\n", NDR_RSGetKeyword(regexState));
+                    return 1;
+                }
+            }
+            endSet = (int) generator->numEndAutomata;
+            generator->endAutomata[generator->numEndAutomata++] = endAutomaton;
+        }
+
+        generator->stateTables[x] = (int) generator->numStateTables;
+        generator->endSets[generator->numStateTables++] = endSet;
+    }
+
+    return 0;
+}
+
+void FreeLexerGenerator(LexerGenerator* generator){
+    for(size_t x = 0; x < generator->numEndAutomata; x++){
+        if(generator->endAutomata[x] != NULL){
+            NDR_FreeLexerDFA(generator->endAutomata[x]);
+            free(generator->endAutomata[x]);
+        }
+    }
+    free(generator->endAutomata);
+    free(generator->endSets);
+    free(generator->stateTables);
+}
+
+void GetGeneratedAutomaton(GeneratedAutomaton* automaton, size_t numStates, size_t numByteClasses, const size_t* byteClasses, const size_t* transitions, const int* acceptingRule, const size_t* numCompleteMatches){
+    automaton->numStates = numStates;
+    automaton->numByteClasses = numByteClasses;
+    automaton->byteClasses = byteClasses;
+    automaton->transitions = transitions;
+    automaton->acceptingRule = acceptingRule;
+    automaton->numCompleteMatches = numCompleteMatches;
+}
+
+void WriteCode(LexerGenerator* generator, const char* code){
+    for(size_t x = 0; code[x] != '\0'; x++){
+        if(code[x] == '@')
+            fputs(generator->name, generator->output);
+        else
+            fputc(code[x], generator->output);
+    }
+}
+
+// Write a string as a C string literal, escaping every byte that cannot appear within one as is
+void WriteString(FILE* output, const char* string){
+    fputc('"', output);
+    for(size_t x = 0; string[x] != '\0'; x++){
+        unsigned char ch = (unsigned char) string[x];
+        if(ch == '"' || ch == '\\' || ch == '?')
+            fprintf(output, "\\%c", ch);
+        else if(ch < 32 || ch > 126)
+            fprintf(output, "\\%03o", ch);
+        else
+            fputc(ch, output);
+    }
+    fputc('"', output);
+}
+
+// The step function switches on the state and then on the class of the byte, the most common target of a state is its default
+void WriteAutomaton(LexerGenerator* generator, const char* prefix, GeneratedAutomaton* automaton, bool withAcceptingRules){
+    FILE* output = generator->output;
+    size_t numClasses = automaton->numByteClasses;
+    size_t* counts = malloc(sizeof(size_t) * numClasses);
+
+    bool live = false;
+    for(size_t x = 0; x < automaton->numStates * numClasses && live == false; x++)
+        live = (automaton->transitions[x] != 0);
+
+    WriteCode(generator, "static size_t @_");
+    fprintf(output, "%sStep(size_t state, unsigned char ch){\n", prefix);
+    if(live == false){
+        fprintf(output, "    (void) state;\n    (void) ch;\n    return 0;\n}\n\n");
+    }
+    else{
+        fprintf(output, "    static const unsigned char byteClasses[256] = {");
+        for(size_t x = 0; x < 256; x++)
+            fprintf(output, "%s%zu%s", (x % LEXGEN_VALUESPERLINE == 0) ? "\n        " : "", automaton->byteClasses[x], (x < 255) ? ", " : "\n    };\n");
+        fprintf(output, "    switch(state){\n");
+
+        for(size_t state = 0; state < automaton->numStates; state++){
+            const size_t* row = automaton->transitions + (state * numClasses);
+
+            // The default target is the one reached from the most byte classes, ties go to the lowest class
+            size_t defaultClass = 0;
+            for(size_t x = 0; x < numClasses; x++){
+                counts[x] = 0;
+                for(size_t y = 0; y < numClasses; y++)
+                    counts[x] += (row[y] == row[x]);
+                if(counts[x] > counts[defaultClass])
+                    defaultClass = x;
+            }
+            size_t defaultTarget = row[defaultClass];
+
+            if(counts[defaultClass] == numClasses){
+                if(defaultTarget != 0)
+                    fprintf(output, "    case %zu: return %zu;\n", state, defaultTarget);
+                continue;
+            }
+
+            fprintf(output, "    case %zu:\n        switch(byteClasses[ch]){\n", state);
+            for(size_t x = 0; x < numClasses; x++){
+                bool firstOfTarget = (row[x] != defaultTarget);
+                for(size_t y = 0; y < x && firstOfTarget == true; y++)
+                    firstOfTarget = (row[y] != row[x]);
+                if(firstOfTarget == false)
+                    continue;
+
+                size_t numCases = 0;
+                for(size_t y = x; y < numClasses; y++){
+                    if(row[y] != row[x])
+                        continue;
+                    fprintf(output, "%scase %zu:", (numCases % LEXGEN_VALUESPERLINE == 0) ? ((numCases == 0) ? "        " : "\n        ") : " ", y);
+                    numCases++;
+                }
+                fprintf(output, " return %zu;\n", row[x]);
+            }
+            fprintf(output, "        default: return %zu;\n        }\n", defaultTarget);
+        }
+        fprintf(output, "    }\n    return 0;\n}\n\n");
+    }
+
+    if(withAcceptingRules == true){
+        WriteCode(generator, "static const int @_");
+        fprintf(output, "%sAccepting[%zu] = {", prefix, automaton->numStates);
+        for(size_t x = 0; x < automaton->numStates; x++)
+            fprintf(output, "%s%i%s", (x % LEXGEN_VALUESPERLINE == 0) ? "\n    " : "", automaton->acceptingRule[x], (x + 1 < automaton->numStates) ? ", " : "\n};\n");
+    }
+    WriteCode(generator, "static const size_t @_");
+    fprintf(output, "%sMatches[%zu] = {", prefix, automaton->numStates);
+    for(size_t x = 0; x < automaton->numStates; x++)
+        fprintf(output, "%s%zu%s", (x % LEXGEN_VALUESPERLINE == 0) ? "\n    " : "", automaton->numCompleteMatches[x], (x + 1 < automaton->numStates) ? ", " : "\n};\n\n");
+
+    free(counts);
+}
+
+// The keyword, category and kind of every regex state along with the byte tables of every state token
+void WriteSymbolTables(LexerGenerator* generator){
+    FILE* output = generator->output;
+    NDR_RegexStateWrapper* RSWrapper = generator->context->RSWrapper;
+    size_t numStates = NDR_RSGetNumberOfStates(RSWrapper);
+
+    WriteCode(generator, "static const char* const @_Keywords[] = {\n");
+    for(size_t x = 0; x < numStates; x++){
+        fprintf(output, "    ");
+        WriteString(output, NDR_RSGetKeyword(NDR_RSGetRegexState(RSWrapper, x)));
+        fprintf(output, "%s\n", (x + 1 < numStates) ? "," : "");
+    }
+    fprintf(output, "};\n");
+
+    WriteCode(generator, "static const NDR_StateCategories @_Categories[] = {\n");
+    for(size_t x = 0; x < numStates; x++){
+        NDR_StateCategories category = NDR_RSGetCategory(NDR_RSGetRegexState(RSWrapper, x));
+        if(category == NDR_STATE_ACCEPT)
+            fprintf(output, "    NDR_STATE_ACCEPT");
+        else if(category == NDR_STATE_IGNORE)
+            fprintf(output, "    NDR_STATE_IGNORE");
+        else if(category == NDR_STATE_ERROR)
+            fprintf(output, "    NDR_STATE_ERROR");
+        else
+            fprintf(output, "    (NDR_StateCategories) %i", (int) category);
+        fprintf(output, "%s\n", (x + 1 < numStates) ? "," : "");
+    }
+    fprintf(output, "};\n");
+
+    WriteCode(generator, "static const bool @_IsLiteral[] = {");
+    for(size_t x = 0; x < numStates; x++)
+        fprintf(output, "%s%s%s", (x % LEXGEN_VALUESPERLINE == 0) ? "\n    " : "", (NDR_RSGetLiteralFlag(NDR_RSGetRegexState(RSWrapper, x)) == true) ? "true" : "false", (x + 1 < numStates) ? ", " : "\n};\n");
+
+    WriteCode(generator, "static const int @_StateTables[] = {");
+    for(size_t x = 0; x < numStates; x++)
+        fprintf(output, "%s%i%s", (x % LEXGEN_VALUESPERLINE == 0) ? "\n    " : "", generator->stateTables[x], (x + 1 < numStates) ? ", " : "\n};\n\n");
+
+    // A configuration without state tokens still gets one row so the tables are never empty
+    size_t numRows = (generator->numStateTables > 0) ? generator->numStateTables : 1;
+    WriteCode(generator, "static const unsigned char @_StateBytes[][256] = {\n");
+    for(size_t row = 0; row < numRows; row++){
+        NDR_RegexState* regexState = NULL;
+        for(size_t x = 0; x < numStates && regexState == NULL; x++){
+            if(generator->stateTables[x] == (int) row)
+                regexState = NDR_RSGetRegexState(RSWrapper, x);
+        }
+        fprintf(output, "    {");
+        for(int ch = 0; ch < 256; ch++){
+            int bytes = 0;
+            if(regexState != NULL){
+                bytes |= (NDR_RSIsAllowedByte(regexState, (char) ch) == true) ? 1 : 0;
+                bytes |= (NDR_RSIsEscapedByte(regexState, (char) ch) == true) ? 2 : 0;
+                bytes |= (NDR_RSIsPlainByte(regexState, (char) ch) == true) ? 4 : 0;
+            }
+            fprintf(output, "%s%i%s", (ch % (LEXGEN_VALUESPERLINE * 2) == 0) ? "\n        " : "", bytes, (ch < 255) ? ", " : "\n    }");
+        }
+        fprintf(output, "%s\n", (row + 1 < numRows) ? "," : "");
+    }
+    fprintf(output, "};\n");
+
+    WriteCode(generator, "static const int @_EndSets[] = {");
+    for(size_t row = 0; row < numRows; row++)
+        fprintf(output, "%s%i%s", (row % LEXGEN_VALUESPERLINE == 0) ? "\n    " : "", (generator->numStateTables > 0) ? generator->endSets[row] : 0, (row + 1 < numRows) ? ", " : "\n};\n\n");
+}
+
+int WriteScanner(LexerGenerator* generator, char* configFileName, char* fileName){
+    NDR_Context* context = generator->context;
+
+    generator->output = fopen(fileName, "w");
+    if(generator->output == NULL){
+        printf("Cannot open \"%s\" to write the scanner\n", fileName);
+        return 1;
+    }
+    FILE* output = generator->output;
+
+    fprintf(output, "/* Generated by ndr_lexgen, changes are lost once the scanner is generated again\n\n");
+    WriteCode(generator, "   int @(NDR_Context* context, const char* data, size_t len);\n\n");
+    fprintf(output, "   lexes data into the token table of a context the same way NDR_Context_LexBuffer would with the lexer configuration\n");
+    fprintf(output, "   the scanner was generated from, without configuring the lexer of the context first. */\n\n");
+    fprintf(output, "#include <stdio.h>\n#include <stdlib.h>\n#include <string.h>\n#include <stdbool.h>\n\n#include \"ndr_lap.h\"\n\n");
+
+    WriteCode(generator, "#define @_ALLOWEDBYTE 1\n#define @_ESCAPEDBYTE 2\n#define @_PLAINBYTE 4\n");
+    WriteCode(generator, "#define @_MATCHALL ");
+    fprintf(output, "%s\n\n", (context->matchAll == true) ? "true" : "false");
+    WriteCode(generator, "int @(NDR_Context* context, const char* data, size_t len);\n\n");
+
+    WriteSymbolTables(generator);
+
+    GeneratedAutomaton automaton;
+    if(context->lexerDFA != NULL)
+        GetGeneratedAutomaton(&automaton, context->lexerDFA->numStates, context->lexerDFA->numByteClasses, context->lexerDFA->byteClasses, context->lexerDFA->transitions, context->lexerDFA->acceptingRule, context->lexerDFA->numCompleteMatches);
+    else
+        GetGeneratedAutomaton(&automaton, 2, 1, emptyByteClasses, emptyTransitions, emptyAcceptingRule, emptyCompleteMatches);
+    WriteAutomaton(generator, "Start", &automaton, true);
+
+    if(context->lexerTrie != NULL)
+        GetGeneratedAutomaton(&automaton, context->lexerTrie->numNodes, context->lexerTrie->numByteClasses, context->lexerTrie->byteClasses, context->lexerTrie->transitions, context->lexerTrie->acceptingRule, context->lexerTrie->numCompleteMatches);
+    else
+        GetGeneratedAutomaton(&automaton, 2, 1, emptyByteClasses, emptyTransitions, emptyAcceptingRule, emptyCompleteMatches);
+    WriteAutomaton(generator, "Trie", &automaton, true);
+
+    size_t numEndAutomata = (generator->numEndAutomata > 0) ? generator->numEndAutomata : 1;
+    char prefix[32];
+    for(size_t x = 0; x < numEndAutomata; x++){
+        NDR_LexerDFA* endAutomaton = (generator->numEndAutomata > 0) ? generator->endAutomata[x] : NULL;
+        if(endAutomaton != NULL)
+            GetGeneratedAutomaton(&automaton, endAutomaton->numStates, endAutomaton->numByteClasses, endAutomaton->byteClasses, endAutomaton->transitions, endAutomaton->acceptingRule, endAutomaton->numCompleteMatches);
+        else
+            GetGeneratedAutomaton(&automaton, 2, 1, emptyByteClasses, emptyTransitions, emptyAcceptingRule, emptyCompleteMatches);
+        sprintf(prefix, "End%zu", x);
+        WriteAutomaton(generator, prefix, &automaton, false);
+    }
+
+    WriteCode(generator, "static size_t (*const @_EndSteps[])(size_t, unsigned char) = {");
+    for(size_t x = 0; x < numEndAutomata; x++){
+        WriteCode(generator, (x % 4 == 0) ? "\n    @_" : " @_");
+        fprintf(output, "End%zuStep%s", x, (x + 1 < numEndAutomata) ? "," : "\n};\n");
+    }
+    WriteCode(generator, "static const size_t* const @_EndMatches[] = {");
+    for(size_t x = 0; x < numEndAutomata; x++){
+        WriteCode(generator, (x % 4 == 0) ? "\n    @_" : " @_");
+        fprintf(output, "End%zuMatches%s", x, (x + 1 < numEndAutomata) ? "," : "\n};\n");
+    }
+
+    for(size_t x = 0; scannerCode[x] != NULL; x++){
+        WriteCode(generator, scannerCode[x]);
+        fputc('\n', output);
+    }
+
+    if(fclose(output) != 0){
+        printf("Failed to write the scanner to \"%s\"\n", fileName);
+        return 1;
+    }
+    if (NDR_STAT == true)
+        printf("\nScanner for \"%s\" written to \"%s\"\n", configFileName, fileName);
+
+    return 0;
+}